@@ -7,6 +7,10 @@
 
 #include <memory>
 
+namespace llvm {
+class PostDominatorTree;
+}
+
 namespace seahorn {
 
 class ControlDependenceAnalysis;
@@ -48,6 +52,11 @@ private:
 
 llvm::ModulePass *createControlDependenceAnalysisPass();
 
+/// Computes control dependence of a single function outside of the pass
+std::unique_ptr<ControlDependenceAnalysis>
+createControlDependenceAnalysis(llvm::Function &F,
+                                llvm::PostDominatorTree &PDT);
+
 /// Exposes Control Dependence Information on the basic-block-level.
 /// A basic block X is control dependent on a basic block Y iff:
 ///   1) X != Y, and
@@ -2,6 +2,7 @@
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Pass.h"
 
@@ -12,6 +13,20 @@ namespace seahorn {
 class ControlDependenceAnalysis;
 class GateAnalysis;
 
+/// A gating function kept outside of the IR, as built by the lazy analysis
+/// (--gsa-lazy). A leaf is a value of the function. Any other node is the
+/// gamma ite(cond, trueVal, falseVal) on the condition of a branch.
+struct Gamma {
+  /// value of a leaf, null otherwise
+  llvm::Value *value = nullptr;
+  /// branch condition of a gamma, null for a leaf
+  llvm::Value *cond = nullptr;
+  const Gamma *trueVal = nullptr;
+  const Gamma *falseVal = nullptr;
+
+  bool isLeaf() const { return cond == nullptr; }
+};
+
 /// Pass for constructing (Thinned) Gated SSA form. Given a module with phi
 /// nodes, it constructs gating gamma functions, and can express them as selects
 /// in the LLVM IR. Note that if phi nodes are replaced with gammas the LLVM
@@ -29,6 +44,11 @@ class GateAnalysis;
 ///   - Assumes the CFG is loop-free. This can be made to work with loops.
 /// This is a module pass because it's used by another module pass (BmcPass) --
 /// there is a bug with using function passes from module passes.
+///
+/// With --gsa-lazy, nothing is computed when the pass runs. Gates of a PHI
+/// node are computed when the node is first queried, as Gamma nodes outside
+/// of the IR. The IR is never changed in this mode, so
+/// --gsa-replace-phis=false is required.
 class GateAnalysisPass : public llvm::ModulePass {
 public:
   static char ID;
@@ -42,14 +62,16 @@ public:
   llvm::StringRef getPassName() const override { return "GateAnalysisPass"; }
   void print(llvm::raw_ostream &os, const llvm::Module *M) const override;
 
-  bool hasAnalysisFor(const llvm::Function &F) const {
-    return m_analyses.count(&F) > 0;
-  }
+  bool hasAnalysisFor(const llvm::Function &F) const;
 
-  GateAnalysis &getGateAnalysis(const llvm::Function &F) {
-    assert(hasAnalysisFor(F));
-    return *m_analyses[&F];
-  }
+  /// True if gates are computed on demand (--gsa-lazy)
+  bool isLazy() const;
+
+  /// Gate analysis of F. In lazy mode, it is created on first request
+  GateAnalysis &getGateAnalysis(const llvm::Function &F);
+
+  /// Gamma of PN, in lazy mode only. Only the gates of PN are computed
+  const Gamma &getGamma(llvm::PHINode &PN);
 
 private:
   // PIMPL idiom used here to minimize the amount of code in headers.
@@ -65,8 +87,13 @@ public:
 
   /// returns: The gating gamma function. This will be either a gamma node
   ///         (SelectInst), another another value if the flow is not gated.
+  ///         Null in lazy mode, where gammas are not in the IR (see
+  ///         GateAnalysisPass::getGamma).
   virtual llvm::Value *getGamma(llvm::PHINode *PN) const = 0;
 
+  /// return: Whether V is a gamma node (SelectInst) created by the analysis.
+  virtual bool isGamma(const llvm::Value *V) const = 0;
+
   /// return: Whether gamma nodes are Thinned (TGSA) or not (GSA). GSA allows
   ///         for Undefs to be used in gammas.
   virtual bool isThinned() const = 0;
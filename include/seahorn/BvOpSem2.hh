@@ -22,6 +22,7 @@ class InterGlobalClam;
 } // namespace clam
 
 namespace seahorn {
+class GateAnalysisPass;
 namespace details {
 class Bv2OpSemContext;
 Bv2OpSemContext &ctx(OpSemContext &_ctx);
@@ -42,6 +43,8 @@ class Bv2OpSem : public OperationalSemantics {
   const DataLayout *m_td;
   const TargetLibraryInfoWrapperPass *m_tliWrapper;
   const CanFail *m_canFail;
+  /// \brief gating functions of PHI nodes, queried on demand (optional)
+  GateAnalysisPass *m_gsa;
 
   /// \brief lvi's map used for analysis
   using lvi_func_map_t =
@@ -67,6 +70,12 @@ public:
   }
   const DataLayout &getDataLayout() { return getTD(); }
 
+  /// \brief Encodes PHI nodes by their gating (gamma) functions instead of
+  /// by the incoming value of the previous block. Gates are queried from
+  /// \p gsa while encoding, so only PHI nodes that are executed are analyzed
+  void setGateAnalysis(GateAnalysisPass *gsa) { m_gsa = gsa; }
+  GateAnalysisPass *getGateAnalysis() const { return m_gsa; }
+
   /// \brief Creates a new context
   OpSemContextPtr mkContext(SymStore &values, ExprVector &side) override;
 
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "seahorn/Expr/Expr.hh"
+#include "seahorn/config.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_CLAM
+#include "seahorn/clam_Clam.hh"
+#include "clam/CrabDomain.hh"
+
+namespace llvm {
+class TargetLibraryInfoWrapperPass;
+} // namespace llvm
+
+namespace seadsa {
+class GlobalAnalysis;
+} // namespace seadsa
+
+namespace clam {
+class CfgBuilder;
+struct CrabBuilderParams;
+} // namespace clam
+#endif
+
+namespace seahorn {
+
+/**
+ * Process-wide cache of per-function Crab invariants.
+ *
+ * The invariant of each block is kept as an SMT-LIB script over the
+ * arguments and instructions of the function, numbered by position.
+ * Entries therefore depend neither on Clam nor on an ExprFactory, and
+ * can be shared by every engine of a pipeline (path-bmc, horn-crab)
+ * and stored on disk with --crab-inv-cache-dir.
+ *
+ * An entry is keyed by the abstract domain, a format version, and a
+ * hash of the function, of the globals and signatures of functions it
+ * refers to, and of its context: the analysis parameters and, for an
+ * inter-procedural analysis, the whole module (see crabCacheContext).
+ * Editing a function only invalidates its own entry and the entries of
+ * functions that use a changed signature or global. Invariants are in
+ * crab semantics: every value is an integer or a boolean constant (see
+ * LinConsToExpr).
+ */
+class CrabInvariantCache {
+public:
+  /// SMT-LIB script of the invariant of each block, in block order.
+  /// An empty script stands for true.
+  using Entry = std::vector<std::string>;
+  using BlockInvariants = llvm::DenseMap<const llvm::BasicBlock *, expr::Expr>;
+
+private:
+  std::mutex m_mutex;
+  llvm::StringMap<Entry> m_entries;
+
+  bool loadFromDisk(llvm::StringRef key, Entry &out);
+  void storeToDisk(llvm::StringRef key, const Entry &entry);
+
+public:
+  /// The cache shared by all passes of the process
+  static CrabInvariantCache &get();
+  /// True if engines should go through the cache (--crab-inv-cache)
+  static bool isEnabled();
+
+  /// Hash of the globals and functions of M, for the context of an
+  /// inter-procedural analysis. Module and source file names are left
+  /// out since they name temporary files.
+  static std::string moduleFingerprint(const llvm::Module &M);
+
+  /// Key of the invariants of F computed with the given abstract domain.
+  /// Covers F and the globals and signatures of functions it refers to.
+  /// context identifies everything else the invariants depend on.
+  static std::string key(const llvm::Function &F, llvm::StringRef domain,
+                         llvm::StringRef context);
+
+  /// Finds an entry in memory or on disk. Thread-safe.
+  bool lookup(llvm::StringRef key, Entry &out);
+  /// Adds an entry, and writes it to disk if enabled. Thread-safe.
+  void insert(llvm::StringRef key, Entry entry);
+  void clear();
+
+  /// Splits an invariant into its top-level conjuncts
+  static void conjuncts(expr::Expr e, expr::ExprVector &out);
+
+  /// Serializes the invariants of the blocks of F. Conjuncts that
+  /// refer to values that are not local to F are dropped.
+  static Entry encode(const llvm::Function &F, const BlockInvariants &inv);
+  /// Converts an entry back into invariants over the values of F.
+  /// Blocks whose invariant is true are omitted. Returns false if the
+  /// entry does not match F.
+  static bool decode(const llvm::Function &F, const Entry &entry,
+                     expr::ExprFactory &efac, BlockInvariants &out);
+};
+
+#ifdef HAVE_CLAM
+/// Converts the Crab invariants of the blocks of F into a cache entry.
+/// pre gives the invariant at the entry of a block, if any. If cfgBuilder
+/// has computed live symbols, invariants are projected onto them.
+CrabInvariantCache::Entry crabInvariantsToEntry(
+    const llvm::Function &F, clam::CfgBuilder *cfgBuilder,
+    const clam::CrabDomain::Type &dom,
+    llvm::function_ref<llvm::Optional<clam::clam_abstract_domain>(
+        const llvm::BasicBlock &)>
+        pre);
+
+/// Context of the cache keys of the functions of M analyzed with the
+/// given Crab CFG parameters, and a context-sensitive heap abstraction
+/// if cs is true. The whole module is part of the context only if the
+/// analysis is inter-procedural.
+std::string crabCacheContext(const llvm::Module &M,
+                             const clam::CrabBuilderParams &params, bool cs,
+                             bool interproc);
+
+/// Computes the intra-procedural Crab invariants of every function of M
+/// that is not yet in the cache. Functions are analyzed one at a time,
+/// since Crab and Stats are not thread-safe. Returns the context of the
+/// cache keys of the functions of M.
+std::string computeCrabInvariants(llvm::Module &M, seadsa::GlobalAnalysis &dsa,
+                                  llvm::TargetLibraryInfoWrapperPass &tli,
+                                  const clam::CrabDomain::Type &dom);
+#endif
+} // namespace seahorn
@@ -185,8 +185,18 @@ template <typename T> class EVR {
 
     assert(bv::isBvNum(exp));
 
-    mpz_class mpz = bv::toMpz(exp);
     unsigned width = bv::widthBvNum(exp);
+    signed long small;
+    if (!std::is_same<T, mpz_class>::value && bv::toSmallNum(exp, small)) {
+      // -- machine integer, no need to go through GMP
+      unsigned long num = static_cast<unsigned long>(small);
+      if (small < 0 && width < 64)
+        // 2s complement
+        num &= (1UL << width) - 1;
+      return BvNum<T>((T)(num), width);
+    }
+
+    mpz_class mpz = bv::toMpz(exp);
 
     if (mpz < (unsigned long)0) {
       // 2s complement
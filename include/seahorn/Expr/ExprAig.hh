@@ -2,25 +2,146 @@
 #define _EXPR_AIG__HPP_
 #include "Expr.hh"
 
-/** a basic simplifier */
-
-namespace expr
-{
-  namespace op
-  {
-    namespace boolop
-    {
-      /// aig-fy an expression and simplify it
-      Expr aig (Expr e, bool gather = false);
-      
-      /// same as aig(e, true)
-      inline Expr flat_aig (Expr e) { return aig (e, true); }
-
-      /// size as number of gates + number of inputs
-      unsigned aigSize (Expr e);
-    }  
+#include <unordered_map>
+#include <vector>
+
+/** And-Inverter Graphs for the Boolean structure of expressions */
+
+namespace expr {
+namespace op {
+namespace boolop {
+
+/**
+ * \brief And-Inverter Graph
+ *
+ * Nodes are kept in a flat array and referenced by integer
+ * literals. Literal 2*n is node n and literal 2*n+1 is its
+ * negation. Node 0 is the constant false. Every other node is either
+ * an input or a two-input AND gate whose fanins were created before
+ * it, so the array is in topological order.
+ *
+ * AND gates are structurally hashed and locally rewritten (two-level
+ * minimization) as they are created.
+ *
+ * An expression is imported by its Boolean connectives (AND, OR, NEG,
+ * IMPL, IFF, XOR, Boolean ITE and EQ). Any other sub-expression is an
+ * atom and becomes an input. Exporting an input gives back its atom.
+ */
+class Aig {
+public:
+  using Lit = unsigned;
+  static const Lit FALSE_LIT = 0;
+  static const Lit TRUE_LIT = 1;
+
+  static Lit mkLit(unsigned n, bool neg = false) { return (n << 1) | neg; }
+  static unsigned node(Lit l) { return l >> 1; }
+  static bool isNeg(Lit l) { return l & 1u; }
+  static Lit neg(Lit l) { return l ^ 1u; }
+
+  explicit Aig(ExprFactory &efac);
+
+  /// The input for atom
+  Lit mkInput(Expr atom);
+  Lit mkAnd(Lit a, Lit b);
+  Lit mkOr(Lit a, Lit b) { return neg(mkAnd(neg(a), neg(b))); }
+  Lit mkIte(Lit c, Lit t, Lit e) {
+    return mkOr(mkAnd(c, t), mkAnd(neg(c), e));
+  }
+  Lit mkXor(Lit a, Lit b) { return mkIte(a, neg(b), b); }
+
+  /// Literal for the Boolean structure of e
+  Lit fromExpr(Expr e);
+
+  /// Expression for a literal. With gather, AND trees are exported as
+  /// n-ary AND/OR, and multiplexers as ITE/IFF/XOR
+  Expr toExpr(Lit l, bool gather = true);
+  void toExpr(const std::vector<Lit> &lits, ExprVector &out,
+              bool gather = true);
+
+  unsigned numNodes() const { return m_nodes.size(); }
+  bool isInput(unsigned n) const { return n > 0 && m_nodes[n].f0 == NONE; }
+  bool isAnd(unsigned n) const { return n > 0 && m_nodes[n].f0 != NONE; }
+  Lit fanin0(unsigned n) const {
+    assert(isAnd(n));
+    return m_nodes[n].f0;
+  }
+  Lit fanin1(unsigned n) const {
+    assert(isAnd(n));
+    return m_nodes[n].f1;
+  }
+  Expr atom(unsigned n) const {
+    assert(isInput(n));
+    return m_atoms[m_nodes[n].f1];
   }
-}
 
+  /// Number of AND gates and inputs in the cone of lits
+  unsigned coneSize(const std::vector<Lit> &lits) const;
+
+  /// Remove nodes that are not in the cone of outs. outs is updated
+  /// to the literals of the new graph.
+  void compact(std::vector<Lit> &outs);
+
+  struct FraigStats {
+    unsigned satCalls = 0;
+    unsigned merged = 0;
+    unsigned constants = 0;
+    unsigned undecided = 0;
+  };
+
+  /**
+   * \brief SAT sweeping (fraiging)
+   *
+   * Nodes in the cone of outs are simulated on random patterns. A node
+   * whose simulation signature matches an earlier node (or a constant,
+   * up to negation) is checked with a SAT solver and merged when they
+   * are equivalent. outs is updated to the literals of the new graph.
+   *
+   * \param conflicts conflict budget of each SAT query. A query that
+   *        runs out of budget is treated as non-equivalent.
+   * \param maxCandidates number of candidates tried for each node
+   */
+  FraigStats fraig(std::vector<Lit> &outs, unsigned conflicts = 1000,
+                   unsigned maxCandidates = 8);
+
+private:
+  static const Lit NONE = ~0u;
+  // -- an input has f0 == NONE and f1 the index of its atom
+  struct Node {
+    Lit f0;
+    Lit f1;
+  };
+
+  ExprFactory &m_efac;
+  std::vector<Node> m_nodes;
+  ExprVector m_atoms;
+  std::unordered_map<uint64_t, unsigned> m_strash;
+  std::unordered_map<Expr, Lit> m_inputs;
+  std::unordered_map<Expr, Lit> m_cache;
+
+  bool rewrite(Lit a, Lit b, Lit &res);
+  void markCone(const std::vector<Lit> &lits, std::vector<char> &mark) const;
+  void swap(Aig &o);
+  friend class AigSweeper;
+};
+
+/// aig-fy an expression and simplify it
+Expr aig(Expr e, bool gather = false);
+
+/// same as aig(e, true)
+inline Expr flat_aig(Expr e) { return aig(e, true); }
+
+/// size as number of gates + number of inputs
+unsigned aigSize(Expr e);
+
+/// aig-fy an expression and simplify it with SAT sweeping
+Expr fraig(Expr e);
+
+/// Simplify a conjunction of constraints with SAT sweeping in a single
+/// AIG. Constraints that become true are removed. If one becomes false
+/// the result is the single constraint false.
+void fraig(ExprVector &conj);
+} // namespace boolop
+} // namespace op
+} // namespace expr
 
 #endif
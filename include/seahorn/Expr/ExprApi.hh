@@ -4,6 +4,8 @@
 #include "seahorn/Expr/ExprOpCore.hh"
 #include "llvm/Support/Casting.h"
 
+#include <type_traits>
+
 namespace expr {
 
 /**********************************************************************/
@@ -43,6 +45,31 @@ template <typename T> T getTerm(Expr e) {
   return llvm::dyn_cast<const term_type>(&e->op())->get();
 }
 
+/* Creates a terminal expression from a machine integer. Integer numerals
+ * that fit in a signed long do not go through GMP.
+ * Usage: mkTerm<mpz_class> (5, efac)
+ */
+template <typename T, typename I,
+          typename = std::enable_if_t<std::is_same<T, mpz_class>::value &&
+                                      std::is_integral<I>::value>>
+Expr mkTerm(I v, ExprFactory &f) {
+  using V = std::conditional_t<std::is_signed<I>::value, signed long,
+                               unsigned long>;
+  Terminal<T> op(static_cast<V>(v));
+  return f.mkTerm(op);
+}
+
+/* True if e is an integer numeral that fits in a signed long. The value
+ * is stored in v without creating a GMP integer.
+ */
+inline bool getSmallMpz(Expr e, signed long &v) {
+  auto *t = llvm::dyn_cast<op::MPZ>(&e->op());
+  if (!t || !t->isSmall())
+    return false;
+  v = t->getSmall();
+  return true;
+}
+
 /* Creates a unary expression with a given operator.
  * Usage: mk<NEG> (exp)
  */
@@ -0,0 +1,50 @@
+#pragma once
+#include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/ExprVisitor.hh"
+
+#include <memory>
+
+namespace expr {
+namespace op {
+namespace bv {
+class BvRewriter;
+
+/**
+ * Word-level simplifier for quantifier-free terms over bit-vectors and
+ * arrays (QF_ABV) that does not use an SMT solver.
+
+ Terms are rewritten bottom-up with the following rules:
+   - constant folding of bit-vector, Boolean and comparison operators
+   - normalization of extract, concat, zext and sext
+   - read-over-write when the two indices are numerals, or the same
+     base plus different numeral offsets
+   - lifting of operators over ite whose branches are numerals
+   - canonical bvadd, bvmul, bvand, bvor and bvxor: nested applications
+     are flattened, numerals are folded into a single first argument,
+     and the other arguments are ordered by id
+
+ Rewritten sub-terms are memoized for the lifetime of the simplifier,
+ so that a term shared by many calls is only rewritten once.
+ */
+class BvSimplifier {
+  struct Visitor {
+    std::shared_ptr<BvRewriter> m_rw;
+    StaticVisitAction operator()(Expr exp) const;
+    Expr rewrite(Expr exp);
+  };
+
+  Visitor m_visitor;
+  DagVisit<Visitor> m_visit;
+
+public:
+  explicit BvSimplifier(ExprFactory &efac);
+  ~BvSimplifier();
+  BvSimplifier(const BvSimplifier &) = delete;
+
+  Expr simplify(Expr e) { return m_visit(e); }
+  /// Forgets all memoized terms
+  void reset();
+};
+} // namespace bv
+} // namespace op
+} // namespace expr
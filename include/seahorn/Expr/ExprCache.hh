@@ -1,62 +1,184 @@
 #pragma once
-#include <boost/bimap.hpp>
-#include <boost/bimap/list_of.hpp>
-#include <boost/bimap/unordered_set_of.hpp>
+#include "seahorn/Expr/ExprCore.hh"
+
+#include <cassert>
+#include <utility>
+#include <vector>
 
 namespace expr {
-using namespace boost;
 
-/** LRU Cache */
-template <typename T> class ExprCache {
-  using cache_type =
-      boost::bimaps::bimap<boost::bimaps::unordered_set_of<ENode *>,
-                           boost::bimaps::list_of<T>>;
-  using value_type = typename cache_type::left_value_type;
-  using right_iterator = typename cache_type::right_iterator;
+/**
+ * Bounded cache from expressions to values of type T.
 
-  cache_type cache;
-  size_t capacity;
+ Entries live in a flat open-addressing table (linear probing, at most
+ half full) so that a lookup touches a single contiguous array and an
+ insert does not allocate. When the cache is full, the victim is
+ chosen with the CLOCK policy, an approximation of LRU: a hit only sets
+ a bit on the entry, and the clock hand evicts the first entry whose
+ bit is clear, clearing bits as it goes.
 
-public:
-  using const_iterator = typename cache_type::left_const_iterator;
-  using iterator = typename cache_type::left_iterator;
+ By default the cache holds a reference on its keys, so they stay alive
+ while cached. A cache constructed with an ExprFactory is weak instead:
+ it does not hold references, and is registered with the factory which
+ erases an entry when its key is released.
 
+ Iterators are invalidated by insert and erase. T must be default
+ constructible.
+ */
+template <typename T> class ExprCache {
 public:
-  ExprCache(size_t c) : capacity(c) {}
+  struct Slot {
+    ENode *first = nullptr;
+    T second = T();
+    bool referenced = false;
+  };
+  using iterator = Slot *;
+  using const_iterator = const Slot *;
 
-  ~ExprCache() { clear(); }
+private:
+  std::vector<Slot> m_table;
+  size_t m_mask;
+  size_t m_capacity;
+  size_t m_size = 0;
+  size_t m_hand = 0;
+  ExprFactory *m_efac = nullptr;
 
-  void clear() {
-    for (auto it = cache.left.begin(), end = cache.left.end(); it != end;
-         ++it) {
-      ENode *n = it->first;
+  static size_t tableSize(size_t capacity) {
+    size_t sz = 8;
+    while (sz < 2 * capacity)
+      sz <<= 1;
+    return sz;
+  }
+
+  size_t slotOf(const ENode *n) const {
+    // -- ids are consecutive, spread them over the table
+    return (static_cast<size_t>(n->getId()) * 0x9E3779B97F4A7C15ULL >> 7) &
+           m_mask;
+  }
+
+  Slot *lookup(const ENode *n) {
+    for (size_t i = slotOf(n);; i = (i + 1) & m_mask) {
+      Slot &s = m_table[i];
+      if (s.first == n)
+        return &s;
+      if (!s.first)
+        return nullptr;
+    }
+  }
+
+  void release(ENode *n) {
+    if (!m_efac)
       n->efac().Deref(n);
+  }
+
+  /// remove the entry at position i. Later entries of the same probe
+  /// sequence are moved back so that lookups need no tombstones
+  void eraseAt(size_t i) {
+    release(m_table[i].first);
+    --m_size;
+    size_t hole = i;
+    for (size_t j = (i + 1) & m_mask; m_table[j].first; j = (j + 1) & m_mask) {
+      size_t home = slotOf(m_table[j].first);
+      // -- move j to the hole unless its home is cyclically in (hole, j]
+      bool stays = hole <= j ? (hole < home && home <= j)
+                             : (hole < home || home <= j);
+      if (!stays) {
+        m_table[hole] = std::move(m_table[j]);
+        hole = j;
+      }
+    }
+    m_table[hole] = Slot();
+  }
+
+  void evict() {
+    for (;; m_hand = (m_hand + 1) & m_mask) {
+      Slot &s = m_table[m_hand];
+      if (!s.first)
+        continue;
+      if (s.referenced) {
+        s.referenced = false;
+        continue;
+      }
+      eraseAt(m_hand);
+      return;
     }
-    cache.clear();
+  }
+
+public:
+  /// A cache of at most \p c entries that keeps its keys alive
+  ExprCache(size_t c)
+      : m_table(tableSize(c)), m_mask(m_table.size() - 1), m_capacity(c) {
+    assert(c > 0);
+  }
+
+  /// A weak cache of at most \p c entries over expressions of \p efac
+  ExprCache(size_t c, ExprFactory &efac) : ExprCache(c) {
+    m_efac = &efac;
+    m_efac->registerCache(*this);
+  }
+
+  ExprCache(const ExprCache &) = delete;
+  ExprCache &operator=(const ExprCache &) = delete;
+
+  ~ExprCache() {
+    clear();
+    if (m_efac)
+      m_efac->unregisterCache(*this);
+  }
+
+  void clear() {
+    if (m_size == 0)
+      return;
+    for (Slot &s : m_table)
+      if (s.first) {
+        release(s.first);
+        s = Slot();
+      }
+    m_size = 0;
+    m_hand = 0;
   }
 
   const_iterator find(Expr e) {
-    auto it = cache.left.find(&*e);
-    if (it != cache.left.end())
-      cache.right.relocate(cache.right.end(), cache.project_right(it));
-    return it;
+    Slot *s = lookup(&*e);
+    if (s)
+      s->referenced = true;
+    return s;
   }
 
-  const_iterator end() const { return cache.left.end(); }
+  const_iterator end() const { return nullptr; }
 
-  std::pair<iterator, bool> insert(Expr e, T &v) {
-    if (cache.size() == capacity) {
-      right_iterator it = cache.right.begin();
-      // -- dereference a key that is about to be deleted
-      ENode *old = it->second;
-      old->efac().Deref(old);
-      cache.right.erase(it);
-    }
+  std::pair<iterator, bool> insert(Expr e, const T &v) {
     ENode *n = &*e;
-    n->Ref();
-    return cache.left.insert(value_type(n, v));
+    if (Slot *s = lookup(n))
+      return {s, false};
+
+    if (m_size == m_capacity)
+      evict();
+
+    size_t i = slotOf(n);
+    while (m_table[i].first)
+      i = (i + 1) & m_mask;
+
+    if (!m_efac)
+      n->Ref();
+    Slot &s = m_table[i];
+    s.first = n;
+    s.second = v;
+    s.referenced = false;
+    ++m_size;
+    return {&s, true};
+  }
+
+  /// Remove the entry of \p n, if any. Called by the factory on the keys
+  /// it releases when the cache is weak
+  void erase(ENode *n) {
+    if (m_size == 0)
+      return;
+    if (Slot *s = lookup(n))
+      eraseAt(s - m_table.data());
   }
 
-  size_t size() const { return cache.size(); }
+  size_t size() const { return m_size; }
+  size_t capacity() const { return m_capacity; }
 };
 } // namespace expr
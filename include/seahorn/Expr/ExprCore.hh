@@ -6,9 +6,14 @@
 #include <boost/pool/pool.hpp>
 #include "seahorn/boost_ptr_vector.hh"
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <set>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 namespace expr {
@@ -82,6 +87,8 @@ public:
   virtual bool operator<(const Operator &rhs) const = 0;
   virtual size_t hash() const = 0;
   virtual bool isMutable() const { return false; }
+  /// \brief True for the terminal of a bound variable
+  virtual bool isBoundVar() const { return false; }
   /// \brief Returns heap-allocted copy of the operator
   virtual Operator *clone(ExprFactoryAllocator &allocator) const = 0;
   virtual std::string name() const = 0;
@@ -112,7 +119,22 @@ protected:
   /** unique identifier of this expression node */
   unsigned int id;
   /** reference counter */
-  unsigned int count;
+  unsigned int count : 31;
+  /** true if the node is waiting to be collected by the factory */
+  unsigned int pending : 1;
+
+  // -- structural summary, computed once when the node is created.
+  // -- Nodes above a mutable node are not updated when it changes.
+
+  /// \brief Size of the expression as a tree, saturated at UINT32_MAX.
+  /// An upper bound on its size as a DAG
+  uint32_t m_sizeBound;
+  /// \brief Length of the longest path to a leaf, saturated at MAX_DEPTH
+  uint16_t m_depth : 15;
+  /// \brief True if a bound variable occurs in the DAG
+  uint16_t m_bvars : 1;
+  /// \brief Bit i is set if an operator of OpFamilyId i occurs in the DAG
+  uint16_t m_families;
 
   /// \brief Parent factory that created this node
   ExprFactory *fac;
@@ -131,6 +153,9 @@ protected:
   /// \brief Set id of the node
   void setId(unsigned int v) { id = v; }
 
+  /// \brief Compute the structural summary from the arguments
+  void updateSummary();
+
 public:
   ENode(ExprFactory &f, const Operator &o);
   ~ENode();
@@ -178,6 +203,24 @@ public:
 
   size_t arity() const { return args.size(); }
 
+  /// \brief Upper bound on the DAG size of the expression, in O(1).
+  /// Exact size as a tree, unless saturated at UINT32_MAX
+  size_t sizeBound() const { return m_sizeBound; }
+  /// \brief Length of the longest path to a leaf (0 for a leaf),
+  /// saturated at MAX_DEPTH
+  unsigned depth() const { return m_depth; }
+  static const unsigned MAX_DEPTH = (1u << 15) - 1;
+  /// \brief True if a bound variable (bind::BVAR) occurs in the expression.
+  /// When false, substituting bound variables leaves the node unchanged
+  bool hasBoundVar() const { return m_bvars; }
+  /// \brief True if an operator of family \p f occurs in the expression.
+  /// When false, visitors looking for \p f can skip the node
+  bool hasOpFamily(OpFamilyId f) const {
+    return m_families & (1u << static_cast<unsigned>(f));
+  }
+  /// \brief Bit mask of the operator families that occur in the expression
+  unsigned opFamilies() const { return m_families; }
+
   const Operator &op() const { return *m_oper; }
   void Print(std::ostream &OS, int depth = 0, bool brkt = true) const {
     m_oper->Print(OS, args, depth, brkt);
@@ -297,6 +340,11 @@ protected:
   /** counter for assigning unique ids*/
   unsigned int idCount;
 
+  /** number of open epochs */
+  unsigned int epochs;
+  /** nodes that became garbage during an epoch */
+  std::vector<ENode *> garbage;
+
   /** returns a unique id > 0 */
   unsigned int uniqueId() { return ++idCount; }
 
@@ -331,12 +379,14 @@ protected:
   ENode *canonize(ENode *v) {
     if (v->isMutable()) {
       v->setId(uniqueId());
+      v->updateSummary();
       return v;
     }
 
     auto x = unique[v->op().name()].insert(v);
     if (x.second) {
       v->setId(uniqueId());
+      v->updateSummary();
       return v;
     } else {
       freeNode(v);
@@ -389,15 +439,77 @@ private:
   ENode *allocNode(const Operator &op);
 
 public:
-  ExprFactory() : idCount(0) {}
+  ExprFactory() : idCount(0), epochs(0) {}
 
   /** Derefernce a value */
   void Deref(ENode *val) {
     val->Deref();
-    if (val->isGarbage())
+    if (!val->isGarbage())
+      return;
+    if (epochs == 0)
       Remove(val);
+    else if (!val->pending) {
+      // -- keep the node until the epoch ends. It is still in the
+      // -- unique table and is reused if it is created again
+      val->pending = 1;
+      garbage.push_back(val);
+    }
+  }
+
+  /**
+   * Begin an epoch. Until the matching endEpoch(), nodes that become
+   * garbage are not freed. They are freed in bulk by collect() or when
+   * the outermost epoch ends. This avoids cascades of recursive
+   * deallocation when a large formula is dropped.
+   */
+  void beginEpoch() { ++epochs; }
+  void endEpoch() {
+    assert(epochs > 0);
+    if (epochs == 1)
+      collect();
+    --epochs;
+  }
+  bool inEpoch() const { return epochs > 0; }
+
+  /** Free all garbage nodes of the current epoch */
+  void collect() {
+    if (garbage.empty())
+      return;
+    // -- the unique table entry of each operator type. The name of an
+    // -- operator depends only on its type, so it is looked up once
+    std::unordered_map<std::type_index, unique_entry_type *> entries;
+
+    // -- children released while freeing a node are queued, so the
+    // -- teardown is a loop instead of a recursion
+    ++epochs;
+    while (!garbage.empty()) {
+      ENode *n = garbage.back();
+      garbage.pop_back();
+      n->pending = 0;
+      if (!n->isGarbage())
+        continue;
+
+      clearCaches(n);
+      if (!n->isMutable()) {
+        unique_entry_type *&entry = entries[typeid(n->op())];
+        if (!entry) {
+          auto it = unique.find(n->op().name());
+          assert(it != unique.end());
+          entry = &it->second;
+        }
+        entry->erase(n);
+      }
+      freeNode(n);
+    }
+    --epochs;
+
+    for (auto it = unique.begin(); it != unique.end();)
+      it = it->second.empty() ? unique.erase(it) : std::next(it);
   }
 
+  /** Number of nodes waiting to be collected */
+  size_t garbageSize() const { return garbage.size(); }
+
   /*===================== PUBLIC API ========================================*/
 
   Expr mkTerm(const Operator &o) { return Expr(mkExpr(o)); }
@@ -438,8 +550,20 @@ public:
   friend class ENode;
 };
 
+/// \brief Keeps an epoch of an ExprFactory open while in scope
+class ScopedExprEpoch {
+  ExprFactory &m_efac;
+
+public:
+  ScopedExprEpoch(ExprFactory &efac) : m_efac(efac) { m_efac.beginEpoch(); }
+  ScopedExprEpoch(const ScopedExprEpoch &) = delete;
+  ~ScopedExprEpoch() { m_efac.endEpoch(); }
+};
+
 inline ENode::ENode(ExprFactory &f, const Operator &o)
-    : count(0), fac(&f),
+    : count(0), pending(0), m_sizeBound(1), m_depth(0), m_bvars(0),
+      m_families(0),
+      fac(&f),
       m_oper(o.clone(f.allocator), f.allocator.get_deleter()) {}
 
 } // namespace expr
@@ -455,19 +579,19 @@ inline void operator delete(void *p, expr::ExprFactoryAllocator &alloc) {
 namespace expr {
 
 inline void ExprFactory::freeNode(ENode *n) {
+  for (ENode *a : n->args)
+    Deref(a);
+  n->args.clear();
+  n->m_oper.reset();
+
+  assert(n->count == 0);
+  assert(!n->pending);
   if (freeList.size() < FREE_LIST_MAX_SIZE) {
-    for (ENode *a : n->args)
-      Deref(a);
-    n->args.clear();
-    n->m_oper.reset();
-
-    if (freeList.size() < FREE_LIST_MAX_SIZE) {
-      assert(n->count == 0);
-      freeList.push_back(n);
-      return;
-    }
+    freeList.push_back(n);
+    return;
   }
 
+  n->~ENode();
   operator delete(static_cast<void *>(n), allocator);
 }
 
@@ -518,6 +642,27 @@ template <typename iterator> void ENode::renew_args(iterator b, iterator e) {
   // -- decrement reference count of all old arguments
   for (auto b = old.begin(), e = old.end(); b != e; ++b)
     efac().Deref(*b);
+
+  updateSummary();
+}
+
+inline void ENode::updateSummary() {
+  static_assert(static_cast<unsigned>(OpFamilyId::MutModelOp) < 16,
+                "too many operator families for the summary");
+  uint64_t sz = 1;
+  unsigned d = 0;
+  bool bvars = op().isBoundVar();
+  uint16_t fam = 1u << static_cast<unsigned>(op().getFamilyId());
+  for (ENode *a : args) {
+    sz += a->m_sizeBound;
+    d = std::max(d, static_cast<unsigned>(a->m_depth) + 1);
+    bvars |= a->m_bvars;
+    fam |= a->m_families;
+  }
+  m_sizeBound = std::min<uint64_t>(sz, UINT32_MAX);
+  m_depth = d < MAX_DEPTH ? d : MAX_DEPTH;
+  m_bvars = bvars;
+  m_families = fam;
 }
 
 inline ENode::~ENode() {
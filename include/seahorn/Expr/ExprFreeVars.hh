@@ -0,0 +1,59 @@
+#pragma once
+#include "seahorn/Expr/Expr.hh"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+namespace expr {
+
+/**
+ * Index of the constants (bind::IsConst) that occur in expressions.
+
+ Every indexed node gets a 64-bit signature: a Bloom filter of the
+ constants below it. The sorted set of constants of a node is only
+ built when it is asked for, and is then memoized.
+
+ A node can only contain a sub-expression k if the signature of k is
+ included in the signature of the node. Together with the structural
+ summary kept on ENode (depth, operator families and bound variables),
+ this lets substitution skip sub-expressions that it cannot change.
+
+ Signatures over-approximate: a constant bound by a quantifier still
+ counts as occurring. The index keeps the nodes it has seen alive until
+ clear() is called.
+ */
+class FreeVarIndex {
+public:
+  using Signature = uint64_t;
+
+  /// Signature of the constants that occur in e
+  Signature signature(Expr e);
+  /// Signature of a single constant
+  static Signature constSignature(Expr c);
+
+  /// false if sub does not occur in e. true if it may
+  bool mayContain(Expr e, Expr sub);
+
+  /// The constants of e, without duplicates and sorted by id
+  const ExprVector &vars(Expr e);
+
+  /// Replace the sub-expressions of e that are keys of sub. The
+  /// result is the same as expr::replace(e, sub)
+  Expr replace(Expr e, const ExprMap &sub);
+
+  /// Number of indexed nodes
+  size_t size() const { return m_info.size(); }
+  void clear() { m_info.clear(); }
+
+private:
+  struct Info {
+    Signature sig = 0;
+    std::unique_ptr<ExprVector> vars;
+  };
+  std::unordered_map<Expr, Info> m_info;
+
+  Info &info(Expr e);
+};
+
+} // namespace expr
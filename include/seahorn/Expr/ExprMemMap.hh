@@ -39,12 +39,38 @@ class MemCell {
   std::pair<Expr, Expr> m_pair; // <addr, content>
   bool m_isRepeated = false;
 
+  // -- sort key, computed once since a cell is compared O(log n) times
+  // -- when it is inserted into a MemCellSet
+  bool m_isNumeric = false;
+  // -- the index is a non-negative number that fits in 64 bits
+  bool m_isSmall = false;
+  uint64_t m_smallIdx = 0;
+  mpz_class m_idxNum;
+  // -- decimal (or printed) form of the index, only built when the index
+  // -- is not a non-negative number
+  mutable std::string m_idxStr;
+
+  const std::string &getIdxKeyStr() const;
+
 public:
   MemCell(Expr idx, Expr value, bool isRepeated = false);
 
-  bool isSortable() const;
+  bool isSortable() const { return m_isNumeric; }
+
+  /// \note assumes that the index is numeric
+  const mpz_class &getIdxNum() const {
+    assert(m_isNumeric);
+    return m_idxNum;
+  }
 
-  mpz_class getIdxNum() const;
+  /// true if the index is a non-negative number that fits in 64 bits
+  bool hasSmallIdx() const { return m_isSmall; }
+
+  /// \note assumes hasSmallIdx()
+  uint64_t getSmallIdx() const {
+    assert(m_isSmall);
+    return m_smallIdx;
+  }
 
   Expr getIdxExpr() const { return m_pair.first; }
 
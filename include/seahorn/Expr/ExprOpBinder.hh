@@ -446,7 +446,8 @@ template <typename Range> struct SubBnd {
 
   const Range &m_r;
   unsigned m_sz;
-  std::vector<SUBBND<this_type>> m_pinned;
+  // -- a deque so that visitors stay in place when new ones are pinned
+  std::deque<SUBBND<this_type>> m_pinned;
   typedef std::map<unsigned, DagVisit<SUBBND<this_type>>> cache_type;
   cache_type m_cache;
 
@@ -472,7 +473,8 @@ struct SUBBND : public std::unary_function<Expr, VisitAction> {
   SUBBND(Sub &a, unsigned offset) : m_a(a), m_offset(offset){};
 
   VisitAction operator()(Expr exp) const {
-    if (bind::isFdecl(exp))
+    // -- nothing to substitute below exp
+    if (!exp->hasBoundVar() || bind::isFdecl(exp))
       return VisitAction::skipKids();
     else if (bind::isBVar(exp)) {
       unsigned idx = bind::bvarId(exp);
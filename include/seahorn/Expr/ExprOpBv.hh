@@ -84,6 +84,13 @@ inline Expr bvnum(mpz_class num, unsigned bwidth, ExprFactory &efac) {
   return bvnum(mkTerm(num, efac), bvsort(bwidth, efac));
 }
 
+/// bit-vector numeral of a machine integer
+template <typename I,
+          typename = std::enable_if_t<std::is_integral<I>::value>>
+inline Expr bvnum(I num, unsigned bwidth, ExprFactory &efac) {
+  return bvnum(mkTerm<mpz_class>(num, efac), bvsort(bwidth, efac));
+}
+
 /// true if v is a bit-vector numeral
 inline bool is_bvnum(Expr v) {
   return isOpX<BIND>(v) && v->arity() == 2 && isOpX<MPZ>(v->arg(0)) &&
@@ -115,6 +122,13 @@ inline mpz_class toMpz(Expr v) {
   return getTerm<mpz_class>(v->arg(0));
 }
 
+/// true if v is a bit-vector numeral whose value fits in a signed long,
+/// which is then stored in num without creating a GMP integer
+inline bool toSmallNum(Expr v, signed long &num) {
+  assert(is_bvnum(v));
+  return getSmallMpz(v->arg(0), num);
+}
+
 inline Expr bvConst(Expr v, unsigned width) {
   Expr sort = bvsort(width, v->efac());
   return bind::mkConst(v, sort);
@@ -2,8 +2,12 @@
 #pragma once
 #include "seahorn/Expr/ExprCore.hh"
 #include "seahorn/Expr/ExprGmp.hh"
+#include "llvm/ADT/Optional.h"
 #include "llvm/Support/Casting.h"
 
+#include <climits>
+#include <type_traits>
+
 namespace expr {
 
 class TypeCheckertc;
@@ -85,6 +89,10 @@ public:
 
   std::string name() const override { return terminal_type::name(); }
 
+  bool isBoundVar() const override {
+    return terminal_type::getKind() == TerminalKind::BVAR;
+  }
+
   bool operator==(const this_type &rhs) const {
     return terminal_type::equal_to(val, rhs.val);
   }
@@ -204,11 +212,6 @@ template <> struct TerminalTrait<expr::mpz_class> {
     return v1 == v2;
   }
 
-  static inline size_t hash(const expr::mpz_class &v) {
-    std::hash<std::string> hasher;
-    return hasher(v.to_string());
-  }
-
   static TerminalKind getKind() { return TerminalKind::MPZ; }
   static std::string name() { return "expr::mpz_class"; }
   static inline Expr inferType(Expr exp, TypeChecker &tc) {
@@ -216,6 +219,122 @@ template <> struct TerminalTrait<expr::mpz_class> {
   }
 };
 
+/// \brief Terminal for GMP integers
+///
+/// A value that fits in a signed long is kept inline, and no GMP integer
+/// is created for it. Other values are kept as GMP integers. The
+/// representation is canonical: equal values have the same
+/// representation, so hashing and comparison of small values never go
+/// through GMP.
+template <>
+class Terminal<expr::mpz_class, TerminalTrait<expr::mpz_class>>
+    : public TerminalBase {
+  signed long m_small = 0;
+  llvm::Optional<expr::mpz_class> m_big;
+
+public:
+  using base_type = expr::mpz_class;
+  using terminal_type = TerminalTrait<expr::mpz_class>;
+  using this_type = Terminal<base_type, terminal_type>;
+
+  Terminal(const base_type &v) : TerminalBase(terminal_type::getKind()) {
+    if (mpz_fits_slong_p(v.get_mpz_t()))
+      m_small = v.get_si();
+    else
+      m_big = v;
+  }
+  Terminal(signed long v)
+      : TerminalBase(terminal_type::getKind()), m_small(v) {}
+  Terminal(unsigned long v) : TerminalBase(terminal_type::getKind()) {
+    if (v <= static_cast<unsigned long>(LONG_MAX))
+      m_small = static_cast<signed long>(v);
+    else
+      m_big = base_type(v);
+  }
+  Terminal(const this_type &) = default;
+
+  /// true if the value fits in a signed long
+  bool isSmall() const { return !m_big.hasValue(); }
+  signed long getSmall() const {
+    assert(isSmall());
+    return m_small;
+  }
+
+  base_type get() const { return isSmall() ? base_type(m_small) : *m_big; }
+
+  this_type *clone(ExprFactoryAllocator &allocator) const override {
+    return new (allocator) this_type(*this);
+  }
+
+  void Print(std::ostream &OS, const std::vector<ENode *> &args, int depth = 0,
+             bool brkt = true) const override {
+    if (isSmall() && m_small < 65535L && m_small > -65535L)
+      OS << m_small;
+    else
+      terminal_type::print(OS, get(), depth, brkt);
+  }
+
+  std::string name() const override { return terminal_type::name(); }
+
+  bool operator==(const this_type &rhs) const {
+    if (isSmall() || rhs.isSmall())
+      return isSmall() && rhs.isSmall() && m_small == rhs.m_small;
+    return *m_big == *rhs.m_big;
+  }
+
+  bool operator<(const this_type &rhs) const {
+    if (isSmall() && rhs.isSmall())
+      return m_small < rhs.m_small;
+    if (isSmall())
+      return mpz_cmp_si(rhs.m_big->get_mpz_t(), m_small) > 0;
+    if (rhs.isSmall())
+      return mpz_cmp_si(m_big->get_mpz_t(), rhs.m_small) < 0;
+    return *m_big < *rhs.m_big;
+  }
+
+  bool operator==(const Operator &rhs) const override {
+    if (&rhs == this)
+      return true;
+
+    auto *prhs = llvm::dyn_cast<this_type>(&rhs);
+    return prhs && *this == *prhs;
+  }
+
+  bool operator<(const Operator &rhs) const override {
+    if (&rhs == this)
+      return false;
+
+    if (this->getFamilyId() != rhs.getFamilyId())
+      return this->getFamilyId() < rhs.getFamilyId();
+
+    if (auto *prhs = llvm::dyn_cast<this_type>(&rhs))
+      return *this < *prhs;
+    return terminal_type::getKind() < llvm::cast<TerminalBase>(&rhs)->m_kind;
+  }
+
+  size_t hash() const override {
+    if (isSmall())
+      return std::hash<signed long>()(m_small);
+    // -- large values: combine the limbs
+    mpz_srcptr v = m_big->get_mpz_t();
+    size_t res = mpz_sgn(v);
+    for (size_t i = 0, sz = mpz_size(v); i < sz; ++i)
+      res = res * 31 + std::hash<mp_limb_t>()(mpz_getlimbn(v, i));
+    return res;
+  }
+
+  static bool classof(Operator const *op) {
+    return llvm::isa<TerminalBase>(op) &&
+           llvm::cast<TerminalBase>(op)->m_kind == terminal_type::getKind();
+  }
+
+  bool typeCheckTopDown() const override { return false; }
+
+  Expr inferType(Expr exp, TypeChecker &tc) const override {
+    return terminal_type::inferType(exp, tc);
+  }
+};
+
 /// \brief Terminal traits for GMP rationals
 template <> struct TerminalTrait<expr::mpq_class> {
   static inline void print(std::ostream &OS, const expr::mpq_class &v,
@@ -154,27 +154,27 @@ struct TrivialSimplifier : public std::unary_function<Expr, Expr> {
 namespace {
 
 template <typename M>
-struct RVSIMP : public std::unary_function<Expr, VisitAction> {
+struct RVSIMP : public std::unary_function<Expr, StaticVisitAction> {
   typedef typename M::const_iterator const_iterator;
 
   const M &map;
 
-  std::shared_ptr<boolop::TrivialSimplifier> r;
+  boolop::TrivialSimplifier r;
 
   typedef RVSIMP<M> this_type;
 
   RVSIMP(const this_type &o) : map(o.map), r(o.r) {}
-  RVSIMP(ExprFactory &fac, const M &m)
-      : map(m), r(std::make_shared<boolop::TrivialSimplifier>(fac)) {}
+  RVSIMP(ExprFactory &fac, const M &m) : map(m), r(fac) {}
 
-  VisitAction operator()(Expr exp) const {
+  StaticVisitAction operator()(Expr exp) const {
     const_iterator it = map.find(exp);
 
     if (it == map.end())
-      return VisitAction::changeDoKidsRewrite(exp, r);
+      return StaticVisitAction::doKidsRewrite();
 
-    return VisitAction::changeTo(it->second);
+    return StaticVisitAction::changeTo(it->second);
   }
+  Expr rewrite(Expr exp) { return r(exp); }
 };
 
 } // namespace
@@ -193,14 +193,15 @@ template <typename T> struct BS {
   BS(std::shared_ptr<T> r) : _r(r) {}
   BS(T *r) : _r(r) {}
 
-  VisitAction operator()(Expr exp) {
+  StaticVisitAction operator()(Expr exp) {
     // -- apply the rewriter
     if (isOp<BoolOp>(exp))
-      return VisitAction::changeDoKidsRewrite(exp, _r);
+      return StaticVisitAction::doKidsRewrite();
 
     // -- do not descend into non-boolean operators
-    return VisitAction::skipKids();
+    return StaticVisitAction::skipKids();
   }
+  Expr rewrite(Expr exp) { return (*_r)(exp); }
 };
 } // namespace boolop
 } // namespace op
@@ -25,44 +25,39 @@ struct IdentityRewriter {
   Expr operator()(Expr e) { return e; }
 };
 
-struct ExprFn {
-  virtual ~ExprFn() {}
-  virtual Expr apply(Expr e) = 0;
-};
-
-namespace {
-template <typename T> struct ExprFunctionoid : public ExprFn {
-  using fn_type = std::shared_ptr<T>;
-
-  fn_type fn;
-
-  ExprFunctionoid(T *f) : fn_type(fn) {}
-  ExprFunctionoid(fn_type f) : fn(f) {}
-  Expr apply(Expr e) override { return (*fn)(e); }
-};
-} // namespace
-
 class VisitAction {
 protected:
   bool m_skipKids;
   Expr m_expr;
 
 private:
-  std::shared_ptr<ExprFn> m_fn;
+  /// the rewriter, or null for the identity
+  std::shared_ptr<void> m_rw;
+  Expr (*m_apply)(void *, Expr) = nullptr;
+
+  template <typename R> static Expr applyRewriter(void *r, Expr e) {
+    return (*static_cast<R *>(r))(e);
+  }
+
+  template <typename R> void setRewriter(std::shared_ptr<R> r) {
+    m_rw = std::move(r);
+    m_apply = &applyRewriter<R>;
+  }
+  void setRewriter(std::shared_ptr<IdentityRewriter>) {}
 
 public:
   // skipKids or doKids
-  VisitAction(bool kids = false)
-      : m_skipKids(kids), m_fn(new ExprFunctionoid<IdentityRewriter>(
-                              std::make_shared<IdentityRewriter>())) {}
+  VisitAction(bool kids = false) : m_skipKids(kids) {}
   VisitAction(const VisitAction &) = default;
   VisitAction &operator= (const VisitAction &) = default;
 
   // changeTo or doKidsRewrite
   template <typename R>
-  VisitAction(Expr e, bool kids = false,
-              std::shared_ptr<R> r = std::make_shared<IdentityRewriter>())
-      : m_skipKids(kids), m_expr(e), m_fn(new ExprFunctionoid<R>(r)) {}
+  VisitAction(Expr e, bool kids, std::shared_ptr<R> r)
+      : m_skipKids(kids), m_expr(e) {
+    setRewriter(std::move(r));
+  }
+  VisitAction(Expr e, bool kids = false) : m_skipKids(kids), m_expr(e) {}
 
   bool isSkipKids() { return m_skipKids && m_expr.get() == nullptr; }
   bool isChangeTo() { return m_skipKids && m_expr.get() != nullptr; }
@@ -71,18 +66,16 @@ public:
     return !m_skipKids && m_expr.get() != nullptr;
   }
 
-  Expr rewrite(Expr v) { return m_fn->apply(v); }
+  Expr rewrite(Expr v) { return m_apply ? m_apply(m_rw.get(), v) : v; }
 
   Expr getExpr() { return m_expr; }
 
   static inline VisitAction skipKids() { return VisitAction(true); }
   static inline VisitAction doKids() { return VisitAction(false); }
-  static inline VisitAction changeTo(Expr e) {
-    return VisitAction(e, true, std::make_shared<IdentityRewriter>());
-  }
+  static inline VisitAction changeTo(Expr e) { return VisitAction(e, true); }
 
   static inline VisitAction changeDoKids(Expr e) {
-    return VisitAction(e, false, std::make_shared<IdentityRewriter>());
+    return VisitAction(e, false);
   }
 
   template <typename R>
@@ -91,6 +84,70 @@ public:
   }
 };
 
+/**
+ * Action of a visitor that provides its rewriter statically.
+
+ A visitor whose operator() returns a StaticVisitAction may also have a
+ method
+    Expr rewrite(Expr e)
+ that is called on every node whose action asked for a rewrite, once its
+ kids are visited. Without it, the rewrite is the identity.
+
+ Unlike VisitAction, an action does not own a rewriter, so visiting a
+ node neither allocates nor updates reference counts of a rewriter.
+ */
+class StaticVisitAction {
+  bool m_skipKids;
+  bool m_rewrite;
+  Expr m_expr;
+
+public:
+  StaticVisitAction(bool kids = false, bool rw = false, Expr e = Expr())
+      : m_skipKids(kids), m_rewrite(rw), m_expr(e) {}
+
+  bool isSkipKids() { return m_skipKids && m_expr.get() == nullptr; }
+  bool isChangeTo() { return m_skipKids && m_expr.get() != nullptr; }
+  bool isDoKids() { return !m_skipKids && m_expr.get() == nullptr; }
+  bool isChangeDoKidsRewrite() {
+    return !m_skipKids && m_expr.get() != nullptr;
+  }
+  /// True if the visitor rewrites the node after its kids
+  bool isRewrite() { return m_rewrite; }
+
+  Expr getExpr() { return m_expr; }
+
+  static inline StaticVisitAction skipKids() { return StaticVisitAction(true); }
+  static inline StaticVisitAction doKids() { return StaticVisitAction(false); }
+  static inline StaticVisitAction changeTo(Expr e) {
+    return StaticVisitAction(true, false, e);
+  }
+  static inline StaticVisitAction changeDoKids(Expr e) {
+    return StaticVisitAction(false, false, e);
+  }
+  static inline StaticVisitAction doKidsRewrite() {
+    return StaticVisitAction(false, true);
+  }
+  static inline StaticVisitAction changeDoKidsRewrite(Expr e) {
+    return StaticVisitAction(false, true, e);
+  }
+};
+
+namespace visit_detail {
+template <typename V> Expr rewrite(V &, VisitAction &va, Expr e) {
+  return va.rewrite(e);
+}
+/// v.rewrite(e) if the visitor has a rewriter, e otherwise
+template <typename V>
+auto applyRewrite(V &v, Expr e, int) -> decltype(v.rewrite(e)) {
+  return v.rewrite(e);
+}
+template <typename V> Expr applyRewrite(V &, Expr e, long) { return e; }
+
+template <typename V> Expr rewrite(V &v, StaticVisitAction &va, Expr e) {
+  return va.isRewrite() ? applyRewrite(v, e, 0) : e;
+}
+} // namespace visit_detail
+
 using DagVisitCache = std::unordered_map<ENode *, Expr>;
 
 template <typename ExprVisitor>
@@ -104,7 +161,7 @@ Expr visitRec(ExprVisitor &v, Expr expr, DagVisitCache &cache) {
       return cit->second;
   }
 
-  VisitAction va = v(expr);
+  auto va = v(expr);
   Expr res;
 
   if (va.isSkipKids())
@@ -131,7 +188,7 @@ Expr visitRec(ExprVisitor &v, Expr expr, DagVisitCache &cache) {
       }
     }
 
-    res = va.rewrite(res);
+    res = visit_detail::rewrite(v, va, res);
   }
 
   if (expr->use_count() > 1) {
@@ -150,8 +207,9 @@ Expr visitNoRec(ExprVisitor &v, Expr _expr, DagVisitCache &cache) {
   llvm::SmallVector<std::pair<Expr, unsigned>, 16> todo;
   todo.emplace_back(_expr, 0);
 
+  using Action = decltype(v(_expr));
   llvm::SmallVector<Expr, 16> resStack;
-  llvm::SmallVector<VisitAction, 16> actionStack;
+  llvm::SmallVector<Action, 16> actionStack;
 
   while (!todo.empty()) {
     auto &frame = todo.back();
@@ -167,10 +225,10 @@ Expr visitNoRec(ExprVisitor &v, Expr _expr, DagVisitCache &cache) {
       }
     }
 
-    VisitAction _va;
+    Action _va;
     if (idx == 0) _va = v(expr);
     // -- execute visitor when expression is visited the first time
-    VisitAction &va = idx == 0 ? _va : actionStack.back();
+    Action &va = idx == 0 ? _va : actionStack.back();
 
     Expr res;
     unsigned arity = 0;
@@ -212,7 +270,7 @@ Expr visitNoRec(ExprVisitor &v, Expr _expr, DagVisitCache &cache) {
         }
       }
 
-      res = va.rewrite(res);
+      res = visit_detail::rewrite(v, va, res);
       if (popActionStack) actionStack.pop_back();
     }
 
@@ -266,7 +324,7 @@ void dagVisit(ExprVisitor &v, const ExprVector &vec) {
 /// -- this does not use a visited table and might visit the same expression
 /// multiple times
 template <typename ExprVisitor> Expr treeVisit(ExprVisitor &v, Expr expr) {
-  VisitAction va = v(expr);
+  auto va = v(expr);
 
   if (va.isSkipKids())
     return expr;
@@ -277,7 +335,7 @@ template <typename ExprVisitor> Expr treeVisit(ExprVisitor &v, Expr expr) {
   Expr res = va.isChangeDoKidsRewrite() ? va.getExpr() : expr;
 
   if (res->arity() == 0)
-    return va.rewrite(res);
+    return visit_detail::rewrite(v, va, res);
 
   bool changed = false;
   std::vector<Expr> kids;
@@ -295,7 +353,7 @@ template <typename ExprVisitor> Expr treeVisit(ExprVisitor &v, Expr expr) {
       res->renew_args(kids.begin(), kids.end());
   }
 
-  res = va.rewrite(res);
+  res = visit_detail::rewrite(v, va, res);
 
   return res;
 }
@@ -305,7 +363,7 @@ template <typename ExprVisitor> Expr treeVisit(ExprVisitor &v, Expr expr) {
 namespace expr {
 namespace {
 template <typename T>
-struct RW : public std::unary_function<Expr, VisitAction> {
+struct RW : public std::unary_function<Expr, StaticVisitAction> {
   std::shared_ptr<T> _r;
 
   typedef RW<T> this_type;
@@ -313,9 +371,10 @@ struct RW : public std::unary_function<Expr, VisitAction> {
   RW(const this_type &o) : _r(o._r) {}
   RW(std::shared_ptr<T> r) : _r(r) {}
 
-  VisitAction operator()(Expr exp) {
-    return VisitAction::changeDoKidsRewrite(exp, _r);
+  StaticVisitAction operator()(Expr exp) {
+    return StaticVisitAction::doKidsRewrite();
   }
+  Expr rewrite(Expr exp) { return (*_r)(exp); }
 };
 } // namespace
 
@@ -326,31 +385,36 @@ template <typename T> Expr rewrite(std::shared_ptr<T> r, Expr e) {
 }
 
 namespace {
+/// A prune predicate that never prunes
+struct NoPrune {
+  bool operator()(Expr) const { return false; }
+};
 
-template <typename F, typename OutputIterator>
-struct FV : public std::unary_function<Expr, VisitAction> {
+template <typename F, typename OutputIterator, typename P = NoPrune>
+struct FV : public std::unary_function<Expr, StaticVisitAction> {
   F filter;
+  P prune;
 
   OutputIterator out;
   ExprSet seen;
 
-  typedef FV<F, OutputIterator> this_type;
-  FV(const this_type &o) : filter(o.filter), out(o.out), seen(o.seen) {
+  typedef FV<F, OutputIterator, P> this_type;
+  FV(const this_type &o)
+      : filter(o.filter), prune(o.prune), out(o.out), seen(o.seen) {
     llvm_unreachable(nullptr);
   }
 
-  FV(F f, OutputIterator o) : filter(f), out(o) {}
-  VisitAction operator()(Expr exp) {
-    if (seen.count(exp) > 0)
-      return VisitAction::skipKids();
-    seen.insert(exp);
+  FV(F f, OutputIterator o, P p = P()) : filter(f), prune(p), out(o) {}
+  StaticVisitAction operator()(Expr exp) {
+    if (prune(exp) || !seen.insert(exp).second)
+      return StaticVisitAction::skipKids();
 
     if (filter(exp)) {
       *(out++) = exp;
-      return VisitAction::skipKids();
+      return StaticVisitAction::skipKids();
     }
 
-    return VisitAction::doKids();
+    return StaticVisitAction::doKids();
   }
 };
 } // namespace
@@ -361,6 +425,14 @@ void filter(Expr exp, F filter, OutputIterator out) {
   dagVisit(fv, exp);
 }
 
+// -- same as filter, but does not look inside sub-expressions that satisfy
+// -- prune. Use to skip sub-expressions that cannot contain a match.
+template <typename F, typename P, typename OutputIterator>
+void filter(Expr exp, F filter, P prune, OutputIterator out) {
+  FV<F, OutputIterator, P> fv(filter, out, prune);
+  dagVisit(fv, exp);
+}
+
 namespace {
 /** A wrapper to use any functional object as a replace-map */
 template <typename F> struct fn_map {
@@ -395,16 +467,16 @@ template <typename F> struct fn_map {
 };
 
 template <typename M>
-struct RV : public std::unary_function<Expr, VisitAction> {
+struct RV : public std::unary_function<Expr, StaticVisitAction> {
   typedef typename M::const_iterator const_iterator;
 
   const M &map;
   RV(const M &m) : map(m) {}
-  VisitAction operator()(Expr exp) const {
+  StaticVisitAction operator()(Expr exp) const {
     const_iterator it = map.find(exp);
 
-    return it == map.end() ? VisitAction::doKids()
-                           : VisitAction::changeTo(it->second);
+    return it == map.end() ? StaticVisitAction::doKids()
+                           : StaticVisitAction::changeTo(it->second);
   }
 };
 
@@ -10,19 +10,21 @@ namespace expr {
 namespace hexDump {
 using namespace exprMemMap;
 // helper functions
-void getValueStr(Expr value, unsigned desiredNumBytes, bool includeAscii,
-                 llvm::raw_string_ostream &stream);
+void getContentStr(Expr value, unsigned desiredNumBytes, bool includeAscii,
+                   llvm::raw_ostream &stream);
 
-void getIdxStr(Expr value, unsigned desiredNumBytes,
-               llvm::raw_string_ostream &stream);
+void getIdxStr(Expr value, unsigned desiredNumBytes, llvm::raw_ostream &stream);
 
-void getCellStr(const MemCell &cell, llvm::raw_string_ostream &stream,
+void getCellStr(const MemCell &cell, llvm::raw_ostream &stream,
                 size_t idWidth, size_t contentWidth, bool includeAscii,
                 bool isDefault = false);
 
 class HexDump : public ExprMemMap {
   void fillInGaps();
 
+  void printCells(llvm::raw_ostream &OS, bool includeAscii) const;
+  void printCells(std::ostream &OS, bool includeAscii) const;
+
 public:
   HexDump(Expr exp) : ExprMemMap(exp) {
     if (isValid())
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "seahorn/Expr/Smt/EZ3.hh"
+#include "seahorn/Expr/Smt/Model.hh"
+#include "seahorn/Expr/Smt/Solver.hh"
+
+#include <memory>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}
+
+namespace seahorn {
+namespace solver {
+
+/** Resource limits of a forked query. Zero means no limit. */
+struct fork_limits {
+  /* CPU time (sec) of the worker process */
+  unsigned cpu = 0;
+  /* address space (MB) that the query may use in the worker process, on
+     top of what the worker inherits from the parent when it is forked.
+     Only enforced where the current usage is known (/proc/self/statm) */
+  unsigned mem = 0;
+  /* wall-clock time (sec) after which the worker is killed */
+  unsigned wall = 0;
+};
+
+/**
+ * A solver that discharges each query in a forked worker process
+ * running Z3.
+ *
+ * Assertions are kept in the parent and inherited by the worker when
+ * it is forked, so nothing is serialized on the way in. The worker
+ * runs under the given CPU and memory limits; if it is killed, runs
+ * out of memory, or exceeds the wall-clock limit the result is
+ * UNKNOWN and the parent carries on.
+ *
+ * Models only contain values of Boolean, integer, real and
+ * bit-vector constants. Arrays and functions are left uninterpreted.
+ */
+class forked_solver_impl : public Solver {
+public:
+  using model_ref = typename Solver::model_ref;
+
+private:
+  expr::ExprFactory &m_efac;
+  fork_limits m_limits;
+  /* one frame of assertions per push */
+  std::vector<expr::ExprVector> m_frames;
+
+  SolverResult m_last_result;
+  expr::ExprVector m_last_core;
+  expr::ExprMap m_last_model;
+
+public:
+  forked_solver_impl(expr::ExprFactory &efac, fork_limits limits = {});
+
+  ~forked_solver_impl() = default;
+
+  SolverKind get_kind() const override { return SolverKind::FORKED; }
+
+  const fork_limits &limits() const { return m_limits; }
+  void set_limits(fork_limits limits) { m_limits = limits; }
+
+  bool add(expr::Expr exp) override;
+
+  /** Check for satisfiability */
+  SolverResult check() override;
+
+  /** Check with assumptions */
+  SolverResult
+  check_with_assumptions(const expr_const_it_range &assumptions) override;
+
+  /** Return an unsatisfiable core */
+  void unsat_core(expr::ExprVector &out) override;
+
+  /** Push a context */
+  void push() override;
+
+  /** Pop a context */
+  void pop() override;
+
+  /** Get a model */
+  model_ref get_model() override;
+
+  /** Clear all assertions */
+  void reset() override;
+
+  /** Print asserted formulas to SMT-LIB format **/
+  void to_smt_lib(llvm::raw_ostream &o) override;
+};
+
+/** A model returned by forked_solver_impl */
+class forked_model_impl : public Model {
+  expr::ExprMap m_values;
+  std::unique_ptr<EZ3> m_zctx;
+
+public:
+  forked_model_impl(expr::ExprFactory &efac, expr::ExprMap values);
+  ~forked_model_impl();
+
+  expr::Expr eval(expr::Expr expr, bool complete) override;
+
+  void print(llvm::raw_ostream &o) const override;
+};
+
+/**
+ * Check independent queries, each a conjunction of assertions, in
+ * forked worker processes. At most jobs workers run at the same time
+ * (0 means the number of hardware threads).
+ */
+std::vector<SolverResult>
+forked_check_all(expr::ExprFactory &efac,
+                 const std::vector<expr::ExprVector> &queries,
+                 fork_limits limits, unsigned jobs = 0);
+} // namespace solver
+} // namespace seahorn
@@ -4,12 +4,12 @@
 #include <gmp.h>
 #include "yices.h"
 #include "seahorn/Expr/ExprLlvm.hh"
-#include <map>
+#include <unordered_map>
 
 namespace seahorn {
 namespace solver {
 
-using ycache_t = std::map<expr::Expr, term_t>;
+using ycache_t = std::unordered_map<expr::Expr, term_t>;
 
 class marshal_yices {
   
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "seahorn/Expr/Smt/Model.hh"
+#include "seahorn/Expr/Smt/Solver.hh"
+
+#include <memory>
+#include <unordered_map>
+
+namespace llvm {
+class raw_ostream;
+}
+
+namespace seahorn {
+namespace solver {
+
+namespace sat {
+class Cdcl;
+}
+
+/**
+ * A propositional solver backed by an in-process CDCL engine.
+ *
+ * Formulas are converted to CNF by Tseitin encoding. Boolean
+ * constants and any non-Boolean atoms (e.g., bit-vector comparisons)
+ * become propositional variables, so for formulas that are not purely
+ * propositional the solver decides their Boolean abstraction.
+ *
+ * Push/pop is implemented with activation literals.
+ */
+class sat_solver_impl : public Solver {
+public:
+  using model_ref = typename Solver::model_ref;
+
+private:
+  expr::ExprFactory &m_efac;
+  std::unique_ptr<sat::Cdcl> m_sat;
+
+  /* Tseitin literal of each encoded formula */
+  std::unordered_map<expr::Expr, unsigned> m_lits;
+  /* atom of each variable (null for Tseitin variables) */
+  expr::ExprVector m_atoms;
+  /* literal that is always true */
+  unsigned m_true_lit;
+  /* activation literal of each pushed scope */
+  std::vector<unsigned> m_scopes;
+  /* formulas of the scopes that are not popped, for to_smt_lib */
+  expr::ExprVector m_assertions;
+  /* size of m_assertions when each scope was pushed */
+  std::vector<size_t> m_scope_sizes;
+  /* to build unsat cores */
+  std::unordered_map<unsigned, expr::Expr> m_last_assumptions;
+  SolverResult m_last_result;
+
+  unsigned newLit(expr::Expr atom);
+  unsigned encode(expr::Expr e);
+  void addClause(std::vector<unsigned> lits);
+  void init();
+
+public:
+  sat_solver_impl(expr::ExprFactory &efac);
+
+  ~sat_solver_impl();
+
+  SolverKind get_kind() const override { return SolverKind::SAT; }
+
+  bool add(expr::Expr exp) override;
+
+  /** Check for satisfiability */
+  SolverResult check() override;
+
+  /** Check with assumptions */
+  SolverResult
+  check_with_assumptions(const expr_const_it_range &assumptions) override;
+
+  /** Return an unsatisfiable core */
+  void unsat_core(expr::ExprVector &out) override;
+
+  /** Push a context */
+  void push() override;
+
+  /** Pop a context */
+  void pop() override;
+
+  /** Get a model */
+  model_ref get_model() override;
+
+  /** Clear all assertions */
+  void reset() override;
+
+  /** Print asserted formulas to SMT-LIB format. Atoms that SMT-LIB
+      cannot express are written as fresh Boolean constants: this is
+      the Boolean abstraction that the solver decides **/
+  void to_smt_lib(llvm::raw_ostream &o) override;
+};
+
+/** A model of sat_solver_impl: a value for each atom */
+class sat_model_impl : public Model {
+  expr::ExprMap m_values;
+
+  expr::Expr evalRec(expr::Expr e, bool complete, expr::ExprMap &cache);
+
+public:
+  sat_model_impl(expr::ExprMap &&values) : m_values(std::move(values)) {}
+
+  /* Evaluate the Boolean structure of expr. Atoms without a value are
+     kept as they are unless complete is set and they are Boolean
+     constants. */
+  expr::Expr eval(expr::Expr expr, bool complete) override;
+
+  void print(llvm::raw_ostream &o) const override;
+};
+} // namespace solver
+} // namespace seahorn
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "seahorn/Expr/Expr.hh"
+
+#include "llvm/ADT/StringRef.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace seahorn {
+
+/**
+ * Parses SMT-LIB2 scripts directly into Expr.
+ *
+ * Terms are built bottom-up while the input is tokenized, without an
+ * intermediate S-expression tree or Z3 AST, and without recursion on
+ * the nesting depth of terms. Terms bound with let are shared in the
+ * resulting DAG.
+ *
+ * Supported: set-logic, declare-fun, declare-const, define-fun (as a
+ * macro), assert, and the fixedpoint extensions declare-rel,
+ * declare-var, rule and query. Other commands are skipped. Theories
+ * are core, integer and real arithmetic, bit-vectors and arrays.
+ *
+ * Variables of a top-level forall of an assertion (or the declared
+ * variables of a rule) are kept free, so that Horn clauses can be
+ * loaded without opening binders (see HornClauseDB::loadSmtLib()).
+ */
+class SmtLibParser {
+public:
+  struct Assertion {
+    /* universally quantified variables (constants) */
+    expr::ExprVector vars;
+    expr::Expr body;
+
+    /** The assertion with its variables bound by forall */
+    expr::Expr closed() const;
+  };
+
+private:
+  class Impl;
+  std::unique_ptr<Impl> m_impl;
+
+public:
+  SmtLibParser(expr::ExprFactory &efac);
+  ~SmtLibParser();
+
+  /** Parses a script. Returns false on error (see getError()) */
+  bool parse(llvm::StringRef text);
+  bool parseFile(llvm::StringRef fname);
+
+  const std::string &getError() const;
+  /** Logic of set-logic, empty if none */
+  const std::string &getLogic() const;
+  /** Declared functions (fdecl), in order */
+  const expr::ExprVector &getDecls() const;
+  /** Relations of declare-rel (fdecl), in order */
+  const expr::ExprVector &getRelations() const;
+  /** Assertions of assert and rule commands, in order */
+  const std::vector<Assertion> &getAssertions() const;
+  /** Queries of query commands */
+  const expr::ExprVector &getQueries() const;
+};
+} // namespace seahorn
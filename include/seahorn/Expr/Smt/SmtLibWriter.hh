@@ -0,0 +1,58 @@
+#pragma once
+
+#include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/TypeChecker.hh"
+
+#include <string>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}
+
+namespace seahorn {
+
+/**
+ * Writes expressions in SMT-LIB2 directly to a stream.
+ *
+ * Unlike operator<< on Expr, which prints the expression as a tree,
+ * the writer is DAG-aware: every non-atomic sub-term that occurs more
+ * than once is bound once with let and referred to by name, so the
+ * output is linear in the size of the DAG. Nothing is buffered and no
+ * Z3 context is needed.
+ *
+ * Only operators that have an SMT-LIB2 counterpart are supported (see
+ * isSupported()). Z3 extensions such as overflow predicates or
+ * array-map are not.
+ */
+class SmtLibWriter {
+  llvm::raw_ostream &m_out;
+  expr::TypeChecker m_tc;
+  /* number of let names used so far */
+  unsigned m_lets;
+  /* names of variables bound by enclosing quantifiers, innermost last */
+  std::vector<std::string> m_bound;
+
+  void writeBinder(expr::Expr e);
+  void writeAtom(expr::Expr e);
+
+public:
+  SmtLibWriter(llvm::raw_ostream &out) : m_out(out), m_lets(0) {}
+
+  llvm::raw_ostream &out() { return m_out; }
+
+  /** True if every operator in e can be written */
+  static bool isSupported(expr::Expr e);
+
+  /** Writes a sort (Bool, Int, Real, bit-vector or array) */
+  void writeSort(expr::Expr ty);
+  /** Writes the name of a function declaration, quoted if needed */
+  void writeSymbol(expr::Expr fdecl);
+  /** (declare-fun f (D1 ... Dn) R) */
+  void writeDeclareFun(expr::Expr fdecl);
+  /** Writes e, let-binding shared sub-terms */
+  void writeTerm(expr::Expr e);
+  /** (assert e), universally closed over vars if vars is not empty */
+  void writeAssert(expr::Expr e, const expr::ExprVector &vars = {});
+};
+} // namespace seahorn
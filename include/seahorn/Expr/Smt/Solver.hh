@@ -15,7 +15,7 @@ namespace seahorn {
 namespace solver {
 
 /** Kind of solver **/
-enum class SolverKind { Z3 , YICES2};
+enum class SolverKind { Z3 , YICES2, SAT, FORKED};
 
 /** Result of the check */
 enum class SolverResult {
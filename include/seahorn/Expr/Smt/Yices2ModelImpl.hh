@@ -6,6 +6,8 @@
 #include "seahorn/Expr/Smt/Model.hh"
 #include "seahorn/Expr/Smt/Yices2SolverImpl.hh"
 
+#include <unordered_map>
+
 namespace seahorn {
 namespace solver {
 
@@ -23,7 +25,9 @@ class yices_model_impl : public Model {
   yices_solver_impl &d_solver;
   
   expr::ExprFactory &d_efac;
-  
+
+  /* values already computed; the model does not change */
+  std::unordered_map<expr::Expr, expr::Expr> d_values;
   
 public:
   yices_model_impl(model_t *model, yices_solver_impl &solver, expr::ExprFactory &efac);
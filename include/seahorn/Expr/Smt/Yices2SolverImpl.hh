@@ -6,6 +6,8 @@
 #include "yices.h"
 
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace llvm {
 class raw_ostream;
@@ -29,7 +31,7 @@ public:
   
   using model_ref = typename Solver::model_ref;
   
-  using ycache_t = std::map<expr::Expr, term_t>;
+  using ycache_t = std::unordered_map<expr::Expr, term_t>;
 
   using solver_options = std::map<std::string, std::string>;
   
@@ -44,10 +46,31 @@ private:
   
   expr::ExprFactory &d_efac;
   
+  /* Expr to yices term. yices terms are global, not owned by the context,
+     so the cache is kept for the lifetime of the solver, across push,
+     pop and reset */
   ycache_t d_cache;
-  
+
+  /* formulas added since the last call to the context; they are asserted
+     together with yices_assert_formulas */
+  std::vector<term_t> d_pending;
+
+  /* formulas of the scopes that are not popped, for query statistics
+     and to_smt_lib */
+  expr::ExprVector d_assertions;
+
+  /* size of d_assertions when each scope was pushed */
+  std::vector<size_t> d_scope_sizes;
+
   /* to build unsat cores: this avoids a decode_term function */
   assumptions_map_t d_last_assumptions;
+
+  /* assert the pending formulas */
+  void flush();
+
+  /* write the assertions, and the assumptions if any, to SMT-LIB */
+  void write_smt_lib(llvm::raw_ostream &o,
+                     const expr::ExprVector &assumptions);
   
 public:
   yices_solver_impl(expr::ExprFactory &efac, const char *logic = nullptr,
@@ -29,6 +29,7 @@
 #include "seahorn/Expr/ExprLlvm.hh"
 #include "seahorn/Expr/ExprOpBinder.hh"
 #include "seahorn/Expr/ExprOpBv.hh"
+#include "seahorn/Support/QueryStats.hh"
 #include "seahorn/Support/SeaDebug.h"
 #include "seahorn/Support/SeaLog.hh"
 
@@ -96,6 +97,35 @@ inline boost::tribool z3l_to_tribool(Z3_lbool l) {
   return boost::indeterminate;
 }
 
+/// Number of distinct nodes in the DAG of a vector of z3 terms
+inline unsigned z3_dag_size(z3::context &ctx, const z3::ast_vector &v) {
+  std::unordered_set<unsigned> seen;
+  std::vector<Z3_ast> todo;
+  for (unsigned i = 0; i < v.size(); ++i)
+    todo.push_back(Z3_ast_vector_get(ctx, v, i));
+
+  while (!todo.empty()) {
+    Z3_ast a = todo.back();
+    todo.pop_back();
+    if (!seen.insert(Z3_get_ast_id(ctx, a)).second)
+      continue;
+    switch (Z3_get_ast_kind(ctx, a)) {
+    case Z3_APP_AST: {
+      Z3_app app = Z3_to_app(ctx, a);
+      for (unsigned i = 0, n = Z3_get_app_num_args(ctx, app); i < n; ++i)
+        todo.push_back(Z3_get_app_arg(ctx, app, i));
+      break;
+    }
+    case Z3_QUANTIFIER_AST:
+      todo.push_back(Z3_get_quantifier_body(ctx, a));
+      break;
+    default:
+      break;
+    }
+  }
+  return seen.size();
+}
+
 template <typename Z> Expr z3_lite_simplify(Z &z3, Expr e) {
   z3::context &ctx = z3.get_ctx();
   z3::ast ast(z3.toAst(e));
@@ -613,8 +643,11 @@ public:
   }
 
   boost::tribool solve() {
+    seahorn::ScopedQuery q("z3.solver");
     boost::tribool res = z3l_to_tribool(Z3_solver_check(ctx, solver));
     ctx.check_error();
+    if (q.active())
+      recordQuery(q, res, ExprVector());
     return res;
   }
 
@@ -627,12 +660,29 @@ public:
     for (unsigned i = 0; i < av.size(); ++i)
       raw_av[i] = Z3_ast_vector_get(ctx, av, i);
 
+    seahorn::ScopedQuery q("z3.solver");
     boost::tribool res = z3l_to_tribool(
         Z3_solver_check_assumptions(ctx, solver, raw_av.size(), &raw_av[0]));
     ctx.check_error();
+    if (q.active())
+      recordQuery(q, res, ExprVector(std::begin(lits), std::end(lits)));
     return res;
   }
 
+private:
+  /// Record size and result of the last query (see QueryStats)
+  void recordQuery(seahorn::ScopedQuery &q, boost::tribool res,
+                   const ExprVector &assumptions) {
+    z3::ast_vector asserts(ctx, Z3_solver_get_assertions(ctx, solver));
+    ctx.check_error();
+    unsigned nodes = z3_dag_size(ctx, asserts);
+    q.finish(res, asserts.size(), nodes, [&](llvm::raw_ostream &o) {
+      toSmtLibAssuming(o, assumptions);
+    });
+  }
+
+public:
+
   template <typename OutputIterator> void unsatCore(OutputIterator out) const {
     z3::ast_vector core(ctx, Z3_solver_get_unsat_core(ctx, solver));
     ctx.check_error();
@@ -641,6 +691,32 @@ public:
       *(out++) = z3.toExpr(core[i]);
   }
 
+  /// Marshal a range of expressions into the context of the solver
+  template <typename Range> z3::ast_vector toAstVector(const Range &rng) {
+    z3::ast_vector av(ctx);
+    for (Expr e : rng)
+      av.push_back(z3.toAst(e));
+    return av;
+  }
+
+  /// Same as solveAssuming but for literals that are already marshaled
+  /// (see toAstVector). Does not access the ExprFactory so it is safe
+  /// to call concurrently with solvers that use a different context.
+  boost::tribool solveAssumingAst(const std::vector<Z3_ast> &lits) {
+    boost::tribool res = z3l_to_tribool(Z3_solver_check_assumptions(
+        ctx, solver, lits.size(), lits.empty() ? nullptr : &lits[0]));
+    ctx.check_error();
+    return res;
+  }
+
+  /// Same as unsatCore but without unmarshaling to Expr
+  void unsatCoreAst(std::vector<Z3_ast> &out) const {
+    z3::ast_vector core(ctx, Z3_solver_get_unsat_core(ctx, solver));
+    ctx.check_error();
+    for (unsigned i = 0; i < core.size(); ++i)
+      out.push_back(Z3_ast_vector_get(ctx, core, i));
+  }
+
   /**
    * Combines solveAssuming(lits) and unsatCore (out)
    */
@@ -736,8 +812,12 @@ public:
     assert(bind::isBoolConst(m_queries.at(0)) || isOp<TRUE>(m_queries.at(0)) ||
            isOp<FALSE>(m_queries.at(0)));
     z3::ast ast = z3::ast(z3.toAst(m_queries.at(0)));
+    seahorn::ScopedQuery sq("z3.fixedpoint");
     tribool res = z3l_to_tribool(Z3_fixedpoint_query(ctx, fp, ast));
     ctx.check_error();
+    if (sq.active())
+      sq.finish(res, m_rules.size(), dagSize(m_rules),
+                [this](llvm::raw_ostream &o) { o << toString(); });
     return res;
   }
 
@@ -89,15 +89,25 @@ template <typename M> struct BasicExprMarshal {
       std::string sname = boost::lexical_cast<std::string>(val);
       res = Z3_mk_numeral(ctx, sname.c_str(), sort);
     } else if (isOpX<MPZ>(e)) {
-      const mpz_class &val = getTerm<mpz_class>(e);
       z3::sort sort(ctx, Z3_mk_int_sort(ctx));
-      std::string sname = boost::lexical_cast<std::string>(val);
-      res = Z3_mk_numeral(ctx, sname.c_str(), sort);
+      signed long small;
+      if (getSmallMpz(e, small))
+        res = Z3_mk_int64(ctx, small, sort);
+      else {
+        const mpz_class &val = getTerm<mpz_class>(e);
+        std::string sname = boost::lexical_cast<std::string>(val);
+        res = Z3_mk_numeral(ctx, sname.c_str(), sort);
+      }
     } else if (bv::is_bvnum(e)) {
       z3::sort sort(ctx, Z3_mk_bv_sort(ctx, bv::width(e->arg(1))));
-      const mpz_class &val = getTerm<mpz_class>(e->arg(0));
-      std::string sname = boost::lexical_cast<std::string>(val);
-      res = Z3_mk_numeral(ctx, sname.c_str(), sort);
+      signed long small;
+      if (bv::toSmallNum(e, small))
+        res = Z3_mk_int64(ctx, small, sort);
+      else {
+        const mpz_class &val = getTerm<mpz_class>(e->arg(0));
+        std::string sname = boost::lexical_cast<std::string>(val);
+        res = Z3_mk_numeral(ctx, sname.c_str(), sort);
+      }
     } else if (bind::isBoolVar(e)) {
       // XXX The name 'edge' is misleading. Should be changed.
       Expr edge = bind::name(e);
@@ -604,16 +614,23 @@ template <typename U> struct BasicExprUnmarshal {
     if (kind == Z3_NUMERAL_AST) {
       Expr res;
       Z3_sort sort = Z3_get_sort(ctx, z);
-      std::string snum = Z3_get_numeral_string(ctx, z);
+      int64_t small;
       switch (Z3_get_sort_kind(ctx, sort)) {
       case Z3_REAL_SORT:
-        res = mkTerm(mpq_class(snum), efac);
+        res = mkTerm(mpq_class(Z3_get_numeral_string(ctx, z)), efac);
         break;
       case Z3_INT_SORT:
-        res = mkTerm(mpz_class(snum), efac);
+        if (Z3_get_numeral_int64(ctx, z, &small))
+          res = mkTerm<mpz_class>(small, efac);
+        else
+          res = mkTerm(mpz_class(Z3_get_numeral_string(ctx, z)), efac);
         break;
       case Z3_BV_SORT:
-        res = bv::bvnum(mpz_class(snum), Z3_get_bv_sort_size(ctx, sort), efac);
+        if (Z3_get_numeral_int64(ctx, z, &small))
+          res = bv::bvnum(small, Z3_get_bv_sort_size(ctx, sort), efac);
+        else
+          res = bv::bvnum(mpz_class(Z3_get_numeral_string(ctx, z)),
+                          Z3_get_bv_sort_size(ctx, sort), efac);
         break;
       default:
         assert(0 && "Unsupported numeric constant");
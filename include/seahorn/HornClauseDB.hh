@@ -22,6 +22,7 @@ using namespace llvm;
 using namespace expr;
 
 class HornClauseDB;
+class SmtLibParser;
 class HornRule {
   ExprVector m_vars;
   Expr m_head;
@@ -100,6 +101,8 @@ private:
   ExprFactory &m_efac;
   expr_set_type m_rels;
   mutable ExprVector m_vars;
+  /// true if m_vars is sorted and has no duplicates
+  mutable bool m_vars_sorted = true;
   RuleVector m_rules;
   ExprVector m_queries;
   std::map<Expr, ExprVector> m_constraints;
@@ -165,16 +168,15 @@ public:
 
   void addRule(const HornRule &rule) {
     m_rules.push_back(rule);
-    boost::copy(rule.vars(), std::back_inserter(m_vars));
+    if (!rule.vars().empty()) {
+      boost::copy(rule.vars(), std::back_inserter(m_vars));
+      m_vars_sorted = false;
+    }
     resetIndexes();
   }
 
   const ExprVector &getVars() {
-    // -- remove duplicates
-    std::sort(m_vars.begin(), m_vars.end());
-    m_vars.erase(std::unique(m_vars.begin(), m_vars.end()), m_vars.end());
-
-    return m_vars;
+    return static_cast<const HornClauseDB *>(this)->getVars();
   }
 
   void removeRule(const HornRule &r) {
@@ -182,6 +184,18 @@ public:
     resetIndexes();
   }
 
+  /// Replace rule \p r of the database by \p n in place. Unlike
+  /// removeRule followed by addRule, this does not search the rules
+  void replaceRule(HornRule &r, const HornRule &n) {
+    assert(&r >= m_rules.data() && &r < m_rules.data() + m_rules.size());
+    r = n;
+    if (!n.vars().empty()) {
+      boost::copy(n.vars(), std::back_inserter(m_vars));
+      m_vars_sorted = false;
+    }
+    resetIndexes();
+  }
+
   const RuleVector &getRules() const { return m_rules; }
   RuleVector &getRules() { return m_rules; }
 
@@ -211,6 +225,16 @@ public:
   std::map<Expr, ExprVector> &getAllInvariants() { return m_invariants; }
 
   raw_ostream &write(raw_ostream &o) const;
+  /// -- writes the database as SMT-LIB2 CHC (logic HORN) without going
+  /// -- through Z3. Shared sub-terms are let-bound.
+  /// -- requires isSmtLibWritable()
+  raw_ostream &writeSmtLib(raw_ostream &o) const;
+  /// -- true if every rule and query can be written by writeSmtLib()
+  bool isSmtLibWritable() const;
+  /// -- adds the relations, rules and queries of a parsed SMT-LIB2
+  /// -- script (HORN logic or fixedpoint extensions).
+  /// -- returns false if an assertion is not a Horn clause
+  bool loadSmtLib(const SmtLibParser &parser);
 
   /// load current HornClauseDB to a given FixedPoint object
   template <typename FP>
@@ -333,7 +357,8 @@ void get_all_pred_apps(Expr e, HornClauseDB &db, OutputIterator out) {
 
 template <typename OutputIterator>
 void get_all_bvars(Expr e, OutputIterator out) {
-  filter(e, IsBVar(), out);
+  filter(
+      e, IsBVar(), [](Expr e) { return !e->hasBoundVar(); }, out);
 }
 
 template <typename OutputIterator>
@@ -351,7 +376,7 @@ void get_all_booleans(Expr e, OutputIterator out) {
  * true.
  */
 bool hasBvarInRule(HornRule r, HornClauseDB &db,
-                   std::map<Expr, ExprVector> currentCandidates);
+                   const std::map<Expr, ExprVector> &currentCandidates);
 
 } // namespace seahorn
 #endif /* _HORN_CLAUSE_DB__H_ */
@@ -3,6 +3,10 @@
 
 #include "seahorn/Expr/Smt/EZ3.hh"
 #include "seahorn/HornClauseDB.hh"
+#include "seahorn/HornModelConverter.hh"
+
+#include <map>
+#include <vector>
 
 namespace seahorn {
 
@@ -17,4 +21,34 @@ void removeFiniteMapsHornClausesTransf(HornClauseDB &db, HornClauseDB &tdb);
 // primitives `zctx` is used to simplify
 void removeFiniteMapsBodyHornClausesTransf(HornClauseDB &db, HornClauseDB &tdb,
                                            EZ3 &zctx);
+
+// \brief maps a model of the database computed by coiHornClauseDBTransf
+// back to the relations of the original database
+class CoiHornModelConverter : public HornModelConverter {
+  friend void coiHornClauseDBTransf(HornClauseDB &, HornClauseDB &,
+                                    CoiHornModelConverter &);
+  // -- used to eliminate the local variables of inlined rules
+  EZ3 &m_zctx;
+  // -- relations of the original database
+  ExprVector m_origRels;
+  // -- relation in the cone of the query -> new relation and the
+  // -- positions of the arguments that are kept
+  std::map<Expr, std::pair<Expr, std::vector<unsigned>>> m_args;
+  // -- relations after argument elimination
+  HornClauseDB::expr_set_type m_rels;
+  // -- defining rules of inlined relations, in the order of inlining
+  std::vector<HornRule> m_inlined;
+
+public:
+  CoiHornModelConverter(EZ3 &zctx) : m_zctx(zctx) {}
+  bool convert(HornDbModel &in, HornDbModel &out) override;
+};
+
+// \brief cone-of-influence reduction of db into the empty database tdb:
+// 1. removes relations and rules that cannot reach a query
+// 2. removes arguments of relations that never influence a query
+// 3. inlines relations that are defined by one rule and used once
+// mc maps models of tdb back to db
+void coiHornClauseDBTransf(HornClauseDB &db, HornClauseDB &tdb,
+                           CoiHornModelConverter &mc);
 } // namespace seahorn
@@ -2,7 +2,6 @@
 #define HORNDBMODEL__HH_
 
 #include "seahorn/HornClauseDB.hh"
-#include "seahorn/HornifyModule.hh"
 
 #include "seahorn/Expr/Smt/EZ3.hh"
 
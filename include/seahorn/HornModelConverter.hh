@@ -2,7 +2,6 @@
 #define HORNMODEL_CONVERTER__HH_
 
 #include "seahorn/HornClauseDB.hh"
-#include "seahorn/HornifyModule.hh"
 #include "seahorn/HornDbModel.hh"
 
 #include "seahorn/Expr/Expr.hh"
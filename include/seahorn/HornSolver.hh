@@ -13,6 +13,8 @@ using namespace llvm;
 
 class HornSolver : public llvm::ModulePass {
   boost::tribool m_result;
+  /// true if a counterexample is extracted from the solver (HornCex)
+  bool m_cex;
   std::unique_ptr<EZ3> m_local_ctx;
   std::unique_ptr<ZFixedPoint<EZ3>> m_fp;
 
@@ -25,7 +27,8 @@ class HornSolver : public llvm::ModulePass {
 public:
   static char ID;
 
-  HornSolver() : ModulePass(ID), m_result(boost::indeterminate) {}
+  HornSolver(bool cex = false)
+      : ModulePass(ID), m_result(boost::indeterminate), m_cex(cex) {}
   virtual ~HornSolver() {}
 
   virtual bool runOnModule(Module &M) override;
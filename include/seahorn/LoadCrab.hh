@@ -67,6 +67,9 @@ public:
   expr::Expr toExpr(const clam::lin_cst_t &cst,
 		    OperationalSemantics &sem, OpSemContext &semCtx,
 		    const llvm::DenseSet<const llvm::Value*> *live = nullptr);
+  /* Convert an Expr in crab's semantics into sem's semantics */
+  expr::Expr toExpr(expr::Expr e, OperationalSemantics &sem,
+		    OpSemContext &semCtx);
 
 private:
   std::unique_ptr<clam::LinConsToExprImpl> m_impl;
@@ -37,6 +37,7 @@ llvm::Pass *createOneAssumePerBlockPass();
 llvm::Pass *createExternalizeAddressTakenFunctionsPass();
 llvm::Pass *createExternalizeFunctionsPass();
 llvm::Pass *createSliceFunctionsPass();
+llvm::Pass *createAssertionSlicePass();
 llvm::Pass *createDevirtualizeFunctionsPass();
 llvm::Pass *createAbstractMemoryPass();
 llvm::Pass *createPromoteMemoryToRegisterPass();
@@ -78,6 +78,7 @@ public:
 } // namespace seahorn
 #else
 
+#include "seahorn/PathBmcMuc.hh"
 #include "seahorn/clam_Clam.hh"
 
 #include <memory>
@@ -178,6 +179,14 @@ protected:
   std::unique_ptr<solver::Solver> m_boolean_solver;
   // solver used to solve a path formula over arrays, bitvectors, etc
   std::unique_ptr<solver::Solver> m_smt_path_solver;
+  // formulas asserted in m_smt_path_solver when solving paths
+  // incrementally. The i-th formula is asserted in the i-th scope.
+  ExprVector m_path_stack;
+  // solver used to compute unsat cores if m_smt_path_solver is used
+  // incrementally
+  std::unique_ptr<solver::Solver> m_muc_solver;
+  // cache of unsat cores of path formulas
+  path_bmc::MucCache m_muc_cache;
   // model of a path formula
   solver::Solver::model_ref m_model;
   /// last result of the main solver (m_boolean_solver)
@@ -202,6 +211,8 @@ protected:
   std::unique_ptr<clam::CrabBuilderManager> m_cfg_builder_man;
   // crab instance to solve paths
   std::unique_ptr<clam::IntraClam> m_crab_path_solver;
+  // context of the keys of m_fn in CrabInvariantCache
+  std::string m_crab_cache_ctx;
 
   /****************** Helpers ****************/
   using expr_invariants_map_t = DenseMap<const BasicBlock *, ExprVector>;
@@ -220,6 +231,17 @@ protected:
   /// false if some error happened.
   bool refineBoolAbstraction();
 
+  /// Assert path_formula in m_smt_path_solver. If paths are solved
+  /// incrementally then only the suffix that differs from the
+  /// previous path formula is asserted.
+  void assertPathFormula(const ExprVector &path_formula);
+
+  /// Clear all assertions from m_smt_path_solver
+  void resetPathSolver();
+
+  /// Return the solver used to compute unsat cores of path formulas
+  solver::Solver &mucSolver();
+
   /// Check feasibility of a path induced by trace using SMT solver.
   /// Return true (sat), false (unsat), or indeterminate (inconclusive).
   /// If unsat then it produces a blocking clause stored in m_gen_path.
@@ -267,6 +289,10 @@ protected:
   void loadCrabInvariants(const clam::IntraClam &analysis,
                           DenseMap<const BasicBlock *, ExprVector> &out);
 
+  /// Same as loadCrabInvariants but through CrabInvariantCache. Crab
+  /// runs only if the invariants of the function are not cached yet.
+  void loadCachedCrabInvariants(DenseMap<const BasicBlock *, ExprVector> &out);
+
   /// Add the crab invariants in m_side after applying the symbolic store s.
   void assertCrabInvariants(const expr_invariants_map_t &invariants,
                             SymStore &s);
@@ -1,6 +1,11 @@
+#pragma once
 #include "seahorn/Expr/ExprLlvm.hh"
 #include "seahorn/Expr/Smt/Solver.hh"
 
+#include <list>
+#include <map>
+#include <unordered_map>
+
 namespace seahorn {
 namespace path_bmc {
 
@@ -8,7 +13,8 @@ enum class MucMethodKind {
   MUC_NONE,
   MUC_DELETION,
   MUC_ASSUMPTIONS,
-  MUC_BINARY_SEARCH
+  MUC_BINARY_SEARCH,
+  MUC_PARALLEL
 };
 
 /** General API to compute unsat cores **/
@@ -77,5 +83,95 @@ public:
   std::string getName() const override { return "QuickXplain"; }
 };
 
+/**
+ * Parallel and anytime deletion-based MUC.
+ *
+ * Each round splits the candidates of the current core into disjoint
+ * chunks and tests them concurrently on cloned solvers. A candidate
+ * whose removal makes the core satisfiable is necessary in every
+ * subset of the core, so necessary candidates found by different
+ * workers can be combined. A removal that keeps the core
+ * unsatisfiable yields a smaller core from the solver and the smallest
+ * one found in the round becomes the new core.
+ *
+ * If the time budget runs out, the best core found so far is
+ * returned. Only Z3 is supported. For other solvers it falls back to
+ * MucDeletion.
+ **/
+class MucParallel : public minimalUnsatCore {
+  unsigned m_timeout; /*seconds*/
+  unsigned m_threads;
+  unsigned m_budget; /*seconds*/
+
+public:
+  /// threads=0 means one thread per core. budget=0 means no time budget.
+  MucParallel(solver::Solver &solver, unsigned timeout, unsigned threads,
+              unsigned budget);
+
+  void run(const expr::ExprVector &f, expr::ExprVector &out) override;
+
+  std::string getName() const override { return "Parallel MUC"; }
+};
+
+/**
+ * Memoize unsat cores of path formulas.
+ *
+ * Cores are keyed on the set of boolean literals of the path that
+ * produced them. A lookup succeeds either if the same set of literals
+ * is seen again or if some cached core is contained in the new path
+ * formula. In both cases the new path formula is unsatisfiable and
+ * the cached core can be used as its unsat core.
+ *
+ * Entries are indexed by a hash of their literals, for the first case,
+ * and by the smallest expression of their core, for the second one: a
+ * core contained in the path is only looked for among the cores
+ * indexed by some expression of the path. When the cache is full, the
+ * least recently used entry is evicted.
+ **/
+class MucCache {
+  struct Entry {
+    // sorted path literals
+    expr::ExprVector lits;
+    // sorted unsat core
+    expr::ExprVector core;
+  };
+  using entry_list = std::list<Entry>;
+  using entry_it = entry_list::iterator;
+
+  // most recently used first
+  entry_list m_entries;
+  // hash of the literals -> entries
+  std::unordered_multimap<size_t, entry_it> m_by_lits;
+  // smallest expression of the core -> entries
+  std::unordered_multimap<expr::Expr, entry_it> m_by_core;
+  // maximum number of cores kept
+  unsigned m_max_size;
+
+  static size_t hashLits(const expr::ExprVector &lits);
+  void touch(entry_it it) {
+    m_entries.splice(m_entries.begin(), m_entries, it);
+  }
+  void evict();
+
+public:
+  MucCache(unsigned max_size) : m_max_size(max_size) {}
+
+  /// Return true if an unsat core of path is known. The core is
+  /// stored in out.
+  bool lookup(const expr::ExprVector &lits, const expr::ExprVector &path,
+              expr::ExprVector &out);
+
+  /// Remember that core is an unsat core of the path given by lits
+  void insert(const expr::ExprVector &lits, const expr::ExprVector &core);
+
+  unsigned size() const { return m_entries.size(); }
+
+  void clear() {
+    m_by_lits.clear();
+    m_by_core.clear();
+    m_entries.clear();
+  }
+};
+
 } // end namespace path_bmc
 } // end namespace seahorn
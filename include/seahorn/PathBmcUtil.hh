@@ -13,6 +13,8 @@ namespace path_bmc {
 
 struct scopedSolver {
   solver::Solver &m_solver;
+  // -- previous wall-clock limit of a forked solver
+  unsigned m_old_timeout;
 
 public:
   /* Timeout in seconds*/
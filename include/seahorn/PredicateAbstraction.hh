@@ -10,6 +10,7 @@
 #include "llvm/Pass.h"
 
 #include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/ExprFreeVars.hh"
 #include "seahorn/Expr/Smt/EZ3.hh"
 #include "seahorn/HornClauseDBWto.hh"
 
@@ -45,6 +46,8 @@ private:
   std::map<Expr, Expr> m_oldToNewPredMap;
   std::map<Expr, Expr> m_newToOldPredMap;
   std::map<Expr, ExprVector> m_currentCandidates;
+  /// constants of candidates and rules, to skip them when substituting
+  FreeVarIndex m_fvIdx;
 
   HornifyModule &m_hm;
 
@@ -55,9 +58,10 @@ public:
   void guessCandidate(HornClauseDB &db);
 
   Expr applyArgsToBvars(Expr cand, Expr fapp,
-                        std::map<Expr, ExprVector> currentCandidates);
+                        const std::map<Expr, ExprVector> &currentCandidates);
+  Expr applyArgsToBvars(Expr cand, const ExprMap &bvarMap);
   ExprMap getBvarsToArgsMap(Expr fapp,
-                            std::map<Expr, ExprVector> currentCandidates);
+                            const std::map<Expr, ExprVector> &currentCandidates);
 
   void generateAbstractDB(HornClauseDB &db, HornClauseDB &new_DB,
                           PredAbsHornModelConverter &converter);
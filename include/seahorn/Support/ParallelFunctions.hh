@@ -0,0 +1,21 @@
+#pragma once
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+
+namespace seahorn {
+/// Number of threads used by per-function analyses (--sea-analysis-threads).
+/// 1 means that analyses run serially
+unsigned getAnalysisThreads();
+
+/// Calls fn on every function of M that has a body.
+///
+/// If more than one analysis thread is requested, the calls run
+/// concurrently on a thread pool. In that case fn must only read the IR
+/// (no new instructions, constants or types) and must only write state
+/// that is owned by the function it is called on. Results meant for a
+/// shared container should be stored in slots allocated before the call.
+void forEachFunction(llvm::Module &M,
+                     llvm::function_ref<void(llvm::Function &)> fn);
+} // namespace seahorn
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+#include <boost/logic/tribool.hpp>
+
+#include "llvm/Support/raw_ostream.h"
+
+namespace seahorn {
+
+/** A single solver query */
+struct QueryRecord {
+  unsigned id = 0;
+  /* solver that answered the query (e.g., z3.solver) */
+  std::string engine;
+  /* what the query was asked for (e.g., a cut-point or instruction) */
+  std::string origin;
+  unsigned assertions = 0;
+  /* number of nodes in the DAG of the query */
+  unsigned nodes = 0;
+  /* wall-clock time in seconds */
+  double seconds = 0;
+  std::string result;
+  /* SMT-LIB file where the query was dumped, if any */
+  std::string dump;
+};
+
+/**
+ * Per-query solver telemetry.
+ *
+ * Enabled with --sea-query-stats. Each solver query is recorded with
+ * its size, time, result and origin. The slowest queries are printed
+ * with the other statistics, optionally logged as JSON lines, and
+ * queries slower than --sea-slow-query are dumped to SMT-LIB.
+ *
+ * Not thread-safe: queries must be recorded from the main thread.
+ */
+class QueryStats {
+public:
+  using dump_fn = std::function<void(llvm::raw_ostream &)>;
+
+  static bool enabled();
+  /** Turn recording on or off (e.g., in a forked process) */
+  static void enable(bool v);
+
+  /** Record a query. dump prints the query to SMT-LIB if it is slow */
+  static void record(QueryRecord r, const dump_fn &dump);
+
+  /** Directory for slow queries if --sea-slow-query-dir is not given */
+  static void setDefaultDumpDir(const std::string &dir);
+
+  /** Origin of the queries issued from now on */
+  static void pushOrigin(std::string origin);
+  static void popOrigin();
+  static std::string origin();
+
+  /** Print the slowest queries and write the log if requested */
+  static void Print(llvm::raw_ostream &OS);
+};
+
+/** Sets the origin of the queries issued in a scope */
+class ScopedQueryOrigin {
+  bool m_active;
+
+public:
+  ScopedQueryOrigin(const std::function<void(llvm::raw_ostream &)> &fn)
+      : m_active(QueryStats::enabled()) {
+    if (m_active) {
+      std::string s;
+      llvm::raw_string_ostream os(s);
+      fn(os);
+      QueryStats::pushOrigin(os.str());
+    }
+  }
+  ScopedQueryOrigin(const std::string &origin)
+      : m_active(QueryStats::enabled()) {
+    if (m_active)
+      QueryStats::pushOrigin(origin);
+  }
+  ~ScopedQueryOrigin() {
+    if (m_active)
+      QueryStats::popOrigin();
+  }
+};
+
+/**
+   Usage:
+     ScopedQuery q("z3.solver");
+     auto res = solve();
+     if (q.active())
+       q.finish(res, num_assertions, num_nodes, dump);
+*/
+class ScopedQuery {
+  const char *m_engine;
+  bool m_active;
+  std::chrono::steady_clock::time_point m_start;
+
+public:
+  ScopedQuery(const char *engine)
+      : m_engine(engine), m_active(QueryStats::enabled()) {
+    if (m_active)
+      m_start = std::chrono::steady_clock::now();
+  }
+
+  bool active() const { return m_active; }
+
+  void finish(boost::tribool res, unsigned assertions, unsigned nodes,
+              const QueryStats::dump_fn &dump) {
+    if (!m_active)
+      return;
+    std::chrono::duration<double> d =
+        std::chrono::steady_clock::now() - m_start;
+    QueryRecord r;
+    r.engine = m_engine;
+    r.assertions = assertions;
+    r.nodes = nodes;
+    r.seconds = d.count();
+    r.result = res ? "sat" : (!res ? "unsat" : "unknown");
+    QueryStats::record(std::move(r), dump);
+    m_active = false;
+  }
+};
+} // namespace seahorn
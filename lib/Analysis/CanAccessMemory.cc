@@ -1,6 +1,8 @@
 #include "seahorn/Analysis/CanAccessMemory.hh"
 
+#include "seahorn/Support/ParallelFunctions.hh"
 #include "seahorn/Support/SeaDebug.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SCCIterator.h"
 #include "llvm/Analysis/CallGraph.h"
 #include "llvm/IR/InstIterator.h"
@@ -15,26 +17,36 @@ bool CanAccessMemory::canAccess(const Function *f) const {
   return m_must.count(f) > 0 || m_may.count(f) > 0;
 }
 
+/// true if F itself reads or writes memory
+static bool accessesMemory(Function &F) {
+  for (Instruction &I : instructions(F)) {
+    if (isa<LoadInst>(I) || isa<StoreInst>(I))
+      return true;
+    if (const CallInst *CI = dyn_cast<CallInst>(&I)) {
+      const Function *cf = CI->getCalledFunction();
+      if (cf && (cf->getName().startswith("llvm.memcpy") ||
+                 cf->getName().startswith("llvm.memmove") ||
+                 cf->getName().startswith("llvm.memset")))
+        return true;
+    }
+  }
+  return false;
+}
+
 bool CanAccessMemory::runOnModule(Module &M) {
   LOG("canmem", errs() << "Running may access memory analysis\n";);
 
-  for (Function &F : M) {
-    for (Instruction &I : instructions(F)) {
-      if (isa<LoadInst>(I) || isa<StoreInst>(I)) {
-        m_must.insert(&F);
-        break;
-      }
-      if (const CallInst *CI = dyn_cast<CallInst>(&I)) {
-        const Function *cf = CI->getCalledFunction();
-        if (cf && (cf->getName().startswith("llvm.memcpy") ||
-                   cf->getName().startswith("llvm.memmove") ||
-                   cf->getName().startswith("llvm.memset"))) {
-          m_must.insert(&F);
-          break;
-        }
-      }
-    }
-  }
+  // -- one slot per function, filled in by possibly concurrent tasks
+  DenseMap<const Function *, bool> must;
+  for (Function &F : M)
+    if (!F.isDeclaration())
+      must[&F] = false;
+  forEachFunction(M, [&must](Function &F) {
+    must.find(&F)->second = accessesMemory(F);
+  });
+  for (auto &kv : must)
+    if (kv.second)
+      m_must.insert(kv.first);
 
   LOG("canmem", errs() << "Must access to memory: "; for (auto v
                                                           : m_must) errs()
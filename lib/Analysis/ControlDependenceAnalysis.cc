@@ -18,6 +18,7 @@
 
 #include "llvm/Support/raw_ostream.h"
 
+#include "seahorn/Support/ParallelFunctions.hh"
 #include "seahorn/Support/SeaDebug.h"
 #include "seahorn/Support/Stats.hh"
 
@@ -190,9 +191,24 @@ void ControlDependenceAnalysisPass::getAnalysisUsage(AnalysisUsage &AU) const {
 bool ControlDependenceAnalysisPass::runOnModule(llvm::Module &M) {
   Stats::resume("Control dependence analysis");
   bool changed = false;
-  for (auto &F : M)
-    if (!F.isDeclaration())
-      changed |= runOnFunction(F);
+  if (getAnalysisThreads() > 1) {
+    // -- the analysis only reads the CFG. Post-dominator trees are
+    // -- computed by each task since the pass manager is not thread-safe,
+    // -- and every task writes to its own pre-allocated slot
+    for (auto &F : M)
+      if (!F.isDeclaration())
+        (void)m_analyses[&F];
+    forEachFunction(M, [this](Function &F) {
+      CDA_LOG(llvm::errs() << "CDA: Running on " << F.getName() << "\n");
+      PostDominatorTree PDT(F);
+      m_analyses.find(&F)->second =
+          std::make_unique<ControlDependenceAnalysisImpl>(F, PDT);
+    });
+  } else {
+    for (auto &F : M)
+      if (!F.isDeclaration())
+        changed |= runOnFunction(F);
+  }
   Stats::stop("Control dependence analysis");
   return changed;
 }
@@ -214,6 +230,11 @@ llvm::ModulePass *createControlDependenceAnalysisPass() {
   return new ControlDependenceAnalysisPass();
 }
 
+std::unique_ptr<ControlDependenceAnalysis>
+createControlDependenceAnalysis(llvm::Function &F, PostDominatorTree &PDT) {
+  return std::make_unique<ControlDependenceAnalysisImpl>(F, PDT);
+}
+
 } // namespace seahorn
 
 static llvm::RegisterPass<seahorn::ControlDependenceAnalysisPass>
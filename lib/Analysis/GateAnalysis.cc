@@ -17,9 +17,12 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <deque>
+
 #include "seahorn/Analysis/ControlDependenceAnalysis.hh"
 
 #include "seahorn/Support/SeaDebug.h"
+#include "seahorn/Support/SeaLog.hh"
 #include "seahorn/Support/Stats.hh"
 
 #define GSA_LOG(...) LOG("gsa", __VA_ARGS__)
@@ -33,25 +36,105 @@ static llvm::cl::opt<bool>
                    llvm::cl::desc("Replace phis with gammas"),
                    llvm::cl::init(true));
 
+static llvm::cl::opt<bool>
+    GsaLazy("gsa-lazy",
+            llvm::cl::desc("Compute gates on demand, per function and per "
+                           "phi (requires --gsa-replace-phis=false)"),
+            llvm::cl::init(false));
+
 using namespace llvm;
 
 namespace seahorn {
 
 namespace {
 
+/// Builds gammas as selects placed in the IR, at an insertion point
+class SelectGammas {
+  IRBuilder<> &m_IRB;
+  DenseSet<const Value *> &m_insts;
+
+public:
+  using value_type = Value *;
+
+  SelectGammas(IRBuilder<> &irb, DenseSet<const Value *> &insts,
+               Instruction *insertionPt)
+      : m_IRB(irb), m_insts(insts) {
+    m_IRB.SetInsertPoint(insertionPt);
+  }
+
+  Value *leaf(Value *v) { return v; }
+  Value *gamma(Value *cond, Value *trueVal, Value *falseVal,
+               const Twine &name) {
+    Value *SI = m_IRB.CreateSelect(cond, trueVal, falseVal, name);
+    m_insts.insert(SI);
+    return SI;
+  }
+  static StringRef name(Value *v) { return v->getName(); }
+};
+
+/// Builds gammas outside of the IR. Leaves are shared, so that equal
+/// values are equal gammas
+class DetachedGammas {
+  std::deque<Gamma> &m_nodes;
+  DenseMap<Value *, const Gamma *> &m_leaves;
+
+public:
+  using value_type = const Gamma *;
+
+  DetachedGammas(std::deque<Gamma> &nodes,
+                 DenseMap<Value *, const Gamma *> &leaves)
+      : m_nodes(nodes), m_leaves(leaves) {}
+
+  const Gamma *leaf(Value *v) {
+    const Gamma *&res = m_leaves[v];
+    if (!res) {
+      m_nodes.emplace_back();
+      m_nodes.back().value = v;
+      res = &m_nodes.back();
+    }
+    return res;
+  }
+  const Gamma *gamma(Value *cond, const Gamma *trueVal,
+                     const Gamma *falseVal, const Twine &) {
+    m_nodes.emplace_back();
+    Gamma &res = m_nodes.back();
+    res.cond = cond;
+    res.trueVal = trueVal;
+    res.falseVal = falseVal;
+    return &res;
+  }
+  static StringRef name(const Gamma *g) {
+    return g->isLeaf() ? g->value->getName() : "gamma";
+  }
+};
+
 class GateAnalysisImpl : public seahorn::GateAnalysis {
   Function &m_function;
   DominatorTree &m_DT;
   PostDominatorTree &m_PDT;
   ControlDependenceAnalysis &m_CDA;
+  bool m_lazy;
 
   DenseMap<PHINode *, Value *> m_gammas;
+  DenseSet<const Value *> m_gammaInsts;
+  DenseMap<BasicBlock *, Instruction *> m_insertionPts;
   IRBuilder<> m_IRB;
 
+  // -- gammas outside of the IR, memoized on demand in lazy mode
+  mutable DenseMap<PHINode *, const Gamma *> m_detached;
+  mutable std::deque<Gamma> m_nodes;
+  mutable DenseMap<Value *, const Gamma *> m_leaves;
+
 public:
   GateAnalysisImpl(Function &f, DominatorTree &dt, PostDominatorTree &pdt,
-                   ControlDependenceAnalysis &cda)
-      : m_function(f), m_DT(dt), m_PDT(pdt), m_CDA(cda), m_IRB(f.getContext()) {
+                   ControlDependenceAnalysis &cda, bool lazy = false)
+      : m_function(f), m_DT(dt), m_PDT(pdt), m_CDA(cda), m_lazy(lazy),
+        m_IRB(f.getContext()) {
+    // -- lazy gammas are built per phi by getDetachedGamma(), outside of
+    // -- the IR, which is never changed
+    if (lazy)
+      return;
+
     LOG("gsa-dump-before",
         errs()
             << "Dumping IR before running Gated SSA analysis pass on function: "
@@ -72,18 +155,60 @@ public:
   }
 
   Value *getGamma(PHINode *PN) const override {
-    auto it = m_gammas.find(PN);
-    assert(it != m_gammas.end());
-    return it->second;
+    assert(!m_lazy);
+    return m_gammas.lookup(PN);
+  }
+
+  bool isGamma(const Value *V) const override {
+    return m_gammaInsts.count(V) > 0;
   }
 
   bool isThinned() const override { return ThinnedGsa; }
 
+  /// Gamma of PN outside of the IR. Computed on first request
+  const Gamma &getDetachedGamma(PHINode *PN) const {
+    assert(m_lazy && PN->getFunction() == &m_function);
+    auto it = m_detached.find(PN);
+    if (it != m_detached.end())
+      return *it->second;
+    Stats::count("GSA.lazy.phis");
+    DetachedGammas builder(m_nodes, m_leaves);
+    const Gamma *res = computeGamma(PN, builder);
+    m_detached[PN] = res;
+    GSA_LOG(errs() << "Gamma for phi: " << PN->getName() << "\n");
+    return *res;
+  }
+
 private:
   void calculate();
   void processPhi(PHINode *PN, Instruction *insertionPt);
-  DenseMap<BasicBlock *, Value *>
-  processIncomingValues(PHINode *PN, Instruction *insertionPt);
+  template <typename Builder>
+  DenseMap<BasicBlock *, typename Builder::value_type>
+  processIncomingValues(PHINode *PN, Builder &B) const;
+  template <typename Builder>
+  typename Builder::value_type computeGamma(PHINode *PN, Builder &B) const;
+};
+
+/// Gate analysis of a function computed on demand, owning the analyses it
+/// depends on
+class LazyGateAnalysis : public seahorn::GateAnalysis {
+  DominatorTree m_DT;
+  PostDominatorTree m_PDT;
+  std::unique_ptr<ControlDependenceAnalysis> m_CDA;
+  GateAnalysisImpl m_impl;
+
+public:
+  LazyGateAnalysis(Function &f)
+      : m_DT(f), m_PDT(f), m_CDA(createControlDependenceAnalysis(f, m_PDT)),
+        m_impl(f, m_DT, m_PDT, *m_CDA, true) {}
+
+  Value *getGamma(PHINode *) const override { return nullptr; }
+  bool isGamma(const Value *) const override { return false; }
+  bool isThinned() const override { return m_impl.isThinned(); }
+
+  const Gamma &getDetachedGamma(PHINode *PN) const {
+    return m_impl.getDetachedGamma(PN);
+  }
 };
 
 Value *GetCondition(Instruction *TI) {
@@ -102,7 +227,6 @@ Value *GetCondition(Instruction *TI) {
 
 void GateAnalysisImpl::calculate() {
   std::vector<PHINode *> phis; // All phis in the function.
-  DenseMap<BasicBlock *, Instruction *> insertionPts;
 
   // Gammas need to be placed just after the last PHI nodes. This is because
   // LLVM utilities expect PHIs to appear at the very beginning of basic blocks.
@@ -111,7 +235,7 @@ void GateAnalysisImpl::calculate() {
   for (auto &BB : m_function) {
     Instruction *insertionPoint = BB.getFirstNonPHI();
     assert(insertionPoint);
-    insertionPts.insert({&BB, insertionPoint});
+    m_insertionPts[&BB] = insertionPoint;
 
     for (auto &PN : BB.phis())
       phis.push_back(&PN);
@@ -119,24 +243,25 @@ void GateAnalysisImpl::calculate() {
 
   for (PHINode *PN : phis) {
     auto *BB = PN->getParent();
-    processPhi(PN, insertionPts[BB]);
+    processPhi(PN, m_insertionPts[BB]);
   }
 }
 
 // Construct gating functions for incoming critical edges in the GSA mode.
 // Construct a mapping between incoming blocks to values.
-DenseMap<BasicBlock *, Value *>
-GateAnalysisImpl::processIncomingValues(PHINode *PN, Instruction *insertionPt) {
+template <typename Builder>
+DenseMap<BasicBlock *, typename Builder::value_type>
+GateAnalysisImpl::processIncomingValues(PHINode *PN, Builder &B) const {
+  using GammaVal = typename Builder::value_type;
   assert(PN);
 
   BasicBlock *const currentBB = PN->getParent();
-  m_IRB.SetInsertPoint(insertionPt);
-  UndefValue *const Undef = UndefValue::get(PN->getType());
+  GammaVal const Undef = B.leaf(UndefValue::get(PN->getType()));
 
-  DenseMap<BasicBlock *, Value *> incomingBlockToValue;
+  DenseMap<BasicBlock *, GammaVal> incomingBlockToValue;
   for (unsigned i = 0, e = PN->getNumIncomingValues(); i != e; ++i) {
     BasicBlock *incomingBlock = PN->getIncomingBlock(i);
-    Value *incomingValue = PN->getIncomingValue(i);
+    GammaVal incomingValue = B.leaf(PN->getIncomingValue(i));
     incomingBlockToValue[incomingBlock] = incomingValue;
 
     auto *TI = incomingBlock->getTerminator();
@@ -151,10 +276,10 @@ GateAnalysisImpl::processIncomingValues(PHINode *PN, Instruction *insertionPt) {
     assert(trueDest == currentBB || falseDest == currentBB);
 
     if (!ThinnedGsa) {
-      Value *SI = m_IRB.CreateSelect(
-          cond, trueDest == currentBB ? incomingValue : Undef,
-          falseDest == currentBB ? incomingValue : Undef,
-          {"seahorn.gsa.gamma.crit.", incomingBlock->getName()});
+      GammaVal SI =
+          B.gamma(cond, trueDest == currentBB ? incomingValue : Undef,
+                  falseDest == currentBB ? incomingValue : Undef,
+                  {"seahorn.gsa.gamma.crit.", incomingBlock->getName()});
       incomingBlockToValue[incomingBlock] = SI;
     }
   }
@@ -163,12 +288,30 @@ GateAnalysisImpl::processIncomingValues(PHINode *PN, Instruction *insertionPt) {
 }
 
 void GateAnalysisImpl::processPhi(PHINode *PN, Instruction *insertionPt) {
+  SelectGammas builder(m_IRB, m_gammaInsts, insertionPt);
+  Value *gamma = computeGamma(PN, builder);
+  gamma->setName(gamma->getName() + ".y." + PN->getName());
+  m_gammas[PN] = gamma;
+
+  GSA_LOG(errs() << "Gamma for phi: " << PN->getName() << "\n\t");
+  GSA_LOG(m_gammas[PN]->print(errs()));
+  GSA_LOG(errs() << "\n");
+  if (GsaReplacePhis) {
+    PN->replaceAllUsesWith(gamma);
+    PN->eraseFromParent();
+  }
+}
+
+template <typename Builder>
+typename Builder::value_type
+GateAnalysisImpl::computeGamma(PHINode *PN, Builder &B) const {
+  using GammaVal = typename Builder::value_type;
   assert(PN);
   GSA_LOG(PN->print(errs()); errs() << "\n");
 
   BasicBlock *const currentBB = PN->getParent();
-  DenseMap<BasicBlock *, Value *> incomingBlockToValue =
-      processIncomingValues(PN, insertionPt);
+  DenseMap<BasicBlock *, GammaVal> incomingBlockToValue =
+      processIncomingValues(PN, B);
 
   // Make sure CD blocks are sorted in reverse-topological order. We need this
   // because we want to process them in order opposite to execution order.
@@ -187,12 +330,10 @@ void GateAnalysisImpl::processPhi(PHINode *PN, Instruction *insertionPt) {
   }
 
   // Mapping from blocks in cdInfo to values potentially guarded by gammas.
-  DenseMap<BasicBlock *, Value *> flowingValues(incomingBlockToValue.begin(),
-                                                incomingBlockToValue.end());
+  DenseMap<BasicBlock *, GammaVal> flowingValues(incomingBlockToValue.begin(),
+                                                 incomingBlockToValue.end());
 
-  Type *const phiTy = PN->getType();
-  UndefValue *const Undef = UndefValue::get(phiTy);
-  m_IRB.SetInsertPoint(insertionPt);
+  GammaVal const Undef = B.leaf(UndefValue::get(PN->getType()));
 
   // For all blocks in cdInfo and inspect their successors to construct gamma
   // nodes where needed.
@@ -207,7 +348,7 @@ void GateAnalysisImpl::processPhi(PHINode *PN, Instruction *insertionPt) {
 
     // Collect all successors and associated values that flows when they are
     // taken (or Undef if no such flow exists).
-    SmallDenseMap<BasicBlock *, Value *, 2> SuccToVal;
+    SmallDenseMap<BasicBlock *, GammaVal, 2> SuccToVal;
     for (auto *S : successors(BB)) {
       GSA_LOG(errs() << "\tsuccessor " << S->getName() << "\n");
       // Either no values flows.
@@ -218,7 +359,7 @@ void GateAnalysisImpl::processPhi(PHINode *PN, Instruction *insertionPt) {
         SuccToVal[S] = incomingBlockToValue[BB];
         GSA_LOG({
           errs() << "1) SuccToVal[" << S->getName() << "] = direct branch to "
-                 << currentBB->getName() << ": " << SuccToVal[S]->getName()
+                 << currentBB->getName() << ": " << B.name(SuccToVal[S])
                  << "\n";
         });
       }
@@ -237,7 +378,7 @@ void GateAnalysisImpl::processPhi(PHINode *PN, Instruction *insertionPt) {
           SuccToVal[S] = it->second;
           GSA_LOG(errs() << "2) SuccToVal[" << S->getName()
                          << "] = postdom for cd " << postDomBlock->getName()
-                         << ": " << it->second->getName() << "\n");
+                         << ": " << B.name(it->second) << "\n");
           break;
         }
         auto *treeNode = m_PDT.getNode(postDomBlock)->getIDom();
@@ -257,8 +398,8 @@ void GateAnalysisImpl::processPhi(PHINode *PN, Instruction *insertionPt) {
     } else if (SuccToVal.size() == 2) {
       BasicBlock *TrueDest = BI->getSuccessor(0);
       BasicBlock *FalseDest = BI->getSuccessor(1);
-      Value *TrueVal = SuccToVal[TrueDest];
-      Value *FalseVal = SuccToVal[FalseDest];
+      GammaVal TrueVal = SuccToVal[TrueDest];
+      GammaVal FalseVal = SuccToVal[FalseDest];
 
       // Construct gamma node only when necessary.
       assert(TrueVal != Undef || FalseVal != Undef);
@@ -267,9 +408,10 @@ void GateAnalysisImpl::processPhi(PHINode *PN, Instruction *insertionPt) {
       } else if (ThinnedGsa && (TrueVal == Undef || FalseVal == Undef)) {
         flowingValues[BB] = FalseVal == Undef ? TrueVal : FalseVal;
       } else {
-        // Gammas as expressed as SelectInsts and placed in the analyzed IR.
-        Value *Ite = m_IRB.CreateSelect(BI->getCondition(), TrueVal, FalseVal,
-                                        {"seahorn.gsa.gamma.", BB->getName()});
+        // Gammas as expressed as SelectInsts and placed in the analyzed IR,
+        // or kept outside of it in lazy mode.
+        GammaVal Ite = B.gamma(BI->getCondition(), TrueVal, FalseVal,
+                               {"seahorn.gsa.gamma.", BB->getName()});
         flowingValues[BB] = Ite;
       }
     }
@@ -279,17 +421,7 @@ void GateAnalysisImpl::processPhi(PHINode *PN, Instruction *insertionPt) {
   assert(IDomBlock);
   assert(flowingValues.count(IDomBlock));
 
-  Value *gamma = flowingValues[IDomBlock];
-  gamma->setName(gamma->getName() + ".y." + PN->getName());
-  m_gammas[PN] = gamma;
-
-  GSA_LOG(errs() << "Gamma for phi: " << PN->getName() << "\n\t");
-  GSA_LOG(m_gammas[PN]->print(errs()));
-  GSA_LOG(errs() << "\n");
-  if (GsaReplacePhis) {
-    PN->replaceAllUsesWith(gamma);
-    PN->eraseFromParent();
-  }
+  return flowingValues[IDomBlock];
 }
 
 } // anonymous namespace
@@ -297,13 +429,26 @@ void GateAnalysisImpl::processPhi(PHINode *PN, Instruction *insertionPt) {
 char GateAnalysisPass::ID = 0;
 
 void GateAnalysisPass::getAnalysisUsage(AnalysisUsage &AU) const {
-  AU.addRequired<ControlDependenceAnalysisPass>();
-  AU.addRequired<DominatorTreeWrapperPass>();
-  AU.addRequired<PostDominatorTreeWrapperPass>();
+  // -- the lazy analysis computes what it needs on demand
+  if (!GsaLazy) {
+    AU.addRequired<ControlDependenceAnalysisPass>();
+    AU.addRequired<DominatorTreeWrapperPass>();
+    AU.addRequired<PostDominatorTreeWrapperPass>();
+  }
   AU.setPreservesAll();
 }
 
 bool GateAnalysisPass::runOnModule(llvm::Module &M) {
+  if (GsaLazy) {
+    // -- replacing phis on first request erases instructions that the
+    // -- client may still hold, and changes IR of a preserves-all pass
+    if (GsaReplacePhis) {
+      ERR << "--gsa-lazy requires --gsa-replace-phis=false";
+      std::exit(1);
+    }
+    return false;
+  }
+
   Stats::resume("Thinned Gate SSA transformation");
   auto &CDP = getAnalysis<ControlDependenceAnalysisPass>();
 
@@ -328,6 +473,31 @@ bool GateAnalysisPass::runOnModule(llvm::Module &M) {
   return changed;
 }
 
+bool GateAnalysisPass::isLazy() const { return GsaLazy; }
+
+bool GateAnalysisPass::hasAnalysisFor(const llvm::Function &F) const {
+  return m_analyses.count(&F) > 0 || (GsaLazy && !F.isDeclaration());
+}
+
+GateAnalysis &GateAnalysisPass::getGateAnalysis(const llvm::Function &F) {
+  assert(hasAnalysisFor(F));
+  auto &res = m_analyses[&F];
+  if (!res) {
+    ScopedStats _st_("Thinned Gate SSA transformation");
+    GSA_LOG(llvm::errs() << "\nGSA: Computing on demand for " << F.getName()
+                         << "\n");
+    Stats::count("GSA.lazy.functions");
+    res = std::make_unique<LazyGateAnalysis>(const_cast<Function &>(F));
+  }
+  return *res;
+}
+
+const Gamma &GateAnalysisPass::getGamma(PHINode &PN) {
+  assert(GsaLazy);
+  auto &GA = getGateAnalysis(*PN.getFunction());
+  return static_cast<LazyGateAnalysis &>(GA).getDetachedGamma(&PN);
+}
+
 bool GateAnalysisPass::runOnFunction(llvm::Function &F,
                                      ControlDependenceAnalysis &CDA) {
   GSA_LOG(llvm::errs() << "\nGSA: Running on " << F.getName() << "\n");
@@ -0,0 +1,49 @@
+#include "seahorn/Support/ParallelFunctions.hh"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+
+#include <algorithm>
+#include <vector>
+
+static llvm::cl::opt<unsigned> AnalysisThreads(
+    "sea-analysis-threads",
+    llvm::cl::desc("Number of threads for per-function analyses "
+                   "(0 = number of cores, 1 = serial)"),
+    llvm::cl::init(1));
+
+namespace seahorn {
+
+unsigned getAnalysisThreads() {
+  if (AnalysisThreads == 0)
+    return llvm::hardware_concurrency().compute_thread_count();
+  return AnalysisThreads;
+}
+
+void forEachFunction(llvm::Module &M,
+                     llvm::function_ref<void(llvm::Function &)> fn) {
+  std::vector<llvm::Function *> fns;
+  for (llvm::Function &F : M)
+    if (!F.isDeclaration())
+      fns.push_back(&F);
+
+  unsigned numThreads =
+      std::min<unsigned>(getAnalysisThreads(), fns.size());
+  if (numThreads <= 1) {
+    for (llvm::Function *F : fns)
+      fn(*F);
+    return;
+  }
+
+  // -- largest functions first so that a big one does not end up last
+  std::stable_sort(fns.begin(), fns.end(),
+                   [](llvm::Function *a, llvm::Function *b) {
+                     return a->size() > b->size();
+                   });
+  llvm::ThreadPool pool(llvm::hardware_concurrency(numThreads));
+  for (llvm::Function *F : fns)
+    pool.async([&fn, F] { fn(*F); });
+  pool.wait();
+}
+} // namespace seahorn
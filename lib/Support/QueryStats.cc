@@ -0,0 +1,204 @@
+#include "seahorn/Support/QueryStats.hh"
+#include "seahorn/Support/SeaLog.hh"
+#include "seahorn/Support/Stats.hh"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Path.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+using namespace llvm;
+
+namespace seahorn {
+bool QueryStatsEnabled;
+unsigned QueryStatsTop;
+std::string QueryLogFile;
+unsigned SlowQueryMs;
+std::string SlowQueryDir;
+} // namespace seahorn
+
+static llvm::cl::opt<bool, true>
+    XQueryStats("sea-query-stats",
+                llvm::cl::desc("Record time, size and result of each solver "
+                               "query"),
+                llvm::cl::location(seahorn::QueryStatsEnabled),
+                llvm::cl::init(false));
+
+static llvm::cl::opt<unsigned, true> XQueryStatsTop(
+    "sea-query-stats-top",
+    llvm::cl::desc("Number of slowest queries reported by --sea-query-stats"),
+    llvm::cl::location(seahorn::QueryStatsTop), llvm::cl::init(10u));
+
+static llvm::cl::opt<std::string, true> XQueryLogFile(
+    "sea-query-log",
+    llvm::cl::desc("Write the slowest and all slow queries to this file "
+                   "(JSON lines)"),
+    llvm::cl::location(seahorn::QueryLogFile), llvm::cl::init(""));
+
+static llvm::cl::opt<unsigned, true> XSlowQueryMs(
+    "sea-slow-query",
+    llvm::cl::desc("Dump to SMT-LIB every query that takes longer than "
+                   "this many milliseconds (0 to disable)"),
+    llvm::cl::location(seahorn::SlowQueryMs), llvm::cl::init(0u));
+
+static llvm::cl::opt<std::string, true> XSlowQueryDir(
+    "sea-slow-query-dir",
+    llvm::cl::desc("Directory where slow queries are dumped"),
+    llvm::cl::location(seahorn::SlowQueryDir), llvm::cl::init(""));
+
+namespace seahorn {
+namespace {
+struct EngineTotals {
+  unsigned count = 0;
+  double seconds = 0;
+  double max = 0;
+};
+
+unsigned s_num_queries = 0;
+std::vector<std::string> s_origins;
+std::string s_default_dir;
+/* slowest queries, sorted by decreasing time */
+std::vector<QueryRecord> s_worst;
+/* queries above the --sea-slow-query threshold */
+std::vector<QueryRecord> s_slow;
+std::map<std::string, EngineTotals> s_totals;
+
+bool slower(const QueryRecord &a, const QueryRecord &b) {
+  return a.seconds > b.seconds;
+}
+
+std::string dumpQuery(const QueryRecord &r, const QueryStats::dump_fn &dump) {
+  std::string dir = SlowQueryDir.empty() ? s_default_dir : SlowQueryDir;
+  if (dir.empty())
+    dir = ".";
+
+  SmallVector<char, 256> path;
+  path.append(dir.begin(), dir.end());
+  sys::fs::make_absolute(path);
+  std::error_code EC = sys::fs::create_directories(path);
+  if (EC) {
+    ERR << "Cannot create directory " << dir;
+    return "";
+  }
+  sys::path::append(path, "query_" + std::to_string(r.id) + ".smt2");
+  std::string filename(path.begin(), path.end());
+
+  raw_fd_ostream out(filename, EC, sys::fs::OF_Text);
+  if (EC) {
+    ERR << "Could not open: " << filename;
+    return "";
+  }
+  out << "; engine: " << r.engine << "\n"
+      << "; origin: " << r.origin << "\n"
+      << "; time: " << format("%.3f", r.seconds) << "s\n"
+      << "; result: " << r.result << "\n";
+  dump(out);
+  return filename;
+}
+
+json::Value toJSON(const QueryRecord &r) {
+  return json::Object{{"id", r.id},
+                      {"engine", r.engine},
+                      {"origin", r.origin},
+                      {"assertions", r.assertions},
+                      {"nodes", r.nodes},
+                      {"time", r.seconds},
+                      {"result", r.result},
+                      {"dump", r.dump}};
+}
+} // namespace
+
+bool QueryStats::enabled() { return QueryStatsEnabled; }
+void QueryStats::enable(bool v) { QueryStatsEnabled = v; }
+
+void QueryStats::setDefaultDumpDir(const std::string &dir) {
+  s_default_dir = dir;
+}
+
+void QueryStats::pushOrigin(std::string origin) {
+  s_origins.push_back(std::move(origin));
+}
+void QueryStats::popOrigin() {
+  if (!s_origins.empty())
+    s_origins.pop_back();
+}
+std::string QueryStats::origin() {
+  return s_origins.empty() ? "" : s_origins.back();
+}
+
+void QueryStats::record(QueryRecord r, const dump_fn &dump) {
+  r.id = ++s_num_queries;
+  if (r.origin.empty())
+    r.origin = origin();
+
+  auto &totals = s_totals[r.engine];
+  ++totals.count;
+  totals.seconds += r.seconds;
+  totals.max = std::max(totals.max, r.seconds);
+
+  if (SlowQueryMs > 0 && r.seconds * 1000 >= SlowQueryMs) {
+    Stats::count("query.slow");
+    if (dump)
+      r.dump = dumpQuery(r, dump);
+    s_slow.push_back(r);
+  }
+
+  if (QueryStatsTop == 0)
+    return;
+  if (s_worst.size() < QueryStatsTop || slower(r, s_worst.back())) {
+    auto it = std::upper_bound(s_worst.begin(), s_worst.end(), r, slower);
+    s_worst.insert(it, std::move(r));
+    if (s_worst.size() > QueryStatsTop)
+      s_worst.pop_back();
+  }
+}
+
+void QueryStats::Print(llvm::raw_ostream &OS) {
+  if (!enabled())
+    return;
+
+  OS << "\n\n************** SOLVER QUERIES ***************** \n";
+  for (auto &kv : s_totals) {
+    OS << kv.first << ": " << kv.second.count << " queries, "
+       << format("%.2f", kv.second.seconds) << "s total, "
+       << format("%.2f", kv.second.max) << "s max\n";
+  }
+  if (!s_worst.empty())
+    OS << "Slowest queries:\n";
+  for (auto &r : s_worst) {
+    OS << "  #" << r.id << " " << format("%.3f", r.seconds) << "s " << r.result
+       << " " << r.engine << " assertions=" << r.assertions
+       << " nodes=" << r.nodes;
+    if (!r.origin.empty())
+      OS << " [" << r.origin << "]";
+    if (!r.dump.empty())
+      OS << " " << r.dump;
+    OS << "\n";
+  }
+  OS << "************** SOLVER QUERIES END ***************** \n";
+
+  if (QueryLogFile.empty())
+    return;
+  std::error_code EC;
+  raw_fd_ostream log(QueryLogFile, EC, sys::fs::OF_Text);
+  if (EC) {
+    ERR << "Could not open: " << QueryLogFile;
+    return;
+  }
+  // -- slowest queries first, then the remaining slow ones
+  std::vector<QueryRecord> all(s_worst);
+  for (auto &r : s_slow) {
+    if (std::none_of(all.begin(), all.end(),
+                     [&r](const QueryRecord &w) { return w.id == r.id; }))
+      all.push_back(r);
+  }
+  for (auto &r : all)
+    log << toJSON(r) << "\n";
+}
+} // namespace seahorn
@@ -0,0 +1,311 @@
+/**
+ * Assertion-driven program slicing.
+
+ Removes every instruction that can affect neither an assertion nor an
+ assumption of the program. The slicing criteria are all instructions
+ with side effects that cannot be removed (calls to verifier and sea
+ builtins, stores that are not described by shadow memory, calls to
+ impure functions, returns). The slice is the closure of the criteria
+ under data dependence, memory dependence through shadow memory (see
+ DfCoiAnalysis) and control dependence (see ControlDependenceAnalysis).
+
+ Conditional branches that are not in the slice are kept, but branch
+ non-deterministically, so that the CFG is not changed. This only adds
+ behaviours, so the sliced program is safe whenever the original is.
+
+ With --horn-slice-assert-id=N only the assertion numbered N by
+ EnumVerifierCalls is kept. Paths that fail any other assertion end
+ in unreachable, i.e., the other assertions are assumed to hold.
+ */
+#include "seahorn/Analysis/ControlDependenceAnalysis.hh"
+#include "seahorn/DfCoiAnalysis.hh"
+#include "seahorn/Support/SeaDebug.h"
+#include "seahorn/Support/SeaLog.hh"
+#include "seahorn/Support/Stats.hh"
+#include "seahorn/Transforms/Utils/Local.hh"
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+
+using namespace llvm;
+
+static llvm::cl::opt<int> SliceAssertId(
+    "horn-slice-assert-id",
+    llvm::cl::desc("Slice onto the assertion with the given id "
+                   "(as numbered by seahorn.error). -1 keeps all assertions"),
+    llvm::cl::init(-1));
+
+namespace {
+using namespace seahorn;
+
+bool isCallTo(const Instruction &I, StringRef name) {
+  if (auto *CI = dyn_cast<CallInst>(&I))
+    if (const Function *fn = CI->getCalledFunction())
+      return fn->getName().equals(name);
+  return false;
+}
+
+/// shadow.mem.load and shadow.mem.store describe the memory access of
+/// the instruction that follows them, they stay or go together with it
+bool isShadowMemAccess(const Instruction &I) {
+  return isCallTo(I, "shadow.mem.load") || isCallTo(I, "shadow.mem.store");
+}
+
+Instruction *prevInst(Instruction &I) {
+  return &I == &I.getParent()->front() ? nullptr : I.getPrevNode();
+}
+
+class AssertionSlice : public ModulePass {
+  /// defined functions without observable side effects
+  DenseSet<const Function *> m_pure;
+  /// number of branches made non-deterministic so far
+  unsigned m_numBr = 0;
+
+  bool isRemovable(Instruction &I) const;
+  void computePure(Module &M);
+  bool selectAssertion(Module &M, unsigned id);
+  unsigned sliceFunction(Function &F);
+  bool removeDeadFunctions(Module &M);
+
+public:
+  static char ID;
+  AssertionSlice() : ModulePass(ID) {}
+
+  bool runOnModule(Module &M) override;
+  StringRef getPassName() const override { return "AssertionSlice"; }
+};
+
+char AssertionSlice::ID = 0;
+
+/// True if I can be deleted when nothing in the slice depends on it
+bool AssertionSlice::isRemovable(Instruction &I) const {
+  if (I.isTerminator() || isa<AllocaInst>(I))
+    return false;
+
+  if (auto *SI = dyn_cast<StoreInst>(&I)) {
+    // -- a store is only visible to the slice through shadow memory
+    Instruction *prev = prevInst(I);
+    return !SI->isVolatile() && prev && isCallTo(*prev, "shadow.mem.store");
+  }
+
+  if (auto *CI = dyn_cast<CallInst>(&I)) {
+    if (isa<DbgInfoIntrinsic>(CI) || isShadowMemAccess(I))
+      return true;
+    Function *fn = CI->getCalledFunction();
+    if (!fn)
+      return false;
+    StringRef name = fn->getName();
+    if (name.startswith("verifier.nondet"))
+      return true;
+    if (name.startswith("verifier.") || name.startswith("seahorn.") ||
+        name.startswith("sea.") || name.startswith("shadow."))
+      return false;
+    if (fn->isDeclaration())
+      return fn->doesNotAccessMemory() && fn->willReturn();
+    // -- memory passed to the callee is described by shadow.mem.arg.*
+    if (auto *prev = dyn_cast_or_null<CallInst>(prevInst(I)))
+      if (auto *pfn = prev->getCalledFunction())
+        if (pfn->getName().startswith("shadow.mem.arg."))
+          return false;
+    return m_pure.count(fn) > 0;
+  }
+
+  return !I.mayHaveSideEffects();
+}
+
+/// A defined function is pure if all of its instructions are removable
+void AssertionSlice::computePure(Module &M) {
+  m_pure.clear();
+  for (auto &F : M)
+    if (!F.isDeclaration())
+      m_pure.insert(&F);
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto &F : M) {
+      if (!m_pure.count(&F))
+        continue;
+      for (auto &I : instructions(F)) {
+        if (I.isTerminator() ? isa<ReturnInst>(I) || isa<BranchInst>(I)
+                             : isRemovable(I))
+          continue;
+        m_pure.erase(&F);
+        changed = true;
+        break;
+      }
+    }
+  }
+}
+
+/// Keeps only the assertion numbered id. The calls to seahorn.error(k)
+/// and verifier.error of all other assertions are removed, so that
+/// their conditions are no longer in the slice.
+bool AssertionSlice::selectAssertion(Module &M, unsigned id) {
+  bool found = false;
+  SmallVector<CallInst *, 16> others;
+  for (auto &F : M)
+    for (auto &I : instructions(F)) {
+      if (!isCallTo(I, "seahorn.error"))
+        continue;
+      auto &CI = cast<CallInst>(I);
+      auto *k = dyn_cast<ConstantInt>(CI.getArgOperand(0));
+      if (k && k->getZExtValue() == id)
+        found = true;
+      else
+        others.push_back(&CI);
+    }
+
+  if (!found) {
+    WARN << "assertion " << id << " not found, nothing is sliced. "
+         << "Were assertions enumerated with EnumVerifierCalls?";
+    return false;
+  }
+
+  for (CallInst *CI : others) {
+    auto *next = CI->getNextNode();
+    if (next && isCallTo(*next, "verifier.error"))
+      next->eraseFromParent();
+    CI->eraseFromParent();
+  }
+  Stats::uset("slice.other_asserts", others.size());
+  return true;
+}
+
+unsigned AssertionSlice::sliceFunction(Function &F) {
+  PostDominatorTree PDT(F);
+  auto CDA = createControlDependenceAnalysis(F, PDT);
+
+  // -- unreachable only blocks paths, dropping it adds behaviours. The
+  // -- return of main is not observed by anything.
+  bool isMain = F.getName().equals("main");
+  DfCoiAnalysis coi;
+  for (auto &I : instructions(F)) {
+    if (isa<BranchInst>(I) || isa<UnreachableInst>(I) ||
+        (isMain && isa<ReturnInst>(I)) || isRemovable(I))
+      continue;
+    coi.analyze(I);
+  }
+
+  // -- close the data-flow slice under control dependence
+  SmallPtrSet<Instruction *, 32> seen;
+  SmallVector<Instruction *, 32> fresh;
+  auto require = [&coi](Instruction *I) {
+    if (I && !coi.getCoi().count(I))
+      coi.analyze(*I);
+  };
+  while (true) {
+    fresh.clear();
+    for (Value *v : coi.getCoi())
+      if (auto *I = dyn_cast<Instruction>(v))
+        if (I->getFunction() == &F && seen.insert(I).second)
+          fresh.push_back(I);
+    if (fresh.empty())
+      break;
+
+    for (Instruction *I : fresh) {
+      for (BasicBlock *cd : CDA->getCDBlocks(I->getParent()))
+        require(cd->getTerminator());
+      if (auto *phi = dyn_cast<PHINode>(I))
+        for (BasicBlock *pred : phi->blocks())
+          require(pred->getTerminator());
+      if (isShadowMemAccess(*I))
+        require(I->getNextNode());
+      Instruction *prev = prevInst(*I);
+      if (prev && isShadowMemAccess(*prev))
+        require(prev);
+    }
+  }
+
+  const auto &slice = coi.getCoi();
+  SmallVector<Instruction *, 64> dead;
+  unsigned numBr = m_numBr;
+  for (auto &BB : F) {
+    for (auto &I : BB) {
+      if (slice.count(&I))
+        continue;
+      if (auto *BI = dyn_cast<BranchInst>(&I)) {
+        if (BI->isConditional() && !isa<Constant>(BI->getCondition())) {
+          Function &nd =
+              createNewNondetFn(*F.getParent(), *BI->getCondition()->getType(),
+                                m_numBr++, "verifier.nondet.slice.");
+          BI->setCondition(CallInst::Create(&nd, "", BI));
+        }
+      } else if (isRemovable(I)) {
+        dead.push_back(&I);
+      }
+    }
+  }
+
+  for (Instruction *I : dead)
+    if (!I->use_empty())
+      I->replaceAllUsesWith(UndefValue::get(I->getType()));
+  for (Instruction *I : dead)
+    I->dropAllReferences();
+  for (Instruction *I : dead)
+    I->eraseFromParent();
+
+  LOG("slice", errs() << "AssertionSlice: " << F.getName() << " removed "
+                      << dead.size() << " instructions, " << m_numBr - numBr
+                      << " branches made non-deterministic\n";);
+  return dead.size();
+}
+
+/// Removes internal functions that are no longer called
+bool AssertionSlice::removeDeadFunctions(Module &M) {
+  bool changed = false;
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    for (auto it = M.begin(); it != M.end();) {
+      Function &F = *it++;
+      if (F.isDeclaration() || !F.hasLocalLinkage())
+        continue;
+      F.removeDeadConstantUsers();
+      if (!F.use_empty())
+        continue;
+      F.eraseFromParent();
+      Stats::count("slice.removed_functions");
+      progress = changed = true;
+    }
+  }
+  return changed;
+}
+
+bool AssertionSlice::runOnModule(Module &M) {
+  if (M.empty())
+    return false;
+
+  ScopedStats _st_("AssertionSlice");
+
+  m_numBr = 0;
+  bool changed = false;
+  if (SliceAssertId >= 0)
+    changed |= selectAssertion(M, SliceAssertId);
+
+  computePure(M);
+
+  unsigned removed = 0;
+  for (auto &F : M)
+    if (!F.isDeclaration())
+      removed += sliceFunction(F);
+  Stats::uset("slice.removed_insts", removed);
+  Stats::uset("slice.nondet_branches", m_numBr);
+
+  changed |= removeDeadFunctions(M);
+  return changed || removed > 0;
+}
+} // namespace
+
+namespace seahorn {
+llvm::Pass *createAssertionSlicePass() { return new AssertionSlice(); }
+} // namespace seahorn
+
+static llvm::RegisterPass<AssertionSlice>
+    X("assertion-slice", "Slice the program onto its assertions");
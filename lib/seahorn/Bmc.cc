@@ -8,12 +8,14 @@
 
 #include "seahorn/Expr/ExprLlvm.hh"
 #include "seahorn/Expr/HexDump.hh"
+#include "seahorn/Support/QueryStats.hh"
 #include "seahorn/Support/SeaDebug.h"
 
 namespace seahorn {
 std::string BmcSmtLogic;
 std::string BmcSmtTactic;
 bool DumpHex;
+bool BmcEpochGc;
 } // namespace seahorn
 
 static llvm::cl::opt<bool, true>
@@ -28,8 +30,20 @@ static llvm::cl::opt<std::string, true>
     XBmcSmtLogic("horn-bmc-logic",
                  llvm::cl::desc("SMT-LIB logic to pass to smt solver"),
                  llvm::cl::location(seahorn::BmcSmtLogic), cl::init("ALL"));
+static llvm::cl::opt<bool, true> XBmcEpochGc(
+    "horn-bmc-epoch-gc",
+    llvm::cl::desc("Release the expressions dropped while encoding or "
+                   "resetting the BMC engine in bulk, at the end of the call"),
+    llvm::cl::location(seahorn::BmcEpochGc), cl::init(false));
 
 namespace seahorn {
+/// Epoch of the expressions released during one call of the engine, if
+/// --horn-bmc-epoch-gc. It never outlives the call, since the factory is
+/// shared with other users.
+static std::unique_ptr<ScopedExprEpoch> mkBmcEpoch(ExprFactory &efac) {
+  return BmcEpochGc ? std::make_unique<ScopedExprEpoch>(efac) : nullptr;
+}
+
 BmcEngine::BmcEngine(OperationalSemantics &sem, EZ3 &zctx)
     : m_sem(sem), m_efac(sem.efac()), m_result(boost::indeterminate),
       m_cpg(nullptr), m_fn(nullptr), m_smt_solver(zctx, BmcSmtLogic.c_str()),
@@ -55,6 +69,9 @@ void BmcEngine::addCutPoint(const CutPoint &cp) {
 
 boost::tribool BmcEngine::solve() {
   encode();
+  ScopedQueryOrigin origin([this](llvm::raw_ostream &o) {
+    o << "bmc: " << (m_fn ? m_fn->getName() : "");
+  });
   m_result = m_smt_solver.solve();
   return m_result;
 }
@@ -65,6 +82,9 @@ void BmcEngine::encode(bool assert_formula) {
   if (m_semCtx)
     return;
 
+  // -- intermediate expressions of the encoding are freed when it ends
+  auto epoch = mkBmcEpoch(m_efac);
+
   assert(m_cpg);
   assert(m_fn);
 
@@ -97,6 +117,7 @@ void BmcEngine::encode(bool assert_formula) {
 }
 
 void BmcEngine::reset() {
+  auto epoch = mkBmcEpoch(m_efac);
   m_cps.clear();
   m_cpg = nullptr;
   m_fn = nullptr;
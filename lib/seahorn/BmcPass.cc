@@ -196,10 +196,15 @@ public:
 
     if (m_engine == BmcEngineKind::mono_bmc) {
       std::unique_ptr<OperationalSemantics> sem;
-      if (HornBv2)
-        sem = std::make_unique<Bv2OpSem>(efac, *this,
-                                         F.getParent()->getDataLayout(), MEM);
-      else
+      if (HornBv2) {
+        auto bv2 = std::make_unique<Bv2OpSem>(
+            efac, *this, F.getParent()->getDataLayout(), MEM);
+        // -- with lazy gates, PHI nodes are kept and encoded by their
+        // -- gates, computed on demand
+        if (HornGSA && getAnalysis<GateAnalysisPass>().isLazy())
+          bv2->setGateAnalysis(&getAnalysis<GateAnalysisPass>());
+        sem = std::move(bv2);
+      } else
         sem = std::make_unique<BvOpSem>(efac, *this,
                                         F.getParent()->getDataLayout(), MEM);
 
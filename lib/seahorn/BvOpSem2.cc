@@ -15,8 +15,10 @@
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Regex.h"
 
+#include "seahorn/Analysis/GateAnalysis.hh"
 #include "seahorn/CallUtils.hh"
 #include "seahorn/Support/CFG.hh"
+#include "seahorn/Support/QueryStats.hh"
 #include "seahorn/Support/SeaDebug.h"
 #include "seahorn/Support/SeaLog.hh"
 #include "seahorn/Support/Stats.hh"
@@ -124,6 +126,19 @@ static llvm::cl::opt<bool> SimplifyExpr(
     llvm::cl::desc("Simplify expressions as they are written to memory"),
     llvm::cl::init(false));
 
+namespace {
+enum class SimplifierKind { Z3, Native };
+} // namespace
+
+static llvm::cl::opt<SimplifierKind> SimplifierOpt(
+    "horn-bv2-simplifier",
+    llvm::cl::desc("Simplifier used by --horn-bv2-simplify"),
+    llvm::cl::values(clEnumValN(SimplifierKind::Z3, "z3",
+                                "Round trip through the Z3 simplifier"),
+                     clEnumValN(SimplifierKind::Native, "native",
+                                "Word-level rewriting over Expr")),
+    llvm::cl::init(SimplifierKind::Native));
+
 static llvm::cl::opt<enum seahorn::details::VacCheckOptions> VacuityCheckOpt(
     "horn-bv2-vacuity-check",
     llvm::cl::desc("A choice for levels of vacuity check"),
@@ -1012,6 +1027,8 @@ public:
     }
     // const llvm::DebugLoc &dloc = I.getDebugLoc();
     bool isBackEdge = I.hasMetadata("backedge_assert");
+    ScopedQueryOrigin origin(
+        [&I](llvm::raw_ostream &o) { o << "opsem.assert: " << I; });
     Stats::resume("opsem.vacuity");
     // The solving is done incrementally. We only
     // reset the solver once per assert instruction.
@@ -2513,6 +2530,26 @@ struct OpSemPhiVisitor : public InstVisitor<OpSemPhiVisitor>, OpSemVisitorBase {
   OpSemPhiVisitor(Bv2OpSemContext &ctx, Bv2OpSem &sem)
       : OpSemVisitorBase(ctx, sem) {}
 
+  /// \brief Value of a gating function, built from its gates. A gamma can
+  /// be reached along several branches, so its value is memoized
+  Expr lookupGamma(const Gamma &g, DenseMap<const Gamma *, Expr> &cache) {
+    if (g.isLeaf())
+      return lookup(*g.value);
+    auto it = cache.find(&g);
+    if (it != cache.end())
+      return it->second;
+
+    Expr res;
+    Expr cond = lookup(*g.cond);
+    Expr op0 = lookupGamma(*g.trueVal, cache);
+    Expr op1 = lookupGamma(*g.falseVal, cache);
+    if (cond && op0 && op1)
+      res = strct::isStructVal(op0) ? strct::push_ite_struct(cond, op0, op1)
+                                    : bind::lite(cond, op0, op1);
+    cache[&g] = res;
+    return res;
+  }
+
   void visitBasicBlock(BasicBlock &BB) {
     // -- evaluate all phi-nodes atomically. First read all incoming
     // -- values, then update phi-nodes all together.
@@ -2523,10 +2560,16 @@ struct OpSemPhiVisitor : public InstVisitor<OpSemPhiVisitor>, OpSemVisitorBase {
       return;
 
     // -- evaluate all incoming values in parallel
+    GateAnalysisPass *gsa = m_sem.getGateAnalysis();
+    DenseMap<const Gamma *, Expr> gammas;
     for (; PHINode *phi = dyn_cast<PHINode>(curr); ++curr) {
       // skip phi nodes that are not tracked
       if (m_sem.isSkipped(*phi))
         continue;
+      if (gsa) {
+        ops.push_back(lookupGamma(gsa->getGamma(*phi), gammas));
+        continue;
+      }
       const Value &v = *phi->getIncomingValueForBlock(m_ctx.getPrevBb());
       ops.push_back(lookup(v));
     }
@@ -2557,6 +2600,8 @@ Bv2OpSemContext::Bv2OpSemContext(Bv2OpSem &sem, SymStore &values,
   auto &params = m_z3_simplifier->params();
   params.set("ctrl_c", true);
   params.set(":rewriter.flat", false);
+  if (SimplifierOpt == SimplifierKind::Native)
+    m_bv_simplifier = std::make_shared<expr::op::bv::BvSimplifier>(efac());
   m_shouldSimplify = SimplifyExpr;
   m_alu = mkBvOpSemAlu(*this);
   OpSemMemManager *mem = nullptr;
@@ -2595,7 +2640,8 @@ Bv2OpSemContext::Bv2OpSemContext(SymStore &values, ExprVector &side,
       m_fparams(o.m_fparams), m_ignored(o.m_ignored),
       m_registers(o.m_registers), m_memManager(nullptr), m_alu(nullptr),
       m_parent(&o), zeroE(o.zeroE), oneE(o.oneE), m_z3(o.m_z3),
-      m_z3_simplifier(o.m_z3_simplifier), m_z3_solver(o.m_z3_solver) {
+      m_z3_simplifier(o.m_z3_simplifier),
+      m_bv_simplifier(o.m_bv_simplifier), m_z3_solver(o.m_z3_solver) {
   setPathCond(o.getPathCond());
 }
 
@@ -2633,17 +2679,24 @@ Expr Bv2OpSemContext::simplify(Expr u) {
   ScopedStats _st_("opsem.simplify");
 
   Expr _u, _u_simp;
-  _u_simp = m_z3_simplifier->simplify(u);
-  _u = UseLambdas ? coerceConstArrayToLambda(_u_simp, efac()) : _u_simp;
+  if (m_bv_simplifier) {
+    // -- the native simplifier never introduces constant arrays
+    _u = m_bv_simplifier->simplify(u);
+  } else {
+    _u_simp = m_z3_simplifier->simplify(u);
+    _u = UseLambdas ? coerceConstArrayToLambda(_u_simp, efac()) : _u_simp;
+  }
   LOG(
       "opsem.simplify",
-      if (!isOpX<LAMBDA>(_u) && !isOpX<ITE>(_u) && dagSize(_u) > 100) {
+      if (!isOpX<LAMBDA>(_u) && !isOpX<ITE>(_u) && _u->sizeBound() > 100 &&
+          dagSize(_u) > 100) {
         errs() << "Term after simplification:\n" << m_z3->toSmtLib(_u) << "\n";
       });
 
   LOG(
       "opsem.dump.subformulae",
-      if ((isOpX<EQ>(_u) || isOpX<NEG>(_u)) && dagSize(_u) > 100) {
+      if ((isOpX<EQ>(_u) || isOpX<NEG>(_u)) && _u->sizeBound() > 100 &&
+          dagSize(_u) > 100) {
         static unsigned cnt = 0;
         std::ofstream file("assert." + std::to_string(++cnt) + ".smt2");
         file << m_z3->toSmtLibDecls(_u) << "\n";
@@ -3045,7 +3098,7 @@ Expr Bv2OpSemContext::getRawMem(Expr p) { return mem().getRawMem(p); }
 Bv2OpSem::Bv2OpSem(ExprFactory &efac, Pass &pass, const DataLayout &dl,
                    TrackLevel trackLvl)
     : OperationalSemantics(efac), m_pass(pass), m_trackLvl(trackLvl),
-      m_td(&dl) {
+      m_td(&dl), m_gsa(nullptr) {
   m_canFail = pass.getAnalysisIfAvailable<CanFail>();
   m_lvi_map = UseLVIInferRng ? std::make_unique<lvi_func_map_t>() : nullptr;
   auto *p = pass.getAnalysisIfAvailable<TargetLibraryInfoWrapperPass>();
@@ -3063,7 +3116,7 @@ OpSemContextPtr Bv2OpSem::mkContext(SymStore &values, ExprVector &side) {
 
 Bv2OpSem::Bv2OpSem(const Bv2OpSem &o)
     : OperationalSemantics(o), m_pass(o.m_pass), m_trackLvl(o.m_trackLvl),
-      m_td(o.m_td), m_canFail(o.m_canFail) {}
+      m_td(o.m_td), m_canFail(o.m_canFail), m_gsa(o.m_gsa) {}
 
 Expr Bv2OpSem::errorFlag(const BasicBlock &BB) {
   // -- if BB belongs to a function that cannot fail, errorFlag is always false
@@ -38,7 +38,12 @@ public:
   expr::mpz_class toNum(Expr v) override { return bv::toMpz(v); }
 
   Expr ui(unsigned v, unsigned bitWidth) override {
-    return num(mpz_class(v), bitWidth);
+    switch (bitWidth) {
+    case 1:
+      return v == 1U ? m_trueE : m_falseE;
+    default:
+      return bv::bvnum(v, bitWidth, efac());
+    }
   }
 
   Expr si(int v, unsigned bitWidth) override {
@@ -46,7 +51,7 @@ public:
     case 1:
       return v == 1 ? m_trueE : m_falseE;
     default:
-      return num(static_cast<signed long int>(v), bitWidth);
+      return bv::bvnum(v, bitWidth, efac());
     }
   }
 
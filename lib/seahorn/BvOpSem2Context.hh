@@ -5,6 +5,7 @@
 #include "seahorn/Support/SeaDebug.h"
 #include "seahorn/Support/SeaLog.hh"
 
+#include "seahorn/Expr/ExprBvSimplifier.hh"
 #include "seahorn/Expr/ExprLlvm.hh"
 #include "seahorn/Expr/Smt/EZ3.hh"
 
@@ -160,6 +161,8 @@ private:
   /// \brief local z3 objects
   std::shared_ptr<EZ3> m_z3;
   std::shared_ptr<ZSimplifier<EZ3>> m_z3_simplifier;
+  /// \brief native word-level simplifier (--horn-bv2-simplifier=native)
+  std::shared_ptr<expr::op::bv::BvSimplifier> m_bv_simplifier;
   std::shared_ptr<ZSolver<EZ3>> m_z3_solver;
 
   bool m_shouldSimplify = false;
@@ -0,0 +1,447 @@
+#include "seahorn/CrabInvariantCache.hh"
+
+#include "seahorn/Expr/ExprLlvm.hh"
+#include "seahorn/Expr/ExprOpBinder.hh"
+#include "seahorn/Expr/Smt/SmtLibParser.hh"
+#include "seahorn/Expr/Smt/SmtLibWriter.hh"
+#include "seahorn/Support/SeaDebug.h"
+#include "seahorn/Support/SeaLog.hh"
+#include "seahorn/Support/Stats.hh"
+
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+static llvm::cl::opt<bool> CrabInvCache(
+    "crab-inv-cache",
+    llvm::cl::desc("Compute Crab invariants once per function and share "
+                   "them between engines (path-bmc, horn-crab)"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<std::string> CrabInvCacheDir(
+    "crab-inv-cache-dir",
+    llvm::cl::desc("Directory where cached Crab invariants are kept across "
+                   "runs (implies --crab-inv-cache)"),
+    llvm::cl::init(""), llvm::cl::value_desc("directory"));
+
+using namespace llvm;
+using namespace expr;
+
+namespace {
+const char *BlocksTag = "; blocks ";
+const char *BlockTag = "; block ";
+/// Version of the entries and of their keys. Entries of other versions
+/// are never looked up.
+const char *CacheVersion = "v3";
+
+/// Arguments and instructions of F, in order. Positions in this vector
+/// name the values in cached scripts.
+std::vector<const Value *> localValues(const Function &F) {
+  std::vector<const Value *> res;
+  for (const Argument &arg : F.args())
+    res.push_back(&arg);
+  for (const Instruction &I : instructions(F))
+    res.push_back(&I);
+  return res;
+}
+
+/// Globals, aliases and functions that F refers to, directly or through
+/// constant expressions, in a fixed order
+SetVector<const GlobalValue *> referencedGlobals(const Function &F) {
+  SetVector<const GlobalValue *> res;
+  SmallVector<const Constant *, 16> todo;
+  SmallPtrSet<const Constant *, 16> seen;
+  auto push = [&](const Value *v) {
+    if (auto *c = dyn_cast<Constant>(v))
+      if (seen.insert(c).second)
+        todo.push_back(c);
+  };
+  for (const Instruction &I : instructions(F))
+    for (const Value *op : I.operands())
+      push(op);
+  while (!todo.empty()) {
+    const Constant *c = todo.pop_back_val();
+    if (auto *gv = dyn_cast<GlobalValue>(c))
+      res.insert(gv);
+    else
+      for (const Value *op : c->operands())
+        push(op);
+  }
+  return res;
+}
+
+/// Name of a constant of crab semantics, or null if it is not a value
+const Value *constValue(Expr c) {
+  Expr u = bind::fname(bind::fname(c));
+  return isOpX<VALUE>(u) ? getTerm<const Value *>(u) : nullptr;
+}
+} // namespace
+
+namespace seahorn {
+
+CrabInvariantCache &CrabInvariantCache::get() {
+  static CrabInvariantCache cache;
+  return cache;
+}
+
+bool CrabInvariantCache::isEnabled() {
+  return CrabInvCache || !CrabInvCacheDir.empty();
+}
+
+std::string CrabInvariantCache::moduleFingerprint(const Module &M) {
+  std::string text;
+  raw_string_ostream out(text);
+  out << M.getDataLayoutStr() << "\n" << M.getTargetTriple() << "\n";
+  for (const GlobalVariable &gv : M.globals())
+    out << gv << "\n";
+  for (const GlobalAlias &ga : M.aliases())
+    out << ga << "\n";
+  for (const Function &F : M)
+    F.print(out);
+  out.flush();
+  return utohexstr(xxHash64(text));
+}
+
+std::string CrabInvariantCache::key(const Function &F, StringRef domain,
+                                    StringRef context) {
+  std::string text;
+  raw_string_ostream out(text);
+  const Module &M = *F.getParent();
+  out << context << "\n" << M.getDataLayoutStr() << "\n"
+      << M.getTargetTriple() << "\n";
+  // -- only the signature of a function that F refers to matters
+  for (const GlobalValue *gv : referencedGlobals(F)) {
+    if (auto *fn = dyn_cast<Function>(gv))
+      out << fn->getName() << ": " << *fn->getFunctionType() << "\n";
+    else
+      out << *gv << "\n";
+  }
+  F.print(out);
+  out.flush();
+  return (domain + "-" + CacheVersion + "-" + utohexstr(xxHash64(text))).str();
+}
+
+void CrabInvariantCache::conjuncts(Expr e, ExprVector &out) {
+  if (isOpX<AND>(e)) {
+    for (auto it = e->args_begin(), end = e->args_end(); it != end; ++it)
+      conjuncts(*it, out);
+  } else if (!isOpX<TRUE>(e)) {
+    out.push_back(e);
+  }
+}
+
+bool CrabInvariantCache::lookup(StringRef key, Entry &out) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(key);
+  if (it != m_entries.end()) {
+    Stats::count("crab_cache.hits");
+    out = it->second;
+    return true;
+  }
+  if (loadFromDisk(key, out)) {
+    Stats::count("crab_cache.disk_hits");
+    m_entries[key] = out;
+    return true;
+  }
+  Stats::count("crab_cache.misses");
+  return false;
+}
+
+void CrabInvariantCache::insert(StringRef key, Entry entry) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  storeToDisk(key, entry);
+  m_entries[key] = std::move(entry);
+}
+
+void CrabInvariantCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+}
+
+bool CrabInvariantCache::loadFromDisk(StringRef key, Entry &out) {
+  if (CrabInvCacheDir.empty())
+    return false;
+  SmallString<256> path(CrabInvCacheDir);
+  sys::path::append(path, key + ".inv");
+  auto buf = MemoryBuffer::getFile(path);
+  if (!buf)
+    return false;
+
+  SmallVector<StringRef, 64> lines;
+  (*buf)->getBuffer().split(lines, '\n', -1, false);
+  unsigned numBlocks = 0;
+  if (lines.empty() || !lines[0].startswith(BlocksTag) ||
+      lines[0].drop_front(strlen(BlocksTag)).getAsInteger(10, numBlocks)) {
+    WARN << "ignoring malformed crab invariants in " << path.str();
+    return false;
+  }
+
+  Entry entry(numBlocks);
+  unsigned cur = numBlocks;
+  for (StringRef line : makeArrayRef(lines).drop_front()) {
+    if (line.startswith(BlockTag)) {
+      if (line.drop_front(strlen(BlockTag)).getAsInteger(10, cur) ||
+          cur >= numBlocks) {
+        WARN << "ignoring malformed crab invariants in " << path.str();
+        return false;
+      }
+    } else if (cur < numBlocks) {
+      entry[cur] += line;
+      entry[cur] += "\n";
+    }
+  }
+  out = std::move(entry);
+  return true;
+}
+
+void CrabInvariantCache::storeToDisk(StringRef key, const Entry &entry) {
+  if (CrabInvCacheDir.empty())
+    return;
+  if (std::error_code ec = sys::fs::create_directories(CrabInvCacheDir)) {
+    WARN << "cannot create " << CrabInvCacheDir << ": " << ec.message();
+    return;
+  }
+
+  // -- write to a fresh file and rename it, so that concurrent runs never
+  // -- see a partial entry
+  SmallString<256> path(CrabInvCacheDir), tmp;
+  sys::path::append(path, key + ".inv");
+  int fd;
+  if (sys::fs::createUniqueFile(Twine(path) + ".%%%%%%.tmp", fd, tmp))
+    return;
+  {
+    raw_fd_ostream out(fd, /*shouldClose=*/true);
+    out << BlocksTag << entry.size() << "\n";
+    for (unsigned i = 0, sz = entry.size(); i < sz; ++i) {
+      if (entry[i].empty())
+        continue;
+      out << BlockTag << i << "\n" << entry[i];
+    }
+  }
+  if (sys::fs::rename(tmp, path))
+    sys::fs::remove(tmp);
+}
+
+CrabInvariantCache::Entry
+CrabInvariantCache::encode(const Function &F, const BlockInvariants &inv) {
+  DenseMap<const Value *, unsigned> ids;
+  for (const Value *v : localValues(F))
+    ids.insert({v, ids.size()});
+
+  Entry entry;
+  entry.reserve(F.size());
+  for (const BasicBlock &bb : F) {
+    entry.emplace_back();
+    auto it = inv.find(&bb);
+    if (it == inv.end())
+      continue;
+
+    ExprVector conjs, kept;
+    conjuncts(it->second, conjs);
+    ExprMap names;
+    ExprVector decls;
+    for (Expr conj : conjs) {
+      ExprVector consts;
+      filter(conj, bind::IsConst(), std::back_inserter(consts));
+      // -- a conjunct over a value of another function (e.g., a global)
+      // -- cannot be named by position and is dropped
+      bool local = true;
+      for (Expr c : consts) {
+        if (names.count(c))
+          continue;
+        const Value *v = constValue(c);
+        auto id = v ? ids.find(v) : ids.end();
+        if (id == ids.end()) {
+          local = false;
+          break;
+        }
+        Expr name = mkTerm<std::string>("v" + std::to_string(id->second),
+                                        c->efac());
+        Expr k = bind::mkConst(name, bind::typeOf(c));
+        names[c] = k;
+        decls.push_back(bind::fname(k));
+      }
+      if (local)
+        kept.push_back(replace(conj, names));
+    }
+    if (kept.empty())
+      continue;
+
+    raw_string_ostream out(entry.back());
+    SmtLibWriter writer(out);
+    for (Expr d : decls)
+      writer.writeDeclareFun(d);
+    for (Expr conj : kept)
+      writer.writeAssert(conj);
+  }
+  return entry;
+}
+
+bool CrabInvariantCache::decode(const Function &F, const Entry &entry,
+                                ExprFactory &efac, BlockInvariants &out) {
+  if (entry.size() != F.size())
+    return false;
+
+  std::vector<const Value *> values = localValues(F);
+  unsigned i = 0;
+  for (const BasicBlock &bb : F) {
+    const std::string &script = entry[i++];
+    if (script.empty())
+      continue;
+
+    SmtLibParser parser(efac);
+    if (!parser.parse(script)) {
+      WARN << "cannot read cached crab invariants of " << F.getName() << ": "
+           << parser.getError();
+      return false;
+    }
+    ExprMap sub;
+    for (Expr d : parser.getDecls()) {
+      StringRef name = getTerm<std::string>(bind::fname(d));
+      unsigned id;
+      if (!name.consume_front("v") || name.getAsInteger(10, id) ||
+          id >= values.size())
+        return false;
+      Expr v = mkTerm<const Value *>(values[id], efac);
+      sub[bind::fapp(d)] = bind::mkConst(v, bind::rangeTy(d));
+    }
+    ExprVector conjs;
+    for (auto &a : parser.getAssertions())
+      conjs.push_back(replace(a.body, sub));
+    if (!conjs.empty())
+      out[&bb] = op::boolop::land(conjs);
+  }
+  return true;
+}
+} // namespace seahorn
+
+#ifdef HAVE_CLAM
+#include "seahorn/LoadCrab.hh"
+#include "seahorn/clam_CfgBuilder.hh"
+
+#include "clam/SeaDsaHeapAbstraction.hh"
+#include "seadsa/Global.hh"
+
+#include "llvm/Analysis/TargetLibraryInfo.h"
+
+namespace seahorn {
+
+CrabInvariantCache::Entry crabInvariantsToEntry(
+    const Function &F, clam::CfgBuilder *cfgBuilder,
+    const clam::CrabDomain::Type &dom,
+    function_ref<Optional<clam::clam_abstract_domain>(const BasicBlock &)>
+        pre) {
+  ExprFactory efac;
+  CrabInvariantCache::BlockInvariants inv;
+  for (const BasicBlock &bb : F) {
+    Optional<clam::clam_abstract_domain> preOpt = pre(bb);
+    if (!preOpt.hasValue() || preOpt.getValue().is_top())
+      continue;
+    clam::clam_abstract_domain abs = preOpt.getValue();
+
+    // -- remove dead variables
+    if (cfgBuilder) {
+      Optional<clam::varset_t> live = cfgBuilder->getLiveSymbols(&bb);
+      if (live.hasValue()) {
+        std::vector<clam::var_t> vars(live.getValue().begin(),
+                                      live.getValue().end());
+        abs.project(vars);
+      }
+    }
+
+    if (dom.isDisjunctive()) {
+      DisjunctiveLinConsToExpr conv(cfgBuilder, F);
+      inv[&bb] =
+          conv.toExpr(abs.to_disjunctive_linear_constraint_system(), efac);
+      continue;
+    }
+
+    LinConsToExpr conv(cfgBuilder, F);
+    ExprVector conjs;
+    for (auto cst : abs.to_linear_constraint_system()) {
+      // -- crab can mix variables of different bitwidths
+      if (!cst.is_well_typed())
+        continue;
+      conjs.push_back(conv.toExpr(cst, efac));
+    }
+    if (!conjs.empty())
+      inv[&bb] = op::boolop::land(conjs);
+  }
+  return CrabInvariantCache::encode(F, inv);
+}
+
+std::string crabCacheContext(const Module &M,
+                             const clam::CrabBuilderParams &params, bool cs,
+                             bool interproc) {
+  std::string res;
+  raw_string_ostream out(res);
+  if (interproc)
+    out << CrabInvariantCache::moduleFingerprint(M) << " ";
+  out << "precision=" << static_cast<int>(params.precision_level)
+      << " simplify=" << params.simplify
+      << " inter=" << params.interprocedural
+      << " singleton_aliases=" << params.lower_singleton_aliases
+      << " overflow=" << params.lower_arithmetic_with_overflow_intrinsics
+      << " is_deref=" << params.add_is_deref << " cs=" << cs;
+  return out.str();
+}
+
+std::string computeCrabInvariants(Module &M, seadsa::GlobalAnalysis &dsa,
+                                  TargetLibraryInfoWrapperPass &tli,
+                                  const clam::CrabDomain::Type &dom) {
+  ScopedStats _st_("crab_cache.compute");
+
+  // -- same Crab CFG as path-bmc
+  clam::CrabBuilderParams cfgParams;
+  cfgParams.simplify = false;
+  cfgParams.setPrecision(clam::CrabBuilderPrecision::MEM);
+  cfgParams.lower_singleton_aliases = true;
+  bool cs = dsa.kind() == seadsa::GlobalAnalysisKind::CONTEXT_SENSITIVE;
+  std::string context = crabCacheContext(M, cfgParams, cs, false);
+
+  auto &cache = CrabInvariantCache::get();
+  std::unique_ptr<clam::CrabBuilderManager> man;
+  for (Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+    std::string key = CrabInvariantCache::key(F, dom.name(), context);
+    CrabInvariantCache::Entry entry;
+    if (cache.lookup(key, entry))
+      continue;
+
+    if (!man) {
+      clam::SeaDsaHeapAbstractionParams heapParams;
+      heapParams.is_context_sensitive = cs;
+      heapParams.precision_level = clam::CrabBuilderPrecision::MEM;
+      man = std::make_unique<clam::CrabBuilderManager>(
+          cfgParams, tli,
+          std::make_unique<clam::SeaDsaHeapAbstraction>(M, dsa, heapParams));
+    }
+
+    clam::IntraClam crab(F, *man);
+    clam::CfgBuilder *cfgBuilder = man->getCfgBuilder(F);
+    if (cfgBuilder)
+      cfgBuilder->computeLiveSymbols();
+    clam::AnalysisParams params;
+    params.dom = dom;
+    crab.analyze(params);
+
+    LOG("crab-cache", errs() << "Crab invariants of " << F.getName()
+                             << " computed\n";);
+    cache.insert(key, crabInvariantsToEntry(
+                          F, cfgBuilder, dom, [&crab](const BasicBlock &bb) {
+                            return crab.getPre(&bb);
+                          }));
+  }
+  return context;
+}
+} // namespace seahorn
+#endif
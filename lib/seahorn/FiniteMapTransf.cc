@@ -659,7 +659,8 @@ public:
   VisitAction operator()(Expr exp) {
     if (isOpX<GET>(exp))
       return VisitAction::changeDoKidsRewrite(exp, m_rw);
-    else if (bind::IsConst()(exp))
+    else if (!exp->hasOpFamily(OpFamilyId::FiniteMapOp) ||
+             bind::IsConst()(exp))
       return VisitAction::skipKids();
 
     return VisitAction::doKids();
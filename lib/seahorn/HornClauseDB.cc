@@ -7,10 +7,11 @@
 #include <boost/range/algorithm/sort.hpp>
 
 #include "seahorn/Expr/ExprLlvm.hh"
+#include "seahorn/Expr/Smt/SmtLibParser.hh"
+#include "seahorn/Expr/Smt/SmtLibWriter.hh"
+#include "seahorn/Support/SeaLog.hh"
 #include "seahorn/Support/SeaDebug.h"
 
-#include <sstream>
-
 namespace seahorn {
 
 void HornClauseDB::resetIndexes() {
@@ -90,9 +91,12 @@ void HornClauseDBCallGraph::buildCallGraph() {
 }
 
 const ExprVector &HornClauseDB::getVars() const {
-  boost::sort(m_vars);
-  m_vars.resize(
-      std::distance(m_vars.begin(), std::unique(m_vars.begin(), m_vars.end())));
+  // -- remove duplicates once after rules are added
+  if (!m_vars_sorted) {
+    boost::sort(m_vars);
+    m_vars.erase(std::unique(m_vars.begin(), m_vars.end()), m_vars.end());
+    m_vars_sorted = true;
+  }
   return m_vars;
 }
 
@@ -157,48 +161,179 @@ Expr HornClauseDB::getInvariants(Expr pred) const {
 }
 
 raw_ostream &HornClauseDB::write(raw_ostream &o) const {
-  std::ostringstream oss;
-  oss << "Predicates:\n";
+  o << "Predicates:\n";
   for (auto &p : m_rels) {
-    oss << p << "\n";
+    o << *p << "\n";
   }
-  oss << "Clauses:\n";
+  o << "Clauses:\n";
   for (auto &r : m_rules) {
-    oss << r.head() << " <- " << r.body() << ".\n";
+    o << *r.head() << " <- " << *r.body() << ".\n";
+  }
+  o << "Queries:\n";
+  for (auto &q : m_queries) {
+    o << *q << "\n";
   }
-  oss << "Queries:\n";
+  o.flush();
+  return o;
+}
+
+bool HornClauseDB::isSmtLibWritable() const {
+  for (auto &r : m_rules)
+    if (!SmtLibWriter::isSupported(r.get()))
+      return false;
+  for (auto &q : m_queries)
+    if (!SmtLibWriter::isSupported(q))
+      return false;
+  return true;
+}
+
+raw_ostream &HornClauseDB::writeSmtLib(raw_ostream &o) const {
+  ScopedStats _st_("HornClauseDB::writeSmtLib");
+  SmtLibWriter writer(o);
+  o << "(set-logic HORN)\n";
+  for (auto &p : m_rels) {
+    writer.writeDeclareFun(p);
+    o << "\n";
+  }
+
+  // -- constants that are not quantified by their rule are declared
+  ExprSet declared(m_rels.begin(), m_rels.end());
+  auto declareFree = [&](Expr e, const ExprVector &vars) {
+    ExprSet bound(vars.begin(), vars.end());
+    ExprVector consts;
+    filter(e, bind::IsConst(), std::back_inserter(consts));
+    for (auto &c : consts) {
+      Expr fdecl = bind::fname(c);
+      if (!bound.count(c) && declared.insert(fdecl).second) {
+        writer.writeDeclareFun(fdecl);
+        o << "\n";
+      }
+    }
+  };
+  for (auto &r : m_rules)
+    declareFree(r.get(), r.vars());
+
+  for (auto &r : m_rules)
+    writer.writeAssert(r.get(), r.vars());
+
+  // -- a query q is the clause q -> false over all its constants
   for (auto &q : m_queries) {
-    oss << q << "\n";
+    ExprVector vars;
+    filter(q, bind::IsConst(), std::back_inserter(vars));
+    vars.erase(std::remove_if(vars.begin(), vars.end(),
+                              [this](Expr v) {
+                                return hasRelation(bind::fname(v));
+                              }),
+               vars.end());
+    writer.writeAssert(mk<IMPL>(q, mk<FALSE>(m_efac)), vars);
   }
-  o << oss.str();
+  o << "(check-sat)\n";
   o.flush();
   return o;
 }
 
+bool HornClauseDB::loadSmtLib(const SmtLibParser &parser) {
+  ScopedStats _st_("HornClauseDB::loadSmtLib");
+  for (auto &r : parser.getRelations())
+    registerRelation(r);
+  // -- in HORN logic every declared predicate is a relation. Without it
+  // -- (no set-logic, ALL, ...) uninterpreted predicates are relations,
+  // -- and so are Boolean constants that are the head of a clause
+  bool horn = parser.getLogic() == "HORN";
+  bool inferred = false;
+  ExprSet boolDecls;
+  for (auto &d : parser.getDecls()) {
+    if (!isOpX<BOOL_TY>(bind::rangeTy(d)))
+      continue;
+    if (horn || bind::domainSz(d) > 0) {
+      registerRelation(d);
+      if (!horn)
+        inferred = true;
+    } else {
+      boolDecls.insert(d);
+    }
+  }
+  if (!horn) {
+    for (auto &a : parser.getAssertions()) {
+      Expr head = isOpX<IMPL>(a.body) ? a.body->right() : a.body;
+      if (bind::isFapp(head) && boolDecls.count(bind::fname(head))) {
+        registerRelation(bind::fname(head));
+        inferred = true;
+      }
+    }
+    if (inferred)
+      WARN << "no (set-logic HORN): declared predicates are read as "
+              "relations";
+  }
+
+  auto isRelApp = [this](Expr e) {
+    return bind::isFapp(e) && hasRelation(bind::fname(e));
+  };
+
+  // -- clauses with head false derive a fresh nullary relation that is
+  // -- then queried
+  Expr query;
+  for (auto &a : parser.getAssertions()) {
+    Expr body = mk<TRUE>(m_efac);
+    Expr head = a.body;
+    if (isOpX<IMPL>(head)) {
+      body = head->left();
+      head = head->right();
+    } else if (isOpX<NEG>(head)) {
+      body = head->left();
+      head = mk<FALSE>(m_efac);
+    }
+
+    if (!isRelApp(head)) {
+      if (!isOpX<FALSE>(head)) {
+        // -- a constraint head c is the clause body && !c -> false
+        ExprVector rels;
+        filter(head, IsRelation(*this), std::back_inserter(rels));
+        if (!rels.empty()) {
+          ERR << "Not a Horn clause: " << *a.body;
+          return false;
+        }
+        body = boolop::land(body, boolop::lneg(head));
+      }
+      if (!query) {
+        Expr qdecl =
+            bind::boolConstDecl(mkTerm<std::string>("query!0", m_efac));
+        registerRelation(qdecl);
+        query = bind::fapp(qdecl);
+      }
+      head = query;
+    }
+    addRule(HornRule(a.vars, head, body));
+  }
+  if (query)
+    addQuery(query);
+
+  for (auto &q : parser.getQueries())
+    addQuery(q);
+  return true;
+}
+
 HornClauseDB::horn_set_type HornClauseDB::m_empty_set;
 HornClauseDB::expr_set_type HornClauseDBCallGraph::m_expr_empty_set;
 
 Expr extractTransitionRelation(HornRule r, HornClauseDB &db) {
-  Expr ruleBody = r.body();
-  ExprMap body_map;
-  ExprVector body_pred_apps;
-  get_all_pred_apps(ruleBody, db, std::back_inserter(body_pred_apps));
-
-  for (Expr p : body_pred_apps)
-    body_map.insert(std::make_pair(p, mk<TRUE>(p->efac())));
-
-  Expr body_constraints = replace(ruleBody, body_map);
-  return body_constraints;
+  // -- replace all predicate applications by true in a single pass
+  Expr tru = mk<TRUE>(db.getExprFactory());
+  IsPredApp isPredApp(db);
+  return replace(r.body(), mk_fn_map([&isPredApp, &tru](Expr e) {
+                   return isPredApp(e) ? tru : Expr();
+                 }));
 }
 
 bool hasBvarInRule(HornRule r, HornClauseDB &db,
-                   std::map<Expr, ExprVector> currentCandidates) {
+                   const std::map<Expr, ExprVector> &currentCandidates) {
   ExprVector pred_vector;
   get_all_pred_apps(r.body(), db, std::back_inserter(pred_vector));
   pred_vector.push_back(r.head());
 
   for (Expr pred : pred_vector) {
-    ExprVector term_vec = currentCandidates.find(bind::fname(pred))->second;
+    const ExprVector &term_vec =
+        currentCandidates.find(bind::fname(pred))->second;
     if (term_vec.size() > 1 ||
         (term_vec.size() == 1 && !isOpX<TRUE>(term_vec[0])))
       return true;
@@ -1,7 +1,9 @@
 #include "seahorn/HornClauseDBTransf.hh"
 
 #include "seahorn/Expr/ExprOpFiniteMap.hh"
+#include "seahorn/Expr/Smt/Z3.hh"
 #include "seahorn/FiniteMapTransf.hh"
+#include "seahorn/Support/SeaLog.hh"
 
 namespace seahorn {
 using namespace expr;
@@ -43,6 +45,10 @@ HornRule replaceNonVarsInHead(const HornRule &rule) {
       new_args.push_back(arg);
     }
   }
+  // -- the head only has variables
+  if (new_vars.empty())
+    return rule;
+
   Expr head = bind::fapp(*(h->args_begin()), new_args);
   Expr body = boolop::land(new_body, rule.body());
 
@@ -52,13 +58,10 @@ HornRule replaceNonVarsInHead(const HornRule &rule) {
 }
 
 void normalizeHornClauseHeads(HornClauseDB &db) {
-  std::vector<HornRule> worklist;
-  boost::copy(db.getRules(), std::back_inserter(worklist));
-
-  for (auto rule : worklist) {
+  for (HornRule &rule : db.getRules()) {
     HornRule new_rule = replaceNonVarsInHead(rule);
-    db.removeRule(rule);
-    db.addRule(new_rule);
+    if (!(new_rule == rule))
+      db.replaceRule(rule, new_rule);
   }
 }
 
@@ -177,4 +180,482 @@ void removeFiniteMapsBodyHornClausesTransf(HornClauseDB &db, HornClauseDB &tdb,
     tdb.addQuery(q);
 }
 
+namespace {
+// -- relation applications in the body of a rule
+template <typename Set>
+ExprVector bodyAtoms(Expr body, const Set &rels) {
+  ExprVector atoms;
+  filter(
+      body,
+      [&rels](Expr e) { return bind::isFapp(e) && rels.count(bind::fname(e)); },
+      std::back_inserter(atoms));
+  return atoms;
+}
+
+// -- rule variables that occur in e
+void usedVars(Expr e, const ExprSet &vars, ExprSet &out) {
+  filter(e, [&vars](Expr v) { return vars.count(v) > 0; },
+         std::inserter(out, out.begin()));
+}
+
+// -- rule with only the variables that still occur in it
+HornRule mkRule(const ExprSet &vars, Expr head, Expr body) {
+  ExprSet used;
+  usedVars(head, vars, used);
+  usedVars(body, vars, used);
+  ExprVector rvars(used.begin(), used.end());
+  return HornRule(rvars, head, body);
+}
+
+struct CoiRuleInfo {
+  const HornRule *rule;
+  // -- relation in the head, null for a query-like rule
+  Expr headRel;
+  ExprVector atoms;
+  // -- atoms that are conjuncts of the body
+  ExprVector topAtoms;
+  ExprSet vars;
+  // -- conjuncts of the body that are not relation applications
+  ExprVector constraints;
+  // -- for each constraint, the variable it defines or null. A
+  // -- definition v = t is the only occurrence of v in the body.
+  ExprVector defined;
+  // -- variables the head and the relevant constraints depend on
+  ExprSet pinned;
+};
+
+void flattenAnd(Expr e, ExprVector &out) {
+  if (isOpX<AND>(e))
+    for (auto it = e->args_begin(), end = e->args_end(); it != end; ++it)
+      flattenAnd(*it, out);
+  else if (!isOpX<TRUE>(e))
+    out.push_back(e);
+}
+
+void initConstraints(CoiRuleInfo &ri) {
+  ExprVector conj;
+  flattenAnd(ri.rule->body(), conj);
+  ExprSet atoms(ri.atoms.begin(), ri.atoms.end());
+  std::map<Expr, unsigned> occ;
+  for (Expr c : conj)
+    (atoms.count(c) ? ri.topAtoms : ri.constraints).push_back(c);
+  for (Expr a : ri.atoms)
+    for (unsigned j = 0, sz = bind::domainSz(bind::fname(a)); j < sz; ++j)
+      ++occ[a->arg(j + 1)];
+  for (Expr c : ri.constraints) {
+    ExprSet used;
+    usedVars(c, ri.vars, used);
+    for (Expr v : used)
+      ++occ[v];
+  }
+
+  for (Expr c : ri.constraints) {
+    Expr def;
+    if (isOpX<EQ>(c) && c->arity() == 2)
+      for (Expr v : {c->left(), c->right()}) {
+        Expr t = v == c->left() ? c->right() : c->left();
+        ExprSet tvars;
+        usedVars(t, ri.vars, tvars);
+        if (ri.vars.count(v) && occ[v] == 1 && !tvars.count(v)) {
+          def = v;
+          break;
+        }
+      }
+    ri.defined.push_back(def);
+  }
+}
+
+// -- variables of ri that influence the relevant arguments of its head
+void computePinned(CoiRuleInfo &ri,
+                   std::map<Expr, std::vector<bool>> &keep) {
+  ExprSet &pinned = ri.pinned;
+  pinned.clear();
+  Expr h = ri.rule->head();
+  if (!ri.headRel)
+    usedVars(h, ri.vars, pinned);
+  else
+    for (unsigned i = 0, sz = keep[ri.headRel].size(); i < sz; ++i)
+      if (keep[ri.headRel][i])
+        usedVars(h->arg(i + 1), ri.vars, pinned);
+
+  for (Expr a : ri.atoms) {
+    auto &k = keep[bind::fname(a)];
+    for (unsigned j = 0, sz = k.size(); j < sz; ++j) {
+      Expr arg = a->arg(j + 1);
+      if (k[j] || !ri.vars.count(arg))
+        usedVars(arg, ri.vars, pinned);
+    }
+  }
+  for (unsigned i = 0, sz = ri.constraints.size(); i < sz; ++i)
+    if (!ri.defined[i])
+      usedVars(ri.constraints[i], ri.vars, pinned);
+
+  // -- a definition matters only if its variable does
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (unsigned i = 0, sz = ri.constraints.size(); i < sz; ++i) {
+      Expr v = ri.defined[i];
+      if (!v || !pinned.count(v))
+        continue;
+      unsigned before = pinned.size();
+      usedVars(ri.constraints[i], ri.vars, pinned);
+      changed |= pinned.size() != before;
+    }
+  }
+}
+} // namespace
+
+void coiHornClauseDBTransf(HornClauseDB &db, HornClauseDB &tdb,
+                           CoiHornModelConverter &mc) {
+  ScopedStats _st_("HornCoi");
+  ExprFactory &efac = db.getExprFactory();
+  const auto &rels = db.getRelations();
+  mc.m_origRels.assign(rels.begin(), rels.end());
+
+  // -- 1. relations the queries depend on
+  ExprSet queryRels;
+  for (Expr q : db.getQueries())
+    filter(q, HornClauseDB::IsRelation(db),
+           std::inserter(queryRels, queryRels.begin()));
+
+  std::vector<CoiRuleInfo> infos;
+  std::map<Expr, std::vector<unsigned>> defs;
+  ExprVector worklist;
+  ExprSet live;
+  for (const HornRule &r : db.getRules()) {
+    CoiRuleInfo ri;
+    ri.rule = &r;
+    Expr h = r.head();
+    if (bind::isFapp(h) && db.hasRelation(bind::fname(h)))
+      ri.headRel = bind::fname(h);
+    ri.atoms = bodyAtoms(r.body(), rels);
+    ri.vars.insert(r.vars().begin(), r.vars().end());
+    if (ri.headRel)
+      defs[ri.headRel].push_back(infos.size());
+    infos.push_back(std::move(ri));
+  }
+  for (Expr q : queryRels)
+    if (live.insert(q).second)
+      worklist.push_back(q);
+  // -- rules without a relation in the head are queries as well
+  for (auto &ri : infos)
+    if (!ri.headRel)
+      for (Expr a : ri.atoms)
+        if (live.insert(bind::fname(a)).second)
+          worklist.push_back(bind::fname(a));
+  while (!worklist.empty()) {
+    Expr p = worklist.back();
+    worklist.pop_back();
+    for (unsigned idx : defs[p])
+      for (Expr a : infos[idx].atoms)
+        if (live.insert(bind::fname(a)).second)
+          worklist.push_back(bind::fname(a));
+  }
+  infos.erase(std::remove_if(infos.begin(), infos.end(),
+                             [&live](const CoiRuleInfo &ri) {
+                               return ri.headRel && !live.count(ri.headRel);
+                             }),
+              infos.end());
+
+  // -- 2. argument positions that influence a query (least fixpoint)
+  std::map<Expr, std::vector<bool>> keep;
+  for (Expr p : rels)
+    if (live.count(p))
+      keep[p].assign(bind::domainSz(p), false);
+  for (Expr q : db.getQueries()) {
+    if (bind::isFapp(q) && db.hasRelation(bind::fname(q))) {
+      keep[bind::fname(q)].assign(bind::domainSz(bind::fname(q)), true);
+      continue;
+    }
+    ExprSet qrels;
+    filter(q, HornClauseDB::IsRelation(db),
+           std::inserter(qrels, qrels.begin()));
+    for (Expr p : qrels)
+      keep[p].assign(bind::domainSz(p), true);
+  }
+  for (auto &ri : infos)
+    initConstraints(ri);
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto &ri : infos) {
+      computePinned(ri, keep);
+      const ExprSet &pinned = ri.pinned;
+      std::map<Expr, unsigned> occ;
+      for (Expr a : ri.atoms)
+        for (unsigned j = 0, sz = bind::domainSz(bind::fname(a)); j < sz; ++j)
+          if (ri.vars.count(a->arg(j + 1)))
+            ++occ[a->arg(j + 1)];
+
+      // -- an argument can be dropped only if it is a variable that
+      // -- occurs nowhere else in the rule
+      for (Expr a : ri.atoms) {
+        auto &k = keep[bind::fname(a)];
+        for (unsigned j = 0, sz = k.size(); j < sz; ++j) {
+          Expr arg = a->arg(j + 1);
+          if (k[j])
+            continue;
+          if (!ri.vars.count(arg) || pinned.count(arg) || occ[arg] > 1) {
+            k[j] = true;
+            changed = true;
+          }
+        }
+      }
+    }
+  }
+
+  unsigned numArgs = 0;
+  ExprMap newDecl;
+  ExprVector newRels;
+  for (Expr p : rels) {
+    if (!live.count(p))
+      continue;
+    std::vector<unsigned> kept;
+    ExprVector sig;
+    for (unsigned i = 0, sz = bind::domainSz(p); i < sz; ++i)
+      if (keep[p][i]) {
+        kept.push_back(i);
+        sig.push_back(bind::domainTy(p, i));
+      }
+    sig.push_back(bind::rangeTy(p));
+    numArgs += bind::domainSz(p) - kept.size();
+    Expr np = kept.size() == bind::domainSz(p)
+                  ? p
+                  : bind::fdecl(variant::tag(bind::fname(p), "coi"), sig);
+    newDecl[p] = np;
+    newRels.push_back(np);
+    mc.m_args[p] = std::make_pair(np, kept);
+    mc.m_rels.insert(np);
+  }
+
+  auto rewriteAtom = [&](Expr a) {
+    auto &entry = mc.m_args.at(bind::fname(a));
+    if (entry.first == bind::fname(a))
+      return a;
+    ExprVector args;
+    for (unsigned i : entry.second)
+      args.push_back(a->arg(i + 1));
+    return bind::fapp(entry.first, args);
+  };
+
+  // -- definitions of variables that are no longer needed are dropped
+  std::vector<HornRule> rules;
+  for (auto &ri : infos) {
+    ExprMap sub;
+    for (Expr a : ri.atoms)
+      sub[a] = rewriteAtom(a);
+    ExprVector body;
+    for (Expr a : ri.topAtoms)
+      body.push_back(sub[a]);
+    for (unsigned i = 0, sz = ri.constraints.size(); i < sz; ++i)
+      if (!ri.defined[i] || ri.pinned.count(ri.defined[i]))
+        body.push_back(replace(ri.constraints[i], sub));
+    if (body.empty())
+      body.push_back(mk<TRUE>(efac));
+    Expr head = ri.headRel ? rewriteAtom(ri.rule->head()) : ri.rule->head();
+    rules.push_back(mkRule(ri.vars, head, boolop::land(body)));
+  }
+
+  // -- lemmas whose arguments are all kept are moved to the new relation
+  auto transformLemmas = [&](std::map<Expr, ExprVector> &lMap,
+                             std::map<Expr, ExprVector> &lMapT) {
+    for (auto &kv : lMap) {
+      auto it = mc.m_args.find(kv.first);
+      if (it == mc.m_args.end())
+        continue;
+      Expr np = it->second.first;
+      const auto &kept = it->second.second;
+      for (Expr lemma : kv.second) {
+        ExprVector bvars;
+        get_all_bvars(lemma, std::back_inserter(bvars));
+        ExprMap sub;
+        bool ok = true;
+        for (Expr bv : bvars) {
+          auto pos = std::find(kept.begin(), kept.end(), bind::bvarId(bv));
+          if (pos == kept.end()) {
+            ok = false;
+            break;
+          }
+          sub[bv] = bind::bvar(pos - kept.begin(), bind::type(bv));
+        }
+        if (ok)
+          lMapT[np].push_back(replace(lemma, sub));
+      }
+    }
+  };
+  transformLemmas(db.getAllConstraints(), tdb.getAllConstraints());
+  transformLemmas(db.getAllInvariants(), tdb.getAllInvariants());
+
+  // -- 3. inline relations with a single definition and a single use
+  ExprSet pinnedRels;
+  for (Expr q : queryRels)
+    pinnedRels.insert(newDecl.count(q) ? newDecl[q] : q);
+  for (auto &kv : tdb.getAllConstraints())
+    pinnedRels.insert(kv.first);
+  for (auto &kv : tdb.getAllInvariants())
+    pinnedRels.insert(kv.first);
+
+  std::map<Expr, std::vector<unsigned>> ndefs, nuses;
+  for (unsigned i = 0, sz = rules.size(); i < sz; ++i) {
+    Expr h = rules[i].head();
+    if (bind::isFapp(h) && mc.m_rels.count(bind::fname(h)))
+      ndefs[bind::fname(h)].push_back(i);
+    for (Expr a : bodyAtoms(rules[i].body(), mc.m_rels))
+      nuses[bind::fname(a)].push_back(i);
+  }
+
+  std::vector<bool> dead(rules.size(), false);
+  ExprSet inlined;
+  unsigned fresh = 0;
+  for (Expr p : newRels) {
+    if (pinnedRels.count(p) || ndefs[p].size() != 1 || nuses[p].size() != 1)
+      continue;
+    unsigned d = ndefs[p][0], u = nuses[p][0];
+    if (d == u)
+      continue;
+    const HornRule &rp = rules[d];
+    const HornRule &ru = rules[u];
+
+    Expr use;
+    for (Expr a : bodyAtoms(ru.body(), mc.m_rels))
+      if (bind::fname(a) == p)
+        use = a;
+    assert(use);
+
+    // -- head variables of rp are replaced by the arguments of the use,
+    // -- all other variables of rp are renamed apart
+    ExprMap sub;
+    std::vector<unsigned> eqs;
+    ExprSet rpVars(rp.vars().begin(), rp.vars().end());
+    Expr head = rp.head();
+    for (unsigned i = 0, sz = bind::domainSz(p); i < sz; ++i) {
+      Expr h = head->arg(i + 1);
+      if (rpVars.count(h) && !sub.count(h))
+        sub[h] = use->arg(i + 1);
+      else
+        eqs.push_back(i);
+    }
+    ++fresh;
+    ExprSet vars(ru.vars().begin(), ru.vars().end());
+    for (Expr v : rp.vars()) {
+      if (sub.count(v))
+        continue;
+      Expr fdecl = bind::fname(v);
+      Expr nv = bind::mkConst(
+          variant::tag(bind::fname(fdecl), "inl" + std::to_string(fresh)),
+          bind::rangeTy(fdecl));
+      sub[v] = nv;
+      vars.insert(nv);
+    }
+
+    ExprVector conj;
+    ExprMap noUse;
+    noUse[use] = mk<TRUE>(efac);
+    conj.push_back(replace(ru.body(), noUse));
+    conj.push_back(replace(rp.body(), sub));
+    for (unsigned i : eqs)
+      conj.push_back(mk<EQ>(use->arg(i + 1), replace(head->arg(i + 1), sub)));
+
+    mc.m_inlined.push_back(rp);
+    for (Expr a : bodyAtoms(rp.body(), mc.m_rels))
+      for (unsigned &idx : nuses[bind::fname(a)])
+        if (idx == d)
+          idx = u;
+    rules[u] = mkRule(vars, ru.head(), boolop::land(conj));
+    dead[d] = true;
+    inlined.insert(p);
+  }
+
+  for (Expr p : newRels)
+    if (!inlined.count(p))
+      tdb.registerRelation(p);
+  for (unsigned i = 0, sz = rules.size(); i < sz; ++i)
+    if (!dead[i])
+      tdb.addRule(rules[i]);
+  for (Expr q : db.getQueries())
+    tdb.addQuery(q);
+
+  Stats::uset("HornCoi.removed_rels", rels.size() - tdb.getRelations().size());
+  Stats::uset("HornCoi.removed_rules",
+              db.getRules().size() - tdb.getRules().size());
+  Stats::uset("HornCoi.removed_args", numArgs);
+  Stats::uset("HornCoi.inlined", inlined.size());
+  LOG("horn-coi", errs() << "HornCoi: " << rels.size() << " -> "
+                         << tdb.getRelations().size() << " relations, "
+                         << db.getRules().size() << " -> "
+                         << tdb.getRules().size() << " rules, " << numArgs
+                         << " arguments removed, " << inlined.size()
+                         << " relations inlined\n";);
+}
+
+bool CoiHornModelConverter::convert(HornDbModel &in, HornDbModel &out) {
+  HornDbModel inl;
+  auto getDef = [&](Expr app) {
+    return inl.hasDef(app) ? inl.getDef(app) : in.getDef(app);
+  };
+  auto mkArgs = [](Expr rel) {
+    ExprVector args;
+    Expr v = mkTerm<std::string>("V", rel->efac());
+    for (unsigned i = 0, sz = bind::domainSz(rel); i < sz; ++i)
+      args.push_back(bind::mkConst(variant::variant(i, v),
+                                   bind::domainTy(rel, i)));
+    return args;
+  };
+
+  // -- an inlined relation is the projection of the body of its rule
+  // -- onto the head. Later inlined relations may occur in the bodies
+  // -- of earlier ones.
+  bool res = true;
+  for (auto it = m_inlined.rbegin(), end = m_inlined.rend(); it != end; ++it) {
+    const HornRule &r = *it;
+    Expr rel = bind::fname(r.head());
+    ExprVector args = mkArgs(rel);
+
+    ExprMap sub;
+    for (Expr a : bodyAtoms(r.body(), m_rels))
+      sub[a] = getDef(a);
+    ExprVector conj{replace(r.body(), sub)};
+    for (unsigned i = 0, sz = args.size(); i < sz; ++i)
+      conj.push_back(mk<EQ>(args[i], r.head()->arg(i + 1)));
+    Expr body = boolop::land(conj);
+
+    ExprSet locals(r.vars().begin(), r.vars().end());
+    Expr def = body;
+    if (!locals.empty())
+      def = boolop::lneg(
+          z3_forall_elim(m_zctx, boolop::lneg(body), locals));
+
+    ExprVector quants;
+    if (def->hasOpFamily(OpFamilyId::BinderOp))
+      filter(def,
+             [](Expr e) { return isOpX<FORALL>(e) || isOpX<EXISTS>(e); },
+             std::back_inserter(quants));
+    if (!quants.empty()) {
+      WARN << "HornCoi: could not eliminate local variables of " << *rel;
+      res = false;
+      def = mk<TRUE>(def->efac());
+    }
+    inl.addDef(bind::fapp(rel, args), def);
+  }
+
+  for (Expr rel : m_origRels) {
+    ExprVector args = mkArgs(rel);
+    Expr def;
+    auto it = m_args.find(rel);
+    if (it == m_args.end()) {
+      // -- relations that do not reach a query are unconstrained
+      def = mk<TRUE>(rel->efac());
+    } else {
+      ExprVector nargs;
+      for (unsigned i : it->second.second)
+        nargs.push_back(args[i]);
+      def = getDef(bind::fapp(it->second.first, nargs));
+    }
+    out.addDef(bind::fapp(rel, args), def);
+  }
+  return res;
+}
+
 } // namespace seahorn
@@ -1,5 +1,4 @@
 #include "seahorn/HornDbModel.hh"
-#include "seahorn/HornifyModule.hh"
 #include "seahorn/HornClauseDB.hh"
 
 #include "seahorn/Expr/Expr.hh"
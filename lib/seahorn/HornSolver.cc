@@ -5,6 +5,8 @@
 #include "seahorn/HornDbModel.hh"
 #include "seahorn/HornifyModule.hh"
 
+#include "seahorn/Support/QueryStats.hh"
+#include "seahorn/Support/SeaLog.hh"
 #include "seahorn/Support/Stats.hh"
 #include "llvm/IR/Function.h"
 #include "llvm/Support/CommandLine.h"
@@ -41,6 +43,13 @@ static llvm::cl::opt<bool> EstimateSizeInvars(
     cl::desc("Give an estimation about the size of all inferred invariants"),
     cl::init(false));
 
+static llvm::cl::opt<bool> HornCoi(
+    "horn-coi",
+    cl::desc("Reduce the CHCs to the cone of influence of the query before "
+             "solving. Ignored when a counterexample (--horn-cex-pass) is "
+             "requested, since it must refer to the original CHCs"),
+    cl::init(false));
+
 static llvm::cl::opt<bool>
     SkipConstraints("horn-skip-constraints", cl::Hidden, cl::init(false),
                     cl::desc("Enabled when number of predicates exceeds 200"));
@@ -133,7 +142,7 @@ bool HornSolver::runOnModule(Module &M) {
   if (InterProcMemFmaps) { // rewrite finite maps
     removeFiniteMapsHornClausesTransf(origdb, tdb);
   }
-  auto &db = InterProcMemFmaps ? tdb : origdb;
+  auto &fdb = InterProcMemFmaps ? tdb : origdb;
 
   if (LocalContext) {
     m_local_ctx.reset(new EZ3(hm.getExprFactory()));
@@ -143,6 +152,18 @@ bool HornSolver::runOnModule(Module &M) {
   }
   ZFixedPoint<EZ3> &fp = *m_fp;
 
+  // -- HornCex maps the rules of the cex to basic blocks of the program.
+  // -- Rules of the reduced CHCs use new relations and skip inlined ones
+  bool coi = HornCoi && !m_cex;
+  if (HornCoi && m_cex)
+    WARN << "horn-coi is ignored when a counterexample is requested";
+
+  HornClauseDB cdb(origdb.getExprFactory());
+  CoiHornModelConverter coiConverter(fp.getContext());
+  if (coi)
+    coiHornClauseDBTransf(fdb, cdb, coiConverter);
+  auto &db = coi ? cdb : fdb;
+
   ZParams<EZ3> params(fp.getContext());
   params.set(":engine", ChcEngine);
   // -- disable slicing so that we can use cover
@@ -181,6 +202,7 @@ bool HornSolver::runOnModule(Module &M) {
   }
 
   Stats::resume("Horn");
+  ScopedQueryOrigin origin(std::string("horn-solver"));
   m_result = fp.query();
   Stats::stop("Horn");
 
@@ -202,11 +224,18 @@ bool HornSolver::runOnModule(Module &M) {
   if (PrintAnswer && !m_result) {
     HornDbModel dbModel;
     initDBModelFromFP(dbModel, db, fp);
-    printInvars(M, dbModel);
+    if (coi) {
+      HornDbModel origModel;
+      coiConverter.convert(dbModel, origModel);
+      printInvars(M, origModel);
+    } else
+      printInvars(M, dbModel);
   } else if (PrintAnswer && m_result)
     printCex();
 
-  if (EstimateSizeInvars)
+  if (EstimateSizeInvars && coi)
+    WARN << "horn-estimate-size-invars is ignored with horn-coi";
+  else if (EstimateSizeInvars)
     estimateSizeInvars(M);
 
   return false;
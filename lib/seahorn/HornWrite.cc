@@ -41,6 +41,13 @@ void setInfo(Out &out, Key &key, Value &val) {
       << ")\n";
 }
 
+template <typename Out> void writeHeader(Out &out, Module &M) {
+  setInfo(out, "original", M.getModuleIdentifier());
+  std::string version("SeaHorn v.");
+  version += SEAHORN_VERSION_INFO;
+  setInfo(out, "authors", version);
+}
+
 bool HornWrite::runOnModule(Module &M) {
   ScopedStats _st_("HornWrite");
   HornifyModule &hm = getAnalysis<HornifyModule>();
@@ -62,6 +69,11 @@ bool HornWrite::runOnModule(Module &M) {
     // -- create writer
     McMtWriter<llvm::raw_fd_ostream> writer(db, hm.getZContext());
     writer.write(m_out);
+  } else if (HornClauseFormat == PURESMT2 && InternalWriter &&
+             db.isSmtLibWritable()) {
+    // -- stream the clauses directly, without building a Z3 fixedpoint
+    writeHeader(m_out, M);
+    db.writeSmtLib(m_out);
   } else {
     // Use local ZFixedPoint object to translate to SMT2.
     //
@@ -80,11 +92,7 @@ bool HornWrite::runOnModule(Module &M) {
       fp.set(params);
     }
 
-    // -- write header
-    setInfo(m_out, "original", M.getModuleIdentifier());
-    std::string version("SeaHorn v.");
-    version += SEAHORN_VERSION_INFO;
-    setInfo(m_out, "authors", version);
+    writeHeader(m_out, M);
 
     if (HornClauseFormat == PURESMT2 || !InternalWriter)
       m_out << fp.toString() << "\n";
@@ -28,6 +28,7 @@
 #include "seahorn/Analysis/CanFail.hh"
 #include "seahorn/Analysis/CutPointGraph.hh"
 #include "seahorn/Expr/Smt/EZ3.hh"
+#include "seahorn/Expr/Smt/SmtLibParser.hh"
 #include "seahorn/Support/Stats.hh"
 
 #include "seahorn/FlatHornifyFunction.hh"
@@ -98,6 +99,12 @@ static llvm::cl::opt<bool> NoVerification(
         "Generate only SMT2 encoding (i.e. even if there are no assertions)"),
     cl::init(false));
 
+static llvm::cl::opt<std::string> LoadSmtLib(
+    "horn-load-smt2",
+    llvm::cl::desc("Load Horn clauses from an SMT-LIB2 file instead of "
+                   "encoding the program"),
+    llvm::cl::init(""), llvm::cl::Hidden);
+
 static llvm::cl::list<std::string>
     AbstractFunctions("horn-abstract",
                       llvm::cl::desc("Abstract all calls to these functions"),
@@ -206,6 +213,17 @@ bool HornifyModule::runOnModule(Module &M) {
     m_sem.reset(new UfoOpSem(m_efac, *this, M.getDataLayout(), TL, abs_fns));
   }
 
+  if (!LoadSmtLib.empty()) {
+    SmtLibParser parser(m_efac);
+    if (!parser.parseFile(LoadSmtLib)) {
+      ERR << LoadSmtLib << ": " << parser.getError();
+      std::exit(1);
+    }
+    if (!m_db.loadSmtLib(parser))
+      std::exit(1);
+    return Changed;
+  }
+
   Function *main = M.getFunction("main");
   if (!main) { // if not main found then program trivially safe
     errs()
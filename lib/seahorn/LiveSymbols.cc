@@ -5,6 +5,8 @@
 #include "seahorn/Expr/ExprLlvm.hh"
 
 #include "seahorn/Support/SortTopo.hh"
+#include "seahorn/Support/Stats.hh"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/IR/CFG.h"
 
 namespace seahorn {
@@ -48,6 +50,7 @@ void LiveInfo::unionLive(ExprVector &v) {
 }
 
 void LiveSymbols::run() {
+  ScopedStats _st_("LiveSymbols");
   // -- compute def/use for each basic block
   localPass();
   // -- for all functions except main, add extra use of arguments
@@ -162,38 +165,90 @@ void LiveSymbols::localPass() {
 
 void LiveSymbols::globalPass() {
   // -- propagate live symbol information until nothing can be propagated
-  // -- based on local live symbol information computed by initialize()
-  bool dirty;
-  do {
-    dirty = false;
-    for (const BasicBlock *src : m_rtopo) {
-      unsigned idx = 0;
-      LiveInfo &srcLi = m_liveInfo[src];
-
-      for (const BasicBlock *dst :
-           boost::make_iterator_range(succ_begin(src), succ_end(src))) {
-        LiveInfo &dstLi = m_liveInfo[dst];
-
-        ExprVector live;
-        live.reserve(dstLi.live().size());
-
-        ExprVector live2;
-        live2.reserve(live.size());
+  // -- based on local live symbol information computed by localPass().
+  // -- Symbols are numbered densely in the order of Expr so that live
+  // -- sets are bit-vectors and set bits enumerate a sorted ExprVector
 
-        boost::set_difference(dstLi.live(), srcLi.edge_defs(idx++),
-                              std::back_inserter(live));
-        boost::set_difference(live, srcLi.defs(), std::back_inserter(live2));
-
-        live.clear();
-        boost::set_difference(live2, srcLi.live(), std::back_inserter(live));
+  // -- only symbols that are live somewhere can be propagated
+  ExprVector syms;
+  for (const BasicBlock *bb : m_rtopo) {
+    const ExprVector &l = m_liveInfo[bb].live();
+    syms.insert(syms.end(), l.begin(), l.end());
+  }
+  boost::sort(syms);
+  syms.erase(std::unique(syms.begin(), syms.end()), syms.end());
+
+  DenseMap<ENode *, unsigned> symIdx;
+  symIdx.reserve(syms.size());
+  for (unsigned i = 0, sz = syms.size(); i < sz; ++i)
+    symIdx[&*syms[i]] = i;
+
+  auto toBits = [&](const ExprVector &v) {
+    BitVector res(syms.size());
+    for (const Expr &e : v) {
+      auto it = symIdx.find(&*e);
+      if (it != symIdx.end())
+        res.set(it->second);
+    }
+    return res;
+  };
+
+  // -- m_rtopo is a post-order, so successors are mostly visited first
+  const unsigned numBlocks = m_rtopo.size();
+  DenseMap<const BasicBlock *, unsigned> blockIdx;
+  for (unsigned i = 0; i < numBlocks; ++i)
+    blockIdx[m_rtopo[i]] = i;
+
+  std::vector<BitVector> live(numBlocks), kill(numBlocks);
+  std::vector<SmallVector<BitVector, 2>> edgeKill(numBlocks);
+  for (unsigned i = 0; i < numBlocks; ++i) {
+    const BasicBlock *bb = m_rtopo[i];
+    LiveInfo &li = m_liveInfo[bb];
+    live[i] = toBits(li.live());
+    kill[i] = toBits(li.defs());
+    unsigned numSucc = succ_size(bb);
+    for (unsigned j = 0; j < numSucc; ++j)
+      edgeKill[i].push_back(toBits(li.edge_defs(j)));
+  }
 
-        if (!live.empty()) {
+  // -- worklist of blocks whose successors changed, swept in post-order
+  BitVector pending(numBlocks, true);
+  BitVector changed(numBlocks);
+  BitVector tmp;
+  while (pending.any()) {
+    for (int i = pending.find_first(); i >= 0; i = pending.find_next(i)) {
+      pending.reset(i);
+      unsigned idx = 0;
+      bool dirty = false;
+      for (const BasicBlock *dst : successors(m_rtopo[i])) {
+        tmp = live[blockIdx.lookup(dst)];
+        tmp.reset(edgeKill[i][idx++]);
+        tmp.reset(kill[i]);
+        tmp.reset(live[i]);
+        if (tmp.any()) {
+          live[i] |= tmp;
           dirty = true;
-          srcLi.addLive(live);
         }
       }
+      if (!dirty)
+        continue;
+      changed.set(i);
+      for (const BasicBlock *pred : predecessors(m_rtopo[i])) {
+        auto it = blockIdx.find(pred);
+        // -- unreachable predecessors are not analyzed
+        if (it != blockIdx.end())
+          pending.set(it->second);
+      }
     }
-  } while (dirty);
+  }
+
+  for (int i = changed.find_first(); i >= 0; i = changed.find_next(i)) {
+    ExprVector l;
+    l.reserve(live[i].count());
+    for (int s : live[i].set_bits())
+      l.push_back(syms[s]);
+    m_liveInfo[m_rtopo[i]].setLive(l);
+  }
 }
 
 void LiveSymbols::symExec(OpSemContext &ctx, const BasicBlock &bb) {
@@ -25,15 +25,41 @@ bool LoadCrabPass::runOnModule(llvm::Module &M) {
 #else
 /// Real implementation starts here
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Support/CommandLine.h"
 
+#include "seahorn/CrabInvariantCache.hh"
 #include "seahorn/Expr/ExprLlvm.hh"
 #include "seahorn/HornifyModule.hh"
 
 #include "seahorn/clam_CfgBuilder.hh"
 #include "seahorn/clam_Clam.hh"
+#include "clam/CrabDomainParser.hh"
+
+#include "seadsa/ShadowMem.hh"
 
 #include <unordered_map>
 
+namespace {
+clam::CrabDomain::Type HornCrabDom;
+}
+
+static llvm::cl::opt<clam::CrabDomain::Type, true, clam::CrabDomainParser>
+    XHornCrabDom(
+        "horn-crab-dom",
+        llvm::cl::desc("Crab abstract domain of the invariants loaded by "
+                       "--horn-crab with --crab-inv-cache"),
+        llvm::cl::values(
+            clEnumValN(clam::CrabDomain::INTERVALS, "int",
+                       "Classical interval domain"),
+            clEnumValN(clam::CrabDomain::ZONES_SPLIT_DBM, "zones",
+                       "Zones domain (default)"),
+            clEnumValN(clam::CrabDomain::OCT, "oct", "Octagon domain"),
+            clEnumValN(clam::CrabDomain::PK, "pk",
+                       "Convex Polyhedra and Linear Equalities domains")),
+        llvm::cl::location(HornCrabDom),
+        llvm::cl::init(clam::CrabDomain::ZONES_SPLIT_DBM));
+
 namespace clam {
 
 using namespace llvm;
@@ -473,6 +499,11 @@ Expr LinConsToExpr::toExpr(const lin_cst_t &cst,
 			   OperationalSemantics &sem, OpSemContext &semCtx,
 			   const DenseSet<const Value*> *live) {
   Expr e = m_impl->toExpr(cst, sem.getExprFactory(), live);
+  return toExpr(e, sem, semCtx);
+}
+
+Expr LinConsToExpr::toExpr(Expr e, OperationalSemantics &sem,
+			   OpSemContext &semCtx) {
   LinConToExprSem::BvWidthMap m;
   LinConToExprSem LCES(sem, semCtx, m);
   return dagVisit(LCES, e);
@@ -533,6 +564,19 @@ Expr LoadCrab::CrabInvToExpr(llvm::BasicBlock &B, const CfgBuilder *cfgBuilder,
 }
 
 
+/// Values of the live variables of BB in the Horn encoding
+static DenseSet<const Value *> liveValues(HornifyModule &hm,
+					  const BasicBlock &BB) {
+  DenseSet<const Value *> liveV;
+  for (auto e : hm.live(BB)) {
+    Expr u = bind::fname(bind::fname(e));
+    if (isOpX<VALUE>(u)) {
+      liveV.insert(getTerm<const Value *>(u));
+    }
+  }
+  return liveV;
+}
+
 bool LoadCrab::runOnModule(Module &M) {
   auto &db = m_hm.getHornClauseDB();
   auto const&cfgBuilderMan = m_clam.getCfgBuilderMan();
@@ -551,13 +595,7 @@ bool LoadCrab::runOnModule(Module &M) {
       
       
       const ExprVector &liveE = m_hm.live(BB);
-      DenseSet<const Value*> liveV;
-      for (auto e : liveE) {
-	Expr u = bind::fname(bind::fname(e));
-	if (isOpX<VALUE>(u)) {
-	  liveV.insert(getTerm<const Value *>(u));
-	}
-      }
+      DenseSet<const Value*> liveV = liveValues(m_hm, BB);
       
       Expr exp = CrabInvToExpr(BB, cfgBuilder, &liveV);
       Expr pred = m_hm.bbPredicate(BB);
@@ -571,8 +609,69 @@ bool LoadCrab::runOnModule(Module &M) {
   return false;
 }
 
+/// Keeps the conjuncts of inv that only refer to live values
+static Expr restrictToLive(Expr inv, const DenseSet<const Value *> &live) {
+  if (isOpX<FALSE>(inv))
+    return inv;
+  ExprVector conjs, kept;
+  CrabInvariantCache::conjuncts(inv, conjs);
+  for (Expr conj : conjs) {
+    ExprVector consts;
+    filter(conj, bind::IsConst(), std::back_inserter(consts));
+    bool isLive = llvm::all_of(consts, [&live](Expr c) {
+      Expr u = bind::fname(bind::fname(c));
+      return isOpX<VALUE>(u) && live.count(getTerm<const Value *>(u));
+    });
+    if (isLive)
+      kept.push_back(conj);
+  }
+  return kept.empty() ? mk<TRUE>(inv->efac()) : boolop::land(kept);
+}
+
+/// Loads the invariants of the invariant cache. Functions are analyzed
+/// intra-procedurally, and only if their invariants are not cached yet.
+static bool loadCachedInvariants(Module &M, HornifyModule &hm,
+				 seadsa::GlobalAnalysis &dsa,
+				 TargetLibraryInfoWrapperPass &tli) {
+  std::string context = computeCrabInvariants(M, dsa, tli, HornCrabDom);
+
+  auto &cache = CrabInvariantCache::get();
+  auto &db = hm.getHornClauseDB();
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    CrabInvariantCache::Entry entry;
+    CrabInvariantCache::BlockInvariants inv;
+    if (!cache.lookup(CrabInvariantCache::key(F, HornCrabDom.name(), context),
+		      entry) ||
+	!CrabInvariantCache::decode(F, entry, hm.getExprFactory(), inv)) {
+      continue;
+    }
+
+    for (auto &BB : F) {
+      auto it = inv.find(&BB);
+      if (it == inv.end() || !hm.hasBbPredicate(BB)) {
+	continue;
+      }
+      const ExprVector &liveE = hm.live(BB);
+      Expr exp = restrictToLive(it->second, liveValues(hm, BB));
+      Expr pred = hm.bbPredicate(BB);
+      LOG("crab", errs() << "Loading cached invariant "
+	  << *bind::fname(pred) << "  " << *exp << "\n";);
+      db.addInvariant(bind::fapp(pred, liveE), exp);
+    }
+  }
+  return false;
+}
+
 bool LoadCrabPass::runOnModule(Module &M) {
   HornifyModule &hm = getAnalysis<HornifyModule>();
+  if (CrabInvariantCache::isEnabled()) {
+    auto &sm = getAnalysis<seadsa::ShadowMemPass>().getShadowMem();
+    auto &tli = getAnalysis<TargetLibraryInfoWrapperPass>();
+    return loadCachedInvariants(M, hm, sm.getDsaAnalysis(), tli);
+  }
   ClamPass &clam = getAnalysis<ClamPass>();
   LoadCrab LC(clam.getClamGlobalAnalysis(), clam.getAnalysisParams(), hm);
   return LC.runOnModule(M);
@@ -581,7 +680,13 @@ bool LoadCrabPass::runOnModule(Module &M) {
 void LoadCrabPass::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.setPreservesAll();
   AU.addRequired<HornifyModule>();
-  AU.addRequired<ClamPass>();
+  if (CrabInvariantCache::isEnabled()) {
+    // -- invariants are computed per function, without ClamPass
+    AU.addRequired<seadsa::ShadowMemPass>();
+    AU.addRequired<TargetLibraryInfoWrapperPass>();
+  } else {
+    AU.addRequired<ClamPass>();
+  }
 }
 
 } // end namespace seahorn
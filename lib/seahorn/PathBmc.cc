@@ -15,20 +15,25 @@ seahorn::PathBmcTrace seahorn::PathBmcEngine::getTrace() {
 }
 /* End dummy implementation for PathBmcEngine if Clam is not available */
 #else
+#include "seahorn/Expr/ExprAig.hh"
 #include "seahorn/Expr/ExprLlvm.hh"
 #include "seahorn/Expr/ExprSimplifier.hh"
 #include "seahorn/Expr/Smt/Solver.hh"
 #ifdef WITH_YICES2
 #include "seahorn/Expr/Smt/Yices2SolverImpl.hh"
 #endif
+#include "seahorn/Expr/Smt/ForkedSolverImpl.hh"
 #include "seahorn/Expr/Smt/Model.hh"
+#include "seahorn/Expr/Smt/SatSolverImpl.hh"
 #include "seahorn/Expr/Smt/Z3SolverImpl.hh"
+#include "seahorn/CrabInvariantCache.hh"
 #include "seahorn/LoadCrab.hh"
 #include "seahorn/PathBmc.hh"
 #include "seahorn/PathBmcBoolAbs.hh"
 #include "seahorn/PathBmcMuc.hh"
 #include "seahorn/PathBmcUtil.hh"
 #include "seahorn/Support/CFG.hh"
+#include "seahorn/Support/QueryStats.hh"
 #include "seahorn/Support/SeaDebug.h"
 #include "seahorn/Support/Stats.hh"
 #include "seahorn/UfoOpSem.hh"
@@ -70,7 +75,9 @@ seahorn::PathBmcTrace seahorn::PathBmcEngine::getTrace() {
  * 3. Generate boolean abstraction (`addGlobalCrabInvariants`)
  * 4. For each model M (`solveBoolAbstraction`) of the boolean abstraction:
  *    4.1 Reconstruct program path from M
- *    4.2 Solve path with Crab (`solvePathWithCrab`):
+ *    4.2 Solve path with Crab (`solvePathWithCrab`), trying the
+ *        domains of --horn-bmc-crab-layers from cheapest to most
+ *        precise until one of them proves the path infeasible:
  *        4.2.1 If sat then goto 4.3
  *        4.2.2 Otherwise, compute (generalized) blocking path
  *              (`encodeBoolPathFromCrabCex`) to refine
@@ -99,10 +106,21 @@ bool UseCrabGlobalInvariants;
 bool UseCrabForSolvingPaths;
 clam::CrabDomain::Type CrabDom;
 bool LayeredCrabSolving;
+std::vector<clam::CrabDomain::Type> CrabLayers;
 path_bmc::MucMethodKind MucMethod;
 unsigned PathTimeout;
 unsigned MucTimeout;
 std::string SmtOutDir;
+unsigned MucThreads;
+unsigned MucBudget;
+bool IncPathSolving;
+bool MucCaching;
+unsigned MucCacheSize;
+bool NativeSatEnum;
+bool AigBoolAbs;
+bool ForkPathSolver;
+unsigned ForkCpuLimit;
+unsigned ForkMemLimit;
 } // namespace seahorn
 
 static llvm::cl::opt<seahorn::solver::SolverKind, true>
@@ -151,6 +169,31 @@ static llvm::cl::opt<bool, true> XLayeredCrabSolving(
                    "--horn-bmc-crab-dom to prove path unsatisfiability"),
     llvm::cl::location(seahorn::LayeredCrabSolving), llvm::cl::init(false));
 
+// It has only effect if UseCrabForSolvingPaths is enabled.
+static llvm::cl::list<clam::CrabDomain::Type,
+                      std::vector<clam::CrabDomain::Type>,
+                      clam::CrabDomainParser>
+    XCrabLayers(
+        "horn-bmc-crab-layers",
+        llvm::cl::desc("Abstract domains tried in order to prove path "
+                       "unsatisfiability, cheapest first (e.g., int,zones,pk). "
+                       "Overrides --horn-bmc-crab-dom"),
+        llvm::cl::values(
+            clEnumValN(clam::CrabDomain::INTERVALS, "int",
+                       "Classical interval domain"),
+            clEnumValN(clam::CrabDomain::ZONES_SPLIT_DBM, "zones",
+                       "Zones domain"),
+            clEnumValN(clam::CrabDomain::TERMS_INTERVALS, "term-int",
+                       "Intervals with uninterpreted functions"),
+            clEnumValN(clam::CrabDomain::TERMS_ZONES, "rtz",
+                       "Reduced product of term-dis-int and zones"),
+            clEnumValN(clam::CrabDomain::WRAPPED_INTERVALS, "w-int",
+                       "Wrapped interval domain"),
+            clEnumValN(clam::CrabDomain::OCT, "oct", "Octagon domain"),
+            clEnumValN(clam::CrabDomain::PK, "pk",
+                       "Convex Polyhedra and Linear Equalities domains")),
+        llvm::cl::CommaSeparated, llvm::cl::location(seahorn::CrabLayers));
+
 static llvm::cl::opt<enum seahorn::path_bmc::MucMethodKind, true> XMucMethod(
     "horn-bmc-muc",
     llvm::cl::desc(
@@ -162,7 +205,9 @@ static llvm::cl::opt<enum seahorn::path_bmc::MucMethodKind, true> XMucMethod(
         clEnumValN(seahorn::path_bmc::MucMethodKind::MUC_DELETION, "deletion",
                    "Deletion-based method"),
         clEnumValN(seahorn::path_bmc::MucMethodKind::MUC_BINARY_SEARCH,
-                   "quickXplain", "QuickXplain method")),
+                   "quickXplain", "QuickXplain method"),
+        clEnumValN(seahorn::path_bmc::MucMethodKind::MUC_PARALLEL, "parallel",
+                   "Parallel deletion-based method (only z3)")),
     llvm::cl::location(seahorn::MucMethod),
     llvm::cl::init(seahorn::path_bmc::MucMethodKind::MUC_ASSUMPTIONS));
 
@@ -178,6 +223,66 @@ static llvm::cl::opt<unsigned, true> XMucTimeout(
     llvm::cl::desc("Timeout (sec) for SMT query during MUC in path-bmc"),
     llvm::cl::location(seahorn::MucTimeout), llvm::cl::init(5u));
 
+static llvm::cl::opt<unsigned, true> XMucThreads(
+    "horn-bmc-muc-threads",
+    llvm::cl::desc("Number of threads used by --horn-bmc-muc=parallel "
+                   "(0 for one per hardware thread)"),
+    llvm::cl::location(seahorn::MucThreads), llvm::cl::init(0u));
+
+static llvm::cl::opt<unsigned, true> XMucBudget(
+    "horn-bmc-muc-budget",
+    llvm::cl::desc("Total time (sec) for --horn-bmc-muc=parallel. When it "
+                   "expires the best core so far is used (0 for no limit)"),
+    llvm::cl::location(seahorn::MucBudget), llvm::cl::init(0u));
+
+static llvm::cl::opt<bool, true> XIncPathSolving(
+    "horn-bmc-inc-path",
+    llvm::cl::desc("Solve path formulas incrementally by asserting only the "
+                   "suffix that differs from the previous path in path-bmc"),
+    llvm::cl::location(seahorn::IncPathSolving), llvm::cl::init(false));
+
+static llvm::cl::opt<bool, true> XMucCaching(
+    "horn-bmc-muc-cache",
+    llvm::cl::desc("Reuse unsat cores of previous paths in path-bmc"),
+    llvm::cl::location(seahorn::MucCaching), llvm::cl::init(false));
+
+static llvm::cl::opt<unsigned, true> XMucCacheSize(
+    "horn-bmc-muc-cache-size",
+    llvm::cl::desc("Maximum number of unsat cores cached in path-bmc. The "
+                   "least recently used core is evicted when it is full"),
+    llvm::cl::location(seahorn::MucCacheSize), llvm::cl::init(1000u));
+
+static llvm::cl::opt<bool, true> XNativeSatEnum(
+    "horn-bmc-native-sat",
+    llvm::cl::desc("Enumerate paths of the boolean abstraction with the "
+                   "built-in CDCL solver instead of the SMT solver"),
+    llvm::cl::location(seahorn::NativeSatEnum), llvm::cl::init(false));
+
+static llvm::cl::opt<bool, true> XAigBoolAbs(
+    "horn-bmc-aig",
+    llvm::cl::desc("Shrink the boolean abstraction in path-bmc with an AIG "
+                   "and SAT sweeping before enumerating paths"),
+    llvm::cl::location(seahorn::AigBoolAbs), llvm::cl::init(false));
+
+static llvm::cl::opt<bool, true> XForkPathSolver(
+    "horn-bmc-fork-solver",
+    llvm::cl::desc("Solve path formulas in a separate process so that a "
+                   "query that runs out of resources returns unknown"),
+    llvm::cl::location(seahorn::ForkPathSolver), llvm::cl::init(false));
+
+static llvm::cl::opt<unsigned, true> XForkCpuLimit(
+    "horn-bmc-fork-cpu",
+    llvm::cl::desc("CPU time limit (sec) of each query with "
+                   "--horn-bmc-fork-solver (0 for no limit)"),
+    llvm::cl::location(seahorn::ForkCpuLimit), llvm::cl::init(0u));
+
+static llvm::cl::opt<unsigned, true> XForkMemLimit(
+    "horn-bmc-fork-mem",
+    llvm::cl::desc("Memory limit (MB) of each query with "
+                   "--horn-bmc-fork-solver, on top of the memory already "
+                   "used by seahorn (0 for no limit)"),
+    llvm::cl::location(seahorn::ForkMemLimit), llvm::cl::init(0u));
+
 static llvm::cl::opt<std::string, true> XSmtOutDir(
     "horn-bmc-smt-outdir",
     llvm::cl::desc("Directory to dump path formulas in SMT-LIB format"),
@@ -219,6 +324,11 @@ void PathBmcEngine::initializeCrab() {
   m_mem_ssa = m_sm.getMemorySSA(*const_cast<Function *>(m_fn));
   assert(m_mem_ssa);
 
+  if (CrabInvariantCache::isEnabled())
+    m_crab_cache_ctx = crabCacheContext(M, cfg_builder_params,
+                                        params.is_context_sensitive,
+                                        /*interproc=*/false);
+
   // -- Create a CFG manager
   m_cfg_builder_man.reset(new clam::CrabBuilderManager(
       cfg_builder_params, m_tli, std::move(heap_abs)));
@@ -243,19 +353,25 @@ void PathBmcEngine::initializeCrab() {
 void PathBmcEngine::addWholeProgramCrabInvariants(
     expr_invariants_map_t &invariants) {
   if (UseCrabGlobalInvariants) {
-    LOG("bmc", get_os(true) << "Begin running crab analysis\n";);
-    Stats::resume("BMC path-based: whole-program crab analysis");
-    clam::IntraClam crab_analysis(*m_fn, *m_cfg_builder_man);
-
-    clam::AnalysisParams params;
-    params.dom = CrabDom;
-    crab_analysis.analyze(params);
-    Stats::stop("BMC path-based: whole-program crab analysis");
-    LOG("bmc", get_os(true) << "End running crab analysis\n";);
-
-    LOG("bmc", get_os(true) << "Begin loading of crab global invariants\n";);
-    Stats::resume("BMC path-based: loading of crab global invariants");
-    loadCrabInvariants(crab_analysis, invariants);
+    if (CrabInvariantCache::isEnabled()) {
+      LOG("bmc", get_os(true) << "Begin loading of cached crab invariants\n";);
+      Stats::resume("BMC path-based: loading of crab global invariants");
+      loadCachedCrabInvariants(invariants);
+    } else {
+      LOG("bmc", get_os(true) << "Begin running crab analysis\n";);
+      Stats::resume("BMC path-based: whole-program crab analysis");
+      clam::IntraClam crab_analysis(*m_fn, *m_cfg_builder_man);
+
+      clam::AnalysisParams params;
+      params.dom = CrabDom;
+      crab_analysis.analyze(params);
+      Stats::stop("BMC path-based: whole-program crab analysis");
+      LOG("bmc", get_os(true) << "End running crab analysis\n";);
+
+      LOG("bmc", get_os(true) << "Begin loading of crab global invariants\n";);
+      Stats::resume("BMC path-based: loading of crab global invariants");
+      loadCrabInvariants(crab_analysis, invariants);
+    }
     // Assumption: the program has been fully unrolled so there is
     // exactly two cutpoint nodes (entry and exit). We use the symbolic
     // store of the exit node.
@@ -344,6 +460,52 @@ void PathBmcEngine::loadCrabInvariants(
   }
 }
 
+/* Load clam invariants of m_fn into the out map through the cache */
+void PathBmcEngine::loadCachedCrabInvariants(
+    DenseMap<const BasicBlock *, ExprVector> &out) {
+  auto &cache = CrabInvariantCache::get();
+  std::string key =
+      CrabInvariantCache::key(*m_fn, CrabDom.name(), m_crab_cache_ctx);
+  auto cfgBuilder = m_cfg_builder_man->getCfgBuilder(*m_fn);
+  CrabInvariantCache::Entry entry;
+  if (!cache.lookup(key, entry)) {
+    Stats::resume("BMC path-based: whole-program crab analysis");
+    clam::IntraClam crab_analysis(*m_fn, *m_cfg_builder_man);
+    clam::AnalysisParams params;
+    params.dom = CrabDom;
+    crab_analysis.analyze(params);
+    entry = crabInvariantsToEntry(
+        *m_fn, cfgBuilder, CrabDom,
+        [&crab_analysis](const BasicBlock &bb) {
+          return crab_analysis.getPre(&bb);
+        });
+    cache.insert(key, entry);
+    Stats::stop("BMC path-based: whole-program crab analysis");
+  }
+
+  CrabInvariantCache::BlockInvariants inv;
+  if (!CrabInvariantCache::decode(*m_fn, entry, sem().getExprFactory(), inv))
+    return;
+
+  LinConsToExpr conv(cfgBuilder, *m_fn);
+  for (auto &kv : inv) {
+    ExprVector conjs, res;
+    CrabInvariantCache::conjuncts(kv.second, conjs);
+    for (Expr c : conjs) {
+      // -- from crab semantics to BMC semantics
+      Expr e = conv.toExpr(c, sem(), semCtx());
+      if (isOpX<FALSE>(e)) {
+        res.assign(1, e);
+        break;
+      } else if (!isOpX<TRUE>(e)) {
+        res.push_back(e);
+      }
+    }
+    if (!res.empty())
+      out.insert({kv.first, res});
+  }
+}
+
 /* Assert the invariants as formulas in m_precise_side */
 void PathBmcEngine::assertCrabInvariants(
     const expr_invariants_map_t &invariants, SymStore &s) {
@@ -828,9 +990,11 @@ bool PathBmcEngine::solvePathWithCrab(
 
   LOG("bmc-details-crab", errs() << "\n";);
 
-  // -- crab parameters
-  AnalysisParams params;
-  params.dom = CrabDom;
+  // -- abstract domains to try, cheapest first
+  std::vector<clam::CrabDomain::Type> layers(CrabLayers.begin(),
+                                             CrabLayers.end());
+  if (layers.empty())
+    layers.push_back(CrabDom);
 
   // -- run crab on the path:
   //    If bottom is inferred then cex_relevant_stmts is a minimal subset of
@@ -838,18 +1002,42 @@ bool PathBmcEngine::solvePathWithCrab(
   std::vector<clam::statement_t *> cex_relevant_stmts;
 
   LOG("bmc-crab", compute_sp = true;);
-  bool res;
-  if (compute_sp) {
-    res =
-        m_crab_path_solver->pathAnalyze(params, cex_blocks, LayeredCrabSolving,
-                                        cex_relevant_stmts, crab_postconditions);
+  bool res = true;
+  for (unsigned i = 0, sz = layers.size(); i < sz && res; ++i) {
+    // -- crab parameters
+    AnalysisParams params;
+    params.dom = layers[i];
+    // -- boolean reasoning does not depend on the domain, so only the
+    // -- first layer tries it
+    bool boolFirst = LayeredCrabSolving && i == 0;
+    std::string layer = "BMC path-based: crab layer " + layers[i].name();
+
+    cex_relevant_stmts.clear();
+    Stats::count(layer + " paths");
+    Stats::resume(layer);
+    // -- post-conditions are only needed from the most precise layer
+    if (compute_sp && i + 1 == sz) {
+      res = m_crab_path_solver->pathAnalyze(params, cex_blocks, boolFirst,
+                                            cex_relevant_stmts,
+                                            crab_postconditions);
+    } else {
+      res = m_crab_path_solver->pathAnalyze(params, cex_blocks, boolFirst,
+                                            cex_relevant_stmts);
+    }
+    Stats::stop(layer);
+    if (!res) {
+      Stats::count(layer + " refuted");
+      LOG("bmc-crab", errs() << "Path refuted by layer " << i << " ("
+                             << layers[i].name() << ")\n";);
+    }
+    Stats::uset(layer + " hit rate (%)", 100 * Stats::get(layer + " refuted") /
+                                             Stats::get(layer + " paths"));
+  }
+
+  if (compute_sp && res) {
     // conversion from crab to Expr
     extractPostConditionsFromCrabCex(cex_blocks, crab_postconditions,
 				     expr_postconditions);
-                                     
-  } else {
-    res = m_crab_path_solver->pathAnalyze(
-        params, cex_blocks, LayeredCrabSolving, cex_relevant_stmts);
   }
 
   if (res) {
@@ -942,6 +1130,38 @@ solver::SolverResult PathBmcEngine::solvePathWithSmt(
   //   toSmtLib(path_formula);
   // }
 
+  // -- boolean literals of the path
+  ExprVector path_lits;
+  path_lits.reserve(path_formula.size());
+  for (Expr e : path_formula) {
+    auto it = implicant_bools_map.find(e);
+    if (it != implicant_bools_map.end()) {
+      path_lits.push_back(it->second);
+    }
+  }
+
+  // -- Use an unsat core of a previous path if possible
+  if (MucCaching) {
+    ExprVector unsat_core;
+    Stats::resume("BMC path-based: MUC cache lookup");
+    bool hit = m_muc_cache.lookup(path_lits, path_formula, unsat_core);
+    Stats::stop("BMC path-based: MUC cache lookup");
+    if (hit) {
+      LOG("bmc", get_os() << "Path unsat by cached core of size "
+                          << unsat_core.size() << "\n";);
+      Stats::count("BMC number symbolic paths discharged by MUC cache");
+      ExprSet gen_path;
+      for (Expr e : unsat_core) {
+        auto it = implicant_bools_map.find(e);
+        if (it != implicant_bools_map.end()) {
+          gen_path.insert(it->second);
+        }
+      }
+      m_gen_path.assign(gen_path.begin(), gen_path.end());
+      return solver::SolverResult::UNSAT;
+    }
+  }
+
   /*****************************************************************
    * This check might be expensive if path_formula contains complex
    * bitvector/floating point expressions.
@@ -949,11 +1169,8 @@ solver::SolverResult PathBmcEngine::solvePathWithSmt(
    * here invariants to make only those decisions which are
    * consistent with the invariants.
    *****************************************************************/
-  m_smt_path_solver->reset();
   // TODO: add here postconditions to help
-  for (Expr e : path_formula) {
-    m_smt_path_solver->add(e);
-  }
+  assertPathFormula(path_formula);
 
   solver::SolverResult res;
   {
@@ -969,7 +1186,8 @@ solver::SolverResult PathBmcEngine::solvePathWithSmt(
     // Stats::resume ("BMC path-based: SMT unsat core");
     // --- Compute minimal unsat core of the path formula
     enum path_bmc::MucMethodKind muc_method = MucMethod;
-    if (res == solver::SolverResult::UNSAT) {
+    bool proved_unsat = (res == solver::SolverResult::UNSAT);
+    if (proved_unsat) {
       LOG("bmc", get_os() << "SMT proved unsat. Size of path formula="
                           << path_formula.size() << ". ");
     } else {
@@ -996,24 +1214,34 @@ solver::SolverResult PathBmcEngine::solvePathWithSmt(
       break;
     }
     case path_bmc::MucMethodKind::MUC_DELETION: {
-      path_bmc::MucDeletion muc(*m_smt_path_solver, MucTimeout);
+      path_bmc::MucDeletion muc(mucSolver(), MucTimeout);
       muc.run(path_formula, unsat_core);
       break;
     }
     case path_bmc::MucMethodKind::MUC_BINARY_SEARCH: {
-      path_bmc::MucBinarySearch muc(*m_smt_path_solver, MucTimeout);
+      path_bmc::MucBinarySearch muc(mucSolver(), MucTimeout);
+      muc.run(path_formula, unsat_core);
+      break;
+    }
+    case path_bmc::MucMethodKind::MUC_PARALLEL: {
+      path_bmc::MucParallel muc(mucSolver(), MucTimeout, MucThreads,
+                                MucBudget);
       muc.run(path_formula, unsat_core);
       break;
     }
     case path_bmc::MucMethodKind::MUC_ASSUMPTIONS:
     default: {
-      path_bmc::MucWithAssumptions muc(*m_smt_path_solver);
+      path_bmc::MucWithAssumptions muc(mucSolver());
       muc.run(path_formula, unsat_core);
       break;
     }
     }
     // Stats::stop ("BMC path-based: SMT unsat core");
 
+    if (MucCaching && proved_unsat) {
+      m_muc_cache.insert(path_lits, unsat_core);
+    }
+
     LOG("bmc", get_os() << "Size of unsat core=" << unsat_core.size() << "\n";);
 
     LOG(
@@ -1043,13 +1271,17 @@ PathBmcEngine::PathBmcEngine(OperationalSemantics &sem,
                              seadsa::ShadowMem &sm)
     : m_sem(sem), m_cpg(nullptr), m_fn(nullptr),
       m_ctxState(sem.efac()), m_boolean_solver(nullptr),
-      m_smt_path_solver(nullptr), m_model(nullptr), m_num_paths(0), m_tli(tli),
+      m_smt_path_solver(nullptr), m_muc_solver(nullptr),
+      m_muc_cache(MucCacheSize), m_model(nullptr), m_num_paths(0), m_tli(tli),
       m_sm(sm), m_mem_ssa(nullptr), m_cfg_builder_man(nullptr),
       m_crab_path_solver(nullptr) {
 
   if (SmtSolver == solver::SolverKind::Z3) {
     m_boolean_solver = std::make_unique<solver::z3_solver_impl>(sem.efac());
     m_smt_path_solver = std::make_unique<solver::z3_solver_impl>(sem.efac());
+    if (IncPathSolving) {
+      m_muc_solver = std::make_unique<solver::z3_solver_impl>(sem.efac());
+    }
     // Tuning m_aux_solver_solver's parameters
     // auto &s = static_cast<solver::z3_solver_impl&>(*m_smt_path_solver);
     // ZParams<EZ3> params(s.get_context());
@@ -1063,12 +1295,36 @@ PathBmcEngine::PathBmcEngine(OperationalSemantics &sem,
 #ifdef WITH_YICES2
     m_boolean_solver = std::make_unique<solver::yices_solver_impl>(sem.efac());
     m_smt_path_solver = std::make_unique<solver::yices_solver_impl>(sem.efac());
+    if (IncPathSolving) {
+      m_muc_solver = std::make_unique<solver::yices_solver_impl>(sem.efac());
+    }
 #else
     assertion_failed("Compile with YICES2_HOME option", __FILE__, __LINE__);
 #endif
   } else {
     assertion_failed("Unsupported smt solver", __FILE__, __LINE__);
   }
+
+  if (ForkPathSolver) {
+    solver::fork_limits limits;
+    limits.cpu = ForkCpuLimit;
+    limits.mem = ForkMemLimit;
+    m_smt_path_solver =
+        std::make_unique<solver::forked_solver_impl>(sem.efac(), limits);
+    if (IncPathSolving) {
+      m_muc_solver =
+          std::make_unique<solver::forked_solver_impl>(sem.efac(), limits);
+    }
+  }
+
+  if (!SmtOutDir.empty()) {
+    QueryStats::setDefaultDumpDir(SmtOutDir);
+  }
+
+  // The boolean abstraction is purely propositional
+  if (NativeSatEnum) {
+    m_boolean_solver = std::make_unique<solver::sat_solver_impl>(sem.efac());
+  }
 }
 
 PathBmcEngine::~PathBmcEngine() {}
@@ -1123,26 +1379,76 @@ void PathBmcEngine::toSmtLib(const ExprVector &f, std::string prefix) {
   }
 
   // dump the formula to the file descriptor
-  m_smt_path_solver->reset();
+  resetPathSolver();
   for (Expr e : f) {
     m_smt_path_solver->add(e);
   }
   m_smt_path_solver->to_smt_lib(fd);
-  m_smt_path_solver->reset();
+  resetPathSolver();
 }
 
 raw_ostream &PathBmcEngine::toSmtLib(raw_ostream &o) {
   encode();
 
-  m_smt_path_solver->reset();
+  resetPathSolver();
   for (Expr e : m_precise_side) {
     m_smt_path_solver->add(e);
   }
   m_smt_path_solver->to_smt_lib(o);
-  m_smt_path_solver->reset();
+  resetPathSolver();
   return o;
 }
 
+void PathBmcEngine::resetPathSolver() {
+  m_smt_path_solver->reset();
+  m_path_stack.clear();
+}
+
+solver::Solver &PathBmcEngine::mucSolver() {
+  // -- keep the incremental state of m_smt_path_solver
+  if (m_muc_solver) {
+    return *m_muc_solver;
+  }
+  m_path_stack.clear();
+  return *m_smt_path_solver;
+}
+
+void PathBmcEngine::assertPathFormula(const ExprVector &path_formula) {
+  if (!IncPathSolving) {
+    resetPathSolver();
+    for (Expr e : path_formula) {
+      m_smt_path_solver->add(e);
+    }
+    return;
+  }
+
+  Stats::resume("BMC path-based: incremental path assertion");
+  // -- length of the prefix shared with the previous path formula.
+  // -- Formulas follow the order of the precise encoding so
+  // -- consecutive paths usually share long prefixes.
+  unsigned prefix = 0;
+  unsigned sz = std::min(m_path_stack.size(), path_formula.size());
+  while (prefix < sz && m_path_stack[prefix] == path_formula[prefix]) {
+    ++prefix;
+  }
+  LOG("bmc-details", errs() << "Reusing " << prefix << " out of "
+                            << path_formula.size()
+                            << " formulas from previous path\n";);
+
+  // -- retract the suffix of the previous path formula
+  while (m_path_stack.size() > prefix) {
+    m_smt_path_solver->pop();
+    m_path_stack.pop_back();
+  }
+  // -- assert the suffix of the new path formula
+  for (unsigned i = prefix, e = path_formula.size(); i < e; ++i) {
+    m_smt_path_solver->push();
+    m_smt_path_solver->add(path_formula[i]);
+    m_path_stack.push_back(path_formula[i]);
+  }
+  Stats::stop("BMC path-based: incremental path assertion");
+}
+
 void PathBmcEngine::encode() {
   Stats::resume("BMC path-based: precise encoding");
 
@@ -1207,6 +1513,15 @@ solver::SolverResult PathBmcEngine::solve() {
   Stats::resume("BMC path-based: initial boolean abstraction");
   ExprVector abs_side;
   path_bmc::boolAbstraction(m_precise_side, abs_side);
+  if (AigBoolAbs && !abs_side.empty()) {
+    Stats::resume("BMC path-based: aig boolean abstraction");
+    Stats::uset("BMC path-based: aig size before",
+                op::boolop::aigSize(op::boolop::land(abs_side)));
+    op::boolop::fraig(abs_side);
+    Stats::uset("BMC path-based: aig size after",
+                op::boolop::aigSize(op::boolop::land(abs_side)));
+    Stats::stop("BMC path-based: aig boolean abstraction");
+  }
   // XXX: we use m_boolean_solver for keeping the abstraction.
   for (Expr v : abs_side) {
     LOG("bmc-details", errs() << "\t" << *v << "\n";);
@@ -1231,6 +1546,9 @@ solver::SolverResult PathBmcEngine::solve() {
       break;
     }
     ++m_num_paths;
+    ScopedQueryOrigin origin([this](llvm::raw_ostream &o) {
+      o << "path-bmc: " << m_fn->getName() << " path " << m_num_paths;
+    });
     Stats::count("BMC total number of symbolic paths");
 
     LOG("bmc", get_os(true) << m_num_paths << ": ");
@@ -1326,7 +1644,7 @@ solver::SolverResult PathBmcEngine::solve() {
       auto kv = m_unsolved_path_formulas.front();
       m_unsolved_path_formulas.pop();
 
-      m_smt_path_solver->reset();
+      resetPathSolver();
       for (Expr e : kv.second) {
         m_smt_path_solver->add(e);
       }
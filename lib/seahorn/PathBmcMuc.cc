@@ -3,6 +3,19 @@
 
 #include "seahorn/Expr/ExprLlvm.hh"
 #include "seahorn/Expr/Smt/Solver.hh"
+#include "seahorn/Expr/Smt/Z3SolverImpl.hh"
+#include "seahorn/Support/Stats.hh"
+#include "seahorn/boost_flat_set.hh"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
 
 namespace seahorn {
 namespace path_bmc {
@@ -201,5 +214,306 @@ void MucBinarySearch::run(const ExprVector &formula, ExprVector &out) {
   qx(formula, i, j, skip, out);
 }
 
+namespace {
+using deadline_t = std::chrono::steady_clock::time_point;
+
+/// A clone of the path solver used by MucParallel. Each worker owns its
+/// Z3 context so workers can run concurrently. Only raw Z3 terms are
+/// accessed while running in a thread.
+struct MucWorker {
+  std::unique_ptr<solver::z3_solver_impl> m_solver;
+  std::unique_ptr<path_bmc::scopedSolver> m_timeout;
+  // -- marshaled assumption literals, one per formula
+  std::unique_ptr<z3::ast_vector> m_lits;
+  std::vector<Z3_ast> m_raw_lits;
+  std::unordered_map<Z3_ast, unsigned> m_lit_idx;
+
+  // -- results of the last round
+  std::vector<unsigned> m_necessary;
+  std::vector<unsigned> m_unknown;
+  std::vector<unsigned> m_core;
+
+  MucWorker(ExprFactory &efac, const ExprVector &f, const ExprVector &lits,
+            unsigned timeout)
+      : m_solver(new solver::z3_solver_impl(efac)) {
+    for (unsigned i = 0, sz = f.size(); i < sz; ++i) {
+      m_solver->add(mk<IMPL>(lits[i], f[i]));
+    }
+    m_lits.reset(
+        new z3::ast_vector(m_solver->get_solver().toAstVector(lits)));
+    for (unsigned i = 0, sz = m_lits->size(); i < sz; ++i) {
+      Z3_ast a = (*m_lits)[i];
+      m_raw_lits.push_back(a);
+      m_lit_idx[a] = i;
+    }
+    m_timeout.reset(new path_bmc::scopedSolver(*m_solver, timeout));
+  }
+
+  /// Check the conjunction of the formulas in core. On unsat, the
+  /// indexes of the unsat core are stored in out.
+  boost::tribool check(const std::vector<unsigned> &core,
+                       std::vector<unsigned> &out) {
+    std::vector<Z3_ast> assumptions;
+    assumptions.reserve(core.size());
+    for (unsigned i : core) {
+      assumptions.push_back(m_raw_lits[i]);
+    }
+    boost::tribool res = m_solver->get_solver().solveAssumingAst(assumptions);
+    if (!res) {
+      std::vector<Z3_ast> zcore;
+      m_solver->get_solver().unsatCoreAst(zcore);
+      for (Z3_ast a : zcore) {
+        auto it = m_lit_idx.find(a);
+        if (it != m_lit_idx.end()) {
+          out.push_back(it->second);
+        }
+      }
+      std::sort(out.begin(), out.end());
+    }
+    return res;
+  }
+
+  /// Try to remove each candidate of chunk from core. Stop after the
+  /// first removal that keeps core unsatisfiable.
+  void run(const std::vector<unsigned> &core, llvm::ArrayRef<unsigned> chunk,
+           deadline_t deadline) {
+    m_necessary.clear();
+    m_unknown.clear();
+    m_core.clear();
+    std::vector<unsigned> reduced;
+    reduced.reserve(core.size());
+    for (unsigned c : chunk) {
+      if (std::chrono::steady_clock::now() >= deadline) {
+        return;
+      }
+      reduced.clear();
+      for (unsigned i : core) {
+        if (i != c) {
+          reduced.push_back(i);
+        }
+      }
+      std::vector<unsigned> ucore;
+      boost::tribool res = check(reduced, ucore);
+      if (res) {
+        m_necessary.push_back(c);
+      } else if (!res) {
+        m_core = std::move(ucore);
+        return;
+      } else {
+        m_unknown.push_back(c);
+      }
+    }
+  }
+};
+} // namespace
+
+MucParallel::MucParallel(solver::Solver &solver, unsigned timeout,
+                         unsigned threads, unsigned budget)
+    : minimalUnsatCore(solver), m_timeout(timeout), m_threads(threads),
+      m_budget(budget) {}
+
+void MucParallel::run(const ExprVector &f, ExprVector &out) {
+  if (m_solver.get_kind() != solver::SolverKind::Z3) {
+    MucDeletion muc(m_solver, m_timeout);
+    muc.run(f, out);
+    return;
+  }
+  if (f.size() <= 1) {
+    out.insert(out.end(), f.begin(), f.end());
+    return;
+  }
+
+  deadline_t deadline = deadline_t::max();
+  if (m_budget > 0) {
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(m_budget);
+  }
+
+  unsigned num_threads = m_threads;
+  if (num_threads == 0) {
+    num_threads = llvm::hardware_concurrency().compute_thread_count();
+  }
+  num_threads = std::max(1u, std::min<unsigned>(num_threads, f.size()));
+
+  // -- marshal everything before any thread starts: ExprFactory is not
+  // -- thread-safe
+  ExprFactory &efac = f[0]->efac();
+  ExprVector lits;
+  lits.reserve(f.size());
+  for (Expr v : f) {
+    lits.push_back(bind::boolConst(mk<ASM>(v)));
+  }
+  std::vector<std::unique_ptr<MucWorker>> workers;
+  for (unsigned k = 0; k < num_threads; ++k) {
+    workers.emplace_back(new MucWorker(efac, f, lits, m_timeout));
+  }
+
+  enum class Status { CANDIDATE, NECESSARY, UNKNOWN };
+  std::vector<Status> status(f.size(), Status::CANDIDATE);
+  std::vector<unsigned> core(f.size());
+  for (unsigned i = 0, sz = f.size(); i < sz; ++i) {
+    core[i] = i;
+  }
+
+  // -- start from the unsat core returned by the solver
+  {
+    std::vector<unsigned> ucore;
+    boost::tribool res = workers[0]->check(core, ucore);
+    if (res) {
+      // -- f is satisfiable. Nothing to minimize.
+      out.insert(out.end(), f.begin(), f.end());
+      return;
+    } else if (!res) {
+      core = std::move(ucore);
+    }
+  }
+
+  llvm::ThreadPool pool(llvm::hardware_concurrency(num_threads));
+  std::vector<unsigned> candidates;
+  while (true) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      Stats::count("BMC path-based: parallel MUC out of budget");
+      break;
+    }
+
+    candidates.clear();
+    for (unsigned i : core) {
+      if (status[i] == Status::CANDIDATE) {
+        candidates.push_back(i);
+      }
+    }
+    if (candidates.empty()) {
+      break;
+    }
+
+    // -- test disjoint chunks of candidates concurrently
+    llvm::ArrayRef<unsigned> todo(candidates);
+    // -- chunk_sz is fixed first: with 5 candidates and 4 threads, that is
+    // -- 3 chunks of at most 2 candidates, and every chunk is non-empty
+    unsigned chunk_sz = (todo.size() + num_threads - 1) / num_threads;
+    unsigned num_chunks = (todo.size() + chunk_sz - 1) / chunk_sz;
+    for (unsigned k = 0; k < num_chunks; ++k) {
+      size_t begin = k * chunk_sz;
+      assert(begin < todo.size());
+      llvm::ArrayRef<unsigned> chunk =
+          todo.slice(begin, std::min<size_t>(chunk_sz, todo.size() - begin));
+      MucWorker *w = workers[k].get();
+      pool.async([w, &core, chunk, deadline]() { w->run(core, chunk, deadline); });
+    }
+    pool.wait();
+
+    // -- combine the results of all workers
+    const std::vector<unsigned> *best = nullptr;
+    for (unsigned k = 0; k < num_chunks; ++k) {
+      MucWorker &w = *workers[k];
+      for (unsigned i : w.m_necessary) {
+        status[i] = Status::NECESSARY;
+      }
+      for (unsigned i : w.m_unknown) {
+        status[i] = Status::UNKNOWN;
+      }
+      if (!w.m_core.empty() && (!best || w.m_core.size() < best->size())) {
+        best = &w.m_core;
+      }
+    }
+    if (best) {
+      core = *best;
+    }
+  }
+
+  for (unsigned i : core) {
+    out.push_back(f[i]);
+  }
+}
+
+static ExprVector sortedSet(const ExprVector &v) {
+  ExprVector res(v.begin(), v.end());
+  std::sort(res.begin(), res.end());
+  res.erase(std::unique(res.begin(), res.end()), res.end());
+  return res;
+}
+
+size_t MucCache::hashLits(const ExprVector &lits) {
+  size_t seed = 0;
+  for (Expr e : lits) {
+    boost::hash_combine(seed, e.get());
+  }
+  return seed;
+}
+
+bool MucCache::lookup(const ExprVector &lits, const ExprVector &path,
+                      ExprVector &out) {
+  ExprVector key = sortedSet(lits);
+  auto range = m_by_lits.equal_range(hashLits(key));
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second->lits == key) {
+      touch(it->second);
+      out.assign(it->second->core.begin(), it->second->core.end());
+      return true;
+    }
+  }
+
+  // -- look for a cached core that is contained in path. Such a core is
+  // -- indexed by one of the expressions of path
+  boost::container::flat_set<Expr> pathSet(path.begin(), path.end());
+  for (Expr e : pathSet) {
+    auto cores = m_by_core.equal_range(e);
+    for (auto it = cores.first; it != cores.second; ++it) {
+      const ExprVector &core = it->second->core;
+      if (core.size() > pathSet.size())
+        continue;
+      if (std::all_of(core.begin(), core.end(),
+                      [&pathSet](Expr c) { return pathSet.count(c) > 0; })) {
+        touch(it->second);
+        out.assign(core.begin(), core.end());
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void MucCache::evict() {
+  entry_it victim = std::prev(m_entries.end());
+
+  auto lits = m_by_lits.equal_range(hashLits(victim->lits));
+  for (auto it = lits.first; it != lits.second; ++it) {
+    if (it->second == victim) {
+      m_by_lits.erase(it);
+      break;
+    }
+  }
+  auto cores = m_by_core.equal_range(victim->core.front());
+  for (auto it = cores.first; it != cores.second; ++it) {
+    if (it->second == victim) {
+      m_by_core.erase(it);
+      break;
+    }
+  }
+  m_entries.erase(victim);
+}
+
+void MucCache::insert(const ExprVector &lits, const ExprVector &core) {
+  if (m_max_size == 0 || core.empty())
+    return;
+
+  ExprVector key = sortedSet(lits);
+  size_t h = hashLits(key);
+  auto range = m_by_lits.equal_range(h);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second->lits == key) {
+      touch(it->second);
+      return;
+    }
+  }
+
+  if (m_entries.size() >= m_max_size)
+    evict();
+
+  m_entries.push_front(Entry{std::move(key), sortedSet(core)});
+  entry_it it = m_entries.begin();
+  m_by_lits.insert({h, it});
+  m_by_core.insert({it->core.front(), it});
+}
+
 } // namespace path_bmc
 } // namespace seahorn
@@ -1,5 +1,6 @@
 #include "seahorn/PathBmcUtil.hh"
 
+#include "seahorn/Expr/Smt/ForkedSolverImpl.hh"
 #include "seahorn/Expr/Smt/Solver.hh"
 #ifdef WITH_YICES2
 #include "seahorn/Expr/Smt/Yices2SolverImpl.hh"
@@ -10,7 +11,7 @@ namespace seahorn {
 namespace path_bmc {
 
 scopedSolver::scopedSolver(solver::Solver &solver, unsigned timeout /*sec*/)
-    : m_solver(solver) {
+    : m_solver(solver), m_old_timeout(0) {
   if (m_solver.get_kind() == solver::SolverKind::Z3) {
     solver::z3_solver_impl &z3 =
         static_cast<solver::z3_solver_impl &>(m_solver);
@@ -19,6 +20,13 @@ scopedSolver::scopedSolver(solver::Solver &solver, unsigned timeout /*sec*/)
     // given, e.g., in miliseconds.
     params.set(":timeout", timeout * 1000);
     z3.get_solver().set(params);
+  } else if (m_solver.get_kind() == solver::SolverKind::FORKED) {
+    solver::forked_solver_impl &forked =
+        static_cast<solver::forked_solver_impl &>(m_solver);
+    solver::fork_limits limits = forked.limits();
+    m_old_timeout = limits.wall;
+    limits.wall = timeout;
+    forked.set_limits(limits);
   } else {
 #ifdef WITH_YICES2
     // TODOX: add timeout capabilities to Yices2
@@ -33,6 +41,12 @@ scopedSolver::~scopedSolver() {
     ZParams<EZ3> params(z3.get_context());
     params.set(":timeout", 4294967295u); // disable timeout
     z3.get_solver().set(params);
+  } else if (m_solver.get_kind() == solver::SolverKind::FORKED) {
+    solver::forked_solver_impl &forked =
+        static_cast<solver::forked_solver_impl &>(m_solver);
+    solver::fork_limits limits = forked.limits();
+    limits.wall = m_old_timeout;
+    forked.set_limits(limits);
   }
 }
 
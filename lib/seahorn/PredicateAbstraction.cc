@@ -296,9 +296,14 @@ namespace seahorn
         int index = 0;
         //for converter
         ExprMap boolToTermMap;
-        for(Expr term : m_currentCandidates.find(bind::fname(*it))->second)
+        const ExprVector &terms = m_currentCandidates.find(bind::fname(*it))->second;
+        // -- the same map for every candidate of the predicate
+        ExprMap bvar_map;
+        if(!terms.empty())
+          bvar_map = getBvarsToArgsMap(*it, m_currentCandidates);
+        for(Expr term : terms)
         {
-          Expr term_app = applyArgsToBvars(term, *it, m_currentCandidates);
+          Expr term_app = applyArgsToBvars(term, bvar_map);
           Expr equal_expr = mk<IFF>(new_rule_body_pred->arg(index + 1), term_app);
           //converter
           boolToTermMap.insert(std::make_pair(bind::bvar(index, mk<BOOL_TY>(term_app->efac())), term));
@@ -336,9 +341,13 @@ namespace seahorn
         int index = 0;
         //for converter
         ExprMap boolToTermMap;
-        for(Expr term : m_currentCandidates.find(bind::fname(rule_head))->second)
+        const ExprVector &terms = m_currentCandidates.find(bind::fname(rule_head))->second;
+        ExprMap bvar_map;
+        if(!terms.empty())
+          bvar_map = getBvarsToArgsMap(rule_head, m_currentCandidates);
+        for(Expr term : terms)
         {
-          Expr term_app = applyArgsToBvars(term, rule_head, m_currentCandidates);
+          Expr term_app = applyArgsToBvars(term, bvar_map);
           Expr equal_expr = mk<IFF>(new_rule_head->arg(index + 1), term_app);
           //converter
           boolToTermMap.insert(std::make_pair(bind::bvar(index, mk<BOOL_TY>(term_app->efac())), term));
@@ -388,20 +397,29 @@ namespace seahorn
     }
   }
 
-  Expr PredicateAbstractionAnalysis::applyArgsToBvars(Expr cand, Expr fapp, std::map<Expr, ExprVector> currentCandidates)
+  Expr PredicateAbstractionAnalysis::applyArgsToBvars(Expr cand, Expr fapp, const std::map<Expr, ExprVector> &currentCandidates)
   {
     ExprMap bvar_map = getBvarsToArgsMap(fapp, currentCandidates);
-    return replace(cand, bvar_map);
+    return applyArgsToBvars(cand, bvar_map);
   }
 
-  ExprMap PredicateAbstractionAnalysis::getBvarsToArgsMap(Expr fapp, std::map<Expr, ExprVector> currentCandidates)
+  Expr PredicateAbstractionAnalysis::applyArgsToBvars(Expr cand, const ExprMap &bvarMap)
+  {
+    // -- the keys are bound variables, sub-terms without them are skipped
+    return m_fvIdx.replace(cand, bvarMap);
+  }
+
+  ExprMap PredicateAbstractionAnalysis::getBvarsToArgsMap(Expr fapp, const std::map<Expr, ExprVector> &currentCandidates)
   {
     Expr fdecl = bind::fname(fapp);
-    ExprVector terms = currentCandidates[fdecl];
+    static const ExprVector noTerms;
+    auto termsIt = currentCandidates.find(fdecl);
+    const ExprVector &terms =
+        termsIt != currentCandidates.end() ? termsIt->second : noTerms;
     Expr cand;
     if(terms.size() == 1)
     {
-      cand = currentCandidates[fdecl][0];
+      cand = terms[0];
     }
     else if(terms.size() > 1)
     {
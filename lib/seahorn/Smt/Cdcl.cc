@@ -0,0 +1,485 @@
+#include "Cdcl.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace seahorn {
+namespace solver {
+namespace sat {
+
+const Cdcl::CRef Cdcl::NO_REASON;
+
+/** VarOrder **/
+
+void Cdcl::VarOrder::up(unsigned i) {
+  Var v = m_heap[i];
+  while (i > 0) {
+    unsigned parent = (i - 1) >> 1;
+    if (!lt(v, m_heap[parent]))
+      break;
+    m_heap[i] = m_heap[parent];
+    m_pos[m_heap[i]] = i;
+    i = parent;
+  }
+  m_heap[i] = v;
+  m_pos[v] = i;
+}
+
+void Cdcl::VarOrder::down(unsigned i) {
+  Var v = m_heap[i];
+  unsigned sz = m_heap.size();
+  while (2 * i + 1 < sz) {
+    unsigned child = 2 * i + 1;
+    if (child + 1 < sz && lt(m_heap[child + 1], m_heap[child]))
+      ++child;
+    if (!lt(m_heap[child], v))
+      break;
+    m_heap[i] = m_heap[child];
+    m_pos[m_heap[i]] = i;
+    i = child;
+  }
+  m_heap[i] = v;
+  m_pos[v] = i;
+}
+
+void Cdcl::VarOrder::insert(Var v) {
+  if (v >= (Var)m_pos.size())
+    m_pos.resize(v + 1, -1);
+  if (contains(v))
+    return;
+  m_pos[v] = m_heap.size();
+  m_heap.push_back(v);
+  up(m_pos[v]);
+}
+
+Var Cdcl::VarOrder::removeMax() {
+  Var v = m_heap[0];
+  m_heap[0] = m_heap.back();
+  m_pos[m_heap[0]] = 0;
+  m_pos[v] = -1;
+  m_heap.pop_back();
+  if (m_heap.size() > 1)
+    down(0);
+  return v;
+}
+
+/** Cdcl **/
+
+Cdcl::Cdcl()
+    : m_order(m_activity), m_qhead(0), m_ok(true), m_var_inc(1.0),
+      m_cla_inc(1.0), m_max_learnts(0), m_num_conflicts(0),
+      m_num_decisions(0), m_conflict_budget(-1) {}
+
+Var Cdcl::newVar() {
+  Var v = m_assigns.size();
+  m_assigns.push_back(LBool::UNDEF);
+  m_level.push_back(0);
+  m_reason.push_back(NO_REASON);
+  // -- prefer false like MiniSat
+  m_polarity.push_back(1);
+  m_seen.push_back(0);
+  m_activity.push_back(0.0);
+  m_watches.emplace_back();
+  m_watches.emplace_back();
+  m_order.insert(v);
+  return v;
+}
+
+void Cdcl::attach(CRef cr) {
+  const Clause &c = m_clauses[cr];
+  assert(c.lits.size() > 1);
+  m_watches[negate(c.lits[0])].push_back({cr, c.lits[1]});
+  m_watches[negate(c.lits[1])].push_back({cr, c.lits[0]});
+}
+
+bool Cdcl::addClause(std::vector<Lit> lits) {
+  assert(decisionLevel() == 0);
+  if (!m_ok)
+    return false;
+
+  std::sort(lits.begin(), lits.end());
+  Lit prev = ~0u;
+  unsigned j = 0;
+  for (unsigned i = 0, sz = lits.size(); i < sz; ++i) {
+    Lit p = lits[i];
+    // -- satisfied or tautology
+    if (value(p) == LBool::TRUE || p == negate(prev))
+      return true;
+    if (value(p) != LBool::FALSE && p != prev)
+      lits[j++] = prev = p;
+  }
+  lits.resize(j);
+
+  if (lits.empty()) {
+    m_ok = false;
+    return false;
+  }
+  if (lits.size() == 1) {
+    enqueue(lits[0], NO_REASON);
+    m_ok = (propagate() == NO_REASON);
+    return m_ok;
+  }
+
+  CRef cr = m_clauses.size();
+  m_clauses.push_back({std::move(lits), 0.0, false, false});
+  attach(cr);
+  return true;
+}
+
+void Cdcl::enqueue(Lit p, CRef from) {
+  assert(value(p) == LBool::UNDEF);
+  Var v = var(p);
+  m_assigns[v] = sign(p) ? LBool::FALSE : LBool::TRUE;
+  m_level[v] = decisionLevel();
+  m_reason[v] = from;
+  m_trail.push_back(p);
+}
+
+Cdcl::CRef Cdcl::propagate() {
+  CRef confl = NO_REASON;
+  while (m_qhead < m_trail.size()) {
+    Lit p = m_trail[m_qhead++];
+    Lit false_lit = negate(p);
+    std::vector<Watcher> &ws = m_watches[p];
+
+    unsigned i = 0, j = 0, sz = ws.size();
+    while (i < sz) {
+      Watcher w = ws[i];
+      if (value(w.blocker) == LBool::TRUE) {
+        ws[j++] = ws[i++];
+        continue;
+      }
+      Clause &c = m_clauses[w.cref];
+      if (c.deleted) {
+        ++i;
+        continue;
+      }
+      // -- make sure the false literal is c[1]
+      if (c.lits[0] == false_lit)
+        std::swap(c.lits[0], c.lits[1]);
+      assert(c.lits[1] == false_lit);
+      ++i;
+
+      Lit first = c.lits[0];
+      Watcher nw = {w.cref, first};
+      if (first != w.blocker && value(first) == LBool::TRUE) {
+        ws[j++] = nw;
+        continue;
+      }
+
+      // -- look for a new literal to watch
+      bool found = false;
+      for (unsigned k = 2, csz = c.lits.size(); k < csz; ++k) {
+        if (value(c.lits[k]) != LBool::FALSE) {
+          std::swap(c.lits[1], c.lits[k]);
+          m_watches[negate(c.lits[1])].push_back(nw);
+          found = true;
+          break;
+        }
+      }
+      if (found)
+        continue;
+
+      // -- clause is unit or conflicting
+      ws[j++] = nw;
+      if (value(first) == LBool::FALSE) {
+        confl = w.cref;
+        m_qhead = m_trail.size();
+        while (i < sz)
+          ws[j++] = ws[i++];
+      } else {
+        enqueue(first, w.cref);
+      }
+    }
+    ws.resize(j);
+    if (confl != NO_REASON)
+      break;
+  }
+  return confl;
+}
+
+void Cdcl::cancelUntil(unsigned level) {
+  if (decisionLevel() <= level)
+    return;
+  for (int c = m_trail.size() - 1; c >= (int)m_trail_lim[level]; --c) {
+    Var v = var(m_trail[c]);
+    m_assigns[v] = LBool::UNDEF;
+    m_reason[v] = NO_REASON;
+    m_polarity[v] = sign(m_trail[c]);
+    m_order.insert(v);
+  }
+  m_qhead = m_trail_lim[level];
+  m_trail.resize(m_trail_lim[level]);
+  m_trail_lim.resize(level);
+}
+
+void Cdcl::bumpVar(Var v) {
+  if ((m_activity[v] += m_var_inc) > 1e100) {
+    for (double &a : m_activity)
+      a *= 1e-100;
+    m_var_inc *= 1e-100;
+  }
+  m_order.increased(v);
+}
+
+void Cdcl::bumpClause(Clause &c) {
+  if ((c.activity += m_cla_inc) > 1e20) {
+    for (CRef cr : m_learnts)
+      m_clauses[cr].activity *= 1e-20;
+    m_cla_inc *= 1e-20;
+  }
+}
+
+// -- p is implied by literals that are already in the learnt clause
+bool Cdcl::redundant(Lit p) const {
+  CRef r = m_reason[var(p)];
+  if (r == NO_REASON)
+    return false;
+  const Clause &c = m_clauses[r];
+  for (unsigned k = 1, sz = c.lits.size(); k < sz; ++k) {
+    Var x = var(c.lits[k]);
+    if (!m_seen[x] && m_level[x] > 0)
+      return false;
+  }
+  return true;
+}
+
+void Cdcl::analyze(CRef confl, std::vector<Lit> &learnt, unsigned &btlevel) {
+  int pathC = 0;
+  Lit p = ~0u;
+  // -- room for the asserting literal
+  learnt.push_back(0);
+  int index = m_trail.size() - 1;
+
+  do {
+    assert(confl != NO_REASON);
+    Clause &c = m_clauses[confl];
+    if (c.learnt)
+      bumpClause(c);
+
+    for (unsigned k = (p == ~0u) ? 0 : 1, sz = c.lits.size(); k < sz; ++k) {
+      Lit q = c.lits[k];
+      Var x = var(q);
+      if (!m_seen[x] && m_level[x] > 0) {
+        bumpVar(x);
+        m_seen[x] = 1;
+        if (m_level[x] >= (int)decisionLevel())
+          ++pathC;
+        else
+          learnt.push_back(q);
+      }
+    }
+
+    // -- next literal to look at
+    while (!m_seen[var(m_trail[index--])])
+      ;
+    p = m_trail[index + 1];
+    confl = m_reason[var(p)];
+    m_seen[var(p)] = 0;
+    --pathC;
+  } while (pathC > 0);
+  learnt[0] = negate(p);
+
+  // -- local minimization
+  std::vector<Lit> all(learnt.begin(), learnt.end());
+  unsigned j = 1;
+  for (unsigned i = 1, sz = learnt.size(); i < sz; ++i) {
+    if (!redundant(learnt[i]))
+      learnt[j++] = learnt[i];
+  }
+  learnt.resize(j);
+
+  // -- find the backtrack level
+  btlevel = 0;
+  if (learnt.size() > 1) {
+    unsigned max_i = 1;
+    for (unsigned i = 2, sz = learnt.size(); i < sz; ++i)
+      if (m_level[var(learnt[i])] > m_level[var(learnt[max_i])])
+        max_i = i;
+    std::swap(learnt[1], learnt[max_i]);
+    btlevel = m_level[var(learnt[1])];
+  }
+
+  for (Lit q : all)
+    m_seen[var(q)] = 0;
+}
+
+// -- p is an assumption that is false. Collect the assumptions that
+// -- imply its negation.
+void Cdcl::analyzeFinal(Lit p) {
+  m_failed.clear();
+  m_failed.push_back(p);
+  if (decisionLevel() == 0)
+    return;
+
+  m_seen[var(p)] = 1;
+  for (int i = m_trail.size() - 1; i >= (int)m_trail_lim[0]; --i) {
+    Var x = var(m_trail[i]);
+    if (!m_seen[x])
+      continue;
+    if (m_reason[x] == NO_REASON) {
+      // -- decisions below the assumption levels are assumptions
+      assert(m_level[x] > 0);
+      m_failed.push_back(m_trail[i]);
+    } else {
+      const Clause &c = m_clauses[m_reason[x]];
+      for (unsigned k = 1, sz = c.lits.size(); k < sz; ++k)
+        if (m_level[var(c.lits[k])] > 0)
+          m_seen[var(c.lits[k])] = 1;
+    }
+    m_seen[x] = 0;
+  }
+  m_seen[var(p)] = 0;
+}
+
+Lit Cdcl::pickBranchLit() {
+  while (!m_order.empty()) {
+    Var v = m_order.removeMax();
+    if (m_assigns[v] == LBool::UNDEF)
+      return mkLit(v, m_polarity[v]);
+  }
+  return ~0u;
+}
+
+bool Cdcl::locked(CRef cr) const {
+  const Clause &c = m_clauses[cr];
+  Var v = var(c.lits[0]);
+  return m_reason[v] == cr && value(c.lits[0]) == LBool::TRUE;
+}
+
+void Cdcl::reduceDB() {
+  std::sort(m_learnts.begin(), m_learnts.end(), [this](CRef a, CRef b) {
+    const Clause &ca = m_clauses[a];
+    const Clause &cb = m_clauses[b];
+    // -- binary clauses are kept
+    if (ca.lits.size() == 2 || cb.lits.size() == 2)
+      return ca.lits.size() > 2 && cb.lits.size() == 2;
+    return ca.activity < cb.activity;
+  });
+
+  double extra_lim = m_cla_inc / std::max<size_t>(m_learnts.size(), 1);
+  unsigned j = 0;
+  for (unsigned i = 0, sz = m_learnts.size(); i < sz; ++i) {
+    CRef cr = m_learnts[i];
+    Clause &c = m_clauses[cr];
+    if (c.lits.size() > 2 && !locked(cr) &&
+        (i < sz / 2 || c.activity < extra_lim)) {
+      c.deleted = true;
+      std::vector<Lit>().swap(c.lits);
+    } else {
+      m_learnts[j++] = cr;
+    }
+  }
+  m_learnts.resize(j);
+}
+
+LBool Cdcl::search(int64_t max_conflicts) {
+  int64_t conflicts = 0;
+  std::vector<Lit> learnt;
+  while (true) {
+    CRef confl = propagate();
+    if (confl != NO_REASON) {
+      ++conflicts;
+      ++m_num_conflicts;
+      if (decisionLevel() == 0) {
+        m_ok = false;
+        return LBool::FALSE;
+      }
+      learnt.clear();
+      unsigned btlevel;
+      analyze(confl, learnt, btlevel);
+      cancelUntil(btlevel);
+      if (learnt.size() == 1) {
+        enqueue(learnt[0], NO_REASON);
+      } else {
+        CRef cr = m_clauses.size();
+        m_clauses.push_back({learnt, 0.0, true, false});
+        m_learnts.push_back(cr);
+        attach(cr);
+        bumpClause(m_clauses[cr]);
+        enqueue(learnt[0], cr);
+      }
+      decayActivities();
+      continue;
+    }
+
+    if (max_conflicts >= 0 && conflicts >= max_conflicts) {
+      // -- restart
+      cancelUntil(0);
+      return LBool::UNDEF;
+    }
+    if ((double)m_learnts.size() - m_trail.size() >= m_max_learnts)
+      reduceDB();
+
+    Lit next = ~0u;
+    while (decisionLevel() < m_assumptions.size()) {
+      Lit p = m_assumptions[decisionLevel()];
+      if (value(p) == LBool::TRUE) {
+        // -- dummy decision level
+        newDecisionLevel();
+      } else if (value(p) == LBool::FALSE) {
+        analyzeFinal(p);
+        return LBool::FALSE;
+      } else {
+        next = p;
+        break;
+      }
+    }
+
+    if (next == ~0u) {
+      ++m_num_decisions;
+      next = pickBranchLit();
+      if (next == ~0u)
+        return LBool::TRUE;
+    }
+    newDecisionLevel();
+    enqueue(next, NO_REASON);
+  }
+}
+
+// Finite subsequences of the Luby sequence: 1,1,2,1,1,2,4,...
+static double luby(double y, int x) {
+  int size, seq;
+  for (size = 1, seq = 0; size < x + 1; seq++, size = 2 * size + 1)
+    ;
+  while (size - 1 != x) {
+    size = (size - 1) >> 1;
+    seq--;
+    x = x % size;
+  }
+  return std::pow(y, seq);
+}
+
+LBool Cdcl::solve(const std::vector<Lit> &assumptions) {
+  m_model.clear();
+  m_failed.clear();
+  if (!m_ok)
+    return LBool::FALSE;
+
+  m_assumptions = assumptions;
+  m_max_learnts =
+      std::max<double>(m_clauses.size() - m_learnts.size(), 1000) / 3.0;
+
+  LBool status = LBool::UNDEF;
+  const uint64_t start = m_num_conflicts;
+  for (int restarts = 0; status == LBool::UNDEF; ++restarts) {
+    // -- give up once the conflict budget is exhausted
+    if (m_conflict_budget >= 0 &&
+        m_num_conflicts - start >= (uint64_t)m_conflict_budget)
+      break;
+    status = search((int64_t)(luby(2, restarts) * 100));
+    m_max_learnts *= 1.1;
+  }
+
+  if (status == LBool::TRUE) {
+    m_model.assign(m_assigns.begin(), m_assigns.end());
+  }
+  cancelUntil(0);
+  m_assumptions.clear();
+  return status;
+}
+
+} // namespace sat
+} // namespace solver
+} // namespace seahorn
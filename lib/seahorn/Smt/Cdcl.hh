@@ -0,0 +1,166 @@
+#pragma once
+/* A small incremental CDCL SAT solver */
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace seahorn {
+namespace solver {
+namespace sat {
+
+using Var = int;
+/// A literal is 2*var + sign where sign=1 means negated
+using Lit = unsigned;
+
+inline Lit mkLit(Var v, bool negated = false) {
+  return (static_cast<unsigned>(v) << 1) | static_cast<unsigned>(negated);
+}
+inline Lit negate(Lit l) { return l ^ 1u; }
+inline Var var(Lit l) { return static_cast<Var>(l >> 1); }
+inline bool sign(Lit l) { return l & 1u; }
+
+enum class LBool : uint8_t { TRUE, FALSE, UNDEF };
+
+/**
+ * Conflict-driven clause learning SAT solver in the style of MiniSat:
+ * two watched literals, VSIDS, first-UIP learning, phase saving, Luby
+ * restarts and learnt clause deletion.
+ *
+ * Clauses can be added between calls to solve(). solve() accepts
+ * assumptions and, when they are inconsistent, failedAssumptions()
+ * returns the subset of them responsible for unsatisfiability.
+ */
+class Cdcl {
+public:
+  Cdcl();
+
+  /// Create a fresh variable
+  Var newVar();
+  unsigned numVars() const { return m_assigns.size(); }
+
+  /// Add a clause. Return false if the solver becomes inconsistent.
+  bool addClause(std::vector<Lit> lits);
+
+  /// Solve under the given assumptions
+  LBool solve(const std::vector<Lit> &assumptions);
+
+  /// Maximum number of conflicts of each call to solve(), which returns
+  /// UNDEF when it is exceeded. A negative budget means no limit.
+  void setConflictBudget(int64_t budget) { m_conflict_budget = budget; }
+
+  /// Value of v in the last model
+  LBool modelValue(Var v) const {
+    return v < (Var)m_model.size() ? m_model[v] : LBool::UNDEF;
+  }
+
+  /// Assumptions that made the last call to solve() unsat
+  const std::vector<Lit> &failedAssumptions() const { return m_failed; }
+
+  /// False if the clauses are unsat without assumptions
+  bool okay() const { return m_ok; }
+
+  uint64_t numConflicts() const { return m_num_conflicts; }
+  uint64_t numDecisions() const { return m_num_decisions; }
+
+private:
+  using CRef = unsigned;
+  static const CRef NO_REASON = std::numeric_limits<CRef>::max();
+
+  struct Clause {
+    std::vector<Lit> lits;
+    double activity;
+    bool learnt;
+    bool deleted;
+  };
+
+  struct Watcher {
+    CRef cref;
+    Lit blocker;
+  };
+
+  /// Binary max-heap of variables ordered by activity
+  class VarOrder {
+    const std::vector<double> &m_act;
+    std::vector<Var> m_heap;
+    std::vector<int> m_pos;
+
+    bool lt(Var a, Var b) const { return m_act[a] > m_act[b]; }
+    void up(unsigned i);
+    void down(unsigned i);
+
+  public:
+    VarOrder(const std::vector<double> &act) : m_act(act) {}
+    bool empty() const { return m_heap.empty(); }
+    bool contains(Var v) const {
+      return v < (Var)m_pos.size() && m_pos[v] >= 0;
+    }
+    void insert(Var v);
+    void increased(Var v) {
+      if (contains(v))
+        up(m_pos[v]);
+    }
+    Var removeMax();
+  };
+
+  std::vector<Clause> m_clauses;
+  std::vector<CRef> m_learnts;
+  // -- m_watches[p] are the clauses that watch the negation of p
+  std::vector<std::vector<Watcher>> m_watches;
+
+  std::vector<LBool> m_assigns;
+  std::vector<int> m_level;
+  std::vector<CRef> m_reason;
+  std::vector<char> m_polarity;
+  std::vector<char> m_seen;
+  std::vector<double> m_activity;
+  VarOrder m_order;
+
+  std::vector<Lit> m_trail;
+  std::vector<unsigned> m_trail_lim;
+  unsigned m_qhead;
+
+  std::vector<Lit> m_assumptions;
+  std::vector<LBool> m_model;
+  std::vector<Lit> m_failed;
+
+  bool m_ok;
+  double m_var_inc;
+  double m_cla_inc;
+  double m_max_learnts;
+  uint64_t m_num_conflicts;
+  uint64_t m_num_decisions;
+  int64_t m_conflict_budget;
+
+  LBool value(Lit p) const {
+    LBool v = m_assigns[var(p)];
+    if (v == LBool::UNDEF)
+      return v;
+    return ((v == LBool::TRUE) != sign(p)) ? LBool::TRUE : LBool::FALSE;
+  }
+  unsigned decisionLevel() const { return m_trail_lim.size(); }
+  void newDecisionLevel() { m_trail_lim.push_back(m_trail.size()); }
+
+  void attach(CRef cr);
+  bool locked(CRef cr) const;
+  void enqueue(Lit p, CRef from);
+  CRef propagate();
+  void cancelUntil(unsigned level);
+  void analyze(CRef confl, std::vector<Lit> &learnt, unsigned &btlevel);
+  bool redundant(Lit p) const;
+  void analyzeFinal(Lit p);
+  Lit pickBranchLit();
+  void reduceDB();
+  LBool search(int64_t max_conflicts);
+
+  void bumpVar(Var v);
+  void bumpClause(Clause &c);
+  void decayActivities() {
+    m_var_inc *= (1 / 0.95);
+    m_cla_inc *= (1 / 0.999);
+  }
+};
+
+} // namespace sat
+} // namespace solver
+} // namespace seahorn
@@ -0,0 +1,659 @@
+#include "seahorn/Expr/ExprAig.hh"
+#include "Cdcl.hh"
+
+#include "seahorn/Expr/ExprOpBool.hh"
+
+#include "boost/functional/hash.hpp"
+
+#include <random>
+
+namespace expr {
+namespace op {
+namespace boolop {
+
+namespace sat = seahorn::solver::sat;
+
+const Aig::Lit Aig::FALSE_LIT;
+const Aig::Lit Aig::TRUE_LIT;
+const Aig::Lit Aig::NONE;
+
+Aig::Aig(ExprFactory &efac) : m_efac(efac) {
+  // -- node 0 is the constant
+  m_nodes.push_back({NONE, NONE});
+}
+
+Aig::Lit Aig::mkInput(Expr atom) {
+  auto it = m_inputs.find(atom);
+  if (it != m_inputs.end())
+    return it->second;
+
+  Lit res = mkLit(m_nodes.size());
+  m_nodes.push_back({NONE, (Lit)m_atoms.size()});
+  m_atoms.push_back(atom);
+  m_inputs.insert({atom, res});
+  return res;
+}
+
+/// Two-level AIG minimization rules of Brummayer and Biere. Returns
+/// true if a AND b is simplified to res.
+bool Aig::rewrite(Lit a, Lit b, Lit &res) {
+  for (unsigned i = 0; i < 2; ++i, std::swap(a, b)) {
+    if (!isAnd(node(a)))
+      continue;
+    Lit a0 = fanin0(node(a)), a1 = fanin1(node(a));
+    if (!isNeg(a)) {
+      // -- contradiction: (a0 & a1) & !a0 = false
+      if (a0 == neg(b) || a1 == neg(b)) {
+        res = FALSE_LIT;
+        return true;
+      }
+      // -- idempotence: (a0 & a1) & a0 = a0 & a1
+      if (a0 == b || a1 == b) {
+        res = a;
+        return true;
+      }
+    } else {
+      // -- subsumption: !(a0 & a1) & !a0 = !a0
+      if (a0 == neg(b) || a1 == neg(b)) {
+        res = b;
+        return true;
+      }
+      // -- substitution: !(a0 & a1) & a0 = !a1 & a0
+      if (a0 == b) {
+        res = mkAnd(neg(a1), b);
+        return true;
+      }
+      if (a1 == b) {
+        res = mkAnd(neg(a0), b);
+        return true;
+      }
+    }
+  }
+
+  if (!isAnd(node(a)) || !isAnd(node(b)))
+    return false;
+
+  Lit a0 = fanin0(node(a)), a1 = fanin1(node(a));
+  Lit b0 = fanin0(node(b)), b1 = fanin1(node(b));
+  if (!isNeg(a) && !isNeg(b)) {
+    // -- contradiction: (a0 & a1) & (!a0 & b1) = false
+    if (a0 == neg(b0) || a0 == neg(b1) || a1 == neg(b0) || a1 == neg(b1)) {
+      res = FALSE_LIT;
+      return true;
+    }
+    return false;
+  }
+
+  if (isNeg(a) && isNeg(b)) {
+    // -- resolution: !(a0 & a1) & !(a0 & !a1) = !a0
+    if ((a0 == b0 && a1 == neg(b1)) || (a0 == b1 && a1 == neg(b0))) {
+      res = neg(a0);
+      return true;
+    }
+    if ((a1 == b0 && a0 == neg(b1)) || (a1 == b1 && a0 == neg(b0))) {
+      res = neg(a1);
+      return true;
+    }
+    return false;
+  }
+
+  // -- exactly one of a and b is negated, make it a
+  if (!isNeg(a)) {
+    std::swap(a, b);
+    std::swap(a0, b0);
+    std::swap(a1, b1);
+  }
+  // -- subsumption: !(a0 & a1) & (!a0 & b1) = !a0 & b1
+  if (a0 == neg(b0) || a0 == neg(b1) || a1 == neg(b0) || a1 == neg(b1)) {
+    res = b;
+    return true;
+  }
+  // -- substitution: !(a0 & a1) & (a0 & b1) = !a1 & (a0 & b1)
+  if (a0 == b0 || a0 == b1) {
+    res = mkAnd(neg(a1), b);
+    return true;
+  }
+  if (a1 == b0 || a1 == b1) {
+    res = mkAnd(neg(a0), b);
+    return true;
+  }
+  return false;
+}
+
+Aig::Lit Aig::mkAnd(Lit a, Lit b) {
+  if (a > b)
+    std::swap(a, b);
+
+  // -- constants and trivial cases
+  if (a == FALSE_LIT || a == neg(b))
+    return FALSE_LIT;
+  if (a == TRUE_LIT || a == b)
+    return b;
+
+  Lit res;
+  if (rewrite(a, b, res))
+    return res;
+
+  // -- structural hashing
+  uint64_t key = (static_cast<uint64_t>(a) << 32) | b;
+  auto it = m_strash.find(key);
+  if (it != m_strash.end())
+    return mkLit(it->second);
+
+  unsigned n = m_nodes.size();
+  m_nodes.push_back({a, b});
+  m_strash.insert({key, n});
+  return mkLit(n);
+}
+
+/// true if e is syntactically Boolean
+static bool isBoolean(Expr e) {
+  if (isOpX<ITE>(e))
+    return isBoolean(e->arg(1)) || isBoolean(e->arg(2));
+  return isOp<BoolOp>(e) || isOp<CompareOp>(e) || bind::isBoolConst(e);
+}
+
+Aig::Lit Aig::fromExpr(Expr e) {
+  auto it = m_cache.find(e);
+  if (it != m_cache.end())
+    return it->second;
+
+  Lit res;
+  if (isOpX<TRUE>(e))
+    res = TRUE_LIT;
+  else if (isOpX<FALSE>(e))
+    res = FALSE_LIT;
+  else if (isOpX<NEG>(e))
+    res = neg(fromExpr(e->left()));
+  else if (isOpX<AND>(e) || isOpX<OR>(e)) {
+    // -- OR is a negated AND of negations
+    bool isOr = isOpX<OR>(e);
+    res = TRUE_LIT;
+    for (auto a = e->args_begin(), end = e->args_end(); a != end; ++a) {
+      Lit arg = fromExpr(*a);
+      res = mkAnd(res, isOr ? neg(arg) : arg);
+    }
+    if (isOr)
+      res = neg(res);
+  } else if (isOpX<IMPL>(e))
+    res = mkOr(neg(fromExpr(e->left())), fromExpr(e->right()));
+  else if (isOpX<IFF>(e))
+    res = neg(mkXor(fromExpr(e->left()), fromExpr(e->right())));
+  else if (isOpX<XOR>(e))
+    res = mkXor(fromExpr(e->left()), fromExpr(e->right()));
+  else if (isOpX<ITE>(e) && isBoolean(e))
+    res = mkIte(fromExpr(e->arg(0)), fromExpr(e->arg(1)),
+                fromExpr(e->arg(2)));
+  else if (isOpX<EQ>(e) && isBoolean(e->left()) && isBoolean(e->right()))
+    res = neg(mkXor(fromExpr(e->left()), fromExpr(e->right())));
+  else
+    res = mkInput(e);
+
+  m_cache.insert({e, res});
+  return res;
+}
+
+void Aig::markCone(const std::vector<Lit> &lits,
+                   std::vector<char> &mark) const {
+  mark.assign(m_nodes.size(), 0);
+  for (Lit l : lits)
+    mark[node(l)] = 1;
+  // -- fanins come before a node
+  for (unsigned n = m_nodes.size(); n-- > 1;) {
+    if (!mark[n] || !isAnd(n))
+      continue;
+    mark[node(fanin0(n))] = 1;
+    mark[node(fanin1(n))] = 1;
+  }
+}
+
+unsigned Aig::coneSize(const std::vector<Lit> &lits) const {
+  std::vector<char> mark;
+  markCone(lits, mark);
+  unsigned res = 0;
+  for (unsigned n = 1, sz = m_nodes.size(); n < sz; ++n)
+    res += mark[n];
+  return res;
+}
+
+namespace {
+/// Exports literals of an AIG to Expr, sharing common sub-expressions
+class AigExport {
+  using Lit = Aig::Lit;
+  const Aig &m_aig;
+  ExprFactory &m_efac;
+  bool m_gather;
+  // -- number of fanouts of each node in the exported cone
+  std::vector<unsigned> m_refs;
+  std::unordered_map<Lit, Expr> m_cache;
+
+  /// leaves of the AND tree rooted at l. The tree extends through
+  /// non-negated AND gates with a single fanout
+  void leaves(Lit l, std::vector<Lit> &out) {
+    unsigned n = Aig::node(l);
+    if (m_gather && !Aig::isNeg(l) && m_aig.isAnd(n) && m_refs[n] == 1) {
+      leaves(m_aig.fanin0(n), out);
+      leaves(m_aig.fanin1(n), out);
+    } else
+      out.push_back(l);
+  }
+
+  /// true if node n is !(c & t) & !(!c & e), i.e., the negation of a
+  /// multiplexer ite(c, t, e)
+  bool isMux(unsigned n, Lit &c, Lit &t, Lit &e) const {
+    Lit x = m_aig.fanin0(n), y = m_aig.fanin1(n);
+    if (!Aig::isNeg(x) || !Aig::isNeg(y) || !m_aig.isAnd(Aig::node(x)) ||
+        !m_aig.isAnd(Aig::node(y)))
+      return false;
+    Lit xs[2] = {m_aig.fanin0(Aig::node(x)), m_aig.fanin1(Aig::node(x))};
+    Lit ys[2] = {m_aig.fanin0(Aig::node(y)), m_aig.fanin1(Aig::node(y))};
+    for (unsigned i = 0; i < 2; ++i)
+      for (unsigned j = 0; j < 2; ++j)
+        if (xs[i] == Aig::neg(ys[j])) {
+          c = xs[i];
+          t = xs[1 - i];
+          e = ys[1 - j];
+          // -- prefer a non-negated condition
+          if (Aig::isNeg(c)) {
+            c = Aig::neg(c);
+            std::swap(t, e);
+          }
+          return true;
+        }
+    return false;
+  }
+
+  Expr mkLit(Lit l) {
+    auto it = m_cache.find(l);
+    if (it != m_cache.end())
+      return it->second;
+
+    Expr res;
+    unsigned n = Aig::node(l);
+    if (n == 0)
+      res = l == Aig::FALSE_LIT ? mk<FALSE>(m_efac) : mk<TRUE>(m_efac);
+    else if (m_aig.isInput(n))
+      res = Aig::isNeg(l) ? mk<NEG>(m_aig.atom(n)) : m_aig.atom(n);
+    else
+      res = mkAnd(l);
+
+    m_cache.insert({l, res});
+    return res;
+  }
+
+  Expr mkAnd(Lit l) {
+    unsigned n = Aig::node(l);
+    Lit c, t, e;
+    if (m_gather && isMux(n, c, t, e)) {
+      // -- l is ite(c, t, e) if negated, and ite(c, !t, !e) otherwise
+      if (!Aig::isNeg(l)) {
+        t = Aig::neg(t);
+        e = Aig::neg(e);
+      }
+      if (t == Aig::neg(e)) {
+        // -- ite(c, t, !t) is c <-> t
+        if (Aig::isNeg(t))
+          return mk<XOR>(mkLit(c), mkLit(Aig::neg(t)));
+        return mk<IFF>(mkLit(c), mkLit(t));
+      }
+      return mk<ITE>(mkLit(c), mkLit(t), mkLit(e));
+    }
+
+    std::vector<Lit> ls;
+    if (m_gather) {
+      leaves(m_aig.fanin0(n), ls);
+      leaves(m_aig.fanin1(n), ls);
+    } else {
+      ls.push_back(m_aig.fanin0(n));
+      ls.push_back(m_aig.fanin1(n));
+    }
+
+    ExprVector args;
+    args.reserve(ls.size());
+    bool allNeg = true;
+    for (Lit x : ls)
+      allNeg &= Aig::isNeg(x);
+
+    // -- negation of a conjunction of negations is a disjunction
+    if (m_gather && Aig::isNeg(l) && allNeg) {
+      for (Lit x : ls)
+        args.push_back(mkLit(Aig::neg(x)));
+      return mknary<OR>(args.begin(), args.end());
+    }
+
+    for (Lit x : ls)
+      args.push_back(mkLit(x));
+    Expr res = mknary<AND>(args.begin(), args.end());
+    return Aig::isNeg(l) ? mk<NEG>(res) : res;
+  }
+
+public:
+  AigExport(const Aig &aig, ExprFactory &efac, bool gather)
+      : m_aig(aig), m_efac(efac), m_gather(gather) {}
+
+  void operator()(const std::vector<Lit> &lits, ExprVector &out) {
+    if (m_gather) {
+      std::vector<char> mark(m_aig.numNodes(), 0);
+      m_refs.assign(m_aig.numNodes(), 0);
+      for (Lit l : lits) {
+        mark[Aig::node(l)] = 1;
+        // -- an output is shared with the outside
+        ++m_refs[Aig::node(l)];
+      }
+      for (unsigned n = m_aig.numNodes(); n-- > 1;) {
+        if (!mark[n] || !m_aig.isAnd(n))
+          continue;
+        for (Lit f : {m_aig.fanin0(n), m_aig.fanin1(n)}) {
+          mark[Aig::node(f)] = 1;
+          ++m_refs[Aig::node(f)];
+        }
+      }
+    }
+    for (Lit l : lits)
+      out.push_back(mkLit(l));
+  }
+};
+} // namespace
+
+Expr Aig::toExpr(Lit l, bool gather) {
+  ExprVector out;
+  toExpr(std::vector<Lit>{l}, out, gather);
+  return out[0];
+}
+
+void Aig::toExpr(const std::vector<Lit> &lits, ExprVector &out, bool gather) {
+  AigExport exp(*this, m_efac, gather);
+  exp(lits, out);
+}
+
+void Aig::swap(Aig &o) {
+  assert(&m_efac == &o.m_efac);
+  m_nodes.swap(o.m_nodes);
+  m_atoms.swap(o.m_atoms);
+  m_strash.swap(o.m_strash);
+  m_inputs.swap(o.m_inputs);
+  m_cache.swap(o.m_cache);
+}
+
+void Aig::compact(std::vector<Lit> &outs) {
+  std::vector<char> mark;
+  markCone(outs, mark);
+
+  Aig dst(m_efac);
+  std::vector<Lit> map(m_nodes.size(), NONE);
+  map[0] = FALSE_LIT;
+  auto mapLit = [&map](Lit l) { return map[node(l)] ^ (l & 1u); };
+  for (unsigned n = 1, sz = m_nodes.size(); n < sz; ++n) {
+    if (!mark[n])
+      continue;
+    map[n] = isInput(n) ? dst.mkInput(atom(n))
+                        : dst.mkAnd(mapLit(fanin0(n)), mapLit(fanin1(n)));
+  }
+  for (Lit &l : outs)
+    l = mapLit(l);
+  swap(dst);
+}
+
+/**
+ * SAT sweeping of an AIG that is being built.
+ *
+ * Nodes are swept in the order in which they are created. Each node is
+ * simulated on random patterns, and nodes with the same signature (up
+ * to negation) are candidates for merging. Candidates are proved
+ * equivalent with a CDCL solver on the Tseitin encoding of their
+ * cones.
+ */
+class AigSweeper {
+  using Lit = Aig::Lit;
+  // -- number of 64-bit simulation words per node
+  static const unsigned WORDS = 4;
+
+  Aig &m_aig;
+  unsigned m_max_candidates;
+  Aig::FraigStats m_stats;
+
+  std::mt19937_64 m_rand;
+  std::vector<uint64_t> m_sim;
+  // -- swept nodes are mapped to their representative, others to NONE
+  std::vector<Lit> m_repr;
+  // -- candidate classes: signature hash -> nodes (with phase)
+  std::unordered_map<size_t, std::vector<Lit>> m_classes;
+
+  sat::Cdcl m_sat;
+  std::vector<sat::Var> m_vars;
+
+  const uint64_t *sim(unsigned n) const { return &m_sim[n * WORDS]; }
+
+  void simulate() {
+    for (unsigned n = m_sim.size() / WORDS, sz = m_aig.numNodes(); n < sz;
+         ++n) {
+      for (unsigned w = 0; w < WORDS; ++w) {
+        uint64_t v = 0;
+        if (m_aig.isInput(n))
+          v = m_rand();
+        else if (m_aig.isAnd(n)) {
+          Lit f0 = m_aig.fanin0(n), f1 = m_aig.fanin1(n);
+          uint64_t v0 = m_sim[Aig::node(f0) * WORDS + w];
+          uint64_t v1 = m_sim[Aig::node(f1) * WORDS + w];
+          v = (Aig::isNeg(f0) ? ~v0 : v0) & (Aig::isNeg(f1) ? ~v1 : v1);
+        }
+        m_sim.push_back(v);
+      }
+    }
+    m_repr.resize(m_aig.numNodes(), ~0u);
+  }
+
+  /// phase that makes the first simulation bit of n false
+  bool phase(unsigned n) const { return sim(n)[0] & 1u; }
+
+  /// hash of the signature of n normalized by its phase
+  size_t signature(unsigned n, bool &isZero) const {
+    uint64_t mask = phase(n) ? ~0ULL : 0;
+    size_t res = 0;
+    isZero = true;
+    for (unsigned w = 0; w < WORDS; ++w) {
+      uint64_t v = sim(n)[w] ^ mask;
+      isZero &= v == 0;
+      res = res * 0x9e3779b97f4a7c15ULL + std::hash<uint64_t>()(v);
+    }
+    return res;
+  }
+
+  bool sameSignature(unsigned a, unsigned b) const {
+    uint64_t mask = (phase(a) != phase(b)) ? ~0ULL : 0;
+    for (unsigned w = 0; w < WORDS; ++w)
+      if (sim(a)[w] != (sim(b)[w] ^ mask))
+        return false;
+    return true;
+  }
+
+  /// Tseitin encoding of the cone of n
+  sat::Var encode(unsigned root) {
+    if (m_vars.size() < m_aig.numNodes())
+      m_vars.resize(m_aig.numNodes(), -1);
+    if (m_vars[root] >= 0)
+      return m_vars[root];
+
+    std::vector<unsigned> stack{root};
+    while (!stack.empty()) {
+      unsigned n = stack.back();
+      if (m_vars[n] >= 0) {
+        stack.pop_back();
+        continue;
+      }
+      if (!m_aig.isAnd(n)) {
+        m_vars[n] = m_sat.newVar();
+        if (n == 0)
+          m_sat.addClause({sat::mkLit(m_vars[n], true)});
+        stack.pop_back();
+        continue;
+      }
+
+      unsigned n0 = Aig::node(m_aig.fanin0(n)), n1 = Aig::node(m_aig.fanin1(n));
+      if (m_vars[n0] < 0 || m_vars[n1] < 0) {
+        if (m_vars[n0] < 0)
+          stack.push_back(n0);
+        if (m_vars[n1] < 0)
+          stack.push_back(n1);
+        continue;
+      }
+
+      stack.pop_back();
+      sat::Var v = m_sat.newVar();
+      m_vars[n] = v;
+      sat::Lit x = satLit(Aig::mkLit(n));
+      sat::Lit a = satLit(m_aig.fanin0(n));
+      sat::Lit b = satLit(m_aig.fanin1(n));
+      m_sat.addClause({sat::negate(x), a});
+      m_sat.addClause({sat::negate(x), b});
+      m_sat.addClause({x, sat::negate(a), sat::negate(b)});
+    }
+    return m_vars[root];
+  }
+
+  sat::Lit satLit(Lit l) const {
+    return sat::mkLit(m_vars[Aig::node(l)], Aig::isNeg(l));
+  }
+
+  /// true if the conjunction of a and b is unsatisfiable
+  bool unsat(Lit a, Lit b) {
+    ++m_stats.satCalls;
+    sat::LBool res = m_sat.solve({satLit(a), satLit(b)});
+    if (res == sat::LBool::UNDEF)
+      ++m_stats.undecided;
+    return res == sat::LBool::FALSE;
+  }
+
+  /// true if a and b are equivalent
+  bool equiv(Lit a, Lit b) {
+    encode(Aig::node(a));
+    encode(Aig::node(b));
+    return unsat(a, Aig::neg(b)) && unsat(Aig::neg(a), b);
+  }
+
+public:
+  AigSweeper(Aig &aig, unsigned conflicts, unsigned maxCandidates)
+      : m_aig(aig), m_max_candidates(maxCandidates), m_rand(0x5ea) {
+    m_sat.setConflictBudget(conflicts);
+  }
+
+  const Aig::FraigStats &stats() const { return m_stats; }
+
+  /// Literal equivalent to l. l must have been just created
+  Lit sweep(Lit l) {
+    unsigned n = Aig::node(l);
+    if (!m_aig.isAnd(n))
+      return l;
+    simulate();
+    // -- structural hashing may give back a node that was already swept
+    if (m_repr[n] == ~0u)
+      m_repr[n] = representative(n);
+    return m_repr[n] ^ Aig::isNeg(l);
+  }
+
+private:
+  /// Literal equivalent to node n
+  Lit representative(unsigned n) {
+    bool isZero;
+    size_t sig = signature(n, isZero);
+    // -- x is the node with the phase that is false on the first pattern
+    Lit x = Aig::mkLit(n, phase(n));
+
+    if (isZero) {
+      // -- x might be the constant false
+      encode(n);
+      if (unsat(x, x)) {
+        ++m_stats.constants;
+        return Aig::FALSE_LIT ^ phase(n);
+      }
+    }
+
+    auto &cls = m_classes[sig];
+    unsigned tries = 0;
+    for (Lit y : cls) {
+      if (tries >= m_max_candidates)
+        break;
+      if (!sameSignature(n, Aig::node(y)))
+        continue;
+      ++tries;
+      if (equiv(x, y)) {
+        ++m_stats.merged;
+        return y ^ phase(n);
+      }
+    }
+    cls.push_back(x);
+    return Aig::mkLit(n);
+  }
+};
+
+Aig::FraigStats Aig::fraig(std::vector<Lit> &outs, unsigned conflicts,
+                           unsigned maxCandidates) {
+  std::vector<char> mark;
+  markCone(outs, mark);
+
+  Aig dst(m_efac);
+  AigSweeper sweeper(dst, conflicts, maxCandidates);
+  std::vector<Lit> map(m_nodes.size(), NONE);
+  map[0] = FALSE_LIT;
+  auto mapLit = [&map](Lit l) { return map[node(l)] ^ (l & 1u); };
+  for (unsigned n = 1, sz = m_nodes.size(); n < sz; ++n) {
+    if (!mark[n])
+      continue;
+    if (isInput(n))
+      map[n] = dst.mkInput(atom(n));
+    else
+      map[n] =
+          sweeper.sweep(dst.mkAnd(mapLit(fanin0(n)), mapLit(fanin1(n))));
+  }
+  for (Lit &l : outs)
+    l = mapLit(l);
+  swap(dst);
+  // -- drop nodes that were merged
+  compact(outs);
+  return sweeper.stats();
+}
+
+Expr aig(Expr e, bool gather) {
+  Aig g(e->efac());
+  return g.toExpr(g.fromExpr(e), gather);
+}
+
+unsigned aigSize(Expr e) {
+  Aig g(e->efac());
+  return g.coneSize({g.fromExpr(e)});
+}
+
+Expr fraig(Expr e) {
+  Aig g(e->efac());
+  std::vector<Aig::Lit> outs{g.fromExpr(e)};
+  g.fraig(outs);
+  return g.toExpr(outs[0]);
+}
+
+void fraig(ExprVector &conj) {
+  if (conj.empty())
+    return;
+  ExprFactory &efac = conj[0]->efac();
+
+  Aig g(efac);
+  std::vector<Aig::Lit> outs;
+  outs.reserve(conj.size());
+  for (Expr e : conj)
+    outs.push_back(g.fromExpr(e));
+  g.fraig(outs);
+
+  std::vector<Aig::Lit> lits;
+  for (Aig::Lit l : outs) {
+    if (l == Aig::FALSE_LIT) {
+      conj.assign(1, mk<FALSE>(efac));
+      return;
+    }
+    if (l != Aig::TRUE_LIT)
+      lits.push_back(l);
+  }
+  conj.clear();
+  g.toExpr(lits, conj);
+}
+} // namespace boolop
+} // namespace op
+} // namespace expr
@@ -0,0 +1,754 @@
+/**
+ * Solver-free word-level simplifier for QF_ABV. See ExprBvSimplifier.hh
+ */
+#include "seahorn/Expr/ExprBvSimplifier.hh"
+#include "seahorn/Expr/ExprGmp.hh"
+#include "seahorn/Expr/ExprOpBind.hh"
+#include "seahorn/Expr/ExprOpBv.hh"
+#include "seahorn/Expr/ExprSimplifier.hh"
+#include "seahorn/Expr/TypeChecker.hh"
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+
+namespace expr {
+namespace op {
+namespace bv {
+
+namespace {
+/// 2^w
+mpz_class pow2(unsigned w) { return mpz_class(1UL) << w; }
+
+/// num modulo 2^w
+mpz_class norm(const mpz_class &num, unsigned w) {
+  mpz_class res;
+  mpz_fdiv_r_2exp(res.get_mpz_t(), num.get_mpz_t(), w);
+  return res;
+}
+
+/// num, an unsigned w-bit value, as a two's complement signed value
+mpz_class toSigned(const mpz_class &num, unsigned w) {
+  if (w > 0 && mpz_tstbit(num.get_mpz_t(), w - 1))
+    return num - pow2(w);
+  return num;
+}
+
+mpz_class udiv(const mpz_class &x, const mpz_class &y, unsigned w) {
+  // -- SMT-LIB: division by zero is all ones
+  if (y.sgn() == 0)
+    return pow2(w) - mpz_class(1UL);
+  mpz_class res;
+  mpz_tdiv_q(res.get_mpz_t(), x.get_mpz_t(), y.get_mpz_t());
+  return res;
+}
+
+mpz_class urem(const mpz_class &x, const mpz_class &y) {
+  // -- SMT-LIB: remainder by zero is the dividend
+  if (y.sgn() == 0)
+    return x;
+  mpz_class res;
+  mpz_tdiv_r(res.get_mpz_t(), x.get_mpz_t(), y.get_mpz_t());
+  return res;
+}
+
+mpz_class neg(const mpz_class &x, unsigned w) {
+  return norm(mpz_class(0L) - x, w);
+}
+
+bool msb(const mpz_class &x, unsigned w) {
+  return mpz_tstbit(x.get_mpz_t(), w - 1);
+}
+
+/// Numeral of a Boolean, bit-vector, integer or string sort
+bool isValue(Expr e) {
+  return isOpX<TRUE>(e) || isOpX<FALSE>(e) || isBvNum(e) || isOpX<MPZ>(e);
+}
+} // namespace
+
+/// Rewrites the root of a term whose arguments are already simplified.
+/// Terms built by a rule are rewritten again before they are returned.
+class BvRewriter {
+  ExprFactory &m_efac;
+  TypeChecker m_tc;
+  boolop::TrivialSimplifier m_bool;
+  Expr m_true;
+  Expr m_false;
+
+  Expr mkBool(bool v) { return v ? m_true : m_false; }
+  Expr mkNum(const mpz_class &num, unsigned w) {
+    return bvnum(norm(num, w), w, m_efac);
+  }
+
+  /// Width of a bit-vector term, 0 if it is not a bit-vector
+  unsigned width(Expr e);
+
+  Expr fold(Expr e);
+  Expr liftIte(Expr e);
+  Expr rwAssoc(Expr e);
+  Expr rwSub(Expr e);
+  Expr rwDivShift(Expr e);
+  Expr rwExtract(Expr e);
+  Expr rwConcat(Expr e);
+  Expr rwExtend(Expr e);
+  Expr rwCompare(Expr e);
+  Expr rwEq(Expr e);
+  Expr rwIte(Expr e);
+  Expr rwBool(Expr e);
+  Expr rwSelect(Expr e);
+  Expr rwStore(Expr e);
+
+  llvm::Optional<bool> sameIndex(Expr i, Expr j);
+
+public:
+  explicit BvRewriter(ExprFactory &efac)
+      : m_efac(efac), m_bool(efac), m_true(mk<TRUE>(efac)),
+        m_false(mk<FALSE>(efac)) {}
+
+  Expr operator()(Expr e);
+};
+
+unsigned BvRewriter::width(Expr e) {
+  unsigned w;
+  if (isBvNum(e, w))
+    return w;
+  if (isOpX<BEXTRACT>(e))
+    return high(e) - low(e) + 1;
+  if (isOpX<BSEXT>(e) || isOpX<BZEXT>(e))
+    return bv::width(e->arg(1));
+  if (isOpX<BCONCAT>(e)) {
+    unsigned sum = 0;
+    for (auto *a : llvm::make_range(e->args_begin(), e->args_end())) {
+      unsigned aw = width(a);
+      if (aw == 0)
+        return 0;
+      sum += aw;
+    }
+    return sum;
+  }
+  if (isOpX<ITE>(e))
+    return width(e->arg(1));
+  if (isOpX<BNOT>(e) || isOpX<BNEG>(e) || isOpX<BAND>(e) || isOpX<BOR>(e) ||
+      isOpX<BXOR>(e) || isOpX<BADD>(e) || isOpX<BSUB>(e) || isOpX<BMUL>(e) ||
+      isOpX<BUDIV>(e) || isOpX<BSDIV>(e) || isOpX<BUREM>(e) ||
+      isOpX<BSREM>(e) || isOpX<BSMOD>(e) || isOpX<BSHL>(e) ||
+      isOpX<BLSHR>(e) || isOpX<BASHR>(e))
+    return width(e->arg(0));
+  if (isOpX<SELECT>(e)) {
+    // -- the width of a stored value, if any
+    Expr a = e->left();
+    while (isOpX<STORE>(a) && width(a->arg(2)) == 0)
+      a = a->arg(0);
+    if (isOpX<STORE>(a))
+      return width(a->arg(2));
+    if (isOpX<CONST_ARRAY>(a))
+      return width(a->arg(1));
+  }
+  if (isBvConst(e))
+    return widthBvConst(e);
+
+  Expr ty = m_tc.typeOf(e);
+  return isOpX<BVSORT>(ty) ? bv::width(ty) : 0;
+}
+
+Expr BvRewriter::operator()(Expr e) {
+  if (e->arity() == 0 || isValue(e))
+    return e;
+
+  if (isOpX<ITE>(e))
+    return rwIte(e);
+  if (isOpX<EQ>(e))
+    return rwEq(e);
+  if (isOpX<NEQ>(e)) {
+    Expr eq = rwEq(mk<EQ>(e->left(), e->right()));
+    return isOpX<TRUE>(eq) || isOpX<FALSE>(eq) ? mkBool(isOpX<FALSE>(eq))
+                                               : e;
+  }
+  if (isOp<BoolOp>(e))
+    return rwBool(e);
+  if (isOpX<SELECT>(e))
+    return rwSelect(e);
+  if (isOpX<STORE>(e))
+    return rwStore(e);
+  if (!isOp<BvOp>(e))
+    return e;
+
+  if (std::all_of(e->args_begin(), e->args_end(), [](ENode *a) {
+        return isValue(a) || isOpX<UINT>(a) || isOpX<BVSORT>(a);
+      })) {
+    Expr res = fold(e);
+    if (res)
+      return res;
+  }
+
+  Expr res = liftIte(e);
+  if (res != e)
+    return res;
+
+  if (isOpX<BADD>(e) || isOpX<BMUL>(e) || isOpX<BAND>(e) || isOpX<BOR>(e) ||
+      isOpX<BXOR>(e))
+    return rwAssoc(e);
+  if (isOpX<BSUB>(e))
+    return rwSub(e);
+  if (isOpX<BUDIV>(e) || isOpX<BSDIV>(e) || isOpX<BUREM>(e) ||
+      isOpX<BSREM>(e) || isOpX<BSHL>(e) || isOpX<BLSHR>(e) || isOpX<BASHR>(e))
+    return rwDivShift(e);
+  if ((isOpX<BNOT>(e) && isOpX<BNOT>(e->arg(0))) ||
+      (isOpX<BNEG>(e) && isOpX<BNEG>(e->arg(0))))
+    return e->arg(0)->arg(0);
+  if (isOpX<BEXTRACT>(e))
+    return rwExtract(e);
+  if (isOpX<BCONCAT>(e))
+    return rwConcat(e);
+  if (isOpX<BSEXT>(e) || isOpX<BZEXT>(e))
+    return rwExtend(e);
+  if (isOpX<BULT>(e) || isOpX<BULE>(e) || isOpX<BUGT>(e) || isOpX<BUGE>(e) ||
+      isOpX<BSLT>(e) || isOpX<BSLE>(e) || isOpX<BSGT>(e) || isOpX<BSGE>(e))
+    return rwCompare(e);
+  return e;
+}
+
+/// Evaluates an operator whose arguments are numerals. Returns null if
+/// the operator is not supported.
+Expr BvRewriter::fold(Expr e) {
+  if (isOpX<BEXTRACT>(e)) {
+    mpz_class v = toMpz(earg(e));
+    return mkNum(v >> low(e), high(e) - low(e) + 1);
+  }
+  if (isOpX<BZEXT>(e))
+    return mkNum(toMpz(e->arg(0)), bv::width(e->arg(1)));
+  if (isOpX<BSEXT>(e))
+    return mkNum(toSigned(toMpz(e->arg(0)), widthBvNum(e->arg(0))),
+                 bv::width(e->arg(1)));
+  if (isOpX<BCONCAT>(e)) {
+    mpz_class v(0UL);
+    for (auto *a : llvm::make_range(e->args_begin(), e->args_end()))
+      v = (v << widthBvNum(a)) | toMpz(a);
+    return mkNum(v, width(e));
+  }
+
+  unsigned w = widthBvNum(e->arg(0));
+  mpz_class x = toMpz(e->arg(0));
+  if (isOpX<BNOT>(e))
+    return mkNum(pow2(w) - mpz_class(1UL) - x, w);
+  if (isOpX<BNEG>(e))
+    return mkNum(neg(x, w), w);
+
+  if (isOpX<BADD>(e) || isOpX<BSUB>(e) || isOpX<BMUL>(e) || isOpX<BAND>(e) ||
+      isOpX<BOR>(e) || isOpX<BXOR>(e)) {
+    for (auto *a : llvm::make_range(e->args_begin() + 1, e->args_end())) {
+      mpz_class y = toMpz(a);
+      if (isOpX<BADD>(e))
+        x = x + y;
+      else if (isOpX<BSUB>(e))
+        x = x - y;
+      else if (isOpX<BMUL>(e))
+        x = x * y;
+      else if (isOpX<BAND>(e))
+        x = x & y;
+      else if (isOpX<BOR>(e))
+        x = x | y;
+      else
+        x = x ^ y;
+      x = norm(x, w);
+    }
+    return mkNum(x, w);
+  }
+
+  if (e->arity() != 2)
+    return Expr();
+  mpz_class y = toMpz(e->arg(1));
+  bool mx = msb(x, w), my = msb(y, w);
+  mpz_class sx = toSigned(x, w), sy = toSigned(y, w);
+
+  if (isOpX<BUDIV>(e))
+    return mkNum(udiv(x, y, w), w);
+  if (isOpX<BUREM>(e))
+    return mkNum(urem(x, y), w);
+  if (isOpX<BSDIV>(e)) {
+    mpz_class ax = mx ? neg(x, w) : x, ay = my ? neg(y, w) : y;
+    mpz_class q = udiv(ax, ay, w);
+    return mkNum(mx != my ? neg(q, w) : q, w);
+  }
+  if (isOpX<BSREM>(e)) {
+    mpz_class ax = mx ? neg(x, w) : x, ay = my ? neg(y, w) : y;
+    mpz_class r = urem(ax, ay);
+    return mkNum(mx ? neg(r, w) : r, w);
+  }
+  if (isOpX<BSHL>(e))
+    return y >= mpz_class(static_cast<unsigned long>(w))
+               ? mkNum(mpz_class(0UL), w)
+               : mkNum(x << y.get_ui(), w);
+  if (isOpX<BLSHR>(e))
+    return y >= mpz_class(static_cast<unsigned long>(w))
+               ? mkNum(mpz_class(0UL), w)
+               : mkNum(x >> y.get_ui(), w);
+  if (isOpX<BASHR>(e)) {
+    mp_bitcnt_t s = y >= mpz_class(static_cast<unsigned long>(w))
+                        ? w
+                        : static_cast<mp_bitcnt_t>(y.get_ui());
+    mpz_class res;
+    mpz_fdiv_q_2exp(res.get_mpz_t(), sx.get_mpz_t(), s);
+    return mkNum(res, w);
+  }
+
+  if (isOpX<BULT>(e))
+    return mkBool(x < y);
+  if (isOpX<BULE>(e))
+    return mkBool(x <= y);
+  if (isOpX<BUGT>(e))
+    return mkBool(x > y);
+  if (isOpX<BUGE>(e))
+    return mkBool(x >= y);
+  if (isOpX<BSLT>(e))
+    return mkBool(sx < sy);
+  if (isOpX<BSLE>(e))
+    return mkBool(sx <= sy);
+  if (isOpX<BSGT>(e))
+    return mkBool(sx > sy);
+  if (isOpX<BSGE>(e))
+    return mkBool(sx >= sy);
+  return Expr();
+}
+
+/// op(.., ite(c, n1, n2), ..) --> ite(c, op(.., n1, ..), op(.., n2, ..))
+/// when n1, n2 and all other arguments are numerals, so that both
+/// branches fold to numerals
+Expr BvRewriter::liftIte(Expr e) {
+  int pos = -1;
+  for (unsigned i = 0, sz = e->arity(); i < sz; ++i) {
+    Expr a = e->arg(i);
+    if (isValue(a) || isOpX<UINT>(a) || isOpX<BVSORT>(a))
+      continue;
+    if (pos >= 0 || !isOpX<ITE>(a) || !isValue(a->arg(1)) ||
+        !isValue(a->arg(2)))
+      return e;
+    pos = i;
+  }
+  if (pos < 0)
+    return e;
+
+  Expr ite = e->arg(pos);
+  ExprVector kids(e->args_begin(), e->args_end());
+  kids[pos] = ite->arg(1);
+  Expr t = (*this)(m_efac.mkNary(e->op(), kids));
+  kids[pos] = ite->arg(2);
+  Expr f = (*this)(m_efac.mkNary(e->op(), kids));
+  return (*this)(mk<ITE>(ite->arg(0), t, f));
+}
+
+/// Canonical form of associative and commutative operators
+Expr BvRewriter::rwAssoc(Expr e) {
+  unsigned w = width(e);
+  if (w == 0)
+    return e;
+
+  // -- flatten
+  ExprVector args;
+  ExprVector todo(e->args_begin(), e->args_end());
+  std::reverse(todo.begin(), todo.end());
+  while (!todo.empty()) {
+    Expr a = todo.back();
+    todo.pop_back();
+    if (a->op() == e->op())
+      for (auto it = a->args_end(); it != a->args_begin();)
+        todo.push_back(*--it);
+    else
+      args.push_back(a);
+  }
+
+  bool isAdd = isOpX<BADD>(e), isMul = isOpX<BMUL>(e);
+  bool isAnd = isOpX<BAND>(e), isOr = isOpX<BOR>(e);
+  mpz_class ones = pow2(w) - mpz_class(1UL);
+  mpz_class unit = isMul ? mpz_class(1UL) : isAnd ? ones : mpz_class(0UL);
+
+  // -- fold numerals
+  mpz_class num = unit;
+  ExprVector rest;
+  for (Expr a : args) {
+    if (!isBvNum(a)) {
+      rest.push_back(a);
+      continue;
+    }
+    mpz_class v = toMpz(a);
+    if (isAdd)
+      num = norm(num + v, w);
+    else if (isMul)
+      num = norm(num * v, w);
+    else if (isAnd)
+      num = num & v;
+    else if (isOr)
+      num = num | v;
+    else
+      num = num ^ v;
+  }
+
+  // -- absorbing element
+  if ((isMul || isAnd) && num.sgn() == 0)
+    return mkNum(num, w);
+  if (isOr && num == ones)
+    return mkNum(num, w);
+
+  std::sort(rest.begin(), rest.end(),
+            [](Expr a, Expr b) { return a->getId() < b->getId(); });
+  if (isAnd || isOr) {
+    // -- x & x = x, x | x = x
+    rest.erase(std::unique(rest.begin(), rest.end()), rest.end());
+  } else if (!isAdd && !isMul) {
+    // -- x ^ x = 0
+    ExprVector odd;
+    for (unsigned i = 0; i < rest.size(); ++i) {
+      if (i + 1 < rest.size() && rest[i] == rest[i + 1])
+        ++i;
+      else
+        odd.push_back(rest[i]);
+    }
+    rest.swap(odd);
+  }
+
+  ExprVector kids;
+  if (num != unit || rest.empty())
+    kids.push_back(mkNum(num, w));
+  kids.insert(kids.end(), rest.begin(), rest.end());
+  if (kids.size() == 1)
+    return kids[0];
+
+  // -- only bvadd is n-ary in the other layers (see ZExprConverter)
+  if (isAdd)
+    return m_efac.mkNary(e->op(), kids);
+  Expr res = kids.back();
+  for (auto it = kids.rbegin() + 1, end = kids.rend(); it != end; ++it)
+    res = m_efac.mkBin(e->op(), *it, res);
+  return res;
+}
+
+/// x - x = 0, x - n = x + (-n)
+Expr BvRewriter::rwSub(Expr e) {
+  if (e->arity() != 2)
+    return e;
+  unsigned w = width(e);
+  Expr x = e->arg(0), y = e->arg(1);
+  if (w == 0)
+    return e;
+  if (x == y)
+    return mkNum(mpz_class(0UL), w);
+  if (isBvNum(y))
+    return (*this)(mk<BADD>(x, mkNum(neg(toMpz(y), w), w)));
+  return e;
+}
+
+/// Division, remainder and shift by a numeral, and of zero
+Expr BvRewriter::rwDivShift(Expr e) {
+  unsigned w = width(e);
+  Expr x = e->arg(0), y = e->arg(1);
+  if (w == 0 || e->arity() != 2)
+    return e;
+  mpz_class zero(0UL);
+  bool isRem = isOpX<BUREM>(e) || isOpX<BSREM>(e);
+  bool isShift = isOpX<BSHL>(e) || isOpX<BLSHR>(e) || isOpX<BASHR>(e);
+
+  // -- 0 % y = 0, 0 << y = 0, 0 >> y = 0
+  if (isBvNum(x) && toMpz(x).sgn() == 0 && (isRem || isShift))
+    return x;
+  if (!isBvNum(y))
+    return e;
+
+  mpz_class n = toMpz(y);
+  if (isShift) {
+    if (n.sgn() == 0)
+      return x;
+    if (!isOpX<BASHR>(e) && n >= mpz_class(static_cast<unsigned long>(w)))
+      return mkNum(zero, w);
+    return e;
+  }
+  if (n.sgn() == 0) {
+    // -- SMT-LIB: x / 0 is all ones for bvudiv, x % 0 is x
+    if (isOpX<BUDIV>(e))
+      return mkNum(pow2(w) - mpz_class(1UL), w);
+    if (isRem)
+      return x;
+    return e;
+  }
+  if (n == mpz_class(1UL))
+    return isRem ? mkNum(zero, w) : x;
+  return e;
+}
+
+/// Extract of a term that is itself extracted, concatenated or extended
+Expr BvRewriter::rwExtract(Expr e) {
+  unsigned h = high(e), l = low(e);
+  Expr x = earg(e);
+  unsigned w = width(x);
+  if (w == 0)
+    return e;
+  if (l == 0 && h + 1 == w)
+    return x;
+
+  if (isOpX<BEXTRACT>(x))
+    return (*this)(extract(h + low(x), l + low(x), earg(x)));
+
+  if (isOpX<BZEXT>(x) || isOpX<BSEXT>(x)) {
+    Expr y = x->arg(0);
+    unsigned yw = width(y);
+    if (yw == 0)
+      return e;
+    if (h < yw)
+      return (*this)(extract(h, l, y));
+    if (isOpX<BZEXT>(x) && l >= yw)
+      return mkNum(mpz_class(0UL), h - l + 1);
+    return e;
+  }
+
+  if (isOpX<BCONCAT>(x)) {
+    // -- pieces of the arguments that overlap [l, h], most significant first
+    ExprVector pieces;
+    unsigned lo = 0;
+    for (auto it = x->args_end(); it != x->args_begin();) {
+      Expr a = *--it;
+      unsigned aw = width(a);
+      if (aw == 0)
+        return e;
+      unsigned hi = lo + aw - 1;
+      if (hi >= l && lo <= h) {
+        unsigned ph = std::min(h, hi) - lo, pl = std::max(l, lo) - lo;
+        pieces.push_back((*this)(extract(ph, pl, a)));
+      }
+      lo += aw;
+    }
+    std::reverse(pieces.begin(), pieces.end());
+    if (pieces.size() == 1)
+      return pieces[0];
+    return (*this)(mknary<BCONCAT>(pieces.begin(), pieces.end()));
+  }
+  return e;
+}
+
+/// Flattens concatenations and merges adjacent numerals and adjacent
+/// extracts of the same term
+Expr BvRewriter::rwConcat(Expr e) {
+  ExprVector args;
+  bool changed = false;
+  for (auto *a : llvm::make_range(e->args_begin(), e->args_end())) {
+    if (isOpX<BCONCAT>(a)) {
+      args.insert(args.end(), a->args_begin(), a->args_end());
+      changed = true;
+    } else {
+      args.push_back(a);
+    }
+  }
+
+  ExprVector res;
+  for (Expr a : args) {
+    if (!res.empty()) {
+      Expr prev = res.back();
+      Expr merged;
+      if (isBvNum(prev) && isBvNum(a)) {
+        unsigned aw = widthBvNum(a);
+        merged = mkNum((toMpz(prev) << aw) | toMpz(a), widthBvNum(prev) + aw);
+      } else if (isOpX<BEXTRACT>(prev) && isOpX<BEXTRACT>(a) &&
+                 earg(prev) == earg(a) && low(prev) == high(a) + 1) {
+        merged = (*this)(extract(high(prev), low(a), earg(a)));
+      }
+      if (merged) {
+        res.back() = merged;
+        changed = true;
+        continue;
+      }
+    }
+    res.push_back(a);
+  }
+
+  if (!changed)
+    return e;
+  if (res.size() == 1)
+    return res[0];
+  return mknary<BCONCAT>(res.begin(), res.end());
+}
+
+Expr BvRewriter::rwExtend(Expr e) {
+  Expr x = e->arg(0);
+  unsigned w = bv::width(e->arg(1));
+  if (width(x) == w)
+    return x;
+  // -- zext(zext(x)) = zext(x), sext(sext(x)) = sext(x)
+  if (x->op() == e->op())
+    return (*this)(m_efac.mkBin(e->op(), x->arg(0), e->arg(1)));
+  if (isOpX<BZEXT>(e)) {
+    unsigned xw = width(x);
+    if (xw == 0)
+      return e;
+    return (*this)(concat(mkNum(mpz_class(0UL), w - xw), x));
+  }
+  return e;
+}
+
+Expr BvRewriter::rwCompare(Expr e) {
+  Expr x = e->arg(0), y = e->arg(1);
+  if (x == y)
+    return mkBool(isOpX<BULE>(e) || isOpX<BUGE>(e) || isOpX<BSLE>(e) ||
+                  isOpX<BSGE>(e));
+  // -- 0 <= x, x < 0
+  if (isOpX<BULE>(e) && isBvNum(x) && toMpz(x).sgn() == 0)
+    return m_true;
+  if (isOpX<BULT>(e) && isBvNum(y) && toMpz(y).sgn() == 0)
+    return m_false;
+  return e;
+}
+
+/// The index i as base + offset, where offset is a numeral. base is
+/// null if i is a numeral.
+static std::pair<Expr, mpz_class> splitOffset(Expr i) {
+  if (isBvNum(i))
+    return {Expr(), toMpz(i)};
+  // -- canonical bvadd has its numeral first
+  if (isOpX<BADD>(i) && isBvNum(i->arg(0))) {
+    Expr base = i->arity() == 2
+                    ? Expr(i->arg(1))
+                    : mknary<BADD>(i->args_begin() + 1, i->args_end());
+    return {base, toMpz(i->arg(0))};
+  }
+  return {i, mpz_class(0UL)};
+}
+
+/// True if i and j are the same index, false if they are different, and
+/// none if that cannot be decided syntactically
+llvm::Optional<bool> BvRewriter::sameIndex(Expr i, Expr j) {
+  if (i == j)
+    return true;
+  if (isValue(i) && isValue(j))
+    return false;
+  auto si = splitOffset(i), sj = splitOffset(j);
+  if (si.first == sj.first)
+    return si.second == sj.second;
+  return llvm::None;
+}
+
+Expr BvRewriter::rwEq(Expr e) {
+  Expr x = e->left(), y = e->right();
+  if (x == y)
+    return m_true;
+  if (isValue(x) && isValue(y))
+    return m_false;
+  if (isBvNum(x) || isBvNum(y)) {
+    auto same = sameIndex(x, y);
+    if (same.hasValue())
+      return mkBool(*same);
+  } else if (isOpX<BADD>(x) && isOpX<BADD>(y)) {
+    auto same = sameIndex(x, y);
+    if (same.hasValue())
+      return mkBool(*same);
+  }
+
+  // -- ite(c, n1, n2) = n3
+  if (isOpX<ITE>(y) && isValue(x))
+    std::swap(x, y);
+  if (isOpX<ITE>(x) && isValue(y) && isValue(x->arg(1)) && isValue(x->arg(2)))
+    return (*this)(mk<ITE>(x->arg(0), mkBool(x->arg(1) == y),
+                           mkBool(x->arg(2) == y)));
+
+  // -- Boolean equality with a constant
+  if (isOpX<TRUE>(y))
+    return x;
+  if (isOpX<FALSE>(y))
+    return (*this)(mk<NEG>(x));
+  return e;
+}
+
+Expr BvRewriter::rwIte(Expr e) {
+  Expr c = e->arg(0), t = e->arg(1), f = e->arg(2);
+  if (isOpX<TRUE>(c) || t == f)
+    return t;
+  if (isOpX<FALSE>(c))
+    return f;
+  if (isOpX<NEG>(c))
+    return (*this)(mk<ITE>(c->arg(0), f, t));
+  if (isOpX<TRUE>(t) && isOpX<FALSE>(f))
+    return c;
+  if (isOpX<FALSE>(t) && isOpX<TRUE>(f))
+    return (*this)(mk<NEG>(c));
+  // -- ite(c, ite(c, a, b), d) = ite(c, a, d)
+  if (isOpX<ITE>(t) && t->arg(0) == c)
+    return (*this)(mk<ITE>(c, t->arg(1), f));
+  if (isOpX<ITE>(f) && f->arg(0) == c)
+    return (*this)(mk<ITE>(c, t, f->arg(2)));
+  return e;
+}
+
+Expr BvRewriter::rwBool(Expr e) {
+  if (isOpX<IFF>(e) && e->left() == e->right())
+    return m_true;
+  if (isOpX<AND>(e) || isOpX<OR>(e)) {
+    // -- drop units, stop at absorbing elements
+    Expr unit = isOpX<AND>(e) ? m_true : m_false;
+    Expr zero = isOpX<AND>(e) ? m_false : m_true;
+    ExprVector kids;
+    for (auto *a : llvm::make_range(e->args_begin(), e->args_end())) {
+      if (a == zero)
+        return zero;
+      if (a != unit && std::find(kids.begin(), kids.end(), a) == kids.end())
+        kids.push_back(a);
+    }
+    if (kids.empty())
+      return unit;
+    if (kids.size() == 1)
+      return kids[0];
+    if (kids.size() != e->arity())
+      e = m_efac.mkNary(e->op(), kids);
+  }
+  return m_bool(e);
+}
+
+/// Read-over-write: skips the stores to indices that are known to be
+/// different from the index that is read
+Expr BvRewriter::rwSelect(Expr e) {
+  Expr a = e->left(), j = e->right();
+  while (true) {
+    if (isOpX<CONST_ARRAY>(a))
+      return a->arg(1);
+    if (!isOpX<STORE>(a))
+      break;
+    auto same = sameIndex(a->arg(1), j);
+    if (!same.hasValue())
+      break;
+    if (*same)
+      return a->arg(2);
+    a = a->arg(0);
+  }
+  return a == e->left() ? e : mk<SELECT>(a, j);
+}
+
+/// store(store(a, i, v), i, w) = store(a, i, w), store(a, i, a[i]) = a
+Expr BvRewriter::rwStore(Expr e) {
+  Expr a = e->arg(0), i = e->arg(1), v = e->arg(2);
+  if (isOpX<SELECT>(v) && v->left() == a && v->right() == i)
+    return a;
+  if (isOpX<STORE>(a)) {
+    auto same = sameIndex(a->arg(1), i);
+    if (same.hasValue() && *same)
+      return (*this)(mk<STORE>(a->arg(0), i, v));
+  }
+  return e;
+}
+
+StaticVisitAction BvSimplifier::Visitor::operator()(Expr exp) const {
+  // -- numerals and constants are already in normal form
+  if (exp->arity() == 0 || isValue(exp) || bind::IsConst()(exp) ||
+      isOpX<FDECL>(exp) || isOpX<BIND>(exp))
+    return StaticVisitAction::skipKids();
+  return StaticVisitAction::doKidsRewrite();
+}
+
+Expr BvSimplifier::Visitor::rewrite(Expr exp) { return (*m_rw)(exp); }
+
+BvSimplifier::BvSimplifier(ExprFactory &efac)
+    : m_visitor{std::make_shared<BvRewriter>(efac)}, m_visit(m_visitor) {}
+
+BvSimplifier::~BvSimplifier() = default;
+
+void BvSimplifier::reset() { clearDagVisitCache(m_visit.m_cache); }
+} // namespace bv
+} // namespace op
+} // namespace expr
@@ -0,0 +1,161 @@
+/**
+ * Index of the constants of expressions. See ExprFreeVars.hh
+ */
+#include "seahorn/Expr/ExprFreeVars.hh"
+#include "seahorn/Expr/ExprVisitor.hh"
+
+#include <algorithm>
+
+namespace expr {
+using namespace op;
+
+namespace {
+/// true if a mutable node may occur in e. The structural summary of
+/// its ancestors may be stale
+bool mayHaveMutable(Expr e) {
+  return e->hasOpFamily(OpFamilyId::MutModelOp) ||
+         e->hasOpFamily(OpFamilyId::GateOp);
+}
+
+/// Replaces the keys of a map, and skips sub-expressions that cannot
+/// contain any key
+struct PrunedReplace : public std::unary_function<Expr, StaticVisitAction> {
+  const ExprMap &m_sub;
+  FreeVarIndex &m_idx;
+
+  // -- union of the signatures of the keys
+  FreeVarIndex::Signature m_sigs = 0;
+  // -- every key has a non-empty signature
+  bool m_allSig = true;
+  // -- every key has a bound variable
+  bool m_allBvars = true;
+  // -- operator families common to all keys
+  unsigned m_families = ~0u;
+  // -- smallest depth of a key
+  unsigned m_minDepth = ENode::MAX_DEPTH;
+
+  PrunedReplace(const ExprMap &sub, FreeVarIndex &idx)
+      : m_sub(sub), m_idx(idx) {
+    for (auto &kv : m_sub) {
+      Expr k = kv.first;
+      FreeVarIndex::Signature s = m_idx.signature(k);
+      m_sigs |= s;
+      m_allSig = m_allSig && s != 0;
+      m_allBvars = m_allBvars && k->hasBoundVar();
+      m_families &= k->opFamilies();
+      m_minDepth = std::min(m_minDepth, k->depth());
+    }
+  }
+
+  StaticVisitAction operator()(Expr exp) {
+    auto it = m_sub.find(exp);
+    if (it != m_sub.end())
+      return StaticVisitAction::changeTo(it->second);
+
+    if (mayHaveMutable(exp))
+      return StaticVisitAction::doKids();
+    // -- a key strictly below exp is shallower than exp
+    if (exp->depth() <= m_minDepth && exp->depth() < ENode::MAX_DEPTH)
+      return StaticVisitAction::skipKids();
+    if ((m_families & ~exp->opFamilies()) != 0)
+      return StaticVisitAction::skipKids();
+    if (m_allBvars && !exp->hasBoundVar())
+      return StaticVisitAction::skipKids();
+    if (m_allSig && (m_idx.signature(exp) & m_sigs) == 0)
+      return StaticVisitAction::skipKids();
+    return StaticVisitAction::doKids();
+  }
+};
+} // namespace
+
+FreeVarIndex::Signature FreeVarIndex::constSignature(Expr c) {
+  // -- Fibonacci hashing of the id picks one of the 64 bits
+  uint64_t h = static_cast<uint64_t>(c->getId()) * 0x9E3779B97F4A7C15ULL;
+  return Signature(1) << (h >> 58);
+}
+
+FreeVarIndex::Info &FreeVarIndex::info(Expr e) {
+  auto it = m_info.find(e);
+  if (it != m_info.end())
+    return it->second;
+
+  // -- iterative post-order so that deep expressions do not exhaust the
+  // -- stack. The flag is set once the kids of a node have been pushed
+  std::vector<std::pair<ENode *, bool>> stack;
+  stack.push_back({e.get(), false});
+  while (!stack.empty()) {
+    Expr n(stack.back().first);
+    if (m_info.count(n)) {
+      stack.pop_back();
+      continue;
+    }
+
+    if (bind::IsConst()(n)) {
+      m_info[n].sig = constSignature(n);
+      stack.pop_back();
+      continue;
+    }
+    if (n->arity() == 0 || bind::isFdecl(n)) {
+      m_info[n];
+      stack.pop_back();
+      continue;
+    }
+
+    if (!stack.back().second) {
+      stack.back().second = true;
+      for (ENode *a : *n)
+        if (!m_info.count(Expr(a)))
+          stack.push_back({a, false});
+      continue;
+    }
+
+    Signature sig = 0;
+    for (ENode *a : *n)
+      sig |= m_info.find(Expr(a))->second.sig;
+    m_info[n].sig = sig;
+    stack.pop_back();
+  }
+  return m_info[e];
+}
+
+FreeVarIndex::Signature FreeVarIndex::signature(Expr e) { return info(e).sig; }
+
+bool FreeVarIndex::mayContain(Expr e, Expr sub) {
+  if (e == sub)
+    return true;
+  if (mayHaveMutable(e))
+    return true;
+  if (sub->depth() >= e->depth() && e->depth() < ENode::MAX_DEPTH)
+    return false;
+  if ((sub->opFamilies() & ~e->opFamilies()) != 0)
+    return false;
+  if (sub->hasBoundVar() && !e->hasBoundVar())
+    return false;
+  return (signature(sub) & ~signature(e)) == 0;
+}
+
+const ExprVector &FreeVarIndex::vars(Expr e) {
+  Info &i = info(e);
+  if (!i.vars) {
+    std::unique_ptr<ExprVector> res(new ExprVector());
+    if (i.sig != 0) {
+      // -- all sub-expressions are indexed, so pruning does not insert
+      filter(
+          e, bind::IsConst(),
+          [this](Expr u) { return m_info.find(u)->second.sig == 0; },
+          std::back_inserter(*res));
+      std::sort(res->begin(), res->end());
+    }
+    i.vars = std::move(res);
+  }
+  return *i.vars;
+}
+
+Expr FreeVarIndex::replace(Expr e, const ExprMap &sub) {
+  if (sub.empty())
+    return e;
+  PrunedReplace rv(sub, *this);
+  return dagVisit(rv, e);
+}
+
+} // namespace expr
@@ -22,46 +22,41 @@ bool isMemArray(Expr exp) {
 MemCell::MemCell(Expr idx, Expr value, bool isRepeated)
     : m_pair(expr::numeric::convertToMpz(idx),
              expr::numeric::convertToMpz(value)),
-      m_isRepeated(isRepeated) {}
-
-bool MemCell::isSortable() const {
-  return expr::numeric::isNumeric(m_pair.first);
+      m_isRepeated(isRepeated) {
+  m_isNumeric = expr::numeric::getNum(m_pair.first, m_idxNum);
+  if (m_isNumeric && m_idxNum.sgn() >= 0 &&
+      mpz_sizeinbase(m_idxNum.get_mpz_t(), 2) <= 64) {
+    m_isSmall = true;
+    m_smallIdx = 0;
+    m_idxNum.mpzExport(&m_smallIdx, nullptr, -1, sizeof(m_smallIdx), 0, 0);
+  }
 }
 
-/// \note assumes that the index is numeric
-mpz_class MemCell::getIdxNum() const {
-  assert(expr::numeric::isNumeric(m_pair.first));
-  mpz_class returnValue = 0;
-  expr::numeric::getNum(m_pair.first, returnValue);
-
-  return returnValue;
+const std::string &MemCell::getIdxKeyStr() const {
+  if (m_idxStr.empty()) {
+    if (m_isNumeric) {
+      m_idxStr = m_idxNum.to_string(10);
+    } else {
+      std::stringstream ss;
+      ss << m_pair.first;
+      m_idxStr = ss.str();
+    }
+  }
+  return m_idxStr;
 }
 
-/// converts indices to strings. Compares first by string size and then
-/// lexicographically
+/// Compares the decimal (or printed) form of the indices, first by size
+/// and then lexicographically. For non-negative numbers this is the
+/// numeric order, so the strings are only built for the other indices
 bool MemCell::operator<(MemCell const &other) const {
-  mpz_class num1 = 0;
-  mpz_class num2 = 0;
-
-  std::string s1 = "";
-  std::string s2 = "";
-
-  if (expr::numeric::getNum(m_pair.first, num1)) {
-    s1 = num1.to_string(10);
-  } else {
-    std::stringstream ss;
-    ss << m_pair.first;
-    s1 = ss.str();
-  }
-
-  if (expr::numeric::getNum(other.m_pair.first, num2)) {
-    s2 = num2.to_string(10);
-  } else {
-    std::stringstream ss;
-    ss << other.m_pair.first;
-    s2 = ss.str();
-  }
-
+  if (m_isSmall && other.m_isSmall)
+    return m_smallIdx < other.m_smallIdx;
+  if (m_isNumeric && other.m_isNumeric && m_idxNum.sgn() >= 0 &&
+      other.m_idxNum.sgn() >= 0)
+    return m_idxNum < other.m_idxNum;
+
+  const std::string &s1 = getIdxKeyStr();
+  const std::string &s2 = other.getIdxKeyStr();
   if (s1.size() == s2.size()) {
     return s1 < s2;
   }
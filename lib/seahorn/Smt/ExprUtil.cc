@@ -50,6 +50,13 @@ unsigned circSize(const ExprVector &vec) {
 } // namespace op
 
 namespace {
+/// true if a mutable node (whose arguments can change after the
+/// summary of its parents was computed) may occur in e
+bool mayHaveMutable(Expr e) {
+  return e->hasOpFamily(OpFamilyId::MutModelOp) ||
+         e->hasOpFamily(OpFamilyId::GateOp);
+}
+
 struct SIZE : public std::unary_function<Expr, VisitAction> {
   size_t count;
 
@@ -77,6 +84,9 @@ size_t dagSize(const ExprVector &vec) {
 
 /** Size of an expression as a tree */
 size_t treeSize(Expr e) {
+  // -- the summary is exact unless saturated or stale below a mutable node
+  if (e->sizeBound() < UINT32_MAX && !mayHaveMutable(e))
+    return e->sizeBound();
   SIZE sz;
   treeVisit(sz, e);
   return sz.count;
@@ -107,6 +117,13 @@ struct CV : public std::unary_function<Expr, VisitAction> {
 
 /** Returns true if e1 contains e2 as a sub-expression */
 bool contains(Expr e1, Expr e2) {
+  if (e1 == e2)
+    return true;
+  // -- a sub-expression is shallower and its operators occur in e1
+  if (!mayHaveMutable(e1) &&
+      ((e2->depth() >= e1->depth() && e1->depth() < ENode::MAX_DEPTH) ||
+       (e2->opFamilies() & ~e1->opFamilies()) != 0))
+    return false;
   CV cv(e2);
   dagVisit(cv, e1);
   return cv.found;
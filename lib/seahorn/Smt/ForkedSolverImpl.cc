@@ -0,0 +1,466 @@
+#include "seahorn/Expr/Smt/ForkedSolverImpl.hh"
+
+#include "seahorn/Expr/ExprOpBinder.hh"
+#include "seahorn/Expr/ExprOpBv.hh"
+#include "seahorn/Expr/ExprVisitor.hh"
+#include "seahorn/Expr/Smt/Z3.hh"
+#include "seahorn/Expr/Smt/Z3SolverImpl.hh"
+#include "seahorn/Support/QueryStats.hh"
+#include "seahorn/Support/SeaLog.hh"
+#include "seahorn/Support/Stats.hh"
+
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace expr;
+
+namespace seahorn {
+namespace solver {
+
+namespace {
+using clock = std::chrono::steady_clock;
+
+/* A query given to a worker. Workers are forked so the vectors are
+   simply inherited. */
+struct Query {
+  const ExprVector *assertions;
+  const ExprVector *assumptions;
+  /* constants whose values are sent back when the query is sat */
+  const ExprVector *consts;
+};
+
+struct Answer {
+  SolverResult result = SolverResult::UNKNOWN;
+  std::vector<unsigned> core;
+  std::vector<std::pair<unsigned, Expr>> model;
+};
+
+/* A running worker */
+struct Worker {
+  unsigned id;
+  pid_t pid;
+  int fd;
+  clock::time_point deadline;
+  std::string out;
+};
+
+void writeAll(int fd, const std::string &s) {
+  const char *p = s.data();
+  size_t left = s.size();
+  while (left > 0) {
+    ssize_t n = ::write(fd, p, left);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return;
+    }
+    p += n;
+    left -= n;
+  }
+}
+
+/* Serialize a value of a model. Return false if it is not supported */
+bool writeValue(Expr v, std::ostream &o) {
+  unsigned w;
+  if (isOpX<TRUE>(v))
+    o << "b 1";
+  else if (isOpX<FALSE>(v))
+    o << "b 0";
+  else if (bv::isBvNum(v, w))
+    o << "v " << w << " " << bv::toMpz(v).to_string();
+  else if (isOpX<MPZ>(v))
+    o << "z " << getTerm<expr::mpz_class>(v).to_string();
+  else if (isOpX<MPQ>(v))
+    o << "q " << getTerm<expr::mpq_class>(v).to_string();
+  else
+    return false;
+  return true;
+}
+
+Expr readValue(std::istream &in, ExprFactory &efac) {
+  std::string kind, num;
+  in >> kind;
+  if (kind == "b") {
+    in >> num;
+    return num == "1" ? mk<TRUE>(efac) : mk<FALSE>(efac);
+  } else if (kind == "v") {
+    unsigned w;
+    in >> w >> num;
+    return bv::bvnum(expr::mpz_class(num), w, efac);
+  } else if (kind == "z") {
+    in >> num;
+    return mkTerm(expr::mpz_class(num), efac);
+  } else if (kind == "q") {
+    in >> num;
+    mpq_t q;
+    mpq_init(q);
+    mpq_set_str(q, num.c_str(), 10);
+    mpq_canonicalize(q);
+    Expr res = mkTerm(expr::mpq_class(q), efac);
+    mpq_clear(q);
+    return res;
+  }
+  return Expr();
+}
+
+/* Size (bytes) of the address space of this process, or 0 if unknown */
+size_t addressSpaceInUse() {
+  FILE *f = std::fopen("/proc/self/statm", "r");
+  if (!f)
+    return 0;
+  unsigned long pages = 0;
+  int n = std::fscanf(f, "%lu", &pages);
+  std::fclose(f);
+  if (n != 1)
+    return 0;
+  return static_cast<size_t>(pages) * ::sysconf(_SC_PAGESIZE);
+}
+
+/* Body of the worker process. Never returns. */
+[[noreturn]] void runWorker(int fd, ExprFactory &efac, const Query &q,
+                            const fork_limits &limits) {
+  if (limits.cpu > 0) {
+    struct rlimit rl;
+    rl.rlim_cur = limits.cpu;
+    rl.rlim_max = limits.cpu + 1;
+    setrlimit(RLIMIT_CPU, &rl);
+  }
+  if (limits.mem > 0) {
+    // -- the worker is a copy of the whole parent. The budget is for the
+    // -- query, so it comes on top of the address space already in use
+    size_t used = addressSpaceInUse();
+    if (used > 0) {
+      struct rlimit rl;
+      rl.rlim_cur = rl.rlim_max =
+          static_cast<rlim_t>(used) + (static_cast<rlim_t>(limits.mem) << 20);
+      setrlimit(RLIMIT_AS, &rl);
+    }
+  }
+  // -- the query is recorded by the parent
+  QueryStats::enable(false);
+
+  // -- a worker that fails (e.g., runs out of memory) exits abnormally
+  // -- and the parent answers unknown
+  std::ostringstream o;
+  z3_solver_impl s(efac);
+  for (Expr e : *q.assertions)
+    s.add(e);
+  SolverResult res = s.check_with_assumptions(
+      llvm::make_range(q.assumptions->cbegin(), q.assumptions->cend()));
+  if (res == SolverResult::SAT) {
+    o << "sat\n";
+    auto model = s.get_model();
+    for (unsigned i = 0, sz = q.consts->size(); i < sz; ++i) {
+      Expr v = model->eval((*q.consts)[i], false);
+      std::ostringstream vo;
+      if (writeValue(v, vo))
+        o << "m " << i << " " << vo.str() << "\n";
+    }
+  } else if (res == SolverResult::UNSAT) {
+    o << "unsat\n";
+    ExprVector core;
+    s.unsat_core(core);
+    for (Expr c : core) {
+      auto it = std::find(q.assumptions->begin(), q.assumptions->end(), c);
+      if (it != q.assumptions->end())
+        o << "c " << std::distance(q.assumptions->begin(), it) << "\n";
+    }
+  } else {
+    o << "unknown\n";
+  }
+  writeAll(fd, o.str());
+  ::close(fd);
+  // -- do not run destructors or atexit handlers of the parent
+  _exit(0);
+}
+
+bool spawn(unsigned id, ExprFactory &efac, const Query &q,
+           const fork_limits &limits, Worker &w) {
+  int fds[2];
+  if (::pipe(fds) != 0)
+    return false;
+
+  // -- do not let the worker inherit pending output
+  llvm::outs().flush();
+  llvm::errs().flush();
+  std::fflush(nullptr);
+
+  pid_t pid = ::fork();
+  if (pid < 0) {
+    ::close(fds[0]);
+    ::close(fds[1]);
+    return false;
+  }
+  if (pid == 0) {
+    ::close(fds[0]);
+    runWorker(fds[1], efac, q, limits);
+  }
+
+  ::close(fds[1]);
+  w.id = id;
+  w.pid = pid;
+  w.fd = fds[0];
+  w.deadline = limits.wall > 0 ? clock::now() + std::chrono::seconds(limits.wall)
+                               : clock::time_point::max();
+  w.out.clear();
+  return true;
+}
+
+Answer parse(const Worker &w, bool exited, ExprFactory &efac) {
+  Answer a;
+  if (!exited)
+    return a;
+
+  std::istringstream in(w.out);
+  std::string tag;
+  in >> tag;
+  if (tag == "sat")
+    a.result = SolverResult::SAT;
+  else if (tag == "unsat")
+    a.result = SolverResult::UNSAT;
+  else
+    return a;
+
+  while (in >> tag) {
+    unsigned i;
+    in >> i;
+    if (tag == "c") {
+      a.core.push_back(i);
+    } else if (tag == "m") {
+      Expr v = readValue(in, efac);
+      if (v)
+        a.model.push_back({i, v});
+    }
+  }
+  return a;
+}
+
+/* Run all queries in workers, at most jobs at a time */
+std::vector<Answer> runQueries(ExprFactory &efac,
+                               const std::vector<Query> &queries,
+                               const fork_limits &limits, unsigned jobs) {
+  std::vector<Answer> answers(queries.size());
+  std::vector<Worker> running;
+  unsigned next = 0;
+  jobs = std::max(jobs, 1u);
+
+  while (next < queries.size() || !running.empty()) {
+    while (next < queries.size() && running.size() < jobs) {
+      Worker w;
+      if (spawn(next, efac, queries[next], limits, w)) {
+        running.push_back(std::move(w));
+      } else {
+        WARN << "forked solver: cannot create worker process";
+        Stats::count("forked solver: failed to fork");
+      }
+      ++next;
+    }
+    if (running.empty())
+      continue;
+
+    // -- wait for output or for the earliest deadline
+    auto now = clock::now();
+    auto deadline = clock::time_point::max();
+    std::vector<struct pollfd> pfds;
+    for (auto &w : running) {
+      deadline = std::min(deadline, w.deadline);
+      pfds.push_back({w.fd, POLLIN, 0});
+    }
+    int timeout = -1;
+    if (deadline != clock::time_point::max()) {
+      auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - now)
+                    .count();
+      timeout = static_cast<int>(std::max<int64_t>(ms, 0));
+    }
+    int n = ::poll(pfds.data(), pfds.size(), timeout);
+    if (n < 0 && errno != EINTR) {
+      ERR << "forked solver: poll failed";
+      // -- give up on all workers
+      for (auto &w : running)
+        w.deadline = clock::time_point::min();
+    }
+
+    now = clock::now();
+    std::vector<Worker> still_running;
+    for (unsigned i = 0; i < running.size(); ++i) {
+      Worker &w = running[i];
+      bool eof = false;
+      if (n > 0 && (pfds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+        char buf[4096];
+        ssize_t r = ::read(w.fd, buf, sizeof(buf));
+        if (r > 0)
+          w.out.append(buf, r);
+        else if (r == 0 || errno != EINTR)
+          eof = true;
+      }
+
+      if (!eof && now < w.deadline) {
+        still_running.push_back(std::move(w));
+        continue;
+      }
+
+      ::close(w.fd);
+      if (!eof) {
+        ::kill(w.pid, SIGKILL);
+        Stats::count("forked solver: wall-clock limit reached");
+      }
+      int status = 0;
+      while (::waitpid(w.pid, &status, 0) < 0 && errno == EINTR)
+        ;
+      bool exited = eof && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+      if (eof && !exited) {
+        LOG("forked-solver",
+            WARN << "forked solver: worker terminated abnormally";);
+        Stats::count("forked solver: worker killed");
+      }
+      answers[w.id] = parse(w, exited, efac);
+    }
+    running.swap(still_running);
+  }
+  return answers;
+}
+
+/* Uninterpreted constants of a vector of formulas */
+void collectConsts(const ExprVector &es, ExprVector &out) {
+  ExprSet consts;
+  for (Expr e : es)
+    filter(e, bind::IsConst(), std::inserter(consts, consts.begin()));
+  out.assign(consts.begin(), consts.end());
+}
+} // namespace
+
+forked_solver_impl::forked_solver_impl(ExprFactory &efac, fork_limits limits)
+    : Solver(), m_efac(efac), m_limits(limits), m_frames(1),
+      m_last_result(SolverResult::UNKNOWN) {}
+
+bool forked_solver_impl::add(Expr exp) {
+  m_frames.back().push_back(exp);
+  return true;
+}
+
+SolverResult forked_solver_impl::check() {
+  ExprVector empty;
+  return check_with_assumptions(llvm::make_range(empty.cbegin(), empty.cend()));
+}
+
+SolverResult
+forked_solver_impl::check_with_assumptions(const expr_const_it_range &lits) {
+  ExprVector assertions;
+  for (auto &frame : m_frames)
+    assertions.insert(assertions.end(), frame.begin(), frame.end());
+  ExprVector assumptions(lits.begin(), lits.end());
+
+  ExprVector all(assertions);
+  all.insert(all.end(), assumptions.begin(), assumptions.end());
+  ExprVector consts;
+  collectConsts(all, consts);
+
+  Stats::resume("forked solver");
+  ScopedQuery sq("forked");
+  std::vector<Query> queries{{&assertions, &assumptions, &consts}};
+  Answer a = std::move(runQueries(m_efac, queries, m_limits, 1)[0]);
+  if (sq.active()) {
+    boost::tribool res = boost::indeterminate;
+    if (a.result == SolverResult::SAT)
+      res = true;
+    else if (a.result == SolverResult::UNSAT)
+      res = false;
+    sq.finish(res, assertions.size(), dagSize(all),
+              [this](llvm::raw_ostream &o) { to_smt_lib(o); });
+  }
+  Stats::stop("forked solver");
+
+  m_last_result = a.result;
+  m_last_core.clear();
+  for (unsigned i : a.core)
+    m_last_core.push_back(assumptions[i]);
+  m_last_model.clear();
+  for (auto &kv : a.model)
+    m_last_model[consts[kv.first]] = kv.second;
+  return m_last_result;
+}
+
+void forked_solver_impl::unsat_core(ExprVector &out) {
+  out.insert(out.end(), m_last_core.begin(), m_last_core.end());
+}
+
+void forked_solver_impl::push() { m_frames.emplace_back(); }
+
+void forked_solver_impl::pop() {
+  assert(m_frames.size() > 1);
+  m_frames.pop_back();
+}
+
+Solver::model_ref forked_solver_impl::get_model() {
+  assert(m_last_result == SolverResult::SAT);
+  return std::make_shared<forked_model_impl>(m_efac, m_last_model);
+}
+
+void forked_solver_impl::reset() {
+  m_frames.assign(1, ExprVector());
+  m_last_core.clear();
+  m_last_model.clear();
+  m_last_result = SolverResult::UNKNOWN;
+}
+
+void forked_solver_impl::to_smt_lib(llvm::raw_ostream &o) {
+  // -- only prints, no solving happens in this process
+  z3_solver_impl s(m_efac);
+  for (auto &frame : m_frames)
+    for (Expr e : frame)
+      s.add(e);
+  s.to_smt_lib(o);
+}
+
+forked_model_impl::forked_model_impl(ExprFactory &efac, ExprMap values)
+    : m_values(std::move(values)), m_zctx(new EZ3(efac)) {}
+
+forked_model_impl::~forked_model_impl() {}
+
+Expr forked_model_impl::eval(Expr e, bool complete) {
+  auto it = m_values.find(e);
+  if (it != m_values.end())
+    return it->second;
+  Expr res = replace(e, m_values);
+  if (res == e && bind::IsConst()(e))
+    return e;
+  return z3_simplify(*m_zctx, res);
+}
+
+void forked_model_impl::print(llvm::raw_ostream &o) const {
+  for (auto &kv : m_values)
+    o << *kv.first << " = " << *kv.second << "\n";
+}
+
+std::vector<SolverResult>
+forked_check_all(ExprFactory &efac, const std::vector<ExprVector> &queries,
+                 fork_limits limits, unsigned jobs) {
+  if (jobs == 0)
+    jobs = llvm::hardware_concurrency().compute_thread_count();
+
+  ExprVector none;
+  std::vector<Query> qs;
+  qs.reserve(queries.size());
+  for (auto &q : queries)
+    qs.push_back({&q, &none, &none});
+
+  std::vector<SolverResult> res;
+  for (auto &a : runQueries(efac, qs, limits, jobs))
+    res.push_back(a.result);
+  return res;
+}
+} // namespace solver
+} // namespace seahorn
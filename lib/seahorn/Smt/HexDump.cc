@@ -1,16 +1,78 @@
 #include "seahorn/Expr/HexDump.hh"
 
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/raw_os_ostream.h"
+
+#include <cstdint>
+
 namespace expr {
 namespace hexDump {
 
 /// puts in a specified amount of characters to the stream
 static void fillLeadingChars(char c, unsigned numChars,
-                             llvm::raw_string_ostream &stream) {
-  stream << std::string(numChars, c);
+                             llvm::raw_ostream &stream) {
+  for (unsigned i = 0; i < numChars; ++i)
+    stream << c;
+}
+
+/// number of hex digits of v, at least one
+static unsigned numHexDigits(uint64_t v) {
+  unsigned n = 1;
+  while (v >>= 4)
+    ++n;
+  return n;
+}
+
+/// writes v in lower case hex, padded with zeroes to minDigits
+static void writeHex(uint64_t v, unsigned minDigits,
+                     llvm::raw_ostream &stream) {
+  char buf[16];
+  unsigned n = numHexDigits(v);
+  for (unsigned i = n; i > 0; --i, v >>= 4)
+    buf[i - 1] = "0123456789abcdef"[v & 0xf];
+  if (n < minDigits)
+    fillLeadingChars('0', minDigits - n, stream);
+  stream.write(buf, n);
+}
+
+/// \return true and the value of exp in v if exp is a non-negative
+/// number that fits in 64 bits
+static bool getSmallNum(Expr exp, uint64_t &v) {
+  if (!isOp<MPZ>(exp))
+    return false;
+  const mpz_class &num = getTerm<mpz_class>(exp);
+  if (num.sgn() < 0 || mpz_sizeinbase(num.get_mpz_t(), 2) > 64)
+    return false;
+  v = 0;
+  mpz_export(&v, nullptr, -1, sizeof(v), 0, 0, num.get_mpz_t());
+  return true;
+}
+
+static void writeBytes(llvm::ArrayRef<uint8_t> bytes, bool includeAscii,
+                       llvm::raw_ostream &stream) {
+  if (includeAscii) {
+    stream << format_bytes_with_ascii(bytes, None, bytes.size(), 1, 0, false);
+  } else {
+    stream << format_bytes(bytes, None, bytes.size(), 1, 0, false);
+  }
 }
 
 void getContentStr(Expr value, unsigned desiredNumBytes, bool includeAscii,
-                   llvm::raw_string_ostream &stream) {
+                   llvm::raw_ostream &stream) {
+  uint64_t small;
+  if (getSmallNum(value, small)) {
+    // -- fast path: bytes of the value, most significant first
+    unsigned numBytes = (numHexDigits(small) + 1) / 2;
+    if (desiredNumBytes < numBytes)
+      desiredNumBytes = numBytes;
+
+    llvm::SmallVector<uint8_t, 16> bytes(desiredNumBytes, 0);
+    for (unsigned i = 0; i < numBytes; ++i)
+      bytes[desiredNumBytes - 1 - i] = (small >> (8 * i)) & 0xff;
+    writeBytes(bytes, includeAscii, stream);
+    return;
+  }
+
   mpz_class num = 0;
   if (expr::numeric::getNum(value, num)) {
 
@@ -22,31 +84,27 @@ void getContentStr(Expr value, unsigned desiredNumBytes, bool includeAscii,
       desiredNumBytes = numBytes;
     }
 
-    std::vector<uint8_t> bytes(desiredNumBytes);
-
-    // fill in the leading zeroesi
-    for (unsigned i = 0; i < (desiredNumBytes - numBytes); i++) {
-      bytes[i] = 0;
-    }
+    // leading bytes are zero
+    std::vector<uint8_t> bytes(desiredNumBytes, 0);
 
     // populate bytes with every byte that is in the number
     num.mpzExport(&bytes[desiredNumBytes - numBytes], nullptr, 1, 1, 1,
                   0); // 1:most sig word first, 1 byte/word, 1: each byte has
                       // most sig byte first, 0: nails bit unused
 
-    if (includeAscii) {
-      stream << format_bytes_with_ascii(bytes, None, desiredNumBytes, 1, 0,
-                                        false);
-    } else {
-      stream << format_bytes(bytes, None, desiredNumBytes, 1, 0, false);
-    }
+    writeBytes(bytes, includeAscii, stream);
   } else {
     stream << *value;
   }
 }
 
-void getIdxStr(Expr idx, unsigned desiredNumBytes,
-               llvm::raw_string_ostream &stream) {
+void getIdxStr(Expr idx, unsigned desiredNumBytes, llvm::raw_ostream &stream) {
+  uint64_t small;
+  if (getSmallNum(idx, small)) {
+    writeHex(small, desiredNumBytes * 2, stream);
+    return;
+  }
+
   mpz_class num = 0;
 
   if (expr::numeric::getNum(idx, num)) {
@@ -65,11 +123,13 @@ void getIdxStr(Expr idx, unsigned desiredNumBytes,
   }
 }
 
-void getCellStr(const MemCell &cell, llvm::raw_string_ostream &stream,
+void getCellStr(const MemCell &cell, llvm::raw_ostream &stream,
                 size_t idWidth, size_t contentWidth, bool includeAscii,
                 bool isDefault) {
   if (isDefault) {
     stream << "*";
+  } else if (cell.hasSmallIdx()) {
+    writeHex(cell.getSmallIdx(), idWidth * 2, stream);
   } else {
     getIdxStr(cell.getIdxExpr(), idWidth, stream);
   }
@@ -93,27 +153,55 @@ void HexDump::fillInGaps() {
     return;
 
   size_t gapSize = m_cells.isAligned() ? m_cells.getContentWidth() : 1;
+  Expr defaultVal = m_cells.getDefault();
+  ExprFactory &efac = defaultVal->efac();
   // go through IDed values
   for (auto b = m_cells.cbegin(); b != std::prev(m_cells.cend()); b++) {
-    mpz_class idx1 = (*b).getIdxNum();
-    mpz_class idx2 = (*std::next(b)).getIdxNum();
-
-    // if there is a gap in indices then fill the gap with the default value
-    if ((idx2 > (idx1 + gapSize)) && !(*b).isRepeated()) {
-
-      bool repeats =
-          idx2 > (idx1 + (gapSize * 2)); // if the gap is more than double,
-                                         // then the default value is repeated
+    if (b->isRepeated())
+      continue;
+    auto n = std::next(b);
+
+    bool gap, repeats;
+    if (b->hasSmallIdx() && n->hasSmallIdx() &&
+        b->getSmallIdx() <= UINT64_MAX - 2 * gapSize) {
+      uint64_t idx1 = b->getSmallIdx();
+      uint64_t idx2 = n->getSmallIdx();
+      gap = idx2 > idx1 + gapSize;
+      repeats = idx2 > idx1 + gapSize * 2;
+    } else {
+      mpz_class idx1 = b->getIdxNum();
+      const mpz_class &idx2 = n->getIdxNum();
+      gap = idx2 > (idx1 + gapSize);
+      repeats = idx2 > (idx1 + (gapSize * 2));
+    }
 
-      Expr defaultID =
-          mkTerm<mpz_class>(idx1 + gapSize, (*b).getIdxExpr()->efac());
-      Expr defaultVal = m_cells.getDefault();
+    // if there is a gap in indices then fill the gap with the default value.
+    // If the gap is more than double, then the default value is repeated
+    if (gap) {
+      mpz_class defaultIdx = b->getIdxNum();
+      Expr defaultID = mkTerm<mpz_class>(defaultIdx + gapSize, efac);
       m_cells.insert(defaultID, defaultVal, repeats);
       b = std::next(b);
     }
   }
 }
 
+void HexDump::printCells(llvm::raw_ostream &OS, bool includeAscii) const {
+  // -- cells are written as they are formatted; the dump of a large
+  // -- memory is never materialized as a single string
+  for (auto b = m_cells.cbegin(); b != m_cells.cend(); b++) {
+    getCellStr(*b, OS, m_cells.getIdWidth(), m_cells.getContentWidth(),
+               includeAscii);
+    if (b->isRepeated())
+      OS << "*\n";
+  }
+}
+
+void HexDump::printCells(std::ostream &OS, bool includeAscii) const {
+  llvm::raw_os_ostream ros(OS);
+  printCells(ros, includeAscii);
+}
+
 template <typename T> void HexDump::print(T &OS, bool includeAscii) const {
   if (!isValid()) {
     // expr is not readable by visitor
@@ -121,16 +209,7 @@ template <typename T> void HexDump::print(T &OS, bool includeAscii) const {
     return;
   }
 
-  std::string s("");
-  llvm::raw_string_ostream stream(s);
-
-  for (auto b = m_cells.cbegin(); b != m_cells.cend(); b++) {
-    getCellStr(*b, stream, m_cells.getIdWidth(), m_cells.getContentWidth(),
-               includeAscii);
-    if (b->isRepeated())
-      stream << "*\n";
-  }
-  OS << stream.str();
+  printCells(OS, includeAscii);
 }
 
 std::ostream &operator<<(std::ostream &OS, HexDump const &hd) {
@@ -0,0 +1,294 @@
+#include "seahorn/Expr/Smt/SatSolverImpl.hh"
+#include "Cdcl.hh"
+
+#include "seahorn/Expr/ExprOpBool.hh"
+#include "seahorn/Expr/ExprVisitor.hh"
+#include "seahorn/Expr/Smt/SmtLibWriter.hh"
+#include "seahorn/Support/SeaLog.hh"
+
+#include "llvm/Support/raw_ostream.h"
+
+using namespace expr;
+
+namespace seahorn {
+namespace solver {
+
+/* Syntactically Boolean: enough to encode equalities as IFF */
+static bool isBoolean(Expr e) {
+  return isOp<BoolOp>(e) || isOp<CompareOp>(e) || bind::isBoolConst(e);
+}
+
+sat_solver_impl::sat_solver_impl(ExprFactory &efac)
+    : Solver(), m_efac(efac), m_true_lit(0),
+      m_last_result(SolverResult::UNKNOWN) {
+  init();
+}
+
+sat_solver_impl::~sat_solver_impl() {}
+
+void sat_solver_impl::init() {
+  m_sat = std::make_unique<sat::Cdcl>();
+  m_lits.clear();
+  m_atoms.clear();
+  m_scopes.clear();
+  m_assertions.clear();
+  m_scope_sizes.clear();
+  m_last_assumptions.clear();
+  m_last_result = SolverResult::UNKNOWN;
+  m_true_lit = newLit(Expr());
+  m_sat->addClause({m_true_lit});
+}
+
+unsigned sat_solver_impl::newLit(Expr atom) {
+  sat::Var v = m_sat->newVar();
+  m_atoms.push_back(atom);
+  assert(m_atoms.size() == m_sat->numVars());
+  return sat::mkLit(v);
+}
+
+void sat_solver_impl::addClause(std::vector<unsigned> lits) {
+  m_sat->addClause(std::move(lits));
+}
+
+unsigned sat_solver_impl::encode(Expr e) {
+  auto it = m_lits.find(e);
+  if (it != m_lits.end())
+    return it->second;
+
+  unsigned res;
+  if (isOpX<TRUE>(e)) {
+    res = m_true_lit;
+  } else if (isOpX<FALSE>(e)) {
+    res = sat::negate(m_true_lit);
+  } else if (isOpX<NEG>(e)) {
+    res = sat::negate(encode(e->left()));
+  } else if (isOpX<AND>(e) || isOpX<OR>(e)) {
+    // -- OR(a1..an) is encoded as NEG(AND(NEG(a1)..NEG(an)))
+    bool is_or = isOpX<OR>(e);
+    std::vector<unsigned> args;
+    args.reserve(e->arity());
+    for (auto arg : llvm::make_range(e->args_begin(), e->args_end())) {
+      unsigned l = encode(arg);
+      args.push_back(is_or ? sat::negate(l) : l);
+    }
+    unsigned x = newLit(Expr());
+    std::vector<unsigned> big{x};
+    for (unsigned l : args) {
+      addClause({sat::negate(x), l});
+      big.push_back(sat::negate(l));
+    }
+    addClause(std::move(big));
+    res = is_or ? sat::negate(x) : x;
+  } else if (isOpX<IMPL>(e)) {
+    unsigned a = encode(e->left());
+    unsigned b = encode(e->right());
+    unsigned x = newLit(Expr());
+    addClause({sat::negate(x), sat::negate(a), b});
+    addClause({x, a});
+    addClause({x, sat::negate(b)});
+    res = x;
+  } else if (isOpX<IFF>(e) || isOpX<XOR>(e) ||
+             (isOpX<EQ>(e) &&
+              (isBoolean(e->left()) || isBoolean(e->right())))) {
+    unsigned a = encode(e->left());
+    unsigned b = encode(e->right());
+    unsigned x = newLit(Expr());
+    addClause({sat::negate(x), sat::negate(a), b});
+    addClause({sat::negate(x), a, sat::negate(b)});
+    addClause({x, a, b});
+    addClause({x, sat::negate(a), sat::negate(b)});
+    res = isOpX<XOR>(e) ? sat::negate(x) : x;
+  } else if (isOpX<ITE>(e) && isBoolean(e->arg(1))) {
+    unsigned c = encode(e->arg(0));
+    unsigned t = encode(e->arg(1));
+    unsigned f = encode(e->arg(2));
+    unsigned x = newLit(Expr());
+    addClause({sat::negate(x), sat::negate(c), t});
+    addClause({sat::negate(x), c, f});
+    addClause({x, sat::negate(c), sat::negate(t)});
+    addClause({x, c, sat::negate(f)});
+    res = x;
+  } else {
+    // -- Boolean constants and any other (theory) atom
+    res = newLit(e);
+  }
+
+  m_lits.insert({e, res});
+  return res;
+}
+
+bool sat_solver_impl::add(Expr exp) {
+  m_assertions.push_back(exp);
+  unsigned l = encode(exp);
+  if (m_scopes.empty())
+    addClause({l});
+  else
+    addClause({sat::negate(m_scopes.back()), l});
+  return true;
+}
+
+SolverResult sat_solver_impl::check() {
+  ExprVector empty;
+  return check_with_assumptions(llvm::make_range(empty.cbegin(), empty.cend()));
+}
+
+SolverResult
+sat_solver_impl::check_with_assumptions(const expr_const_it_range &lits) {
+  m_last_assumptions.clear();
+  std::vector<unsigned> assumptions(m_scopes.begin(), m_scopes.end());
+  for (Expr e : lits) {
+    unsigned l = encode(e);
+    assumptions.push_back(l);
+    m_last_assumptions.insert({l, e});
+  }
+
+  switch (m_sat->solve(assumptions)) {
+  case sat::LBool::TRUE:
+    m_last_result = SolverResult::SAT;
+    break;
+  case sat::LBool::FALSE:
+    m_last_result = SolverResult::UNSAT;
+    break;
+  default:
+    m_last_result = SolverResult::UNKNOWN;
+  }
+  return m_last_result;
+}
+
+void sat_solver_impl::unsat_core(ExprVector &out) {
+  for (unsigned l : m_sat->failedAssumptions()) {
+    auto it = m_last_assumptions.find(l);
+    // -- skip activation literals
+    if (it != m_last_assumptions.end())
+      out.push_back(it->second);
+  }
+}
+
+void sat_solver_impl::push() {
+  m_scopes.push_back(newLit(Expr()));
+  m_scope_sizes.push_back(m_assertions.size());
+}
+
+void sat_solver_impl::pop() {
+  if (m_scopes.empty())
+    return;
+  m_assertions.resize(m_scope_sizes.back());
+  m_scope_sizes.pop_back();
+  // -- permanently disable all clauses guarded by the scope
+  addClause({sat::negate(m_scopes.back())});
+  m_scopes.pop_back();
+}
+
+Solver::model_ref sat_solver_impl::get_model() {
+  ExprMap values;
+  if (m_last_result == SolverResult::SAT) {
+    for (unsigned v = 0, sz = m_atoms.size(); v < sz; ++v) {
+      Expr atom = m_atoms[v];
+      if (!atom)
+        continue;
+      sat::LBool val = m_sat->modelValue(v);
+      if (val == sat::LBool::UNDEF)
+        continue;
+      values[atom] = val == sat::LBool::TRUE ? mk<TRUE>(m_efac)
+                                             : mk<FALSE>(m_efac);
+    }
+  }
+  return std::make_shared<sat_model_impl>(std::move(values));
+}
+
+void sat_solver_impl::reset() { init(); }
+
+void sat_solver_impl::to_smt_lib(llvm::raw_ostream &o) {
+  // -- atoms that cannot be written are abstracted, like in the solver
+  ExprMap abstraction;
+  for (Expr atom : m_atoms) {
+    if (atom && !bind::isBoolConst(atom) && !SmtLibWriter::isSupported(atom)) {
+      Expr name = mkTerm<std::string>(
+          "sat.atom!" + std::to_string(abstraction.size()), m_efac);
+      abstraction[atom] = bind::boolConst(name);
+    }
+  }
+
+  ExprVector assertions;
+  assertions.reserve(m_assertions.size());
+  for (Expr e : m_assertions)
+    assertions.push_back(abstraction.empty() ? e : replace(e, abstraction));
+
+  SmtLibWriter writer(o);
+  ExprSet declared;
+  for (Expr e : assertions) {
+    ExprVector consts;
+    filter(e, bind::IsConst(), std::back_inserter(consts));
+    for (Expr c : consts) {
+      Expr fdecl = bind::fname(c);
+      if (declared.insert(fdecl).second) {
+        writer.writeDeclareFun(fdecl);
+        o << "\n";
+      }
+    }
+  }
+  for (Expr e : assertions)
+    writer.writeAssert(e);
+  o << "(check-sat)\n";
+}
+
+Expr sat_model_impl::evalRec(Expr e, bool complete, ExprMap &cache) {
+  auto vit = m_values.find(e);
+  if (vit != m_values.end())
+    return vit->second;
+  auto cit = cache.find(e);
+  if (cit != cache.end())
+    return cit->second;
+
+  Expr res = e;
+  if (bind::isBoolConst(e)) {
+    if (complete)
+      res = mk<FALSE>(e->efac());
+  } else if (isOpX<NEG>(e)) {
+    res = op::boolop::lneg(evalRec(e->left(), complete, cache));
+  } else if (isOpX<AND>(e) || isOpX<OR>(e)) {
+    bool is_and = isOpX<AND>(e);
+    res = is_and ? mk<TRUE>(e->efac()) : mk<FALSE>(e->efac());
+    for (auto arg : llvm::make_range(e->args_begin(), e->args_end())) {
+      Expr v = evalRec(arg, complete, cache);
+      res = is_and ? op::boolop::land(res, v) : op::boolop::lor(res, v);
+    }
+  } else if (isOpX<IMPL>(e)) {
+    res = op::boolop::limp(evalRec(e->left(), complete, cache),
+                           evalRec(e->right(), complete, cache));
+  } else if (isOpX<ITE>(e)) {
+    Expr c = evalRec(e->arg(0), complete, cache);
+    if (isOpX<TRUE>(c))
+      res = evalRec(e->arg(1), complete, cache);
+    else if (isOpX<FALSE>(c))
+      res = evalRec(e->arg(2), complete, cache);
+  } else if (isOpX<IFF>(e) || isOpX<XOR>(e) ||
+             (isOpX<EQ>(e) &&
+              (isBoolean(e->left()) || isBoolean(e->right())))) {
+    Expr a = evalRec(e->left(), complete, cache);
+    Expr b = evalRec(e->right(), complete, cache);
+    if ((isOpX<TRUE>(a) || isOpX<FALSE>(a)) &&
+        (isOpX<TRUE>(b) || isOpX<FALSE>(b))) {
+      bool eq = isOpX<TRUE>(a) == isOpX<TRUE>(b);
+      if (isOpX<XOR>(e))
+        eq = !eq;
+      res = eq ? mk<TRUE>(e->efac()) : mk<FALSE>(e->efac());
+    }
+  }
+
+  cache[e] = res;
+  return res;
+}
+
+Expr sat_model_impl::eval(Expr expr, bool complete) {
+  ExprMap cache;
+  return evalRec(expr, complete, cache);
+}
+
+void sat_model_impl::print(llvm::raw_ostream &o) const {
+  for (auto &kv : m_values)
+    o << *kv.first << " = " << *kv.second << "\n";
+}
+
+} // namespace solver
+} // namespace seahorn
@@ -0,0 +1,1177 @@
+#include "seahorn/Expr/Smt/SmtLibParser.hh"
+#include "seahorn/Expr/ExprOpBinder.hh"
+#include "seahorn/Expr/TypeChecker.hh"
+
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "boost/functional/hash.hpp"
+
+#include <cctype>
+#include <cstring>
+#include <unordered_map>
+
+using namespace expr;
+
+namespace {
+enum class Tok {
+  LPAR,
+  RPAR,
+  SYMBOL,
+  KEYWORD,
+  NUMERAL,
+  DECIMAL,
+  HEX,
+  BIN,
+  STR,
+  END
+};
+
+struct Token {
+  Tok kind;
+  /* contents, without quotes and prefixes */
+  llvm::StringRef text;
+};
+
+/// SMT-LIB2 tokenizer with one token of look-ahead.
+///
+/// Also holds the first error of the parse. After an error, only END
+/// tokens are returned so that every loop over the input stops.
+class Lexer {
+  llvm::StringRef m_buf;
+  size_t m_pos = 0;
+  unsigned m_line = 1;
+  bool m_has_peek = false;
+  Token m_peek;
+  std::string m_error;
+
+  static bool isSymbolChar(char c) {
+    return std::isalnum(c) || std::strchr("~!@$%^&*_-+=<>.?/", c) != nullptr;
+  }
+
+  void skipSpace() {
+    while (m_pos < m_buf.size()) {
+      char c = m_buf[m_pos];
+      if (c == '\n') {
+        ++m_line;
+        ++m_pos;
+      } else if (std::isspace(c))
+        ++m_pos;
+      else if (c == ';') {
+        while (m_pos < m_buf.size() && m_buf[m_pos] != '\n')
+          ++m_pos;
+      } else
+        break;
+    }
+  }
+
+  /// the token ends at the first character that does not satisfy p
+  template <typename P> llvm::StringRef scan(size_t start, P p) {
+    while (m_pos < m_buf.size() && p(m_buf[m_pos]))
+      ++m_pos;
+    return m_buf.slice(start, m_pos);
+  }
+
+  /// scans until the closing delimiter d, counting lines
+  llvm::StringRef scanUntil(char d) {
+    size_t start = m_pos;
+    while (m_pos < m_buf.size() && m_buf[m_pos] != d) {
+      if (m_buf[m_pos] == '\n')
+        ++m_line;
+      ++m_pos;
+    }
+    if (m_pos >= m_buf.size()) {
+      fail("unterminated literal");
+      return llvm::StringRef();
+    }
+    return m_buf.slice(start, m_pos++);
+  }
+
+  /// a literal made of the digits that satisfy p
+  template <typename P> Token digits(Tok kind, size_t start, P p) {
+    llvm::StringRef text = scan(start, p);
+    if (text.empty()) {
+      fail("bad literal");
+      return {Tok::END, ""};
+    }
+    return {kind, text};
+  }
+
+  Token lex() {
+    if (failed())
+      return {Tok::END, ""};
+    skipSpace();
+    if (m_pos >= m_buf.size())
+      return {Tok::END, ""};
+    size_t start = m_pos;
+    char c = m_buf[m_pos++];
+    switch (c) {
+    case '(':
+      return {Tok::LPAR, "("};
+    case ')':
+      return {Tok::RPAR, ")"};
+    case '|': {
+      llvm::StringRef text = scanUntil('|');
+      if (failed())
+        return {Tok::END, ""};
+      return {Tok::SYMBOL, text};
+    }
+    case '"':
+      // -- "" is an escaped quote inside a string
+      scanUntil('"');
+      while (!failed() && m_pos < m_buf.size() && m_buf[m_pos] == '"') {
+        ++m_pos;
+        scanUntil('"');
+      }
+      if (failed())
+        return {Tok::END, ""};
+      return {Tok::STR, m_buf.slice(start + 1, m_pos - 1)};
+    case ':':
+      return {Tok::KEYWORD, scan(start + 1, isSymbolChar)};
+    case '#':
+      if (m_pos < m_buf.size() && m_buf[m_pos] == 'x') {
+        ++m_pos;
+        return digits(Tok::HEX, start + 2,
+                      [](char c) { return std::isxdigit(c); });
+      }
+      if (m_pos < m_buf.size() && m_buf[m_pos] == 'b') {
+        ++m_pos;
+        return digits(Tok::BIN, start + 2,
+                      [](char c) { return c == '0' || c == '1'; });
+      }
+      fail("bad literal");
+      return {Tok::END, ""};
+    default:
+      break;
+    }
+    if (std::isdigit(c)) {
+      scan(start, [](char c) { return std::isdigit(c); });
+      if (m_pos < m_buf.size() && m_buf[m_pos] == '.') {
+        ++m_pos;
+        return {Tok::DECIMAL,
+                scan(start, [](char c) { return std::isdigit(c); })};
+      }
+      return {Tok::NUMERAL, m_buf.slice(start, m_pos)};
+    }
+    if (isSymbolChar(c))
+      return {Tok::SYMBOL, scan(start, isSymbolChar)};
+    fail(std::string("unexpected character '") + c + "'");
+    return {Tok::END, ""};
+  }
+
+public:
+  void reset(llvm::StringRef buf) {
+    m_buf = buf;
+    m_pos = 0;
+    m_line = 1;
+    m_has_peek = false;
+    m_error.clear();
+  }
+
+  /// records msg unless an earlier error was recorded
+  void fail(const std::string &msg) {
+    if (failed())
+      return;
+    m_error = "line " + std::to_string(m_line) + ": " + msg;
+    m_has_peek = false;
+  }
+  bool failed() const { return !m_error.empty(); }
+  const std::string &error() const { return m_error; }
+
+  const Token &peek() {
+    if (!m_has_peek) {
+      m_peek = lex();
+      m_has_peek = true;
+    }
+    return m_peek;
+  }
+  bool peekIs(Tok k) { return peek().kind == k; }
+
+  Token next() {
+    if (m_has_peek) {
+      m_has_peek = false;
+      return m_peek;
+    }
+    return lex();
+  }
+};
+
+enum class Builtin {
+  NONE,
+  NOT,
+  AND,
+  OR,
+  XOR,
+  IMPL,
+  ITE,
+  EQ,
+  DISTINCT,
+  PLUS,
+  MINUS,
+  MULT,
+  DIV,
+  IDIV,
+  MOD,
+  REM,
+  ABS,
+  LT,
+  LEQ,
+  GT,
+  GEQ,
+  SELECT,
+  STORE,
+  CONCAT,
+  BNOT,
+  BNEG,
+  BAND,
+  BOR,
+  BXOR,
+  BNAND,
+  BNOR,
+  BXNOR,
+  BADD,
+  BSUB,
+  BMUL,
+  BUDIV,
+  BSDIV,
+  BUREM,
+  BSREM,
+  BSMOD,
+  BSHL,
+  BLSHR,
+  BASHR,
+  BULT,
+  BSLT,
+  BULE,
+  BSLE,
+  BUGT,
+  BSGT,
+  BUGE,
+  BSGE
+};
+
+Builtin builtin(llvm::StringRef name) {
+  return llvm::StringSwitch<Builtin>(name)
+      .Case("not", Builtin::NOT)
+      .Case("and", Builtin::AND)
+      .Case("or", Builtin::OR)
+      .Case("xor", Builtin::XOR)
+      .Case("=>", Builtin::IMPL)
+      .Case("ite", Builtin::ITE)
+      .Case("=", Builtin::EQ)
+      .Case("distinct", Builtin::DISTINCT)
+      .Case("+", Builtin::PLUS)
+      .Case("-", Builtin::MINUS)
+      .Case("*", Builtin::MULT)
+      .Case("/", Builtin::DIV)
+      .Case("div", Builtin::IDIV)
+      .Case("mod", Builtin::MOD)
+      .Case("rem", Builtin::REM)
+      .Case("abs", Builtin::ABS)
+      .Case("<", Builtin::LT)
+      .Case("<=", Builtin::LEQ)
+      .Case(">", Builtin::GT)
+      .Case(">=", Builtin::GEQ)
+      .Case("select", Builtin::SELECT)
+      .Case("store", Builtin::STORE)
+      .Case("concat", Builtin::CONCAT)
+      .Case("bvnot", Builtin::BNOT)
+      .Case("bvneg", Builtin::BNEG)
+      .Case("bvand", Builtin::BAND)
+      .Case("bvor", Builtin::BOR)
+      .Case("bvxor", Builtin::BXOR)
+      .Case("bvnand", Builtin::BNAND)
+      .Case("bvnor", Builtin::BNOR)
+      .Case("bvxnor", Builtin::BXNOR)
+      .Case("bvadd", Builtin::BADD)
+      .Case("bvsub", Builtin::BSUB)
+      .Case("bvmul", Builtin::BMUL)
+      .Case("bvudiv", Builtin::BUDIV)
+      .Case("bvsdiv", Builtin::BSDIV)
+      .Case("bvurem", Builtin::BUREM)
+      .Case("bvsrem", Builtin::BSREM)
+      .Case("bvsmod", Builtin::BSMOD)
+      .Case("bvshl", Builtin::BSHL)
+      .Case("bvlshr", Builtin::BLSHR)
+      .Case("bvashr", Builtin::BASHR)
+      .Case("bvult", Builtin::BULT)
+      .Case("bvslt", Builtin::BSLT)
+      .Case("bvule", Builtin::BULE)
+      .Case("bvsle", Builtin::BSLE)
+      .Case("bvugt", Builtin::BUGT)
+      .Case("bvsgt", Builtin::BSGT)
+      .Case("bvuge", Builtin::BUGE)
+      .Case("bvsge", Builtin::BSGE)
+      .Default(Builtin::NONE);
+}
+
+/// a term that is being parsed, waiting for its sub-terms
+struct Frame {
+  enum Kind { APP, LET, BINDER, ANNOT } kind;
+  /* APP: name of the function and indices of (_ f i j) */
+  std::string head;
+  std::vector<unsigned> indices;
+  /* APP: sort of (as const S) */
+  Expr sort;
+  ExprVector args;
+  /* LET: bindings parsed so far, name of the one being parsed */
+  std::vector<std::pair<std::string, Expr>> binds;
+  std::string pending;
+  bool inBody = false;
+  /* BINDER: quantifier and bound variables */
+  bool forall = false, lambda = false;
+  ExprVector vars;
+
+  Frame(Kind k) : kind(k) {}
+};
+
+/// left-associative fold of a binary operator
+template <typename Op> Expr foldLeft(const ExprVector &args) {
+  Expr res = args[0];
+  for (unsigned i = 1, sz = args.size(); i < sz; ++i)
+    res = mk<Op>(res, args[i]);
+  return res;
+}
+
+/// chainable operator: (op a b c) is (and (op a b) (op b c))
+template <typename Op> Expr chain(const ExprVector &args) {
+  if (args.size() == 2)
+    return mk<Op>(args[0], args[1]);
+  ExprVector conj;
+  for (unsigned i = 0, sz = args.size(); i + 1 < sz; ++i)
+    conj.push_back(mk<Op>(args[i], args[i + 1]));
+  return mknary<AND>(conj);
+}
+} // namespace
+
+namespace seahorn {
+
+class SmtLibParser::Impl {
+  ExprFactory &m_efac;
+  TypeChecker m_tc;
+  Lexer m_lex;
+
+  std::string m_error;
+  std::string m_logic;
+  ExprVector m_decls;
+  ExprVector m_rels;
+  std::vector<Assertion> m_assertions;
+  ExprVector m_queries;
+
+  /* declared functions (fdecl) by name */
+  std::unordered_map<std::string, Expr> m_funs;
+  /* macros of define-fun */
+  struct Macro {
+    ExprVector params;
+    Expr body;
+  };
+  std::unordered_map<std::string, Macro> m_macros;
+  /* variables of declare-var, in order */
+  ExprVector m_vars;
+
+  /* names bound by let, quantifiers and define-fun, innermost last */
+  std::unordered_map<std::string, ExprVector> m_scoped;
+  std::vector<std::vector<std::string>> m_scopes;
+
+  /* when set, the variables of a top-level forall are left free */
+  bool m_openTop = false;
+  ExprVector m_topVars;
+
+  /// records an error. The caller returns early and its callers check
+  /// failed() before using what it returned
+  void error(const std::string &msg) { m_lex.fail(msg); }
+  bool failed() const { return m_lex.failed(); }
+
+  void expect(Tok k) {
+    if (m_lex.next().kind != k)
+      error(k == Tok::LPAR   ? "expected '('"
+            : k == Tok::RPAR ? "expected ')'"
+                             : "unexpected token");
+  }
+
+  std::string expectSymbol() {
+    Token t = m_lex.next();
+    if (t.kind != Tok::SYMBOL) {
+      error("expected a symbol");
+      return "";
+    }
+    return t.text.str();
+  }
+
+  unsigned expectNumeral() {
+    Token t = m_lex.next();
+    unsigned n;
+    if (t.kind != Tok::NUMERAL || t.text.getAsInteger(10, n)) {
+      error("expected a numeral");
+      return 0;
+    }
+    return n;
+  }
+
+  /// skips the rest of an S-expression whose '(' was consumed
+  void skipToClose() {
+    unsigned depth = 1;
+    while (depth > 0) {
+      Token t = m_lex.next();
+      if (t.kind == Tok::END) {
+        error("unexpected end of input");
+        return;
+      }
+      if (t.kind == Tok::LPAR)
+        ++depth;
+      else if (t.kind == Tok::RPAR)
+        --depth;
+    }
+  }
+
+  Expr mkName(llvm::StringRef name) {
+    return mkTerm<std::string>(name.str(), m_efac);
+  }
+
+  void pushScope(const std::vector<std::pair<std::string, Expr>> &binds) {
+    m_scopes.emplace_back();
+    for (auto &b : binds) {
+      m_scoped[b.first].push_back(b.second);
+      m_scopes.back().push_back(b.first);
+    }
+  }
+
+  void popScope() {
+    for (auto &name : m_scopes.back()) {
+      auto it = m_scoped.find(name);
+      it->second.pop_back();
+      if (it->second.empty())
+        m_scoped.erase(it);
+    }
+    m_scopes.pop_back();
+  }
+
+  Expr parseSort() {
+    Token t = m_lex.next();
+    if (t.kind == Tok::SYMBOL) {
+      if (t.text == "Bool")
+        return sort::boolTy(m_efac);
+      if (t.text == "Int")
+        return sort::intTy(m_efac);
+      if (t.text == "Real")
+        return sort::realTy(m_efac);
+      error("unsupported sort " + t.text.str());
+      return Expr();
+    }
+    if (t.kind != Tok::LPAR) {
+      error("expected a sort");
+      return Expr();
+    }
+    std::string s = expectSymbol();
+    Expr res;
+    if (s == "_" && expectSymbol() == "BitVec") {
+      unsigned w = expectNumeral();
+      if (failed())
+        return Expr();
+      res = bv::bvsort(w, m_efac);
+    } else if (s == "Array") {
+      Expr idx = parseSort();
+      Expr val = parseSort();
+      if (failed())
+        return Expr();
+      res = sort::arrayTy(idx, val);
+    } else {
+      error("unsupported sort");
+      return Expr();
+    }
+    expect(Tok::RPAR);
+    return res;
+  }
+
+  /// ((x S) ...) as constants
+  ExprVector parseSortedVars() {
+    ExprVector res;
+    expect(Tok::LPAR);
+    while (m_lex.peekIs(Tok::LPAR)) {
+      m_lex.next();
+      Expr name = mkName(expectSymbol());
+      Expr sort = parseSort();
+      if (failed())
+        return res;
+      res.push_back(bind::mkConst(name, sort));
+      expect(Tok::RPAR);
+    }
+    expect(Tok::RPAR);
+    return res;
+  }
+
+  void pushVars(const ExprVector &vars) {
+    std::vector<std::pair<std::string, Expr>> binds;
+    for (auto &v : vars)
+      binds.emplace_back(getTerm<std::string>(bind::fname(bind::fname(v))), v);
+    pushScope(binds);
+  }
+
+  Expr lookup(const std::string &name) {
+    auto sit = m_scoped.find(name);
+    if (sit != m_scoped.end())
+      return sit->second.back();
+    auto fit = m_funs.find(name);
+    if (fit != m_funs.end()) {
+      if (bind::domainSz(fit->second) != 0) {
+        error("missing arguments of " + name);
+        return Expr();
+      }
+      return bind::fapp(fit->second);
+    }
+    auto mit = m_macros.find(name);
+    if (mit != m_macros.end() && mit->second.params.empty())
+      return mit->second.body;
+    if (name == "true")
+      return mk<TRUE>(m_efac);
+    if (name == "false")
+      return mk<FALSE>(m_efac);
+    error("unknown symbol " + name);
+    return Expr();
+  }
+
+  Expr mkNumeral(const Token &t) {
+    switch (t.kind) {
+    default:
+      break;
+    case Tok::NUMERAL:
+      return mkTerm<expr::mpz_class>(expr::mpz_class(t.text.str()), m_efac);
+    case Tok::DECIMAL: {
+      auto parts = t.text.split('.');
+      std::string den("1");
+      den.append(parts.second.size(), '0');
+      expr::mpq_class q(parts.first.str() + parts.second.str() + "/" + den);
+      q.canonicalize();
+      return mkTerm<expr::mpq_class>(q, m_efac);
+    }
+    case Tok::HEX:
+      return bv::bvnum(expr::mpz_class(t.text.str(), 16), 4 * t.text.size(),
+                       m_efac);
+    case Tok::BIN:
+      return bv::bvnum(expr::mpz_class(t.text.str(), 2), t.text.size(),
+                       m_efac);
+    }
+    return Expr();
+  }
+
+  Expr negate(Expr e) {
+    if (isOpX<MPZ>(e)) {
+      expr::mpz_class v(getTerm<expr::mpz_class>(e));
+      return mkTerm<expr::mpz_class>(v.neg(), m_efac);
+    }
+    if (isOpX<MPQ>(e)) {
+      expr::mpq_class v(getTerm<expr::mpq_class>(e));
+      return mkTerm<expr::mpq_class>(v.neg(), m_efac);
+    }
+    return mk<UN_MINUS>(e);
+  }
+
+  unsigned bvWidth(Expr e) {
+    Expr ty = m_tc.typeOf(e);
+    if (!isOpX<BVSORT>(ty)) {
+      error("expected a bit-vector");
+      return 0;
+    }
+    return bv::width(ty);
+  }
+
+  Expr mkIndexed(const Frame &f) {
+    auto &args = f.args;
+    if (args.size() != 1) {
+      error("wrong number of arguments of " + f.head);
+      return Expr();
+    }
+    if (f.sort)
+      return mk<CONST_ARRAY>(sort::arrayIndexTy(f.sort), args[0]);
+    if (f.head == "extract" && f.indices.size() == 2)
+      return bv::extract(f.indices[0], f.indices[1], args[0]);
+    bool zext = f.head == "zero_extend", sext = f.head == "sign_extend";
+    if ((zext || sext) && f.indices.size() == 1) {
+      if (f.indices[0] == 0)
+        return args[0];
+      unsigned w = bvWidth(args[0]);
+      if (failed())
+        return Expr();
+      return zext ? bv::zext(args[0], w + f.indices[0])
+                  : bv::sext(args[0], w + f.indices[0]);
+    }
+    error("unsupported indexed function " + f.head);
+    return Expr();
+  }
+
+  Expr mkApp(const Frame &f) {
+    if (f.sort || !f.indices.empty())
+      return mkIndexed(f);
+
+    auto &args = f.args;
+    unsigned sz = args.size();
+    Builtin b = builtin(f.head);
+    auto arity = [&](unsigned n) {
+      if (sz != n)
+        error("wrong number of arguments of " + f.head);
+      return sz == n;
+    };
+    switch (b) {
+    case Builtin::NONE:
+      break;
+    case Builtin::NOT:
+      if (!arity(1))
+        return Expr();
+      return mk<NEG>(args[0]);
+    case Builtin::AND:
+      return sz == 1 ? args[0] : mknary<AND>(args);
+    case Builtin::OR:
+      return sz == 1 ? args[0] : mknary<OR>(args);
+    case Builtin::XOR:
+      return foldLeft<XOR>(args);
+    case Builtin::IMPL: {
+      // -- right associative
+      Expr res = args.back();
+      for (unsigned i = sz - 1; i-- > 0;)
+        res = mk<IMPL>(args[i], res);
+      return res;
+    }
+    case Builtin::ITE:
+      if (!arity(3))
+        return Expr();
+      return mk<ITE>(args[0], args[1], args[2]);
+    case Builtin::EQ:
+      return chain<EQ>(args);
+    case Builtin::DISTINCT: {
+      if (sz == 2)
+        return mk<NEQ>(args[0], args[1]);
+      ExprVector conj;
+      for (unsigned i = 0; i < sz; ++i)
+        for (unsigned j = i + 1; j < sz; ++j)
+          conj.push_back(mk<NEQ>(args[i], args[j]));
+      return mknary<AND>(conj);
+    }
+    case Builtin::PLUS:
+      return sz == 1 ? args[0] : mknary<PLUS>(args);
+    case Builtin::MINUS:
+      return sz == 1 ? negate(args[0]) : mknary<MINUS>(args);
+    case Builtin::MULT:
+      return sz == 1 ? args[0] : mknary<MULT>(args);
+    case Builtin::DIV:
+      return foldLeft<DIV>(args);
+    case Builtin::IDIV:
+      return foldLeft<IDIV>(args);
+    case Builtin::MOD:
+      if (!arity(2))
+        return Expr();
+      return mk<MOD>(args[0], args[1]);
+    case Builtin::REM:
+      if (!arity(2))
+        return Expr();
+      return mk<REM>(args[0], args[1]);
+    case Builtin::ABS:
+      if (!arity(1))
+        return Expr();
+      return mk<ABS>(args[0]);
+    case Builtin::LT:
+      return chain<LT>(args);
+    case Builtin::LEQ:
+      return chain<LEQ>(args);
+    case Builtin::GT:
+      return chain<GT>(args);
+    case Builtin::GEQ:
+      return chain<GEQ>(args);
+    case Builtin::SELECT:
+      if (!arity(2))
+        return Expr();
+      return mk<SELECT>(args[0], args[1]);
+    case Builtin::STORE:
+      if (!arity(3))
+        return Expr();
+      return mk<STORE>(args[0], args[1], args[2]);
+    case Builtin::CONCAT:
+      return foldLeft<BCONCAT>(args);
+    case Builtin::BNOT:
+      if (!arity(1))
+        return Expr();
+      return mk<BNOT>(args[0]);
+    case Builtin::BNEG:
+      if (!arity(1))
+        return Expr();
+      return mk<BNEG>(args[0]);
+    case Builtin::BAND:
+      return foldLeft<BAND>(args);
+    case Builtin::BOR:
+      return foldLeft<BOR>(args);
+    case Builtin::BXOR:
+      return foldLeft<BXOR>(args);
+    case Builtin::BADD:
+      return foldLeft<BADD>(args);
+    case Builtin::BMUL:
+      return foldLeft<BMUL>(args);
+    case Builtin::BNAND:
+      if (!arity(2))
+        return Expr();
+      return mk<BNAND>(args[0], args[1]);
+    case Builtin::BNOR:
+      if (!arity(2))
+        return Expr();
+      return mk<BNOR>(args[0], args[1]);
+    case Builtin::BXNOR:
+      if (!arity(2))
+        return Expr();
+      return mk<BXNOR>(args[0], args[1]);
+    case Builtin::BSUB:
+      if (!arity(2))
+        return Expr();
+      return mk<BSUB>(args[0], args[1]);
+    case Builtin::BUDIV:
+      if (!arity(2))
+        return Expr();
+      return mk<BUDIV>(args[0], args[1]);
+    case Builtin::BSDIV:
+      if (!arity(2))
+        return Expr();
+      return mk<BSDIV>(args[0], args[1]);
+    case Builtin::BUREM:
+      if (!arity(2))
+        return Expr();
+      return mk<BUREM>(args[0], args[1]);
+    case Builtin::BSREM:
+      if (!arity(2))
+        return Expr();
+      return mk<BSREM>(args[0], args[1]);
+    case Builtin::BSMOD:
+      if (!arity(2))
+        return Expr();
+      return mk<BSMOD>(args[0], args[1]);
+    case Builtin::BSHL:
+      if (!arity(2))
+        return Expr();
+      return mk<BSHL>(args[0], args[1]);
+    case Builtin::BLSHR:
+      if (!arity(2))
+        return Expr();
+      return mk<BLSHR>(args[0], args[1]);
+    case Builtin::BASHR:
+      if (!arity(2))
+        return Expr();
+      return mk<BASHR>(args[0], args[1]);
+    case Builtin::BULT:
+      if (!arity(2))
+        return Expr();
+      return mk<BULT>(args[0], args[1]);
+    case Builtin::BSLT:
+      if (!arity(2))
+        return Expr();
+      return mk<BSLT>(args[0], args[1]);
+    case Builtin::BULE:
+      if (!arity(2))
+        return Expr();
+      return mk<BULE>(args[0], args[1]);
+    case Builtin::BSLE:
+      if (!arity(2))
+        return Expr();
+      return mk<BSLE>(args[0], args[1]);
+    case Builtin::BUGT:
+      if (!arity(2))
+        return Expr();
+      return mk<BUGT>(args[0], args[1]);
+    case Builtin::BSGT:
+      if (!arity(2))
+        return Expr();
+      return mk<BSGT>(args[0], args[1]);
+    case Builtin::BUGE:
+      if (!arity(2))
+        return Expr();
+      return mk<BUGE>(args[0], args[1]);
+    case Builtin::BSGE:
+      if (!arity(2))
+        return Expr();
+      return mk<BSGE>(args[0], args[1]);
+    }
+
+    auto fit = m_funs.find(f.head);
+    if (fit != m_funs.end()) {
+      if (bind::domainSz(fit->second) != sz) {
+        error("wrong number of arguments of " + f.head);
+        return Expr();
+      }
+      return bind::fapp(fit->second, args);
+    }
+    auto mit = m_macros.find(f.head);
+    if (mit != m_macros.end()) {
+      auto &macro = mit->second;
+      if (macro.params.size() != sz) {
+        error("wrong number of arguments of " + f.head);
+        return Expr();
+      }
+      ExprMap sub;
+      for (unsigned i = 0; i < sz; ++i)
+        sub[macro.params[i]] = args[i];
+      return replace(macro.body, sub);
+    }
+    error("unknown function " + f.head);
+    return Expr();
+  }
+
+  Expr mkBinder(const Frame &f, Expr body) {
+    if (f.lambda) {
+      Expr res = bind::abs<LAMBDA>(f.vars, body);
+      if (res != body)
+        return res;
+      // -- a constant lambda
+      ExprVector args;
+      for (auto &v : f.vars)
+        args.push_back(bind::fname(v));
+      args.push_back(body);
+      return mknary<LAMBDA>(args);
+    }
+    return f.forall ? bind::abs<FORALL>(f.vars, body)
+                    : bind::abs<EXISTS>(f.vars, body);
+  }
+
+  /// starts parsing a term. Returns the term if it is atomic, otherwise
+  /// pushes a frame for it and returns null. Also returns null on error
+  Expr startTerm(std::vector<Frame> &stack) {
+    Token t = m_lex.next();
+    switch (t.kind) {
+    case Tok::SYMBOL:
+      return lookup(t.text.str());
+    case Tok::NUMERAL:
+    case Tok::DECIMAL:
+    case Tok::HEX:
+    case Tok::BIN:
+      return mkNumeral(t);
+    case Tok::LPAR:
+      break;
+    default:
+      error("expected a term");
+      return Expr();
+    }
+
+    Token h = m_lex.next();
+    if (h.kind == Tok::LPAR) {
+      // -- (_ f i ...) or (as const S) applied to arguments
+      Frame f(Frame::APP);
+      std::string s = expectSymbol();
+      if (s == "_") {
+        f.head = expectSymbol();
+        while (m_lex.peekIs(Tok::NUMERAL))
+          f.indices.push_back(expectNumeral());
+      } else if (s == "as") {
+        f.head = expectSymbol();
+        if (f.head != "const") {
+          error("unsupported qualified identifier");
+          return Expr();
+        }
+        f.sort = parseSort();
+      } else {
+        error("unexpected '('");
+        return Expr();
+      }
+      expect(Tok::RPAR);
+      if (failed())
+        return Expr();
+      stack.push_back(std::move(f));
+      return Expr();
+    }
+    if (h.kind != Tok::SYMBOL) {
+      error("expected a function symbol");
+      return Expr();
+    }
+
+    if (h.text == "_") {
+      // -- (_ bvN w)
+      std::string s = expectSymbol();
+      if (failed())
+        return Expr();
+      llvm::StringRef val(s);
+      if (!val.consume_front("bv") || val.empty() ||
+          !llvm::all_of(val, [](char c) { return std::isdigit(c); })) {
+        error("unsupported indexed constant " + s);
+        return Expr();
+      }
+      unsigned w = expectNumeral();
+      expect(Tok::RPAR);
+      if (failed())
+        return Expr();
+      return bv::bvnum(expr::mpz_class(val.str()), w, m_efac);
+    }
+    if (h.text == "let") {
+      Frame f(Frame::LET);
+      expect(Tok::LPAR);
+      if (m_lex.peekIs(Tok::RPAR)) {
+        m_lex.next();
+        pushScope({});
+        f.inBody = true;
+      } else {
+        expect(Tok::LPAR);
+        f.pending = expectSymbol();
+      }
+      stack.push_back(std::move(f));
+      return Expr();
+    }
+    if (h.text == "forall" || h.text == "exists" || h.text == "lambda") {
+      Frame f(Frame::BINDER);
+      f.forall = h.text == "forall";
+      f.lambda = h.text == "lambda";
+      f.vars = parseSortedVars();
+      if (failed())
+        return Expr();
+      pushVars(f.vars);
+      stack.push_back(std::move(f));
+      return Expr();
+    }
+    if (h.text == "!") {
+      stack.push_back(Frame(Frame::ANNOT));
+      return Expr();
+    }
+    if (h.text == "as") {
+      // -- (as f S) is f
+      std::string name = expectSymbol();
+      parseSort();
+      expect(Tok::RPAR);
+      if (failed())
+        return Expr();
+      return lookup(name);
+    }
+    Frame f(Frame::APP);
+    f.head = h.text.str();
+    stack.push_back(std::move(f));
+    return Expr();
+  }
+
+  /// parses a term with an explicit stack of pending terms
+  Expr parseTerm() {
+    std::vector<Frame> stack;
+    for (;;) {
+      Expr res = startTerm(stack);
+      if (failed())
+        return Expr();
+      while (res) {
+        if (stack.empty())
+          return res;
+        Frame &f = stack.back();
+        switch (f.kind) {
+        case Frame::APP:
+          f.args.push_back(res);
+          res = Expr();
+          if (m_lex.peekIs(Tok::RPAR)) {
+            m_lex.next();
+            res = mkApp(f);
+            stack.pop_back();
+          }
+          break;
+        case Frame::LET:
+          if (f.inBody) {
+            popScope();
+            expect(Tok::RPAR);
+            stack.pop_back();
+            break;
+          }
+          // -- bindings are parallel: they are in scope only in the body
+          f.binds.emplace_back(std::move(f.pending), res);
+          res = Expr();
+          expect(Tok::RPAR);
+          if (m_lex.peekIs(Tok::LPAR)) {
+            m_lex.next();
+            f.pending = expectSymbol();
+          } else {
+            expect(Tok::RPAR);
+            pushScope(f.binds);
+            f.binds.clear();
+            f.inBody = true;
+          }
+          break;
+        case Frame::BINDER:
+          popScope();
+          expect(Tok::RPAR);
+          if (m_openTop && stack.size() == 1 && f.forall)
+            m_topVars = std::move(f.vars);
+          else
+            res = mkBinder(f, res);
+          stack.pop_back();
+          break;
+        case Frame::ANNOT:
+          // -- skip attributes
+          while (!failed() && !m_lex.peekIs(Tok::RPAR)) {
+            Token t = m_lex.next();
+            if (t.kind == Tok::END)
+              error("unexpected end of input");
+            if (t.kind == Tok::LPAR)
+              skipToClose();
+          }
+          m_lex.next();
+          stack.pop_back();
+          break;
+        }
+        if (failed())
+          return Expr();
+      }
+    }
+  }
+
+  Expr declare(const std::string &name, const ExprVector &domain,
+               Expr range) {
+    ExprVector sig(domain);
+    sig.push_back(range);
+    Expr fdecl = bind::fdecl(mkName(name), sig);
+    m_funs[name] = fdecl;
+    return fdecl;
+  }
+
+  ExprVector parseSorts() {
+    ExprVector res;
+    expect(Tok::LPAR);
+    while (!failed() && !m_lex.peekIs(Tok::RPAR))
+      res.push_back(parseSort());
+    m_lex.next();
+    return res;
+  }
+
+  /// skips optional arguments until the end of a command
+  void skipRest() {
+    while (!failed() && !m_lex.peekIs(Tok::RPAR)) {
+      Token t = m_lex.next();
+      if (t.kind == Tok::END)
+        error("unexpected end of input");
+      if (t.kind == Tok::LPAR)
+        skipToClose();
+    }
+    m_lex.next();
+  }
+
+  void command() {
+    expect(Tok::LPAR);
+    std::string cmd = expectSymbol();
+    if (failed())
+      return;
+    if (cmd == "set-logic") {
+      m_logic = expectSymbol();
+      expect(Tok::RPAR);
+    } else if (cmd == "declare-fun") {
+      std::string name = expectSymbol();
+      ExprVector domain = parseSorts();
+      Expr range = parseSort();
+      if (failed())
+        return;
+      m_decls.push_back(declare(name, domain, range));
+      expect(Tok::RPAR);
+    } else if (cmd == "declare-const") {
+      std::string name = expectSymbol();
+      Expr range = parseSort();
+      if (failed())
+        return;
+      m_decls.push_back(declare(name, {}, range));
+      expect(Tok::RPAR);
+    } else if (cmd == "define-fun") {
+      std::string name = expectSymbol();
+      Macro macro;
+      macro.params = parseSortedVars();
+      parseSort();
+      if (failed())
+        return;
+      pushVars(macro.params);
+      macro.body = parseTerm();
+      expect(Tok::RPAR);
+      if (failed())
+        return;
+      popScope();
+      m_macros[name] = std::move(macro);
+    } else if (cmd == "declare-rel") {
+      std::string name = expectSymbol();
+      ExprVector domain = parseSorts();
+      if (failed())
+        return;
+      m_rels.push_back(declare(name, domain, sort::boolTy(m_efac)));
+      skipRest();
+    } else if (cmd == "declare-var") {
+      std::string name = expectSymbol();
+      Expr range = parseSort();
+      if (failed())
+        return;
+      m_vars.push_back(bind::fapp(declare(name, {}, range)));
+      expect(Tok::RPAR);
+    } else if (cmd == "rule") {
+      Expr body = parseTerm();
+      skipRest();
+      if (failed())
+        return;
+      // -- the variables of a rule are the declared ones that it uses
+      ExprSet consts;
+      filter(body, bind::IsConst(), std::inserter(consts, consts.begin()));
+      Assertion a;
+      for (auto &v : m_vars)
+        if (consts.count(v))
+          a.vars.push_back(v);
+      a.body = body;
+      m_assertions.push_back(std::move(a));
+    } else if (cmd == "query") {
+      Expr query = parseTerm();
+      skipRest();
+      if (failed())
+        return;
+      m_queries.push_back(query);
+    } else if (cmd == "assert") {
+      m_openTop = true;
+      m_topVars.clear();
+      Assertion a;
+      a.body = parseTerm();
+      a.vars = std::move(m_topVars);
+      m_openTop = false;
+      expect(Tok::RPAR);
+      if (failed())
+        return;
+      m_assertions.push_back(std::move(a));
+    } else
+      skipToClose();
+  }
+
+public:
+  Impl(ExprFactory &efac) : m_efac(efac) {}
+
+  bool parse(llvm::StringRef text) {
+    m_lex.reset(text);
+    m_error.clear();
+    while (!failed() && !m_lex.peekIs(Tok::END))
+      command();
+    if (!failed())
+      return true;
+    m_error = m_lex.error();
+    m_openTop = false;
+    m_scoped.clear();
+    m_scopes.clear();
+    return false;
+  }
+
+  friend class SmtLibParser;
+};
+
+Expr SmtLibParser::Assertion::closed() const {
+  return vars.empty() ? body : bind::abs<FORALL>(vars, body);
+}
+
+SmtLibParser::SmtLibParser(ExprFactory &efac) : m_impl(new Impl(efac)) {}
+SmtLibParser::~SmtLibParser() = default;
+
+bool SmtLibParser::parse(llvm::StringRef text) { return m_impl->parse(text); }
+
+bool SmtLibParser::parseFile(llvm::StringRef fname) {
+  auto buf = llvm::MemoryBuffer::getFileOrSTDIN(fname);
+  if (!buf) {
+    m_impl->m_error = "cannot open " + fname.str();
+    return false;
+  }
+  return parse((*buf)->getBuffer());
+}
+
+const std::string &SmtLibParser::getError() const { return m_impl->m_error; }
+const std::string &SmtLibParser::getLogic() const { return m_impl->m_logic; }
+const ExprVector &SmtLibParser::getDecls() const { return m_impl->m_decls; }
+const ExprVector &SmtLibParser::getRelations() const {
+  return m_impl->m_rels;
+}
+const std::vector<SmtLibParser::Assertion> &
+SmtLibParser::getAssertions() const {
+  return m_impl->m_assertions;
+}
+const ExprVector &SmtLibParser::getQueries() const {
+  return m_impl->m_queries;
+}
+} // namespace seahorn
@@ -0,0 +1,575 @@
+#include "seahorn/Expr/Smt/SmtLibWriter.hh"
+#include "seahorn/Expr/ExprOpBinder.hh"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "boost/lexical_cast.hpp"
+
+#include <cctype>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace expr;
+
+namespace {
+bool isBinder(Expr e) {
+  return isOpX<FORALL>(e) || isOpX<EXISTS>(e) || isOpX<LAMBDA>(e);
+}
+
+/// e is written without looking at its arguments and is never let-bound
+bool isAtom(Expr e) {
+  return e->arity() == 0 || isOpX<BIND>(e) ||
+         (isOpX<FAPP>(e) && e->arity() == 1);
+}
+
+/// arguments of e that are terms (and not sorts, names or indices)
+void termArgs(Expr e, std::vector<Expr> &out) {
+  out.clear();
+  if (isAtom(e) || isBinder(e))
+    return;
+  if (isOpX<FAPP>(e) && bind::isFdecl(bind::fname(e)))
+    out.insert(out.end(), ++e->args_begin(), e->args_end());
+  else if (isOpX<BEXTRACT>(e))
+    out.push_back(bv::earg(e));
+  else if (isOpX<BSEXT>(e) || isOpX<BZEXT>(e))
+    out.push_back(e->arg(0));
+  else if (isOpX<CONST_ARRAY>(e))
+    out.push_back(e->arg(1));
+  else
+    out.insert(out.end(), e->args_begin(), e->args_end());
+}
+
+bool isSupportedSort(Expr ty) {
+  if (isOpX<BOOL_TY>(ty) || isOpX<INT_TY>(ty) || isOpX<REAL_TY>(ty) ||
+      isOpX<BVSORT>(ty))
+    return true;
+  if (isOpX<ARRAY_TY>(ty))
+    return isSupportedSort(sort::arrayIndexTy(ty)) &&
+           isSupportedSort(sort::arrayValTy(ty));
+  return false;
+}
+
+bool isSupportedFdecl(Expr fdecl) {
+  for (unsigned i = 0, sz = bind::domainSz(fdecl); i < sz; ++i)
+    if (!isSupportedSort(bind::domainTy(fdecl, i)))
+      return false;
+  return isSupportedSort(bind::rangeTy(fdecl));
+}
+
+/// name of the SMT-LIB function of an operator, nullptr if there is none
+const char *opName(Expr e) {
+  auto &op = e->op();
+  switch (op.getFamilyId()) {
+  default:
+    break;
+  case OpFamilyId::BoolOp:
+    switch (llvm::cast<BoolOp>(op).m_kind) {
+    case BoolOpKind::TRUE:
+      return "true";
+    case BoolOpKind::FALSE:
+      return "false";
+    case BoolOpKind::AND:
+      return "and";
+    case BoolOpKind::OR:
+      return "or";
+    case BoolOpKind::XOR:
+      return "xor";
+    case BoolOpKind::NEG:
+      return "not";
+    case BoolOpKind::IMPL:
+      return "=>";
+    case BoolOpKind::ITE:
+      return "ite";
+    case BoolOpKind::IFF:
+      return "=";
+    }
+    break;
+  case OpFamilyId::CompareOp:
+    switch (llvm::cast<CompareOp>(op).m_kind) {
+    case CompareOpKind::EQ:
+      return "=";
+    case CompareOpKind::NEQ:
+      return "distinct";
+    case CompareOpKind::LEQ:
+      return "<=";
+    case CompareOpKind::GEQ:
+      return ">=";
+    case CompareOpKind::LT:
+      return "<";
+    case CompareOpKind::GT:
+      return ">";
+    }
+    break;
+  case OpFamilyId::NumericOp:
+    switch (llvm::cast<NumericOp>(op).m_kind) {
+    default:
+      break;
+    case NumericOpKind::PLUS:
+      return "+";
+    case NumericOpKind::MINUS:
+    case NumericOpKind::UN_MINUS:
+      return "-";
+    case NumericOpKind::MULT:
+      return "*";
+    // -- DIV is integer or real division depending on its arguments
+    case NumericOpKind::DIV:
+      return "/";
+    case NumericOpKind::IDIV:
+      return "div";
+    case NumericOpKind::MOD:
+      return "mod";
+    case NumericOpKind::REM:
+      return "rem";
+    case NumericOpKind::ABS:
+      return "abs";
+    }
+    break;
+  case OpFamilyId::ArrayOp:
+    switch (llvm::cast<ArrayOp>(op).m_kind) {
+    default:
+      break;
+    case ArrayOpKind::SELECT:
+      return "select";
+    case ArrayOpKind::STORE:
+      return "store";
+    case ArrayOpKind::CONST_ARRAY:
+      return "const";
+    }
+    break;
+  case OpFamilyId::BvOp:
+    switch (llvm::cast<BvOp>(op).m_kind) {
+    default:
+      break;
+    case BvOpKind::BNOT:
+      return "bvnot";
+    case BvOpKind::BAND:
+      return "bvand";
+    case BvOpKind::BOR:
+      return "bvor";
+    case BvOpKind::BXOR:
+      return "bvxor";
+    case BvOpKind::BNAND:
+      return "bvnand";
+    case BvOpKind::BNOR:
+      return "bvnor";
+    case BvOpKind::BXNOR:
+      return "bvxnor";
+    case BvOpKind::BNEG:
+      return "bvneg";
+    case BvOpKind::BADD:
+      return "bvadd";
+    case BvOpKind::BSUB:
+      return "bvsub";
+    case BvOpKind::BMUL:
+      return "bvmul";
+    case BvOpKind::BUDIV:
+      return "bvudiv";
+    case BvOpKind::BSDIV:
+      return "bvsdiv";
+    case BvOpKind::BUREM:
+      return "bvurem";
+    case BvOpKind::BSREM:
+      return "bvsrem";
+    case BvOpKind::BSMOD:
+      return "bvsmod";
+    case BvOpKind::BULT:
+      return "bvult";
+    case BvOpKind::BSLT:
+      return "bvslt";
+    case BvOpKind::BULE:
+      return "bvule";
+    case BvOpKind::BSLE:
+      return "bvsle";
+    case BvOpKind::BUGE:
+      return "bvuge";
+    case BvOpKind::BSGE:
+      return "bvsge";
+    case BvOpKind::BUGT:
+      return "bvugt";
+    case BvOpKind::BSGT:
+      return "bvsgt";
+    case BvOpKind::BSHL:
+      return "bvshl";
+    case BvOpKind::BLSHR:
+      return "bvlshr";
+    case BvOpKind::BASHR:
+      return "bvashr";
+    case BvOpKind::BCONCAT:
+      return "concat";
+    case BvOpKind::BEXTRACT:
+      return "extract";
+    case BvOpKind::BSEXT:
+      return "sign_extend";
+    case BvOpKind::BZEXT:
+      return "zero_extend";
+    }
+    break;
+  }
+  return nullptr;
+}
+
+bool isSupportedNode(Expr e) {
+  if (isBinder(e)) {
+    for (unsigned i = 0, sz = bind::numBound(e); i < sz; ++i)
+      if (!isSupportedSort(bind::rangeTy(bind::decl(e, i))))
+        return false;
+    return true;
+  }
+  if (isOpX<MPZ>(e) || isOpX<MPQ>(e))
+    return true;
+  if (isOpX<BIND>(e)) {
+    if (bv::is_bvnum(e))
+      return true;
+    return bind::isBVar(e) && isSupportedSort(bind::type(e));
+  }
+  if (isOpX<FAPP>(e)) {
+    Expr f = bind::fname(e);
+    if (bind::isFdecl(f))
+      return isSupportedFdecl(f);
+    // -- application of a lambda is written as select
+    return isOpX<LAMBDA>(f) && e->arity() == 2;
+  }
+  if (isOpX<CONST_ARRAY>(e) && !isSupportedSort(e->arg(0)))
+    return false;
+  if (isOpX<BCONCAT>(e) && e->arity() < 2)
+    return false;
+  return opName(e) != nullptr;
+}
+
+/// a symbol that can be written without quotes
+bool isSimpleSymbol(const std::string &s) {
+  if (s.empty() || std::isdigit(s[0]))
+    return false;
+  for (char c : s) {
+    if (std::isalnum(c))
+      continue;
+    if (std::strchr("~!@$%^&*_-+=<>.?/", c) == nullptr)
+      return false;
+  }
+  static const char *reserved[] = {"let", "forall", "exists", "!",  "_",
+                                   "as",  "par",    "match",  "lambda"};
+  for (const char *r : reserved)
+    if (s == r)
+      return false;
+  return true;
+}
+
+std::string symbolName(Expr fdecl) {
+  Expr fname = bind::fname(fdecl);
+  std::string name = isOpX<STRING>(fname)
+                         ? getTerm<std::string>(fname)
+                         : boost::lexical_cast<std::string>(*fname);
+  if (isSimpleSymbol(name))
+    return name;
+  // -- quoted symbols cannot contain | or backslash
+  for (char &c : name)
+    if (c == '|' || c == '\\')
+      c = '_';
+  return "|" + name + "|";
+}
+
+void printSort(llvm::raw_ostream &out, Expr ty) {
+  if (isOpX<BOOL_TY>(ty))
+    out << "Bool";
+  else if (isOpX<INT_TY>(ty))
+    out << "Int";
+  else if (isOpX<REAL_TY>(ty))
+    out << "Real";
+  else if (isOpX<BVSORT>(ty))
+    out << "(_ BitVec " << bv::width(ty) << ")";
+  else if (isOpX<ARRAY_TY>(ty)) {
+    out << "(Array ";
+    printSort(out, sort::arrayIndexTy(ty));
+    out << " ";
+    printSort(out, sort::arrayValTy(ty));
+    out << ")";
+  } else
+    out << "|" << boost::lexical_cast<std::string>(*ty) << "|";
+}
+
+/// writes an integer numeral, or a decimal if suffix is ".0"
+void printNumeral(llvm::raw_ostream &out, const mpz_class &n,
+                  const char *suffix = "") {
+  if (n.sgn() < 0) {
+    mpz_class abs(n);
+    out << "(- " << abs.neg().to_string() << suffix << ")";
+  } else
+    out << n.to_string() << suffix;
+}
+
+/// Per-node information of the DAG of one term
+struct NodeInfo {
+  unsigned parents = 0;
+  /// let-binding level of the node
+  unsigned level = 0;
+  /// let name (1-based), 0 if the node is not let-bound
+  unsigned name = 0;
+  bool visited = false;
+};
+} // namespace
+
+namespace seahorn {
+
+bool SmtLibWriter::isSupported(Expr e) {
+  std::unordered_set<ENode *> seen;
+  std::vector<Expr> todo{e}, args;
+  while (!todo.empty()) {
+    Expr n = todo.back();
+    todo.pop_back();
+    if (!seen.insert(&*n).second)
+      continue;
+    if (!isSupportedNode(n))
+      return false;
+    if (isBinder(n)) {
+      todo.push_back(bind::body(n));
+      continue;
+    }
+    termArgs(n, args);
+    todo.insert(todo.end(), args.begin(), args.end());
+  }
+  return true;
+}
+
+void SmtLibWriter::writeSort(Expr ty) { printSort(m_out, ty); }
+
+void SmtLibWriter::writeSymbol(Expr fdecl) { m_out << symbolName(fdecl); }
+
+void SmtLibWriter::writeDeclareFun(Expr fdecl) {
+  m_out << "(declare-fun ";
+  writeSymbol(fdecl);
+  m_out << " (";
+  for (unsigned i = 0, sz = bind::domainSz(fdecl); i < sz; ++i) {
+    if (i > 0)
+      m_out << " ";
+    writeSort(bind::domainTy(fdecl, i));
+  }
+  m_out << ") ";
+  writeSort(bind::rangeTy(fdecl));
+  m_out << ")";
+}
+
+void SmtLibWriter::writeAssert(Expr e, const ExprVector &vars) {
+  m_out << "(assert ";
+  if (vars.empty()) {
+    writeTerm(e);
+    m_out << ")\n";
+    return;
+  }
+  m_out << "(forall (";
+  for (unsigned i = 0, sz = vars.size(); i < sz; ++i) {
+    Expr fdecl = bind::fname(vars[i]);
+    m_out << (i > 0 ? " (" : "(");
+    writeSymbol(fdecl);
+    m_out << " ";
+    writeSort(bind::rangeTy(fdecl));
+    m_out << ")";
+  }
+  m_out << ") ";
+  writeTerm(e);
+  m_out << "))\n";
+}
+
+void SmtLibWriter::writeBinder(Expr e) {
+  m_out << "(" << (isOpX<FORALL>(e) ? "forall" : isOpX<EXISTS>(e) ? "exists"
+                                                                   : "lambda")
+        << " (";
+  unsigned sz = bind::numBound(e);
+  for (unsigned i = 0; i < sz; ++i) {
+    Expr decl = bind::decl(e, i);
+    m_bound.push_back(symbolName(decl));
+    m_out << (i > 0 ? " (" : "(") << m_bound.back() << " ";
+    writeSort(bind::rangeTy(decl));
+    m_out << ")";
+  }
+  m_out << ") ";
+  writeTerm(bind::body(e));
+  m_out << ")";
+  m_bound.resize(m_bound.size() - sz);
+}
+
+void SmtLibWriter::writeTerm(Expr e) {
+  // -- compute post-order of the DAG and the number of parents of each node.
+  // -- binders are not entered: their bodies are written in their own scope
+  std::unordered_map<ENode *, NodeInfo> info;
+  std::vector<Expr> order, args;
+  std::vector<std::pair<Expr, bool>> todo{{e, false}};
+  while (!todo.empty()) {
+    auto item = todo.back();
+    todo.pop_back();
+    if (item.second) {
+      order.push_back(item.first);
+      continue;
+    }
+    auto &ni = info[&*item.first];
+    if (ni.visited)
+      continue;
+    ni.visited = true;
+    todo.push_back({item.first, true});
+    termArgs(item.first, args);
+    for (auto it = args.rbegin(), end = args.rend(); it != end; ++it) {
+      ++info[&*(*it)].parents;
+      todo.push_back({*it, false});
+    }
+  }
+
+  // -- a shared node is let-bound at a level above all shared nodes it uses
+  auto isShared = [&info](Expr n) {
+    return info[&*n].parents > 1 && !isAtom(n);
+  };
+  std::vector<std::vector<Expr>> levels;
+  for (Expr n : order) {
+    auto &ni = info[&*n];
+    termArgs(n, args);
+    for (Expr a : args) {
+      auto &ai = info[&*a];
+      ni.level = std::max(ni.level, isShared(a) ? ai.level + 1 : ai.level);
+    }
+    if (n != e && isShared(n)) {
+      ni.name = ++m_lets;
+      if (levels.size() <= ni.level)
+        levels.resize(ni.level + 1);
+      levels[ni.level].push_back(n);
+    }
+  }
+
+  // -- writes a node of the DAG with an explicit stack. An item of the
+  // -- stack is either a sub-term or a piece of text. Shared sub-terms
+  // -- are written by name, except for the node itself.
+  std::vector<std::pair<Expr, std::string>> stack;
+  auto writeDag = [&](Expr root) {
+    stack.push_back({root, ""});
+    bool top = true;
+    while (!stack.empty()) {
+      auto item = std::move(stack.back());
+      stack.pop_back();
+      Expr n = item.first;
+      if (!n) {
+        m_out << item.second;
+        continue;
+      }
+      unsigned name = info[&*n].name;
+      if (name && !top) {
+        m_out << "a!" << name;
+        continue;
+      }
+      top = false;
+      if (isAtom(n)) {
+        writeAtom(n);
+        continue;
+      }
+      if (isBinder(n)) {
+        writeBinder(n);
+        continue;
+      }
+
+      termArgs(n, args);
+      if ((isOpX<AND>(n) || isOpX<OR>(n)) && args.size() < 2) {
+        if (args.empty())
+          m_out << (isOpX<AND>(n) ? "true" : "false");
+        else
+          stack.push_back({args[0], ""});
+        continue;
+      }
+      if (isOpX<BCONCAT>(n) && args.size() > 2) {
+        // -- concat is binary: nest to the right
+        stack.push_back({Expr(), std::string(args.size() - 1, ')')});
+        stack.push_back({args.back(), ""});
+        for (unsigned i = args.size() - 1; i-- > 0;) {
+          stack.push_back({Expr(), i + 2 == args.size() ? " " : " (concat "});
+          stack.push_back({args[i], ""});
+        }
+        stack.push_back({Expr(), "(concat "});
+        continue;
+      }
+
+      std::string head("(");
+      llvm::raw_string_ostream hs(head);
+      if (isOpX<FAPP>(n)) {
+        // -- lambda applications are selects
+        if (bind::isFdecl(bind::fname(n)))
+          hs << symbolName(bind::fname(n));
+        else
+          hs << "select";
+      } else if (isOpX<BEXTRACT>(n))
+        hs << "(_ extract " << bv::high(n) << " " << bv::low(n) << ")";
+      else if (isOpX<BSEXT>(n) || isOpX<BZEXT>(n)) {
+        unsigned in = bv::width(m_tc.typeOf(args[0]));
+        hs << "(_ " << opName(n) << " " << bv::width(n->arg(1)) - in << ")";
+      } else if (isOpX<CONST_ARRAY>(n)) {
+        hs << "(as const (Array ";
+        printSort(hs, n->arg(0));
+        hs << " ";
+        printSort(hs, m_tc.typeOf(args[0]));
+        hs << "))";
+      } else if (isOpX<DIV>(n) && isOpX<INT_TY>(m_tc.typeOf(args[0])))
+        hs << "div";
+      else
+        hs << opName(n);
+      hs.flush();
+
+      stack.push_back({Expr(), ")"});
+      for (auto it = args.rbegin(), end = args.rend(); it != end; ++it) {
+        stack.push_back({*it, ""});
+        stack.push_back({Expr(), " "});
+      }
+      stack.push_back({Expr(), std::move(head)});
+    }
+  };
+
+  unsigned open = 0;
+  for (auto &group : levels) {
+    if (group.empty())
+      continue;
+    m_out << "(let (";
+    bool first = true;
+    for (Expr n : group) {
+      m_out << (first ? "(" : " (") << "a!" << info[&*n].name << " ";
+      first = false;
+      writeDag(n);
+      m_out << ")";
+    }
+    m_out << ") ";
+    ++open;
+  }
+  writeDag(e);
+  for (unsigned i = 0; i < open; ++i)
+    m_out << ")";
+}
+
+void SmtLibWriter::writeAtom(Expr e) {
+  if (isOpX<TRUE>(e))
+    m_out << "true";
+  else if (isOpX<FALSE>(e))
+    m_out << "false";
+  else if (isOpX<MPZ>(e))
+    printNumeral(m_out, getTerm<mpz_class>(e));
+  else if (isOpX<MPQ>(e)) {
+    const mpq_class &q = getTerm<mpq_class>(e);
+    mpz_class num(mpq_numref(q.get_mpq_t()));
+    mpz_class den(mpq_denref(q.get_mpq_t()));
+    if (den == mpz_class(1ul))
+      printNumeral(m_out, num, ".0");
+    else {
+      m_out << "(/ ";
+      printNumeral(m_out, num, ".0");
+      m_out << " ";
+      printNumeral(m_out, den, ".0");
+      m_out << ")";
+    }
+  } else if (bind::isBVar(e)) {
+    unsigned id = bind::bvarId(e);
+    assert(id < m_bound.size());
+    m_out << m_bound[m_bound.size() - 1 - id];
+  } else if (bv::is_bvnum(e)) {
+    unsigned w = bv::widthBvNum(e);
+    // -- normalize to [0, 2^w)
+    mpz_class v = bv::toMpz(e);
+    mpz_fdiv_r_2exp(v.get_mpz_t(), v.get_mpz_t(), w);
+    m_out << "(_ bv" << v.to_string() << " " << w << ")";
+  } else if (isOpX<FAPP>(e))
+    writeSymbol(bind::fname(e));
+  else
+    m_out << "|" << boost::lexical_cast<std::string>(*e) << "|";
+}
+} // namespace seahorn
@@ -27,7 +27,14 @@ yices_model_impl::~yices_model_impl(){
 }
 
 expr::Expr yices_model_impl::eval(expr::Expr exp, bool complete){
-  return marshal_yices::eval(exp,  d_efac, d_solver.get_cache(), complete, d_model);
+  // -- yices ignores the complete flag, so it is not part of the key
+  auto it = d_values.find(exp);
+  if (it != d_values.end())
+    return it->second;
+  expr::Expr res = marshal_yices::eval(exp, d_efac, d_solver.get_cache(), complete,
+                                 d_model);
+  d_values.insert({exp, res});
+  return res;
 }
 
 void yices_model_impl::print(llvm::raw_ostream& o) const {
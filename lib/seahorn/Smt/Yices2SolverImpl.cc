@@ -5,6 +5,9 @@
 #include "seahorn/Expr/Smt/Yices2SolverImpl.hh"
 #include "seahorn/Expr/Smt/Yices2ModelImpl.hh"
 #include "seahorn/Expr/Smt/MarshalYices.hh"
+#include "seahorn/Expr/Smt/SmtLibWriter.hh"
+#include "seahorn/Expr/ExprVisitor.hh"
+#include "seahorn/Support/QueryStats.hh"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -57,6 +60,14 @@ yices_solver_impl::yices_solver_impl(expr::ExprFactory &efac, const char *logic,
   }
 }
 
+static boost::tribool ystatus_to_tribool(smt_status_t stat) {
+  switch(stat){
+  case STATUS_UNSAT: return false;
+  case STATUS_SAT: return true;
+  default: return boost::indeterminate;
+  }
+}
+
 yices_solver_impl::~yices_solver_impl(){
   yices_free_context(d_ctx);
 }
@@ -75,23 +86,40 @@ bool yices_solver_impl::add(expr::Expr exp){
     str_os << "yices_solver_impl::add:  failed to encode: " << *exp << "\n";
     report_fatal_error(str_os.str());
   }
-  int32_t errcode = yices_assert_formula(d_ctx, yt);
+  d_pending.push_back(yt);
+  d_assertions.push_back(exp);
+  return true;
+}
+
+void yices_solver_impl::flush(){
+  if (d_pending.empty())
+    return;
+  int32_t errcode =
+      yices_assert_formulas(d_ctx, d_pending.size(), d_pending.data());
+  d_pending.clear();
   if (errcode == -1){
     std::string str;      
     raw_string_ostream str_os(str);          
-    str_os << "yices_solver_impl::add:  yices_assert_formula failed: "
+    str_os << "yices_solver_impl::flush:  yices_assert_formulas failed: "
 	   << yices::error_string() << "\n";
     report_fatal_error(str_os.str());    
   }
-  return true;
 }
 
 /** Check for satisfiability */
 SolverResult yices_solver_impl::check(){
   d_last_assumptions.clear();
+  flush();
   
   //could have a param_t field for this call.
+  ScopedQuery q("yices2");
   smt_status_t stat = yices_check_context(d_ctx, nullptr);
+  if (q.active()) {
+    q.finish(ystatus_to_tribool(stat), d_assertions.size(),
+             dagSize(d_assertions), [this](raw_ostream &o) {
+               write_smt_lib(o, ExprVector());
+             });
+  }
   switch(stat){
   case STATUS_UNSAT: return SolverResult::UNSAT;
   case STATUS_SAT: return SolverResult::SAT;
@@ -104,11 +132,11 @@ SolverResult yices_solver_impl::check(){
 
 SolverResult yices_solver_impl::check_with_assumptions(const expr_const_it_range& lits) {
   d_last_assumptions.clear();
+  flush();
   
   std::vector<term_t> y_lits;
   for (auto lit: lits) {
     term_t y_lit = marshal_yices::encode_term(lit, get_cache());
-    d_last_assumptions.insert({y_lit, lit});
     if (y_lit == NULL_TERM){
       std::string str;        
       raw_string_ostream str_os(str);  
@@ -116,11 +144,20 @@ SolverResult yices_solver_impl::check_with_assumptions(const expr_const_it_range
 	     << *lit << "\n";
       report_fatal_error(str_os.str());      
     }
+    d_last_assumptions.insert({y_lit, lit});
     y_lits.push_back(y_lit);
   }
 
+  ScopedQuery q("yices2");
   smt_status_t stat = yices_check_context_with_assumptions(d_ctx, nullptr,
-							   y_lits.size(), &y_lits[0]);
+							   y_lits.size(), y_lits.data());
+  if (q.active()) {
+    ExprVector assumptions(lits.begin(), lits.end());
+    ExprVector all(d_assertions);
+    all.insert(all.end(), assumptions.begin(), assumptions.end());
+    q.finish(ystatus_to_tribool(stat), d_assertions.size(), dagSize(all),
+             [&](raw_ostream &o) { write_smt_lib(o, assumptions); });
+  }
   switch(stat){
   case STATUS_UNSAT: return SolverResult::UNSAT;
   case STATUS_SAT: return SolverResult::SAT;
@@ -157,16 +194,29 @@ void yices_solver_impl::unsat_core(ExprVector& out){
 
 /** Push a context */
 void yices_solver_impl::push(){
+  // -- pending formulas belong to the current scope
+  flush();
+  d_scope_sizes.push_back(d_assertions.size());
   yices_push(d_ctx);
 }
 
 /** Pop a context */
 void yices_solver_impl::pop(){
+  // -- pending formulas are in the popped scope; no need to assert them
+  d_pending.clear();
+  if (!d_scope_sizes.empty()) {
+    d_assertions.resize(d_scope_sizes.back());
+    d_scope_sizes.pop_back();
+  }
   yices_pop(d_ctx);
 }
 
 /** Clear all assertions */
 void yices_solver_impl::reset(){
+  d_pending.clear();
+  d_assertions.clear();
+  d_scope_sizes.clear();
+  d_last_assumptions.clear();
   yices_reset_context(d_ctx);  
 }
 
@@ -176,8 +226,40 @@ yices_solver_impl::model_ref yices_solver_impl::get_model(){
   return model_ref(new yices_model_impl(model, *this, d_efac));
 }
 
+void yices_solver_impl::write_smt_lib(raw_ostream &o,
+                                      const ExprVector &assumptions) {
+  SmtLibWriter writer(o);
+  ExprVector all(d_assertions);
+  all.insert(all.end(), assumptions.begin(), assumptions.end());
+  ExprSet declared;
+  for (Expr e : all) {
+    ExprVector consts;
+    filter(e, bind::IsConst(), std::back_inserter(consts));
+    for (Expr c : consts) {
+      Expr fdecl = bind::fname(c);
+      if (declared.insert(fdecl).second) {
+        writer.writeDeclareFun(fdecl);
+        o << "\n";
+      }
+    }
+  }
+  for (Expr e : d_assertions)
+    writer.writeAssert(e);
+  if (assumptions.empty()) {
+    o << "(check-sat)\n";
+    return;
+  }
+  o << "(check-sat-assuming (";
+  for (unsigned i = 0, sz = assumptions.size(); i < sz; ++i) {
+    if (i > 0)
+      o << " ";
+    writer.writeTerm(assumptions[i]);
+  }
+  o << "))\n";
+}
+
 void yices_solver_impl::to_smt_lib(raw_ostream& o) {
-  errs() << "Warning: yices::to_smt_lib is not implemented\n";
+  write_smt_lib(o, ExprVector());
 }
 
 }
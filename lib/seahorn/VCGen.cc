@@ -7,6 +7,7 @@
 #include "seahorn/Support/Stats.hh"
 #include "seahorn/VCGen.hh"
 
+#include "seahorn/Expr/ExprAig.hh"
 #include "seahorn/Expr/ExprOpBinder.hh"
 #include "seahorn/Support/SeaDebug.h"
 
@@ -30,6 +31,12 @@ static llvm::cl::opt<bool>
                                 "imprecise depending on other configurations."),
                  llvm::cl::init(false), llvm::cl::Hidden);
 
+static llvm::cl::opt<bool>
+    UseAig("horn-vcgen-aig",
+           llvm::cl::desc("Simplify the Boolean structure of the VC of each "
+                          "edge with an AIG and SAT sweeping"),
+           llvm::cl::init(false), llvm::cl::Hidden);
+
 using namespace seahorn;
 namespace seahorn {
 
@@ -109,6 +116,17 @@ void VCGen::checkSideAtEnd(unsigned &head, ExprVector &side,
   }
 }
 
+/// Simplify the Boolean structure of side[start..] in a single AIG
+static void aigSide(ExprVector &side, unsigned start) {
+  if (start >= side.size())
+    return;
+  ScopedStats __st__("VCGen.aig");
+  ExprVector conj(side.begin() + start, side.end());
+  boolop::fraig(conj);
+  side.resize(start);
+  side.insert(side.end(), conj.begin(), conj.end());
+}
+
 void VCGen::genVcForCpEdgeLegacy(SymStore &s, const CpEdge &edge,
                                  ExprVector &side, bool includePhi) {
   OpSemContextPtr ctx = m_sem.mkContext(s, side);
@@ -125,6 +143,7 @@ void VCGen::genVcForCpEdge(OpSemContext &ctx, const CpEdge &edge,
 
   // remember what was added since last call to smt
   unsigned head = ctx.side().size();
+  const unsigned start = head;
 
   bool isEntry = true;
   for (const BasicBlock &bb : edge) {
@@ -157,6 +176,9 @@ void VCGen::genVcForCpEdge(OpSemContext &ctx, const CpEdge &edge,
     if (smt)
       checkSideAtEnd(head, ctx.side(), *smt);
   }
+
+  if (UseAig)
+    aigSide(ctx.side(), start);
 }
 
 namespace sem_detail {
@@ -0,0 +1,32 @@
+// RUN: %sea bpf -O0 --bmc=mono --bound=2 --inline --enum-verifier-calls --horn-slice-asserts --horn-stats "%s" 2>&1 | OutputCheck %s --check-prefix=ALL
+// RUN: %sea bpf -O0 --bmc=mono --bound=2 --inline --enum-verifier-calls --horn-slice-asserts --horn-slice-assert-id=0 --horn-stats "%s" 2>&1 | OutputCheck %s --check-prefix=ID0
+// RUN: %sea bpf -O0 --bmc=mono --bound=2 --inline --enum-verifier-calls --horn-slice-asserts --horn-slice-assert-id=1 --horn-stats "%s" 2>&1 | OutputCheck %s --check-prefix=ID1
+// ALL: ^sat$
+// ID0: ^unsat$
+// ID0: ^BRUNCH_STAT slice.other_asserts 1$
+// ID1: ^sat$
+// ID1: ^BRUNCH_STAT slice.other_asserts 1$
+
+/**
+ * EnumVerifierCalls numbers the calls to verifier.error of a function
+ * from last to first: the assertion on x is 0, the one on y is 1.
+ *
+ * Only the assertion on y fails. Keeping only the assertion on x
+ * assumes that the other one holds, and the program becomes safe.
+ **/
+
+extern int nd(void);
+extern void __VERIFIER_assume(int);
+extern void __VERIFIER_error(void) __attribute__((noreturn));
+#define assume __VERIFIER_assume
+#define assert(X) if(!(X)){__VERIFIER_error();}
+
+int main() {
+  int x = nd();
+  int y = nd();
+  assume(x > 0);
+
+  assert(y > 0);
+  assert(x > 0);
+  return 0;
+}
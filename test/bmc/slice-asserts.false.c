@@ -0,0 +1,29 @@
+// RUN: %sea bpf -O0 --bmc=mono --bound=2 --inline --horn-slice-asserts --horn-stats "%s" 2>&1 | OutputCheck %s
+// RUN: %sea bpf -O3 --bmc=mono --bound=2 --inline --horn-slice-asserts --horn-stats "%s" 2>&1 | OutputCheck %s
+// CHECK: ^sat$
+
+/**
+ * Slicing keeps every assertion, so the one that fails is still found.
+ **/
+
+extern int nd(void);
+extern void __VERIFIER_assume(int);
+extern void __VERIFIER_error(void) __attribute__((noreturn));
+#define assume __VERIFIER_assume
+#define assert(X) if(!(X)){__VERIFIER_error();}
+
+int g;
+
+int main() {
+  int x = nd();
+  int y = nd();
+  assume(x > 0);
+
+  /* does not affect any assertion */
+  int z = x * x + 7;
+  g = z;
+
+  assert(x > 0);
+  assert(y > 0);
+  return 0;
+}
@@ -0,0 +1,33 @@
+// RUN: %sea bpf -O0 --bmc=mono --bound=2 --inline --horn-slice-asserts --horn-stats "%s" 2>&1 | OutputCheck %s
+// CHECK: ^unsat$
+// CHECK: ^BRUNCH_STAT slice.removed_insts [1-9][0-9]*$
+
+/**
+ * The computation of z and the store to g are removed, the
+ * assertions and the assumption they depend on are kept.
+ **/
+
+extern int nd(void);
+extern void __VERIFIER_assume(int);
+extern void __VERIFIER_error(void) __attribute__((noreturn));
+#define assume __VERIFIER_assume
+#define assert(X) if(!(X)){__VERIFIER_error();}
+
+int g;
+
+int main() {
+  int x = nd();
+  int y = nd();
+  assume(x > 0);
+  assume(y > x);
+
+  /* does not affect any assertion */
+  int z = x * x + 7;
+  if (nd())
+    z = z - y;
+  g = z;
+
+  assert(x > 0);
+  assert(y > 1);
+  return 0;
+}
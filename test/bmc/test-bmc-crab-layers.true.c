@@ -0,0 +1,37 @@
+// RUN: %sea bpf -O0 --bound=1 --bmc=path --horn-bmc-crab=true --horn-bmc-crab-invariants=false --horn-bmc-crab-layers=int,zones --horn-stats --inline "%s" 2>&1 | OutputCheck %s
+// CHECK: ^unsat$
+// CHECK: ^BRUNCH_STAT BMC number symbolic paths discharged by Crab [1-9][0-9]*$
+// CHECK: ^BRUNCH_STAT BMC path-based: crab layer int refuted 0$
+// CHECK: ^BRUNCH_STAT BMC path-based: crab layer zones refuted [1-9][0-9]*$
+
+/* Test option --horn-bmc-crab-layers: intervals cannot refute any path
+   to the error since it needs x <= y, but zones refute all of them */
+extern int nd(void);
+extern void __VERIFIER_error(void) __attribute__((noreturn));
+extern void __VERIFIER_assume (int);
+extern void avoid_select_inst(void);
+#define assert(X) if(!(X)){__VERIFIER_error();}
+#define assume __VERIFIER_assume
+
+int main(){
+  int x = nd();
+  int y = nd();
+  assume(x >= 0);
+  assume(y <= 100);
+  assume(x <= y);
+
+  if (nd()) {
+    x++;
+    y++;
+    avoid_select_inst();
+  }
+
+  if (nd()) {
+    x++;
+    y+=2;
+    avoid_select_inst();
+  }
+
+  assert(x <= y);
+  return 0;
+}
@@ -0,0 +1,31 @@
+// RUN: %sea bpf -O0 --bmc=mono --horn-bv2=true --horn-gsa --gsa-lazy --gsa-replace-phis=false --bound=2 --horn-stats --inline "%s" 2>&1 | OutputCheck %s
+// CHECK: ^unsat$
+// CHECK: ^BRUNCH_STAT GSA.lazy.phis [1-9][0-9]*$
+
+/**
+ * The phi nodes of y and z are encoded by their gates, computed on
+ * demand while encoding. The assertion holds only if the gates are
+ * correct.
+ **/
+
+extern int nd(void);
+extern void __VERIFIER_error(void) __attribute__((noreturn));
+#define assert(X) if(!(X)){__VERIFIER_error();}
+
+int main() {
+  int x = nd();
+  int y, z;
+  if (x > 0) {
+    y = 1;
+    z = x;
+  } else if (x < -5) {
+    y = 2;
+    z = -1;
+  } else {
+    y = 3;
+    z = 0;
+  }
+  assert((y == 1) == (z > 0));
+  assert((y == 2) == (z < 0));
+  return 0;
+}
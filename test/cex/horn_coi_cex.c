@@ -0,0 +1,27 @@
+// RUN: %sea pf -O0 --horn-coi --cex=/tmp/test_horn_coi_cex.ll "%s" 2>&1 | OutputCheck %s --check-prefix=SOLVE
+// RUN: %cex --run -g %s /tmp/test_horn_coi_cex.ll 2>&1 | OutputCheck %s
+
+// SOLVE: ^sat$
+// CHECK: ^__VERIFIER_error was executed$
+
+/*
+   The cone of influence of the query does not include y, but the
+   counterexample is mapped to the blocks of the original program, so
+   --horn-coi is ignored when a counterexample is requested.
+*/
+
+#include "seahorn/seahorn.h"
+
+extern int nd_int(void);
+
+int main(int argc, char **argv) {
+  int x = nd_int();
+  int y = nd_int();
+  assume(x >= 0);
+  assume(x <= 10);
+  while (y > 0)
+    y--;
+  if (x > 5)
+    __VERIFIER_error();
+  return 0;
+}
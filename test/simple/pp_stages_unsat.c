@@ -0,0 +1,31 @@
+// RUN: %sea pf "%s" 2>&1 | OutputCheck %s
+// RUN: rm -rf %t.d && mkdir -p %t.d/keep
+// RUN: %sea clang -o %t.d/in.bc "%s"
+//
+// -- pp and ms in the seahorn process give the answer of the sea flow
+// RUN: cd %t.d && %horn --horn-pp-stages=pp,ms --horn-solve --keep-shadows=true -horn-inter-proc -horn-sem-lvl=mem --horn-step=large %t.d/in.bc 2>&1 | OutputCheck %s
+// -- and write no intermediate bitcode by default
+// RUN: not ls %t.d/in.pp.bc
+// RUN: not ls %t.d/in.pp.ms.bc
+//
+// -- unless --horn-pp-keep-dir is given
+// RUN: %horn --horn-pp-stages=pp,ms --horn-pp-keep-dir=%t.d/keep --horn-solve --keep-shadows=true -horn-inter-proc -horn-sem-lvl=mem --horn-step=large %t.d/in.bc 2>&1 | OutputCheck %s
+// RUN: ls %t.d/keep | OutputCheck %s --check-prefix=KEEP
+// CHECK: ^unsat$
+// KEEP: ^in.pp.bc$
+// KEEP-NEXT: ^in.pp.ms.bc$
+
+#include "seahorn/seahorn.h"
+extern int unknown1();
+
+int main() {
+  int x = 1;
+  int y = 1;
+  while (unknown1()) {
+    int t1 = x;
+    int t2 = y;
+    x = t1 + t2;
+    y = t1 + t2;
+  }
+  sassert(y >= 1);
+}
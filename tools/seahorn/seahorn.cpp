@@ -7,9 +7,11 @@
 
 #include "llvm_seahorn/InitializePasses.h"
 #include "llvm_seahorn/Transforms/IPO.h"
+#include "llvm/Bitcode/BitcodeWriterPass.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/InitializePasses.h"
 #include "llvm/LinkAllPasses.h"
@@ -17,6 +19,7 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/SourceMgr.h"
@@ -48,10 +51,13 @@
 #include "seadsa/support/RemovePtrToInt.hh"
 
 #include "seahorn/Expr/Smt/EZ3.hh"
+#include "seahorn/Support/QueryStats.hh"
 #include "seahorn/Support/Stats.hh"
 #include "seahorn/Transforms/Utils/NameValues.hh"
 
 #include "seahorn/Support/GitSHA1.h"
+
+#include "SeappPipeline.hh"
 void print_seahorn_version(llvm::raw_ostream &OS) {
   OS << "SeaHorn (http://seahorn.github.io/):\n"
      << "  SeaHorn version " << SEAHORN_VERSION_INFO << "-" << g_GIT_SHA1
@@ -178,6 +184,12 @@ static llvm::cl::opt<bool>
                  llvm::cl::desc("One assume to rule them all"),
                  llvm::cl::init(false));
 
+static llvm::cl::opt<bool> SliceAsserts(
+    "horn-slice-asserts",
+    llvm::cl::desc("Remove instructions that cannot affect any assertion "
+                   "(see --horn-slice-assert-id)"),
+    llvm::cl::init(false));
+
 static llvm::cl::opt<bool> HoudiniInv(
     "horn-houdini",
     llvm::cl::desc("Use Houdini algorithm to generate inductive invariants"),
@@ -205,6 +217,32 @@ static llvm::cl::opt<bool> EvalBranchSentinelOpt(
     llvm::cl::desc("Evaluate intrinsics added by AddBranchSentinel pass."),
     llvm::cl::init(false));
 
+// Stages of seapp that can run in-process, in the order used by sea
+enum class PpStage { pp, ms, cut };
+
+static llvm::cl::list<PpStage> PpStages(
+    "horn-pp-stages",
+    llvm::cl::desc("Run these seapp stages on the input before seahorn, "
+                   "in the same process and on the same module"),
+    llvm::cl::values(clEnumValN(PpStage::pp, "pp", "Pre-processing (sea pp)"),
+                     clEnumValN(PpStage::ms, "ms",
+                                "Mixed semantics (sea ms)"),
+                     clEnumValN(PpStage::cut, "cut",
+                                "Loop cutting (sea cut-loops)")),
+    llvm::cl::CommaSeparated);
+
+static llvm::cl::opt<std::string> PpKeepDir(
+    "horn-pp-keep-dir",
+    llvm::cl::desc("Write the bitcode produced by each stage of "
+                   "--horn-pp-stages to this directory"),
+    llvm::cl::init(""), llvm::cl::value_desc("dir"));
+
+static llvm::cl::opt<unsigned>
+    PeelLoops("horn-peel-loops",
+              llvm::cl::desc("Number of iterations to peel in the cut stage "
+                             "of --horn-pp-stages"),
+              llvm::cl::init(0));
+
 // removes extension from filename if there is one
 std::string getFileName(const std::string &str) {
   std::string filename = str;
@@ -214,6 +252,54 @@ std::string getFileName(const std::string &str) {
   return filename;
 }
 
+
+/// Runs one seapp stage on M, as a separate seapp process would. base
+/// is the name of the bitcode of the previous stage, without extension.
+static void runPpStage(llvm::Module &M, PpStage stage, std::string &base) {
+  seahorn::SeaPassManagerWrapper pm_wrapper;
+  pm_wrapper.add(llvm_seahorn::createSeaAnnotation2MetadataLegacyPass());
+  pm_wrapper.add(seahorn::createSeaBuiltinsWrapperPass());
+
+  const char *name = "";
+  switch (stage) {
+  case PpStage::pp:
+    name = "pp";
+    seahorn::addPreProcessingPasses(pm_wrapper, InlineAll,
+                                    LowerGlobalInitializers);
+    break;
+  case PpStage::ms:
+    name = "ms";
+    seahorn::addMixedSemPasses(pm_wrapper);
+    break;
+  case PpStage::cut:
+    name = "cut";
+    seahorn::addCutLoopsPasses(pm_wrapper, PeelLoops, true);
+    break;
+  }
+  seahorn::addSeappFinalPasses(pm_wrapper);
+
+  // -- intermediate bitcode is only written on request
+  base += std::string(".") + name;
+  std::unique_ptr<llvm::ToolOutputFile> output;
+  if (!PpKeepDir.empty()) {
+    llvm::SmallString<256> path(PpKeepDir);
+    llvm::sys::path::append(path, base + ".bc");
+    std::error_code error_code;
+    output = std::make_unique<llvm::ToolOutputFile>(path, error_code,
+                                                    llvm::sys::fs::OF_None);
+    if (error_code) {
+      ERR << "Could not open " << path << ": " << error_code.message();
+      std::exit(3);
+    }
+    pm_wrapper.add(createBitcodeWriterPass(output->os()));
+  }
+
+  seahorn::ScopedStats _st(std::string("seapp.") + name);
+  pm_wrapper.run(M);
+  if (output)
+    output->keep();
+}
+
 int main(int argc, char **argv) {
   seahorn::ScopedStats _st("seahorn_total");
 
@@ -233,7 +319,10 @@ int main(int argc, char **argv) {
   std::unique_ptr<llvm::ToolOutputFile> output;
   std::unique_ptr<llvm::ToolOutputFile> asmOutput;
 
-  module = llvm::parseIRFile(InputFilename, err, context);
+  {
+    seahorn::ScopedStats _st("seahorn.load");
+    module = seahorn::loadModule(InputFilename, err, context);
+  }
   if (module.get() == 0) {
     if (llvm::errs().has_colors())
       llvm::errs().changeColor(llvm::raw_ostream::RED);
@@ -304,6 +393,18 @@ int main(int argc, char **argv) {
 
   assert(dl && "Could not find Data Layout for the module");
 
+  // -- seapp stages on the module in memory, as sea would run seapp
+  if (!PpStages.empty()) {
+    if (llvm::verifyModule(*module, &(llvm::errs()))) {
+      ERR << "BROKEN INPUT IR\n";
+      return 4;
+    }
+    seahorn::initializeSeappPasses(Registry);
+    std::string base = llvm::sys::path::stem(InputFilename).str();
+    for (PpStage stage : PpStages)
+      runPpStage(*module, stage, base);
+  }
+
   pass_manager.add(llvm_seahorn::createSeaAnnotation2MetadataLegacyPass());
   pass_manager.add(seahorn::createSeaBuiltinsWrapperPass());
   // turn all functions internal so that we can inline them if requested
@@ -385,6 +486,11 @@ int main(int argc, char **argv) {
   if (UnifyAssumes) {
     pass_manager.add(seahorn::createUnifyAssumesPass());
   }
+
+  if (SliceAsserts) {
+    // -- after shadow memory so that memory dependencies are explicit
+    pass_manager.add(seahorn::createAssertionSlicePass());
+  }
   // #ifdef HAVE_CLAM
   //   if (Crab && !BoogieOutput) {
   //     /// -- insert invariants in the bitecode
@@ -476,7 +582,7 @@ int main(int argc, char **argv) {
     if (PredAbs)
       pass_manager.add(new seahorn::PredicateAbstraction());
     if (Solve) {
-      pass_manager.add(new seahorn::HornSolver());
+      pass_manager.add(new seahorn::HornSolver(Cex));
       if (Cex)
         pass_manager.add(new seahorn::HornCex());
     }
@@ -490,5 +596,6 @@ int main(int argc, char **argv) {
     output->keep();
   if (PrintStats)
     seahorn::Stats::PrintBrunch(llvm::outs());
+  seahorn::QueryStats::Print(llvm::outs());
   return 0;
 }
@@ -0,0 +1,475 @@
+///
+// Pass pipelines of seapp. See SeappPipeline.hh
+///
+
+#include "SeappPipeline.hh"
+
+#include "llvm_seahorn/InitializePasses.h"
+#include "llvm_seahorn/Transforms/IPO.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/LinkAllPasses.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Transforms/IPO.h"
+
+#include "seahorn/InitializePasses.hh"
+#include "seahorn/Passes.hh"
+#include "seahorn/config.h"
+
+#include "seadsa/InitializePasses.hh"
+#include "seadsa/support/RemovePtrToInt.hh"
+
+#ifdef HAVE_LLVM_SEAHORN
+#include "llvm_seahorn/Transforms/Scalar.h"
+#endif
+
+#include "seahorn/Transforms/Utils/NameValues.hh"
+
+static llvm::cl::opt<bool> InlineAllocFn(
+    "horn-inline-allocators",
+    llvm::cl::desc("Inline functions that allocate or deallocate memory"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool>
+    InlineConstructFn("horn-inline-constructors",
+                      llvm::cl::desc("Inline C++ constructors and destructors"),
+                      llvm::cl::init(false));
+
+static llvm::cl::opt<bool> SymbolizeLoops(
+    "horn-symbolize-loops",
+    llvm::cl::desc("Convert constant loop bounds into symbolic bounds"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool>
+    KeepArithOverflow("horn-keep-arith-overflow",
+                      llvm::cl::desc("Keep arithmetic overflow intrinsics."),
+                      llvm::cl::init(false));
+
+static llvm::cl::opt<bool> SimplifyPointerLoops(
+    "simplify-pointer-loops",
+    llvm::cl::desc("Simplify loops that iterate over pointers"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> UnfoldLoopsForDsa(
+    "unfold-loops-for-dsa",
+    llvm::cl::desc(
+        "Unfold the first loop iteration if useful for DSA analysis"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> EnumVerifierCalls(
+    "enum-verifier-calls",
+    llvm::cl::desc("Assign a unique identifier to each call to verifier.error"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> KillVaArg("kill-vaarg",
+                                     llvm::cl::desc("Delete vaarg functions"),
+                                     llvm::cl::init(false));
+
+static llvm::cl::opt<bool>
+    StripExtern("strip-extern",
+                llvm::cl::desc("Replace external functions by nondet"),
+                llvm::cl::init(false));
+
+static llvm::cl::opt<bool>
+    LowerInvoke("lower-invoke", llvm::cl::desc("Lower all invoke instructions"),
+                llvm::cl::init(true));
+
+static llvm::cl::opt<bool> DevirtualizeFuncs(
+    "devirt-functions",
+    llvm::cl::desc("Devirtualize indirect calls "
+                   "(disabled by default). "
+                   "If enabled then use "
+                   "--devirt-functions-method=types|sea-dsa to choose method."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> ExternalizeAddrTakenFuncs(
+    "externalize-addr-taken-funcs",
+    llvm::cl::desc("Externalize uses of address-taken functions"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool>
+    LowerAssert("lower-assert",
+                llvm::cl::desc("Replace assertions with assumptions"),
+                llvm::cl::init(false));
+
+static llvm::cl::opt<bool>
+    PromoteAssumptions("promote-assumptions",
+                       llvm::cl::desc("Promote verifier.assume to llvm.assume"),
+                       llvm::cl::init(false));
+
+// static llvm::cl::opt<int>
+//     SROA_Threshold("sroa-threshold",
+//                    llvm::cl::desc("Threshold for ScalarReplAggregates pass"),
+//                    llvm::cl::init(INT_MAX));
+// static llvm::cl::opt<int> SROA_StructMemThreshold(
+//     "sroa-struct",
+//     llvm::cl::desc("Structure threshold for ScalarReplAggregates"),
+//     llvm::cl::init(INT_MAX));
+
+// static llvm::cl::opt<int> SROA_ArrayElementThreshold(
+//     "sroa-array", llvm::cl::desc("Array threshold for ScalarReplAggregates"),
+//     llvm::cl::init(INT_MAX));
+// static llvm::cl::opt<int> SROA_ScalarLoadThreshold(
+//     "sroa-scalar-load",
+//     llvm::cl::desc("Scalar load threshold for ScalarReplAggregates"),
+//     llvm::cl::init(-1));
+
+static llvm::cl::opt<bool>
+    AbstractMemory("abstract-memory",
+                   llvm::cl::desc("Abstract memory instructions"),
+                   llvm::cl::init(false));
+
+static llvm::cl::opt<bool> NameValuesOpt(
+    "name-values",
+    llvm::cl::desc(
+        "Run the seahorn::NameValues pass (WARNING -- can be extremely slow)"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool>
+    InstNamer("instnamer", llvm::cl::desc("Run the llvm's instnamer pass"),
+              llvm::cl::init(false));
+
+static llvm::cl::opt<bool>
+    LowerSwitch("lower-switch",
+                llvm::cl::desc("Lower SwitchInstructions to branches"),
+                llvm::cl::init(true));
+
+static llvm::cl::opt<bool>
+    PromoteBoolLoads("promote-bool-loads",
+                     llvm::cl::desc("Promote bool loads to sgt"),
+                     llvm::cl::init(true));
+
+static llvm::cl::opt<bool>
+    NondetInit("promote-nondet-undef",
+               llvm::cl::desc("Replace all undef with non-determinism"),
+               llvm::cl::init(true));
+
+static llvm::cl::opt<bool> StripDebug("strip-debug",
+                                      llvm::cl::desc("Strip debug info"),
+                                      llvm::cl::init(false));
+
+static llvm::cl::opt<bool> VerifyAfterAll(
+    "verify-after-all",
+    llvm::cl::desc("Run the verification pass after each transformation"),
+    llvm::cl::init(false));
+
+namespace seahorn {
+
+SeaPassManagerWrapper::SeaPassManagerWrapper() {
+  if (VerifyAfterAll)
+    m_PM.add(seahorn::createDebugVerifierPass(++m_verifierInstanceID,
+                                              "Initial Verifier Pass"));
+}
+
+void SeaPassManagerWrapper::add(llvm::Pass *pass) {
+  m_PM.add(pass);
+
+  if (VerifyAfterAll)
+    m_PM.add(seahorn::createDebugVerifierPass(++m_verifierInstanceID,
+                                              pass->getPassName()));
+}
+
+void initializeSeappPasses(llvm::PassRegistry &Registry) {
+  llvm::initializeCore(Registry);
+  llvm::initializeTransformUtils(Registry);
+  llvm::initializeAnalysis(Registry);
+
+  /// call graph and other IPA passes
+  // llvm::initializeIPA (Registry);
+  // XXX: porting to 3.8
+  llvm::initializeCallGraphWrapperPassPass(Registry);
+  // XXX: commented while porting to 5.0
+  // llvm::initializeCallGraphPrinterPass(Registry);
+  llvm::initializeCallGraphViewerPass(Registry);
+  // XXX: not sure if needed anymore
+  llvm::initializeGlobalsAAWrapperPassPass(Registry);
+  llvm::initializeAllocWrapInfoPass(Registry);
+  llvm::initializeDsaLibFuncInfoPass(Registry);
+
+  llvm::initializeCompleteCallGraphPass(Registry);
+  llvm::initializeSeaAnnotation2MetadataLegacyPass(Registry);
+
+  llvm::initializeRemovePtrToIntPass(Registry);
+}
+
+void addPreProcessingPasses(SeaPassManagerWrapper &pm_wrapper, bool inlineAll,
+                            bool lowerGvInit) {
+  // -- Externalize some user-selected functions
+  pm_wrapper.add(seahorn::createExternalizeFunctionsPass());
+
+  // -- Create a main function if we do not have one.
+  pm_wrapper.add(seahorn::createDummyMainFunctionPass());
+
+  // -- promote verifier specific functions to special names
+  pm_wrapper.add(seahorn::createPromoteVerifierCallsPass());
+
+  // -- promote top-level mallocs to alloca
+  pm_wrapper.add(seahorn::createPromoteMallocPass());
+
+  // -- turn loads from _Bool from truc to sgt
+  if (PromoteBoolLoads)
+    pm_wrapper.add(seahorn::createPromoteBoolLoadsPass());
+
+  if (KillVaArg)
+    pm_wrapper.add(seahorn::createKillVarArgFnPass());
+
+  if (StripExtern)
+    pm_wrapper.add(seahorn::createStripUselessDeclarationsPass());
+
+  // -- mark entry points of all functions
+  pm_wrapper.add(seahorn::createMarkFnEntryPass());
+
+  // turn all functions internal so that we can inline them if requested
+  auto PreserveMain = [=](const llvm::GlobalValue &GV) {
+    return GV.getName() == "main" || GV.getName() == "bcmp";
+  };
+  pm_wrapper.add(llvm::createInternalizePass(PreserveMain));
+
+  if (LowerInvoke) {
+    // -- lower invoke's
+    pm_wrapper.add(llvm::createLowerInvokePass());
+    // cleanup after lowering invoke's
+    pm_wrapper.add(llvm::createCFGSimplificationPass());
+  }
+
+  // -- resolve indirect calls
+  if (DevirtualizeFuncs) {
+    pm_wrapper.add(seadsa::createRemovePtrToIntPass());
+    pm_wrapper.add(llvm::createWholeProgramDevirtPass(nullptr, nullptr));
+    pm_wrapper.add(seahorn::createDevirtualizeFunctionsPass());
+  }
+
+  // -- externalize uses of address-taken functions
+  if (ExternalizeAddrTakenFuncs)
+    pm_wrapper.add(seahorn::createExternalizeAddressTakenFunctionsPass());
+
+  // kill internal unused code
+  pm_wrapper.add(llvm::createGlobalDCEPass()); // kill unused internal global
+
+  // -- global optimizations
+  pm_wrapper.add(llvm::createGlobalOptimizerPass());
+
+  // -- explicitly initialize globals in the beginning of main()
+  if (lowerGvInit)
+    pm_wrapper.add(seahorn::createLowerGvInitializersPass());
+
+  // -- SSA
+  pm_wrapper.add(llvm::createPromoteMemoryToRegisterPass());
+
+  if (NondetInit)
+    // -- Turn undef into nondet
+    pm_wrapper.add(seahorn::createNondetInitPass());
+
+  // -- Promote memcpy to loads-and-stores for easier alias analysis.
+  pm_wrapper.add(seahorn::createPromoteMemcpyPass());
+
+  // -- cleanup after SSA
+  pm_wrapper.add(seahorn::createInstCombine());
+  pm_wrapper.add(llvm::createCFGSimplificationPass());
+
+  // -- break aggregates
+  // XXX: createScalarReplAggregatesPass is not defined in llvm 5.0
+  // pm_wrapper.add(llvm::createScalarReplAggregatesPass(
+  //     SROA_Threshold, true, SROA_StructMemThreshold,
+  //     SROA_ArrayElementThreshold, SROA_ScalarLoadThreshold));
+  pm_wrapper.add(llvm::createSROAPass());
+  if (NondetInit)
+    // -- Turn undef into nondet (undef are created by SROA when it calls
+    //     mem2reg)
+    pm_wrapper.add(seahorn::createNondetInitPass());
+
+  // -- cleanup after break aggregates
+  pm_wrapper.add(seahorn::createInstCombine());
+  pm_wrapper.add(llvm::createCFGSimplificationPass());
+
+  // eliminate unused calls to verifier.nondet() functions
+  pm_wrapper.add(seahorn::createDeadNondetElimPass());
+
+  if (LowerSwitch)
+    pm_wrapper.add(llvm::createLowerSwitchPass());
+
+  pm_wrapper.add(llvm::createDeadCodeEliminationPass());
+  // Superseded by DCE in LLVM12
+  //pm_wrapper.add(llvm::createDeadInstEliminationPass());
+  pm_wrapper.add(seahorn::createRemoveUnreachableBlocksPass());
+
+  if (!KeepArithOverflow)
+    // lower arithmetic with overflow intrinsics
+    pm_wrapper.add(seahorn::createLowerArithWithOverflowIntrinsicsPass());
+  // lower libc++abi functions
+  pm_wrapper.add(seahorn::createLowerLibCxxAbiFunctionsPass());
+
+  // cleanup after lowering
+  pm_wrapper.add(seahorn::createInstCombine());
+  pm_wrapper.add(llvm::createCFGSimplificationPass());
+
+  if (UnfoldLoopsForDsa) {
+    // --- help DSA to be more precise
+#ifdef HAVE_LLVM_SEAHORN
+    pm_wrapper.add(llvm_seahorn::createFakeLatchExitPass());
+#endif
+    pm_wrapper.add(seahorn::createUnfoldLoopForDsaPass());
+  }
+
+  if (SimplifyPointerLoops) {
+    // --- simplify loops that iterate over pointers
+    pm_wrapper.add(seahorn::createSimplifyPointerLoopsPass());
+  }
+
+  // XXX: AG: Should not be part of standard pipeline
+  if (AbstractMemory) {
+    // -- abstract memory load/stores pointer operands with
+    // -- non-deterministic values
+    pm_wrapper.add(seahorn::createAbstractMemoryPass());
+    // -- abstract memory pass generates a lot of dead load/store
+    // -- instructions
+    pm_wrapper.add(llvm::createDeadCodeEliminationPass());
+    // Superseded by DCE in LLVM12
+    //pm_wrapper.add(llvm::createDeadInstEliminationPass());
+  }
+
+  // AG: Used for inconsistency analysis
+  // XXX Should be moved out of standard pp pipeline
+  if (LowerAssert) {
+    pm_wrapper.add(seahorn::createLowerAssertPass());
+    // LowerAssert might generate some dead code
+    pm_wrapper.add(llvm::createDeadCodeEliminationPass());
+    // Superseded by DCE in LLVM12      
+    //pm_wrapper.add(llvm::createDeadInstEliminationPass());
+  }
+  pm_wrapper.add(seahorn::createRemoveUnreachableBlocksPass());
+
+  // -- request seaopt to inline all functions
+  if (inlineAll) {
+    pm_wrapper.add(llvm_seahorn::createSeaAnnotation2MetadataLegacyPass());
+    pm_wrapper.add(seahorn::createMarkInternalInlinePass());
+  } else {
+    // mark memory allocator/deallocators to be inlined
+    if (InlineAllocFn)
+      pm_wrapper.add(seahorn::createMarkInternalAllocOrDeallocInlinePass());
+    // mark constructors to be inlined
+    if (InlineConstructFn)
+      pm_wrapper.add(
+          seahorn::createMarkInternalConstructOrDestructInlinePass());
+  }
+
+  // run inliner pass
+  if (inlineAll || InlineAllocFn || InlineConstructFn) {
+    pm_wrapper.add(llvm::createAlwaysInlinerLegacyPass());
+    pm_wrapper.add(
+        llvm::createGlobalDCEPass()); // kill unused internal global
+    pm_wrapper.add(seahorn::createPromoteMallocPass());
+    pm_wrapper.add(seahorn::createRemoveUnreachableBlocksPass());
+
+    // -- Promote memcpy to loads-and-stores for easier alias analysis.
+    // -- inline can help with alignment which will help this pass
+    pm_wrapper.add(seahorn::createPromoteMemcpyPass());
+  }
+
+  // -- EVERYTHING IS MORE EXPENSIVE AFTER INLINING
+  // -- BEFORE SCHEDULING PASSES HERE, THINK WHETHER THEY BELONG BEFORE
+  // INLINE!
+  pm_wrapper.add(llvm::createDeadCodeEliminationPass());
+  // Superseded by DCE in LLVM12      
+  // pm_wrapper.add(llvm::createDeadInstEliminationPass());
+  pm_wrapper.add(llvm::createGlobalDCEPass()); // kill unused internal global
+  pm_wrapper.add(llvm::createUnifyFunctionExitNodesPass());
+
+  // -- moves loop initialization up
+  // AG: After inline because cheap and loop initialization is moved higher up
+  if (SymbolizeLoops)
+    pm_wrapper.add(seahorn::createSymbolizeConstantLoopBoundsPass());
+
+  // AG: Maybe should be moved before inline. Not used as far as I know.
+  if (EnumVerifierCalls)
+    pm_wrapper.add(seahorn::createEnumVerifierCallsPass());
+
+  pm_wrapper.add(seahorn::createRemoveUnreachableBlocksPass());
+  pm_wrapper.add(seahorn::createPromoteMallocPass());
+  pm_wrapper.add(llvm::createGlobalDCEPass()); // kill unused internal global
+
+  // -- Enable function slicing
+  // AG: NOT USED. Not part of std pipeline
+  pm_wrapper.add(seahorn::createSliceFunctionsPass());
+
+  // -- Create a main function if we sliced it away
+  pm_wrapper.add(seahorn::createDummyMainFunctionPass());
+
+  // AG: Dangerous. Promotes verifier.assume() to llvm.assume()
+  if (PromoteAssumptions)
+    pm_wrapper.add(seahorn::createPromoteSeahornAssumePass());
+}
+
+void addMixedSemPasses(SeaPassManagerWrapper &pm_wrapper) {
+  // -- apply mixed semantics
+  assert(LowerSwitch && "Lower switch must be enabled");
+  pm_wrapper.add(llvm::createLowerSwitchPass());
+  pm_wrapper.add(seahorn::createPromoteVerifierCallsPass());
+  pm_wrapper.add(seahorn::createCanFailPass());
+  pm_wrapper.add(seahorn::createMixedSemanticsPass());
+  pm_wrapper.add(seahorn::createRemoveUnreachableBlocksPass());
+  pm_wrapper.add(seahorn::createPromoteMallocPass());
+}
+
+void addCutLoopsPasses(SeaPassManagerWrapper &pm_wrapper, unsigned peel,
+                       bool cut) {
+  // -- cut loops to turn a program into loop-free program
+  assert(LowerSwitch && "Lower switch must be enabled");
+  pm_wrapper.add(llvm::createLowerSwitchPass());
+  pm_wrapper.add(llvm::createLoopSimplifyPass());
+  pm_wrapper.add(llvm::createLoopSimplifyCFGPass());
+  pm_wrapper.add(llvm_seahorn::createLoopRotatePass(/*1023*/));
+  pm_wrapper.add(llvm::createLCSSAPass());
+  if (peel > 0)
+    pm_wrapper.add(seahorn::createLoopPeelerPass(peel));
+  if (cut) {
+    pm_wrapper.add(seahorn::createBackEdgeCutterPass());
+    // -- disabled. back-edge-cutter should be more robust
+    // pm_wrapper.add(seahorn::createCutLoopsPass());
+  }
+  // pm_wrapper.add (new seahorn::RemoveUnreachableBlocksPass ());
+}
+
+void addSeappFinalPasses(SeaPassManagerWrapper &pm_wrapper) {
+  if (NameValuesOpt)
+    pm_wrapper.add(seahorn::createNameValuesPass());
+
+  if (InstNamer)
+    pm_wrapper.add(llvm::createInstructionNamerPass());
+
+  if (StripDebug)
+    pm_wrapper.add(llvm::createStripDeadDebugInfoPass());
+
+  // --- verify if an undefined value can be read
+  pm_wrapper.add(seahorn::createCanReadUndefPass());
+  // --- verify if bitcode is well-formed
+  pm_wrapper.add(llvm::createVerifierPass());
+}
+
+std::unique_ptr<llvm::Module> loadModule(llvm::StringRef filename,
+                                         llvm::SMDiagnostic &err,
+                                         llvm::LLVMContext &context) {
+  // -- without a null terminator, large files are mapped, not read
+  auto buf = llvm::MemoryBuffer::getFileOrSTDIN(
+      filename, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+  if (std::error_code ec = buf.getError()) {
+    err = llvm::SMDiagnostic(filename, llvm::SourceMgr::DK_Error,
+                             "Could not open input file: " + ec.message());
+    return nullptr;
+  }
+
+  llvm::MemoryBufferRef ref = (*buf)->getMemBufferRef();
+  if (llvm::isBitcode(
+          reinterpret_cast<const unsigned char *>(ref.getBufferStart()),
+          reinterpret_cast<const unsigned char *>(ref.getBufferEnd())))
+    return llvm::parseIR(ref, err, context);
+
+  // -- the assembly parser needs a null-terminated buffer
+  auto text = llvm::MemoryBuffer::getMemBufferCopy(ref.getBuffer(), filename);
+  return llvm::parseIR(text->getMemBufferRef(), err, context);
+}
+} // namespace seahorn
@@ -0,0 +1,57 @@
+#pragma once
+///
+// Pass pipelines of seapp.
+//
+// Shared by seapp and by seahorn, which can run the seapp stages
+// in-process (see --horn-pp-stages) instead of re-reading the bitcode
+// written by a separate seapp process.
+///
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+
+#include <memory>
+
+namespace llvm {
+class LLVMContext;
+class PassRegistry;
+class SMDiagnostic;
+} // namespace llvm
+
+namespace seahorn {
+
+/// Simple wrapper around llvm::legacy::PassManager for easier debugging.
+class SeaPassManagerWrapper {
+  llvm::legacy::PassManager m_PM;
+  int m_verifierInstanceID = 0;
+
+public:
+  SeaPassManagerWrapper();
+  void add(llvm::Pass *pass);
+
+  void run(llvm::Module &m) { m_PM.run(m); }
+
+  llvm::legacy::PassManager &getPassManager() { return m_PM; }
+};
+
+/// Registers the analyses required by the seapp pipelines
+void initializeSeappPasses(llvm::PassRegistry &Registry);
+
+/// Default pre-processing pipeline (sea pp)
+void addPreProcessingPasses(SeaPassManagerWrapper &pm_wrapper, bool inlineAll,
+                            bool lowerGvInit);
+/// Mixed-semantics transformation (sea ms)
+void addMixedSemPasses(SeaPassManagerWrapper &pm_wrapper);
+/// Loop peeling and cutting (sea cut-loops)
+void addCutLoopsPasses(SeaPassManagerWrapper &pm_wrapper, unsigned peel,
+                       bool cut);
+/// Passes that end every run of seapp: naming and well-formedness checks
+void addSeappFinalPasses(SeaPassManagerWrapper &pm_wrapper);
+
+/// Reads a module from bitcode or textual IR. Bitcode is parsed directly
+/// from the memory-mapped file, without a null-terminated copy.
+std::unique_ptr<llvm::Module> loadModule(llvm::StringRef filename,
+                                         llvm::SMDiagnostic &err,
+                                         llvm::LLVMContext &context);
+} // namespace seahorn
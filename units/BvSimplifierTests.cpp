@@ -0,0 +1,258 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/ExprBvSimplifier.hh"
+#include "seahorn/Expr/ExprGmp.hh"
+#include "seahorn/Expr/ExprOpBinder.hh"
+#include "seahorn/Expr/ExprOpBv.hh"
+#include "seahorn/Expr/Smt/EZ3.hh"
+#include "seahorn/Expr/Smt/Z3.hh"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <random>
+
+#include "sea_doctest.hh" // doctest is last to avoid name clash
+
+using namespace expr;
+using namespace expr::op;
+using namespace seahorn;
+
+static Expr mkBvConst(const std::string &name, unsigned width,
+                      ExprFactory &efac) {
+  return bv::bvConst(mkTerm<std::string>(name, efac), width);
+}
+
+static Expr mkArrayConst(const std::string &name, unsigned width,
+                         ExprFactory &efac) {
+  Expr ty = bv::bvsort(width, efac);
+  return bind::mkConst(mkTerm<std::string>(name, efac),
+                       sort::arrayTy(ty, ty));
+}
+
+static bool isValid(EZ3 &z3, Expr e) {
+  ZSolver<EZ3> solver(z3);
+  solver.assertExpr(mk<NEG>(e));
+  return static_cast<bool>(!solver.solve());
+}
+
+namespace {
+/// Generates random QF_ABV terms over 8-bit variables x and y and an
+/// array a. Numerals are frequent so that most rules apply.
+class TermGen {
+  ExprFactory &m_efac;
+  std::mt19937 m_rng;
+  Expr m_x, m_y, m_a;
+
+  unsigned pick(unsigned n) { return m_rng() % n; }
+  Expr num(unsigned v, unsigned w = 8) { return bv::bvnum(v, w, m_efac); }
+
+public:
+  TermGen(ExprFactory &efac, unsigned seed)
+      : m_efac(efac), m_rng(seed), m_x(mkBvConst("x", 8, efac)),
+        m_y(mkBvConst("y", 8, efac)), m_a(mkArrayConst("a", 8, efac)) {}
+
+  Expr array(unsigned depth) {
+    if (depth == 0 || pick(3) == 0)
+      return m_a;
+    return mk<STORE>(array(depth - 1), bv(depth - 1), bv(depth - 1));
+  }
+
+  Expr cond(unsigned depth) {
+    Expr l = bv(depth), r = bv(depth);
+    switch (pick(5)) {
+    case 0:
+      return mk<EQ>(l, r);
+    case 1:
+      return mk<BULT>(l, r);
+    case 2:
+      return mk<BSLE>(l, r);
+    case 3:
+      return mk<NEQ>(l, r);
+    default:
+      return mk<BUGE>(l, r);
+    }
+  }
+
+  Expr bv(unsigned depth) {
+    if (depth == 0) {
+      switch (pick(4)) {
+      case 0:
+        return m_x;
+      case 1:
+        return m_y;
+      default:
+        return num(pick(4) == 0 ? 255 : pick(8));
+      }
+    }
+    --depth;
+    switch (pick(20)) {
+    case 0:
+      return mk<BADD>(bv(depth), bv(depth));
+    case 1:
+      return mk<BSUB>(bv(depth), bv(depth));
+    case 2:
+      return mk<BMUL>(bv(depth), bv(depth));
+    case 3:
+      return mk<BAND>(bv(depth), bv(depth));
+    case 4:
+      return mk<BOR>(bv(depth), bv(depth));
+    case 5:
+      return mk<BXOR>(bv(depth), bv(depth));
+    case 6:
+      return mk<BNOT>(bv(depth));
+    case 7:
+      return mk<BNEG>(bv(depth));
+    case 8:
+      return mk<BUDIV>(bv(depth), bv(depth));
+    case 9:
+      return mk<BUREM>(bv(depth), bv(depth));
+    case 10:
+      return mk<BSDIV>(bv(depth), bv(depth));
+    case 11:
+      return mk<BSREM>(bv(depth), bv(depth));
+    case 12:
+      return mk<BSHL>(bv(depth), bv(depth));
+    case 13:
+      return mk<BLSHR>(bv(depth), bv(depth));
+    case 14:
+      return mk<BASHR>(bv(depth), bv(depth));
+    case 15: {
+      unsigned l = pick(8), h = l + pick(8 - l);
+      Expr ext = bv::extract(h, l, bv(depth));
+      if (h - l + 1 == 8)
+        return ext;
+      return pick(2) ? bv::zext(ext, 8) : bv::sext(ext, 8);
+    }
+    case 16: {
+      Expr v = bv(depth);
+      return bv::concat(bv::extract(3, 0, v),
+                        bv::extract(7, 4, pick(2) ? v : bv(depth)));
+    }
+    case 17:
+      return mk<ITE>(cond(depth), bv(depth), bv(depth));
+    default:
+      return mk<SELECT>(array(depth), bv(depth));
+    }
+  }
+};
+} // namespace
+
+TEST_CASE("bv_simplifier.fold") {
+  ExprFactory efac;
+  bv::BvSimplifier simp(efac);
+  Expr x = mkBvConst("x", 8, efac);
+  auto num = [&efac](unsigned v) { return bv::bvnum(v, 8, efac); };
+
+  CHECK(simp.simplify(mk<BADD>(num(200), num(100))) == num(44));
+  CHECK(simp.simplify(mk<BUDIV>(num(7), num(0))) == num(255));
+  CHECK(simp.simplify(mk<BUREM>(num(7), num(0))) == num(7));
+  // -- -8 / 3 = -2, -8 % 3 = -2
+  CHECK(simp.simplify(mk<BSDIV>(num(248), num(3))) == num(254));
+  CHECK(simp.simplify(mk<BSREM>(num(248), num(3))) == num(254));
+  CHECK(simp.simplify(mk<BASHR>(num(128), num(9))) == num(255));
+  CHECK(simp.simplify(mk<BSLT>(num(128), num(1))) == mk<TRUE>(efac));
+  CHECK(simp.simplify(bv::sext(bv::bvnum(2, 2, efac), 8)) == num(254));
+  CHECK(simp.simplify(mk<BSUB>(x, x)) == num(0));
+  CHECK(simp.simplify(mk<BXOR>(x, mk<BXOR>(num(3), x))) == num(3));
+  CHECK(simp.simplify(mk<BAND>(x, mk<BMUL>(num(0), x))) == num(0));
+}
+
+TEST_CASE("bv_simplifier.canonical") {
+  ExprFactory efac;
+  bv::BvSimplifier simp(efac);
+  Expr x = mkBvConst("x", 8, efac), y = mkBvConst("y", 8, efac);
+  auto num = [&efac](unsigned v) { return bv::bvnum(v, 8, efac); };
+
+  Expr e1 = mk<BADD>(mk<BADD>(x, num(1)), mk<BADD>(y, num(2)));
+  Expr e2 = mk<BADD>(y, mk<BADD>(num(3), x));
+  CHECK(simp.simplify(e1) == simp.simplify(e2));
+  CHECK(simp.simplify(mk<BSUB>(e1, num(3))) == simp.simplify(mk<BADD>(y, x)));
+  CHECK(simp.simplify(mk<BAND>(mk<BAND>(x, y), mk<BAND>(y, x))) ==
+        simp.simplify(mk<BAND>(y, x)));
+}
+
+TEST_CASE("bv_simplifier.extract") {
+  ExprFactory efac;
+  bv::BvSimplifier simp(efac);
+  Expr x = mkBvConst("x", 8, efac), y = mkBvConst("y", 8, efac);
+
+  Expr xy = bv::concat(x, y);
+  CHECK(simp.simplify(bv::extract(11, 8, xy)) == bv::extract(3, 0, x));
+  CHECK(simp.simplify(bv::extract(7, 0, xy)) == y);
+  CHECK(simp.simplify(bv::concat(bv::extract(7, 4, x),
+                                 bv::extract(3, 0, x))) == x);
+  CHECK(simp.simplify(bv::extract(15, 8, bv::zext(x, 16))) ==
+        bv::bvnum(0, 8, efac));
+  CHECK(simp.simplify(bv::extract(3, 1, bv::sext(x, 16))) ==
+        bv::extract(3, 1, x));
+}
+
+TEST_CASE("bv_simplifier.read_over_write") {
+  ExprFactory efac;
+  bv::BvSimplifier simp(efac);
+  Expr x = mkBvConst("x", 8, efac), y = mkBvConst("y", 8, efac);
+  Expr a = mkArrayConst("a", 8, efac);
+  auto num = [&efac](unsigned v) { return bv::bvnum(v, 8, efac); };
+
+  Expr st = mk<STORE>(mk<STORE>(a, num(1), x), num(2), y);
+  CHECK(simp.simplify(mk<SELECT>(st, num(1))) == x);
+  CHECK(simp.simplify(mk<SELECT>(st, num(3))) == mk<SELECT>(a, num(3)));
+
+  // -- different offsets from the same base
+  Expr p = mkBvConst("p", 8, efac);
+  Expr st2 = mk<STORE>(a, mk<BADD>(p, num(4)), x);
+  CHECK(simp.simplify(mk<SELECT>(st2, p)) == mk<SELECT>(a, p));
+  CHECK(simp.simplify(mk<SELECT>(st2, mk<BADD>(num(4), p))) == x);
+  // -- unknown index: the store is kept
+  Expr rd = mk<SELECT>(st2, y);
+  CHECK(simp.simplify(rd) == mk<SELECT>(simp.simplify(st2), y));
+}
+
+TEST_CASE("bv_simplifier.ite") {
+  ExprFactory efac;
+  bv::BvSimplifier simp(efac);
+  Expr x = mkBvConst("x", 8, efac);
+  Expr c = mk<BULT>(x, bv::bvnum(5, 8, efac));
+  auto num = [&efac](unsigned v) { return bv::bvnum(v, 8, efac); };
+
+  Expr ite = mk<ITE>(c, num(1), num(2));
+  CHECK(simp.simplify(mk<BADD>(ite, num(1))) == mk<ITE>(c, num(2), num(3)));
+  CHECK(simp.simplify(mk<EQ>(ite, num(1))) == c);
+  CHECK(simp.simplify(mk<EQ>(ite, num(3))) == mk<FALSE>(efac));
+}
+
+TEST_CASE("bv_simplifier.differential") {
+  ExprFactory efac;
+  EZ3 z3(efac);
+  ZSimplifier<EZ3> zsimp(z3);
+  bv::BvSimplifier simp(efac);
+
+  unsigned nativeSize = 0, z3Size = 0;
+  // -- terms that Z3 reduces to a numeral, and those that are also
+  // -- reduced to a numeral by the native simplifier
+  unsigned z3Nums = 0, nativeNums = 0;
+  for (unsigned seed = 0; seed < 300; ++seed) {
+    TermGen gen(efac, seed);
+    Expr e = gen.bv(2 + seed % 3);
+    Expr native = simp.simplify(e);
+    Expr z3res = zsimp.simplify(e);
+    nativeSize += dagSize(native);
+    z3Size += dagSize(z3res);
+
+    INFO("term: " << z3.toSmtLib(e));
+    // -- Z3 is the oracle: the native result is equivalent to the input
+    CHECK(isValid(z3, mk<EQ>(e, native)));
+    // -- simplified terms are in normal form
+    CHECK(simp.simplify(native) == native);
+    if (bv::isBvNum(z3res) && isValid(z3, mk<EQ>(e, z3res))) {
+      ++z3Nums;
+      if (native == z3res)
+        ++nativeNums;
+    }
+  }
+  llvm::errs() << "dag size native: " << nativeSize << ", z3: " << z3Size
+               << "; numerals native: " << nativeNums << ", z3: " << z3Nums
+               << "\n";
+  CHECK(nativeSize <= z3Size);
+}
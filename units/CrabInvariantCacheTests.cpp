@@ -0,0 +1,204 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "seahorn/CrabInvariantCache.hh"
+#include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/ExprLlvm.hh"
+#include "seahorn/Expr/ExprOpBinder.hh"
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
+
+#include "sea_doctest.hh" // doctest is last to avoid name clash
+
+using namespace expr;
+using namespace seahorn;
+
+static const char *Program = R"(
+@g = global i32 0
+
+define i32 @f(i32 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %body ]
+  %c = icmp slt i32 %i, %n
+  br i1 %c, label %body, label %exit
+body:
+  %i1 = add i32 %i, 1
+  br label %loop
+exit:
+  ret i32 %i
+}
+
+@u = global i32 0
+
+define i32 @k() {
+entry:
+  %v = load i32, i32* @g
+  %r = call i32 @f(i32 %v)
+  ret i32 %r
+}
+)";
+
+static std::unique_ptr<llvm::Module> parse(llvm::LLVMContext &ctx,
+                                           const char *text) {
+  llvm::SMDiagnostic err;
+  auto m = llvm::parseAssemblyString(text, err, ctx);
+  REQUIRE(m);
+  return m;
+}
+
+static Expr intVal(const llvm::Value *v, ExprFactory &efac) {
+  return bind::intConst(mkTerm<const llvm::Value *>(v, efac));
+}
+
+static const llvm::Instruction *inst(llvm::Function &F, llvm::StringRef name) {
+  for (auto &bb : F)
+    for (auto &I : bb)
+      if (I.getName() == name)
+        return &I;
+  return nullptr;
+}
+
+TEST_CASE("crab_cache.round_trip") {
+  llvm::LLVMContext ctx;
+  auto m = parse(ctx, Program);
+  llvm::Function &F = *m->getFunction("f");
+  auto it = F.begin();
+  const llvm::BasicBlock *loop = &*++it, *body = &*++it, *exit = &*++it;
+
+  ExprFactory efac;
+  Expr i = intVal(inst(F, "i"), efac), n = intVal(F.getArg(0), efac);
+  Expr g = intVal(m->getGlobalVariable("g"), efac);
+  Expr zero = mkTerm<expr::mpz_class>(expr::mpz_class(0L), efac);
+
+  CrabInvariantCache::BlockInvariants inv;
+  inv[loop] = mk<AND>(mk<LEQ>(zero, i), mk<LEQ>(mk<MINUS>(zero, g), zero));
+  inv[body] = mk<AND>(mk<LEQ>(zero, i), mk<LEQ>(mk<MINUS>(i, n), zero));
+  inv[exit] = mk<FALSE>(efac);
+
+  CrabInvariantCache::Entry entry = CrabInvariantCache::encode(F, inv);
+  REQUIRE(entry.size() == F.size());
+  CHECK(entry[0].empty());
+
+  // -- decode into another factory, as another engine would
+  ExprFactory efac2;
+  CrabInvariantCache::BlockInvariants out;
+  REQUIRE(CrabInvariantCache::decode(F, entry, efac2, out));
+  CHECK(out.size() == 3);
+  ExprVector conjs;
+  CrabInvariantCache::conjuncts(out[loop], conjs);
+  // -- the conjunct over the global is dropped
+  CHECK(conjs.size() == 1);
+  conjs.clear();
+  CrabInvariantCache::conjuncts(out[body], conjs);
+  CHECK(conjs.size() == 2);
+  CHECK(isOpX<FALSE>(out[exit]));
+
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  os << *out[body];
+  os.flush();
+  CAPTURE(str);
+  CHECK(bind::isIntConst(intVal(inst(F, "i"), efac2)));
+  ExprVector consts;
+  filter(out[body], bind::IsConst(), std::back_inserter(consts));
+  CHECK(std::count(consts.begin(), consts.end(),
+                   intVal(inst(F, "i"), efac2)) == 1);
+  CHECK(std::count(consts.begin(), consts.end(),
+                   intVal(F.getArg(0), efac2)) == 1);
+
+  // -- an entry of another function is rejected
+  CrabInvariantCache::Entry bad(entry.begin(), entry.end() - 1);
+  CHECK(!CrabInvariantCache::decode(F, bad, efac2, out));
+}
+
+TEST_CASE("crab_cache.key") {
+  llvm::LLVMContext ctx;
+  auto m1 = parse(ctx, Program);
+  auto m2 = parse(ctx, Program);
+  llvm::Function &F1 = *m1->getFunction("f");
+  llvm::Function &F2 = *m2->getFunction("f");
+  llvm::Function &K1 = *m1->getFunction("k");
+  llvm::Function &K2 = *m2->getFunction("k");
+  std::string k = CrabInvariantCache::key(F1, "zones", "ctx");
+  std::string kk = CrabInvariantCache::key(K1, "zones", "ctx");
+  CHECK(k == CrabInvariantCache::key(F2, "zones", "ctx"));
+  CHECK(kk == CrabInvariantCache::key(K2, "zones", "ctx"));
+  CHECK(k != CrabInvariantCache::key(F1, "int", "ctx"));
+  // -- other analysis parameters give another key
+  CHECK(k != CrabInvariantCache::key(F1, "zones", "ctx cs=1"));
+
+  // -- a new function or an unused global changes the module only
+  std::string fp = CrabInvariantCache::moduleFingerprint(*m1);
+  CHECK(fp == CrabInvariantCache::moduleFingerprint(*m2));
+  llvm::Function::Create(F2.getFunctionType(),
+                         llvm::GlobalValue::ExternalLinkage, "h", *m2);
+  CHECK(fp != CrabInvariantCache::moduleFingerprint(*m2));
+  m2->getGlobalVariable("u")->setConstant(true);
+  CHECK(k == CrabInvariantCache::key(F2, "zones", "ctx"));
+  CHECK(kk == CrabInvariantCache::key(K2, "zones", "ctx"));
+  m2->getFunction("h")->eraseFromParent();
+  m2->getGlobalVariable("u")->setConstant(false);
+  CHECK(fp == CrabInvariantCache::moduleFingerprint(*m2));
+  // -- a global changes the key of the functions that use it
+  m2->getGlobalVariable("g")->setConstant(true);
+  CHECK(k == CrabInvariantCache::key(F2, "zones", "ctx"));
+  CHECK(kk != CrabInvariantCache::key(K2, "zones", "ctx"));
+  m2->getGlobalVariable("g")->setConstant(false);
+  // -- the module name is not part of keys or of the fingerprint
+  m2->setModuleIdentifier("/tmp/sea-123/other.bc");
+  m2->setSourceFileName("/tmp/sea-123/other.c");
+  CHECK(fp == CrabInvariantCache::moduleFingerprint(*m2));
+  CHECK(k == CrabInvariantCache::key(F2, "zones", "ctx"));
+
+  // -- a changed function gets a new key, its callers keep theirs
+  const_cast<llvm::Instruction *>(inst(F2, "i1"))->setName("j");
+  CHECK(k != CrabInvariantCache::key(F2, "zones", "ctx"));
+  CHECK(kk == CrabInvariantCache::key(K2, "zones", "ctx"));
+  CHECK(fp != CrabInvariantCache::moduleFingerprint(*m2));
+
+  auto &cache = CrabInvariantCache::get();
+  cache.clear();
+  CrabInvariantCache::Entry entry;
+  CHECK(!cache.lookup(k, entry));
+  cache.insert(k, {"", "(assert false)\n"});
+  REQUIRE(cache.lookup(k, entry));
+  CHECK(entry.size() == 2);
+  CHECK(entry[1] == "(assert false)\n");
+}
+
+TEST_CASE("crab_cache.disk") {
+  llvm::SmallString<128> dir;
+  llvm::sys::path::system_temp_directory(true, dir);
+  llvm::sys::path::append(dir, "crab-cache");
+  REQUIRE(!llvm::sys::fs::createUniqueDirectory(dir, dir));
+  auto &opts = llvm::cl::getRegisteredOptions();
+  auto *opt =
+      static_cast<llvm::cl::opt<std::string> *>(opts["crab-inv-cache-dir"]);
+  REQUIRE(opt);
+  opt->setValue(dir.str().str());
+  CHECK(CrabInvariantCache::isEnabled());
+
+  auto &cache = CrabInvariantCache::get();
+  cache.clear();
+  CrabInvariantCache::Entry entry{"", "(declare-fun v0 () Int)\n"
+                                      "(assert (<= v0 3))\n",
+                                  ""};
+  cache.insert("int-1234", entry);
+
+  // -- a later run starts with an empty cache and reads the file
+  cache.clear();
+  CrabInvariantCache::Entry out;
+  REQUIRE(cache.lookup("int-1234", out));
+  CHECK(out == entry);
+  CHECK(!cache.lookup("int-5678", out));
+
+  opt->setValue("");
+  llvm::sys::fs::remove_directories(dir);
+}
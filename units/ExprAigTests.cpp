@@ -0,0 +1,187 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/ExprAig.hh"
+#include "seahorn/Expr/ExprOpBinder.hh"
+#include "seahorn/Expr/ExprOpBv.hh"
+#include "seahorn/Expr/Smt/EZ3.hh"
+#include "seahorn/Expr/Smt/Z3.hh"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <random>
+
+#include "sea_doctest.hh" // doctest is last to avoid name clash
+
+using namespace expr;
+using namespace expr::op;
+using namespace seahorn;
+
+static Expr mkBoolConst(const std::string &name, ExprFactory &efac) {
+  return bind::boolConst(mkTerm<std::string>(name, efac));
+}
+
+static bool isValid(EZ3 &z3, Expr e) {
+  ZSolver<EZ3> solver(z3);
+  solver.assertExpr(mk<NEG>(e));
+  return static_cast<bool>(!solver.solve());
+}
+
+namespace {
+/// Generates random Boolean formulas over a few Boolean constants and
+/// bit-vector comparisons
+class BoolGen {
+  ExprFactory &m_efac;
+  std::mt19937 m_rand;
+  ExprVector m_atoms;
+
+  unsigned pick(unsigned n) { return m_rand() % n; }
+
+public:
+  BoolGen(ExprFactory &efac, unsigned seed) : m_efac(efac), m_rand(seed) {
+    for (const char *n : {"a", "b", "c", "d", "e"})
+      m_atoms.push_back(mkBoolConst(n, efac));
+    Expr x = bv::bvConst(mkTerm<std::string>("x", efac), 8);
+    Expr y = bv::bvConst(mkTerm<std::string>("y", efac), 8);
+    m_atoms.push_back(mk<BULT>(x, y));
+    m_atoms.push_back(mk<EQ>(x, bv::bvnum(3U, 8, efac)));
+  }
+
+  Expr gen(unsigned depth) {
+    if (depth == 0 || pick(4) == 0)
+      return m_atoms[pick(m_atoms.size())];
+    Expr a = gen(depth - 1), b = gen(depth - 1);
+    switch (pick(7)) {
+    case 0:
+      return mk<AND>(a, b);
+    case 1:
+      return mk<OR>(a, b);
+    case 2:
+      return mk<NEG>(a);
+    case 3:
+      return mk<IMPL>(a, b);
+    case 4:
+      return mk<IFF>(a, b);
+    case 5:
+      return mk<XOR>(a, b);
+    default:
+      return mk<ITE>(gen(depth - 1), a, b);
+    }
+  }
+};
+} // namespace
+
+TEST_CASE("aig.strash") {
+  ExprFactory efac;
+  boolop::Aig g(efac);
+  using Aig = boolop::Aig;
+
+  Aig::Lit a = g.mkInput(mkBoolConst("a", efac));
+  Aig::Lit b = g.mkInput(mkBoolConst("b", efac));
+  Aig::Lit c = g.mkInput(mkBoolConst("c", efac));
+  CHECK(a == g.mkInput(mkBoolConst("a", efac)));
+
+  Aig::Lit ab = g.mkAnd(a, b);
+  CHECK(ab == g.mkAnd(b, a));
+  CHECK(g.mkAnd(a, Aig::neg(a)) == Aig::FALSE_LIT);
+  CHECK(g.mkAnd(a, Aig::TRUE_LIT) == a);
+  CHECK(g.mkAnd(a, a) == a);
+  // -- two-level rules
+  CHECK(g.mkAnd(ab, a) == ab);
+  CHECK(g.mkAnd(ab, Aig::neg(b)) == Aig::FALSE_LIT);
+  CHECK(g.mkAnd(Aig::neg(ab), Aig::neg(a)) == Aig::neg(a));
+  CHECK(g.mkAnd(Aig::neg(ab), a) == g.mkAnd(a, Aig::neg(b)));
+  CHECK(g.mkAnd(Aig::neg(ab), Aig::neg(g.mkAnd(a, Aig::neg(b)))) ==
+        Aig::neg(a));
+  CHECK(g.mkAnd(ab, g.mkAnd(Aig::neg(a), c)) == Aig::FALSE_LIT);
+
+  // -- 3 inputs and the gate a & b
+  CHECK(g.coneSize({ab}) == 3);
+  CHECK(g.coneSize({ab, c}) == 4);
+}
+
+TEST_CASE("aig.roundtrip") {
+  ExprFactory efac;
+  EZ3 z3(efac);
+  BoolGen gen(efac, 7);
+
+  for (unsigned i = 0; i < 50; ++i) {
+    Expr e = gen.gen(5);
+    INFO("e: " << *e);
+    Expr g = boolop::aig(e, false);
+    Expr fg = boolop::flat_aig(e);
+    INFO("aig: " << *g);
+    INFO("flat aig: " << *fg);
+    CHECK(isValid(z3, mk<IFF>(e, g)));
+    CHECK(isValid(z3, mk<IFF>(e, fg)));
+  }
+}
+
+TEST_CASE("aig.fraig") {
+  ExprFactory efac;
+  using Aig = boolop::Aig;
+  Expr a = mkBoolConst("a", efac);
+  Expr b = mkBoolConst("b", efac);
+  Expr c = mkBoolConst("c", efac);
+
+  Aig g(efac);
+  // -- equivalent but structurally different
+  Aig::Lit x = g.fromExpr(mk<AND>(a, mk<OR>(b, c)));
+  Aig::Lit y = g.fromExpr(mk<OR>(mk<AND>(a, b), mk<AND>(a, c)));
+  Aig::Lit u = g.fromExpr(mk<XOR>(a, mk<XOR>(b, c)));
+  Aig::Lit v = g.fromExpr(mk<XOR>(mk<XOR>(a, b), c));
+  // -- a tautology
+  Aig::Lit t = g.fromExpr(
+      mk<OR>(mk<AND>(a, mk<OR>(b, c)), mk<NEG>(mk<OR>(mk<AND>(a, b),
+                                                      mk<AND>(a, c)))));
+  CHECK(x != y);
+  CHECK(u != v);
+
+  std::vector<Aig::Lit> outs{x, y, u, v, t};
+  unsigned before = g.coneSize(outs);
+  Aig::FraigStats stats = g.fraig(outs);
+  CHECK(outs[0] == outs[1]);
+  CHECK(outs[2] == outs[3]);
+  CHECK(outs[4] == Aig::TRUE_LIT);
+  CHECK(stats.merged + stats.constants >= 2);
+  CHECK(g.coneSize(outs) < before);
+  CHECK(g.numNodes() == g.coneSize(outs) + 1);
+}
+
+TEST_CASE("aig.fraig.random") {
+  ExprFactory efac;
+  EZ3 z3(efac);
+  BoolGen gen(efac, 11);
+
+  for (unsigned i = 0; i < 20; ++i) {
+    Expr e = mk<AND>(gen.gen(6), mk<OR>(gen.gen(6), gen.gen(6)));
+    INFO("e: " << *e);
+    boolop::Aig g(efac);
+    std::vector<boolop::Aig::Lit> outs{g.fromExpr(e)};
+    unsigned before = g.coneSize(outs);
+    g.fraig(outs);
+    CHECK(g.coneSize(outs) <= before);
+
+    Expr f = g.toExpr(outs[0]);
+    INFO("fraig: " << *f);
+    CHECK(isValid(z3, mk<IFF>(e, f)));
+  }
+}
+
+TEST_CASE("aig.fraig.conj") {
+  ExprFactory efac;
+  Expr a = mkBoolConst("a", efac);
+  Expr b = mkBoolConst("b", efac);
+
+  ExprVector conj{mk<IMPL>(a, b), mk<OR>(a, mk<NEG>(a)),
+                  mk<OR>(mk<NEG>(a), b)};
+  boolop::fraig(conj);
+  // -- the tautology is removed, the two implications are the same node
+  REQUIRE(conj.size() == 2);
+  CHECK(conj[0] == conj[1]);
+
+  conj = {a, mk<AND>(b, mk<NEG>(b))};
+  boolop::fraig(conj);
+  REQUIRE(conj.size() == 1);
+  CHECK(isOpX<FALSE>(conj[0]));
+}
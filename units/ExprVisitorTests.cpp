@@ -0,0 +1,141 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/ExprOpBinder.hh"
+#include "seahorn/Expr/ExprSimplifier.hh"
+#include "seahorn/Expr/ExprVisitor.hh"
+
+#include <boost/functional/hash.hpp>
+#include <chrono>
+
+#include "sea_doctest.hh" // doctest is last to avoid name clash
+
+using namespace expr;
+
+static Expr boolConst(const std::string &name, ExprFactory &efac) {
+  return bind::boolConst(mkTerm<std::string>(name, efac));
+}
+
+/// A balanced tree of alternating AND and OR over n distinct constants
+static Expr mkTree(unsigned n, ExprFactory &efac) {
+  ExprVector level;
+  for (unsigned i = 0; i < n; ++i)
+    level.push_back(boolConst("b" + std::to_string(i), efac));
+  bool isAnd = true;
+  while (level.size() > 1) {
+    ExprVector next;
+    for (unsigned i = 0; i + 1 < level.size(); i += 2)
+      next.push_back(isAnd ? mk<AND>(level[i], level[i + 1])
+                           : mk<OR>(level[i], level[i + 1]));
+    if (level.size() % 2)
+      next.push_back(level.back());
+    level.swap(next);
+    isAnd = !isAnd;
+  }
+  return level[0];
+}
+
+namespace {
+/// Simplifies boolean operators with a rewriter held by a VisitAction
+struct LegacySimp {
+  std::shared_ptr<op::boolop::TrivialSimplifier> m_r;
+  LegacySimp(ExprFactory &efac)
+      : m_r(std::make_shared<op::boolop::TrivialSimplifier>(efac)) {}
+  VisitAction operator()(Expr exp) {
+    if (isOp<BoolOp>(exp))
+      return VisitAction::changeDoKidsRewrite(exp, m_r);
+    return VisitAction::skipKids();
+  }
+};
+
+/// Same as LegacySimp, with the rewriter held by the visitor
+struct StaticSimp {
+  op::boolop::TrivialSimplifier m_r;
+  StaticSimp(ExprFactory &efac) : m_r(efac) {}
+  StaticVisitAction operator()(Expr exp) {
+    if (isOp<BoolOp>(exp))
+      return StaticVisitAction::doKidsRewrite();
+    return StaticVisitAction::skipKids();
+  }
+  Expr rewrite(Expr exp) { return m_r(exp); }
+};
+} // namespace
+
+TEST_CASE("expr_visitor.replace") {
+  ExprFactory efac;
+  Expr a = boolConst("a", efac), b = boolConst("b", efac);
+  Expr c = boolConst("c", efac);
+  Expr shared = mk<OR>(a, b);
+  Expr e = mk<AND>(shared, mk<NEG>(shared));
+
+  ExprMap m;
+  m[a] = c;
+  CHECK(replace(e, m) ==
+        mk<AND>(mk<OR>(c, b), mk<NEG>(mk<OR>(c, b))));
+
+  // -- replace and simplify
+  m[a] = mk<TRUE>(efac);
+  CHECK(replaceSimplify(mk<AND>(a, b), m) == b);
+  CHECK(replaceSimplify(mk<OR>(a, b), m) == mk<TRUE>(efac));
+}
+
+TEST_CASE("expr_visitor.filter") {
+  ExprFactory efac;
+  Expr a = boolConst("a", efac), b = boolConst("b", efac);
+  Expr e = mk<AND>(mk<OR>(a, b), mk<NEG>(mk<OR>(a, b)), a);
+
+  ExprVector consts;
+  filter(e, bind::IsConst(), std::back_inserter(consts));
+  CHECK(consts.size() == 2);
+  CHECK(std::count(consts.begin(), consts.end(), a) == 1);
+  CHECK(std::count(consts.begin(), consts.end(), b) == 1);
+}
+
+TEST_CASE("expr_visitor.static_and_legacy") {
+  ExprFactory efac;
+  Expr a = boolConst("a", efac), b = boolConst("b", efac);
+  Expr t = mk<TRUE>(efac), f = mk<FALSE>(efac);
+  Expr e = mk<OR>(mk<AND>(a, t), mk<AND>(f, mk<OR>(b, mk<NEG>(t))));
+
+  LegacySimp legacy(efac);
+  StaticSimp stat(efac);
+  Expr r1 = dagVisit(legacy, e);
+  Expr r2 = dagVisit(stat, e);
+  CHECK(r1 == a);
+  CHECK(r2 == a);
+  CHECK(treeVisit(stat, e) == a);
+
+  // -- rewrite() through a shared rewriter
+  CHECK(rewrite(std::make_shared<op::boolop::TrivialSimplifier>(efac),
+                mk<AND>(t, b)) == b);
+
+  // -- visitors with and without a rewriter agree on a large DAG
+  Expr tree = mkTree(1000, efac);
+  CHECK(dagVisit(legacy, tree) == dagVisit(stat, tree));
+}
+
+TEST_CASE("expr_visitor.bench" * doctest::skip(true)) {
+  using clock = std::chrono::steady_clock;
+  ExprFactory efac;
+  Expr tree = mkTree(1 << 20, efac);
+  // -- visited nodes: the operators and the constants, whose kids are
+  // -- skipped
+  double nodes = 2.0 * (1 << 20);
+
+  auto run = [&](auto &v) {
+    auto start = clock::now();
+    Expr res = dagVisit(v, tree);
+    std::chrono::duration<double> t = clock::now() - start;
+    CHECK(res == tree);
+    return t.count();
+  };
+
+  LegacySimp legacy(efac);
+  StaticSimp stat(efac);
+  double tl = run(legacy);
+  double ts = run(stat);
+
+  MESSAGE("nodes: " << nodes);
+  MESSAGE("VisitAction: " << nodes / tl << " nodes/s");
+  MESSAGE("StaticVisitAction: " << nodes / ts << " nodes/s");
+}
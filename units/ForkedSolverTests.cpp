@@ -0,0 +1,143 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <string>
+
+#include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/ExprGmp.hh"
+#include "seahorn/Expr/ExprOpBinder.hh"
+#include "seahorn/Expr/ExprOpBv.hh"
+#include "seahorn/Expr/Smt/ForkedSolverImpl.hh"
+
+#include "sea_doctest.hh" // doctest is last to avoid name clash
+
+using namespace expr;
+using namespace seahorn;
+using namespace seahorn::solver;
+
+static Expr mkBool(const std::string &name, ExprFactory &efac) {
+  return bind::boolConst(mkTerm<std::string>(name, efac));
+}
+
+static Expr mkInt(unsigned long num, ExprFactory &efac) {
+  return mkTerm<expr::mpz_class>(expr::mpz_class(num), efac);
+}
+
+/* Pigeonhole principle: hard for resolution based solvers */
+static ExprVector pigeonhole(unsigned holes, ExprFactory &efac) {
+  ExprVector res;
+  unsigned pigeons = holes + 1;
+  auto p = [&](unsigned i, unsigned j) {
+    return mkBool("p" + std::to_string(i) + "_" + std::to_string(j), efac);
+  };
+  for (unsigned i = 0; i < pigeons; ++i) {
+    ExprVector row;
+    for (unsigned j = 0; j < holes; ++j)
+      row.push_back(p(i, j));
+    res.push_back(mknary<OR>(row));
+  }
+  for (unsigned j = 0; j < holes; ++j)
+    for (unsigned i = 0; i < pigeons; ++i)
+      for (unsigned k = i + 1; k < pigeons; ++k)
+        res.push_back(mk<OR>(mk<NEG>(p(i, j)), mk<NEG>(p(k, j))));
+  return res;
+}
+
+TEST_CASE("forked.sat_model") {
+  ExprFactory efac;
+  forked_solver_impl s(efac);
+  Expr x = bind::intConst(mkTerm<std::string>("x", efac));
+  Expr y = bv::bvConst(mkTerm<std::string>("y", efac), 8);
+  Expr a = mkBool("a", efac);
+
+  s.add(mk<EQ>(x, mkInt(42, efac)));
+  s.add(mk<EQ>(y, bv::bvnum(expr::mpz_class(7U), 8, efac)));
+  s.add(a);
+  CHECK(s.check() == SolverResult::SAT);
+  auto m = s.get_model();
+  CHECK(m->eval(x, true) == mkInt(42, efac));
+  CHECK(m->eval(y, true) == bv::bvnum(expr::mpz_class(7U), 8, efac));
+  CHECK(isOpX<TRUE>(m->eval(a, true)));
+  CHECK(isOpX<TRUE>(m->eval(mk<GT>(x, mkInt(10, efac)), true)));
+
+  s.push();
+  s.add(mk<LT>(x, mkInt(0, efac)));
+  CHECK(s.check() == SolverResult::UNSAT);
+  s.pop();
+  CHECK(s.check() == SolverResult::SAT);
+}
+
+TEST_CASE("forked.unsat_core") {
+  ExprFactory efac;
+  forked_solver_impl s(efac);
+  Expr a = mkBool("a", efac);
+  Expr b = mkBool("b", efac);
+  Expr c = mkBool("c", efac);
+
+  s.add(mk<IMPL>(a, mk<NEG>(c)));
+  ExprVector assumptions{b, a, c};
+  CHECK(s.check_with_assumptions(llvm::make_range(
+            assumptions.cbegin(), assumptions.cend())) == SolverResult::UNSAT);
+  ExprVector core;
+  s.unsat_core(core);
+  CHECK(core.size() == 2);
+  CHECK(std::find(core.begin(), core.end(), b) == core.end());
+}
+
+TEST_CASE("forked.limits") {
+  ExprFactory efac;
+  fork_limits limits;
+  limits.wall = 1;
+  forked_solver_impl s(efac, limits);
+  for (Expr e : pigeonhole(14, efac))
+    s.add(e);
+  // -- the worker is killed and the parent carries on
+  CHECK(s.check() == SolverResult::UNKNOWN);
+
+  limits.wall = 0;
+  limits.cpu = 1;
+  s.set_limits(limits);
+  CHECK(s.check() == SolverResult::UNKNOWN);
+
+  s.reset();
+  s.add(mkBool("a", efac));
+  CHECK(s.check() == SolverResult::SAT);
+}
+
+TEST_CASE("forked.mem_limit") {
+  ExprFactory efac;
+  // -- the parent uses more address space than the budget of a query
+  std::vector<char> ballast(256u << 20, 1);
+  fork_limits limits;
+  limits.mem = 64;
+  forked_solver_impl s(efac, limits);
+  Expr x = bind::intConst(mkTerm<std::string>("x", efac));
+  s.add(mk<GT>(x, mkInt(ballast[0], efac)));
+  CHECK(s.check() == SolverResult::SAT);
+
+  // -- the budget is still enforced
+  limits.mem = 1;
+  limits.wall = 10;
+  s.set_limits(limits);
+  for (Expr e : pigeonhole(10, efac))
+    s.add(e);
+  CHECK(s.check() == SolverResult::UNKNOWN);
+}
+
+TEST_CASE("forked.check_all") {
+  ExprFactory efac;
+  Expr a = mkBool("a", efac);
+  std::vector<ExprVector> queries;
+  queries.push_back({a});
+  queries.push_back({a, mk<NEG>(a)});
+  queries.push_back(pigeonhole(14, efac));
+  queries.push_back(pigeonhole(3, efac));
+
+  fork_limits limits;
+  limits.wall = 1;
+  auto res = forked_check_all(efac, queries, limits, 2);
+  REQUIRE(res.size() == 4);
+  CHECK(res[0] == SolverResult::SAT);
+  CHECK(res[1] == SolverResult::UNSAT);
+  CHECK(res[2] == SolverResult::UNKNOWN);
+  CHECK(res[3] == SolverResult::UNSAT);
+}
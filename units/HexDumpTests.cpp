@@ -5,6 +5,7 @@
 #include "llvm/ADT/APInt.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <chrono>
 #include <regex>
 #include <string>
 
@@ -587,3 +588,40 @@ TEST_CASE("specialCases.test") {
 
   checkPairs(kvList.cbegin(), kvList.cend(), hd5.cbegin(), hd5.cend());
 }
+
+TEST_CASE("hexDump.bench" * doctest::skip(true)) {
+  ExprFactory efac;
+  Expr bvSort = bv::bvsort(32, efac);
+  const unsigned n = 1u << 15;
+
+  // -- a large buffer: 32-bit words with a gap every 8 words
+  Expr e = array::constArray(bvSort, bv::bvnum(0U, 32, efac));
+  for (unsigned i = 0; i < n; ++i) {
+    if (i % 8 == 7)
+      continue;
+    e = array::store(e, bv::bvnum(0x10000000U + 4 * i, 32, efac),
+                     bv::bvnum(i * 2654435761U, 32, efac));
+  }
+
+  // -- the same buffer as a model of nested ite
+  Expr a = bind::intConst(mkTerm<std::string>("a", efac));
+  Expr ite = bv::bvnum(0U, 32, efac);
+  for (unsigned i = 0; i < n / 4; ++i)
+    ite = mk<ITE>(mk<EQ>(a, bv::bvnum(0x10000000U + 4 * i, 32, efac)),
+                  bv::bvnum(i * 2654435761U, 32, efac), ite);
+
+  auto run = [](Expr e) {
+    auto start = std::chrono::steady_clock::now();
+    HexDump hd(e);
+    std::string s;
+    llvm::raw_string_ostream OS(s);
+    OS << hd;
+    OS.flush();
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    MESSAGE("cells: " << std::distance(hd.cbegin(), hd.cend())
+                      << " bytes: " << s.size() << " time: " << d.count()
+                      << "s");
+  };
+  run(e);
+  run(ite);
+}
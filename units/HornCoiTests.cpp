@@ -0,0 +1,157 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/ExprOpBinder.hh"
+#include "seahorn/Expr/Smt/EZ3.hh"
+#include "seahorn/Expr/Smt/Z3.hh"
+#include "seahorn/HornClauseDB.hh"
+#include "seahorn/HornClauseDBTransf.hh"
+#include "seahorn/HornDbModel.hh"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "sea_doctest.hh" // doctest is last to avoid name clash
+
+using namespace expr;
+using namespace seahorn;
+
+static Expr mkInt(long num, ExprFactory &efac) {
+  return mkTerm<expr::mpz_class>(expr::mpz_class(num), efac);
+}
+
+static Expr intConst(const std::string &name, ExprFactory &efac) {
+  return bind::intConst(mkTerm<std::string>(name, efac));
+}
+
+static Expr mkRel(const std::string &name, unsigned arity,
+                  ExprFactory &efac) {
+  ExprVector sig(arity, mk<INT_TY>(efac));
+  sig.push_back(mk<BOOL_TY>(efac));
+  return bind::fdecl(mkTerm<std::string>(name, efac), sig);
+}
+
+/* x counts up and y down until they meet, z is irrelevant, junk does
+ * not reach the query and b has one definition and one use */
+static void mkCounters(HornClauseDB &db, long bound) {
+  ExprFactory &efac = db.getExprFactory();
+  Expr a = mkRel("a", 3, efac), b = mkRel("b", 1, efac);
+  Expr junk = mkRel("junk", 1, efac), err = mkRel("err", 0, efac);
+  for (Expr r : {a, b, junk, err})
+    db.registerRelation(r);
+
+  Expr x = intConst("x", efac), y = intConst("y", efac);
+  Expr z = intConst("z", efac), x1 = intConst("x1", efac);
+  Expr y1 = intConst("y1", efac), z1 = intConst("z1", efac);
+  ExprVector vs{x, y, z, x1, y1, z1};
+  Expr zero = mkInt(0, efac), one = mkInt(1, efac);
+
+  db.addRule(vs, mk<IMPL>(mk<AND>(mk<EQ>(x, zero), mk<EQ>(y, mkInt(10, efac))),
+                          bind::fapp(a, x, y, z)));
+  db.addRule(vs, mk<IMPL>(mknary<AND>(ExprVector{
+                              bind::fapp(a, x, y, z), mk<LT>(x, y),
+                              mk<EQ>(x1, mk<PLUS>(x, one)),
+                              mk<EQ>(y1, mk<MINUS>(y, one)),
+                              mk<EQ>(z1, mk<MULT>(z, mkInt(2, efac)))}),
+                          bind::fapp(a, x1, y1, z1)));
+  db.addRule(vs, mk<IMPL>(mk<AND>(bind::fapp(a, x, y, z), mk<GEQ>(x, y)),
+                          bind::fapp(b, x)));
+  db.addRule(vs, mk<IMPL>(mk<AND>(bind::fapp(b, x), mk<GT>(x, mkInt(bound,
+                                                                    efac))),
+                          bind::fapp(err)));
+  db.addRule(vs, mk<IMPL>(mk<EQ>(x, one), bind::fapp(junk, x)));
+  db.addRule(vs, mk<IMPL>(mk<AND>(bind::fapp(junk, x), mk<EQ>(x1, x)),
+                          bind::fapp(junk, x1)));
+  db.addQuery(bind::fapp(err));
+}
+
+static boost::tribool solve(HornClauseDB &db, ZFixedPoint<EZ3> &fp) {
+  ZParams<EZ3> params(fp.getContext());
+  params.set(":engine", "spacer");
+  params.set(":xform.slice", false);
+  params.set(":xform.inline-linear", false);
+  params.set(":xform.inline-eager", false);
+  fp.set(params);
+  db.loadZFixedPoint(fp);
+  return fp.query();
+}
+
+/* Checks that model satisfies every rule of db */
+static void checkModel(HornClauseDB &db, HornDbModel &model, EZ3 &z3) {
+  for (const HornRule &r : db.getRules()) {
+    ExprMap sub;
+    ExprVector apps;
+    get_all_pred_apps(r.body(), db, std::back_inserter(apps));
+    for (Expr app : apps)
+      sub[app] = model.getDef(app);
+    Expr head = db.hasRelation(bind::fname(r.head())) ? model.getDef(r.head())
+                                                      : r.head();
+    ZSolver<EZ3> solver(z3);
+    solver.assertExpr(replace(r.body(), sub));
+    solver.assertExpr(mk<NEG>(head));
+    CAPTURE(*r.get());
+    CHECK(!solver.solve());
+  }
+}
+
+TEST_CASE("horn_coi.reduce") {
+  ExprFactory efac;
+  HornClauseDB db(efac);
+  mkCounters(db, 6);
+  EZ3 z3(efac);
+  HornClauseDB tdb(efac);
+  CoiHornModelConverter mc(z3);
+  coiHornClauseDBTransf(db, tdb, mc);
+
+  std::string str;
+  llvm::raw_string_ostream out(str);
+  out << tdb;
+  out.flush();
+  CAPTURE(str);
+  // -- junk is removed, b is inlined into the rule of err
+  CHECK(tdb.getRelations().size() == 2);
+  CHECK(tdb.getRules().size() == 3);
+  // -- the third argument of a is dropped
+  for (Expr rel : tdb.getRelations())
+    CHECK(bind::domainSz(rel) <= 2);
+  CHECK(str.find("junk") == std::string::npos);
+  CHECK(str.find("z1") == std::string::npos);
+}
+
+TEST_CASE("horn_coi.model") {
+  ExprFactory efac;
+  HornClauseDB db(efac);
+  mkCounters(db, 6);
+  EZ3 z3(efac);
+  HornClauseDB tdb(efac);
+  CoiHornModelConverter mc(z3);
+  coiHornClauseDBTransf(db, tdb, mc);
+
+  ZFixedPoint<EZ3> fp(z3);
+  REQUIRE(!solve(tdb, fp));
+
+  // -- invariants of the reduced database map back to the original
+  HornDbModel tmodel, model;
+  initDBModelFromFP(tmodel, tdb, fp);
+  CHECK(mc.convert(tmodel, model));
+  checkModel(db, model, z3);
+  CHECK(isOpX<FALSE>(model.getDef(bind::fapp(mkRel("err", 0, efac)))));
+}
+
+TEST_CASE("horn_coi.same_answer") {
+  for (long bound : {4, 5, 6}) {
+    ExprFactory efac;
+    HornClauseDB db(efac);
+    mkCounters(db, bound);
+    EZ3 z3(efac);
+    HornClauseDB tdb(efac);
+    CoiHornModelConverter mc(z3);
+    coiHornClauseDBTransf(db, tdb, mc);
+
+    ZFixedPoint<EZ3> fp(z3), tfp(z3);
+    boost::tribool res = solve(db, fp);
+    boost::tribool tres = solve(tdb, tfp);
+    CAPTURE(bound);
+    CHECK(static_cast<bool>(res) == static_cast<bool>(tres));
+    CHECK(static_cast<bool>(res) == (bound < 5));
+  }
+}
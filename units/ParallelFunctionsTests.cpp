@@ -0,0 +1,149 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "seahorn/Analysis/CanAccessMemory.hh"
+#include "seahorn/Analysis/ControlDependenceAnalysis.hh"
+#include "seahorn/Support/ParallelFunctions.hh"
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "sea_doctest.hh" // doctest is last to avoid name clash
+
+using namespace seahorn;
+
+/* A module with n functions of different shapes and sizes. Function i
+   calls function i+1 every third function, and every fourth one accesses
+   memory, so that both the per-function and the call-graph parts of the
+   analyses matter */
+static std::string program(unsigned n) {
+  std::string s = "@g = global i32 0\n";
+  for (unsigned i = 0; i < n; ++i) {
+    std::string f = "f" + std::to_string(i);
+    s += "define i32 @" + f + "(i32 %x) {\nentry:\n  br label %d0\n";
+    unsigned diamonds = 1 + i % 5;
+    for (unsigned d = 0; d < diamonds; ++d) {
+      std::string D = std::to_string(d), N = std::to_string(d + 1);
+      s += "d" + D + ":\n  %c" + D + " = icmp sgt i32 %x, " + D +
+           "\n  br i1 %c" + D + ", label %t" + D + ", label %e" + D + "\n";
+      s += "t" + D + ":\n  br label %d" + N + "\n";
+      s += "e" + D + ":\n  br label %d" + N + "\n";
+    }
+    std::string last = "d" + std::to_string(diamonds);
+    s += last + ":\n";
+    if (i % 4 == 0)
+      s += "  store i32 %x, i32* @g\n";
+    if (i % 3 == 0 && i + 1 < n)
+      s += "  %r = call i32 @f" + std::to_string(i + 1) + "(i32 %x)\n";
+    // -- a loop back to the first diamond in every other function
+    if (i % 2 == 0)
+      s += "  %l = icmp slt i32 %x, 0\n  br i1 %l, label %d0, label %exit\n";
+    else
+      s += "  br label %exit\n";
+    s += "exit:\n  ret i32 %x\n}\n";
+  }
+  return s;
+}
+
+static std::unique_ptr<llvm::Module> parse(llvm::LLVMContext &ctx,
+                                           const std::string &text) {
+  llvm::SMDiagnostic err;
+  auto m = llvm::parseAssemblyString(text, err, ctx);
+  REQUIRE(m);
+  return m;
+}
+
+static void setThreads(unsigned n) {
+  auto &opts = llvm::cl::getRegisteredOptions();
+  auto *opt =
+      static_cast<llvm::cl::opt<unsigned> *>(opts["sea-analysis-threads"]);
+  REQUIRE(opt);
+  opt->setValue(n);
+  REQUIRE(getAnalysisThreads() == n);
+}
+
+/* Runs both analyses with the given number of threads and prints their
+   results, by function, in a form that does not depend on the run */
+static std::map<std::string, std::string> analyze(llvm::Module &M,
+                                                  unsigned threads) {
+  setThreads(threads);
+  auto *cda = new ControlDependenceAnalysisPass();
+  auto *cam = new CanAccessMemory();
+  llvm::legacy::PassManager pm;
+  pm.add(cda);
+  pm.add(cam);
+  pm.run(M);
+
+  std::map<std::string, std::string> res;
+  for (llvm::Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+    std::string str;
+    llvm::raw_string_ostream out(str);
+    out << "must=" << cam->mustAccess(&F) << " may=" << cam->canAccess(&F)
+        << "\n";
+    REQUIRE(cda->hasAnalysisFor(F));
+    auto &cd = cda->getControlDependenceAnalysis(F);
+    for (llvm::BasicBlock &bb : F) {
+      out << bb.getName() << " topo=" << cd.getBBTopoIdx(&bb) << " cd=";
+      for (llvm::BasicBlock *dep : cd.getCDBlocks(&bb))
+        out << dep->getName() << ",";
+      out << " reach=";
+      for (llvm::BasicBlock &dst : F)
+        out << cd.isReachable(&bb, &dst);
+      out << "\n";
+    }
+    res[F.getName().str()] = out.str();
+  }
+  return res;
+}
+
+TEST_CASE("parallel_functions.each_once") {
+  llvm::LLVMContext ctx;
+  auto m = parse(ctx, program(40) + "declare i32 @ext(i32)\n");
+  setThreads(4);
+
+  std::map<llvm::Function *, unsigned> slot;
+  for (llvm::Function &F : *m)
+    if (!F.isDeclaration())
+      slot[&F] = slot.size();
+  std::vector<std::atomic<unsigned>> calls(slot.size());
+  for (auto &c : calls)
+    c = 0;
+  forEachFunction(*m, [&](llvm::Function &F) {
+    REQUIRE(slot.count(&F));
+    ++calls[slot.at(&F)];
+  });
+  // -- every defined function exactly once, declarations never
+  for (auto &c : calls)
+    CHECK(c == 1);
+  setThreads(1);
+}
+
+TEST_CASE("parallel_functions.same_as_serial") {
+  llvm::LLVMContext ctx;
+  auto m = parse(ctx, program(40));
+
+  auto serial = analyze(*m, 1);
+  REQUIRE(serial.size() == 40);
+  // -- sanity: the call-graph part propagated memory accesses
+  CHECK(serial["f3"].find("must=0 may=1") == 0);
+  for (unsigned threads : {2, 4, 8}) {
+    CAPTURE(threads);
+    auto threaded = analyze(*m, threads);
+    for (auto &kv : serial) {
+      CAPTURE(kv.first);
+      CHECK(threaded[kv.first] == kv.second);
+    }
+  }
+  setThreads(1);
+}
@@ -0,0 +1,114 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <string>
+
+#include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/ExprOpBinder.hh"
+#include "seahorn/Expr/Smt/Z3SolverImpl.hh"
+#include "seahorn/PathBmcMuc.hh"
+
+#include "sea_doctest.hh" // doctest is last to avoid name clash
+
+using namespace expr;
+using namespace seahorn;
+using namespace seahorn::path_bmc;
+
+static Expr mkBool(const std::string &name, ExprFactory &efac) {
+  return bind::boolConst(mkTerm<std::string>(name, efac));
+}
+
+TEST_CASE("muc_cache.lookup") {
+  ExprFactory efac;
+  Expr a = mkBool("a", efac), b = mkBool("b", efac), c = mkBool("c", efac);
+  Expr x = mkBool("x", efac), y = mkBool("y", efac), z = mkBool("z", efac);
+
+  MucCache cache(10);
+  cache.insert({a, b}, {x, y});
+  CHECK(cache.size() == 1);
+
+  ExprVector out;
+  // -- same literals, in another order
+  CHECK(cache.lookup({b, a}, {z}, out));
+  CHECK(out == ExprVector({std::min(x, y), std::max(x, y)}));
+
+  // -- other literals, but the path contains the core
+  out.clear();
+  CHECK(cache.lookup({c}, {z, y, x}, out));
+  CHECK(out.size() == 2);
+
+  // -- the path only contains part of the core
+  out.clear();
+  CHECK(!cache.lookup({c}, {x, z}, out));
+  CHECK(out.empty());
+}
+
+TEST_CASE("muc_cache.evict") {
+  ExprFactory efac;
+  ExprVector lits, cores;
+  for (unsigned i = 0; i < 4; ++i) {
+    lits.push_back(mkBool("l" + std::to_string(i), efac));
+    cores.push_back(mkBool("c" + std::to_string(i), efac));
+  }
+
+  MucCache cache(2);
+  cache.insert({lits[0]}, {cores[0]});
+  cache.insert({lits[1]}, {cores[1]});
+
+  // -- touch the first entry, so that the second one is evicted
+  ExprVector out;
+  CHECK(cache.lookup({lits[0]}, {}, out));
+  cache.insert({lits[2]}, {cores[2]});
+  CHECK(cache.size() == 2);
+
+  out.clear();
+  CHECK(cache.lookup({lits[0]}, {}, out));
+  out.clear();
+  CHECK(cache.lookup({lits[2]}, {}, out));
+  out.clear();
+  CHECK(!cache.lookup({lits[1]}, {cores[1]}, out));
+
+  // -- the index of the evicted core is dropped too
+  cache.insert({lits[3]}, {cores[3]});
+  CHECK(cache.size() == 2);
+  out.clear();
+  CHECK(!cache.lookup({lits[1]}, {cores[0]}, out));
+  CHECK(cache.lookup({lits[1]}, {cores[3], cores[2]}, out));
+}
+
+/* x0, x0 -> x1, ..., x(n-3) -> x(n-2), !x(n-2): n formulas, every one is
+   needed */
+static ExprVector chain(unsigned n, ExprFactory &efac) {
+  ExprVector res;
+  auto x = [&](unsigned i) { return mkBool("x" + std::to_string(i), efac); };
+  res.push_back(x(0));
+  for (unsigned i = 0; i + 2 < n; ++i)
+    res.push_back(mk<IMPL>(x(i), x(i + 1)));
+  res.push_back(mk<NEG>(x(n - 2)));
+  return res;
+}
+
+TEST_CASE("muc_parallel.uneven_chunks") {
+  ExprFactory efac;
+  solver::z3_solver_impl s(efac);
+
+  // -- the number of candidates is not a multiple of the number of threads
+  for (unsigned threads : {2u, 3u, 4u}) {
+    for (unsigned n : {5u, 7u}) {
+      ExprVector f = chain(n, efac);
+      REQUIRE(f.size() == n);
+      ExprVector out;
+      MucParallel muc(s, 10, threads, 0);
+      muc.run(f, out);
+      CHECK(out.size() == n);
+    }
+  }
+
+  // -- only the last three formulas are needed
+  ExprVector f = chain(3, efac);
+  f.insert(f.begin(), mkBool("y", efac));
+  f.insert(f.begin(), mkBool("z", efac));
+  ExprVector out;
+  MucParallel muc(s, 10, 4, 0);
+  muc.run(f, out);
+  CHECK(out.size() == 3);
+}
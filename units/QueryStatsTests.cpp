@@ -0,0 +1,101 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <string>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/ExprOpBinder.hh"
+#include "seahorn/Expr/Smt/EZ3.hh"
+#include "seahorn/Expr/Smt/Z3.hh"
+#include "seahorn/Support/QueryStats.hh"
+
+#include "sea_doctest.hh" // doctest is last to avoid name clash
+
+using namespace expr;
+using namespace seahorn;
+
+static Expr mkBool(const std::string &name, ExprFactory &efac) {
+  return bind::boolConst(mkTerm<std::string>(name, efac));
+}
+
+/* runs first: with --sea-query-stats-top=0 queries are counted but none is
+   kept as one of the slowest */
+TEST_CASE("query_stats.top_zero") {
+  auto &opts = llvm::cl::getRegisteredOptions();
+  auto *top =
+      static_cast<llvm::cl::opt<unsigned, true> *>(opts["sea-query-stats-top"]);
+  REQUIRE(top);
+  top->setValue(0);
+  QueryStats::enable(true);
+
+  for (unsigned i = 0; i < 3; ++i) {
+    QueryRecord r;
+    r.engine = "top_zero";
+    r.seconds = i;
+    r.result = "sat";
+    QueryStats::record(r, nullptr);
+  }
+
+  std::string out;
+  llvm::raw_string_ostream os(out);
+  QueryStats::Print(os);
+  os.flush();
+  CHECK(out.find("top_zero: 3 queries") != std::string::npos);
+  CHECK(out.find("Slowest queries") == std::string::npos);
+
+  top->setValue(10);
+  QueryStats::enable(false);
+}
+
+TEST_CASE("query_stats.record") {
+  llvm::SmallString<128> dir;
+  REQUIRE(!llvm::sys::fs::createUniqueDirectory("slow", dir));
+  std::string dirOpt = "--sea-slow-query-dir=" + std::string(dir.str());
+  const char *argv[] = {"units_query_stats", "--sea-query-stats",
+                        "--sea-slow-query=1", dirOpt.c_str()};
+  llvm::cl::ParseCommandLineOptions(4, argv);
+  REQUIRE(QueryStats::enabled());
+
+  ExprFactory efac;
+  EZ3 z3(efac);
+  ZSolver<EZ3> solver(z3);
+
+  // -- pigeonhole with 8 holes: slow enough to be dumped
+  const unsigned holes = 8, pigeons = holes + 1;
+  auto p = [&](unsigned i, unsigned j) {
+    return mkBool("p" + std::to_string(i) + "_" + std::to_string(j), efac);
+  };
+  for (unsigned i = 0; i < pigeons; ++i) {
+    ExprVector row;
+    for (unsigned j = 0; j < holes; ++j)
+      row.push_back(p(i, j));
+    solver.assertExpr(mknary<OR>(row));
+  }
+  for (unsigned j = 0; j < holes; ++j)
+    for (unsigned i = 0; i < pigeons; ++i)
+      for (unsigned k = i + 1; k < pigeons; ++k)
+        solver.assertExpr(mk<OR>(mk<NEG>(p(i, j)), mk<NEG>(p(k, j))));
+
+  {
+    ScopedQueryOrigin origin(std::string("pigeonhole"));
+    CHECK(!solver.solve());
+  }
+  CHECK(QueryStats::origin().empty());
+
+  std::string out;
+  llvm::raw_string_ostream os(out);
+  QueryStats::Print(os);
+  os.flush();
+  CHECK(out.find("z3.solver: 1 queries") != std::string::npos);
+  CHECK(out.find("unsat z3.solver assertions=") != std::string::npos);
+  CHECK(out.find("[pigeonhole]") != std::string::npos);
+
+  // -- queries are numbered across tests: query_stats.top_zero made 3
+  llvm::SmallString<128> dump(dir);
+  llvm::sys::path::append(dump, "query_4.smt2");
+  CHECK(llvm::sys::fs::exists(dump));
+  llvm::sys::fs::remove_directories(dir);
+}
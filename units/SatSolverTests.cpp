@@ -0,0 +1,194 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <random>
+#include <string>
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/ExprOpBinder.hh"
+#include "seahorn/Expr/ExprOpBool.hh"
+#include "seahorn/Expr/Smt/SatSolverImpl.hh"
+#include "seahorn/Expr/Smt/Z3SolverImpl.hh"
+
+#include "sea_doctest.hh" // doctest is last to avoid name clash
+
+using namespace expr;
+using namespace seahorn;
+using namespace seahorn::solver;
+
+static Expr mkBool(const std::string &name, ExprFactory &efac) {
+  return bind::boolConst(mkTerm<std::string>(name, efac));
+}
+
+TEST_CASE("sat.basic") {
+  ExprFactory efac;
+  sat_solver_impl s(efac);
+  Expr a = mkBool("a", efac);
+  Expr b = mkBool("b", efac);
+  Expr c = mkBool("c", efac);
+
+  s.add(mk<OR>(a, b, c));
+  s.add(mk<IMPL>(a, b));
+  s.add(mk<NEG>(b));
+  CHECK(s.check() == SolverResult::SAT);
+  auto m = s.get_model();
+  CHECK(isOpX<FALSE>(m->eval(a, true)));
+  CHECK(isOpX<FALSE>(m->eval(b, true)));
+  CHECK(isOpX<TRUE>(m->eval(c, true)));
+  CHECK(isOpX<TRUE>(m->eval(mk<OR>(a, b, c), false)));
+
+  s.push();
+  s.add(mk<IFF>(c, a));
+  CHECK(s.check() == SolverResult::UNSAT);
+  s.pop();
+  CHECK(s.check() == SolverResult::SAT);
+
+  s.add(mk<XOR>(c, mk<TRUE>(efac)));
+  CHECK(s.check() == SolverResult::UNSAT);
+  s.reset();
+  CHECK(s.check() == SolverResult::SAT);
+}
+
+TEST_CASE("sat.theory_atoms") {
+  ExprFactory efac;
+  sat_solver_impl s(efac);
+  Expr x = bind::intConst(mkTerm<std::string>("x", efac));
+  Expr y = bind::intConst(mkTerm<std::string>("y", efac));
+  Expr lt = mk<LT>(x, y);
+  Expr eq = mk<EQ>(x, y);
+
+  // -- atoms are abstracted: x<y and x=y are independent
+  s.add(lt);
+  s.add(eq);
+  CHECK(s.check() == SolverResult::SAT);
+  auto m = s.get_model();
+  CHECK(isOpX<TRUE>(m->eval(lt, false)));
+  CHECK(isOpX<TRUE>(m->eval(mk<AND>(lt, eq), false)));
+
+  s.add(mk<ITE>(lt, mk<NEG>(eq), eq));
+  CHECK(s.check() == SolverResult::UNSAT);
+}
+
+TEST_CASE("sat.unsat_core") {
+  ExprFactory efac;
+  sat_solver_impl s(efac);
+  Expr a = mkBool("a", efac);
+  Expr b = mkBool("b", efac);
+  Expr c = mkBool("c", efac);
+  Expr d = mkBool("d", efac);
+
+  s.push();
+  s.add(mk<IMPL>(a, b));
+  s.add(mk<IMPL>(b, mk<NEG>(c)));
+
+  ExprVector assumptions{d, a, c};
+  CHECK(s.check_with_assumptions(
+            llvm::make_range(assumptions.cbegin(), assumptions.cend())) ==
+        SolverResult::UNSAT);
+  ExprVector core;
+  s.unsat_core(core);
+  CHECK(core.size() == 2);
+  CHECK(std::find(core.begin(), core.end(), d) == core.end());
+  s.pop();
+
+  // -- the implications are gone
+  CHECK(s.check_with_assumptions(
+            llvm::make_range(assumptions.cbegin(), assumptions.cend())) ==
+        SolverResult::SAT);
+}
+
+TEST_CASE("sat.pigeonhole") {
+  ExprFactory efac;
+  sat_solver_impl s(efac);
+  const unsigned holes = 6, pigeons = holes + 1;
+  auto p = [&](unsigned i, unsigned j) {
+    return mkBool("p" + std::to_string(i) + "_" + std::to_string(j), efac);
+  };
+  for (unsigned i = 0; i < pigeons; ++i) {
+    ExprVector row;
+    for (unsigned j = 0; j < holes; ++j)
+      row.push_back(p(i, j));
+    s.add(mknary<OR>(row));
+  }
+  for (unsigned j = 0; j < holes; ++j)
+    for (unsigned i = 0; i < pigeons; ++i)
+      for (unsigned k = i + 1; k < pigeons; ++k)
+        s.add(mk<OR>(mk<NEG>(p(i, j)), mk<NEG>(p(k, j))));
+  CHECK(s.check() == SolverResult::UNSAT);
+}
+
+TEST_CASE("sat.random_3sat_vs_z3") {
+  ExprFactory efac;
+  std::mt19937 rng(42);
+  const unsigned nvars = 30;
+  ExprVector vars;
+  for (unsigned i = 0; i < nvars; ++i)
+    vars.push_back(mkBool("v" + std::to_string(i), efac));
+
+  for (unsigned round = 0; round < 40; ++round) {
+    sat_solver_impl s(efac);
+    z3_solver_impl z(efac);
+    // -- clause/variable ratio around the phase transition
+    unsigned nclauses = 120 + round % 10;
+    ExprVector clauses;
+    for (unsigned i = 0; i < nclauses; ++i) {
+      ExprVector cl;
+      for (unsigned k = 0; k < 3; ++k) {
+        Expr v = vars[rng() % nvars];
+        cl.push_back(rng() % 2 ? v : mk<NEG>(v));
+      }
+      Expr c = mknary<OR>(cl);
+      clauses.push_back(c);
+      s.add(c);
+      z.add(c);
+    }
+    SolverResult res = s.check();
+    CHECK(res == z.check());
+    if (res == SolverResult::SAT) {
+      auto m = s.get_model();
+      // -- every clause must be true in the model
+      for (Expr c : clauses)
+        CHECK(isOpX<TRUE>(m->eval(c, true)));
+    }
+  }
+}
+
+TEST_CASE("sat.to_smt_lib") {
+  ExprFactory efac;
+  sat_solver_impl s(efac);
+  Expr a = mkBool("a", efac);
+  Expr b = mkBool("b", efac);
+  Expr x = bind::intConst(mkTerm<std::string>("x", efac));
+
+  auto check = [&s](z3::check_result expected) {
+    std::string str;
+    llvm::raw_string_ostream out(str);
+    s.to_smt_lib(out);
+    out.flush();
+    z3::context ctx;
+    z3::solver z(ctx);
+    z.from_string(str.c_str());
+    CHECK(z.check() == expected);
+    return str;
+  };
+
+  s.add(mk<OR>(a, b));
+  s.add(mk<IMPL>(a, mk<LT>(x, mkTerm<expr::mpz_class>(0UL, efac))));
+  check(z3::sat);
+
+  // -- popped formulas are not written
+  s.push();
+  s.add(mk<NEG>(a));
+  s.add(mk<NEG>(b));
+  CHECK(s.check() == SolverResult::UNSAT);
+  check(z3::unsat);
+  s.pop();
+  std::string str = check(z3::sat);
+  CHECK(str.find("(declare-fun a () Bool)") != std::string::npos);
+  CHECK(str.find("(declare-fun x () Int)") != std::string::npos);
+
+  s.reset();
+  str = check(z3::sat);
+  CHECK(str.find("declare-fun") == std::string::npos);
+}
@@ -0,0 +1,294 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <chrono>
+#include <string>
+
+#include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/ExprOpBinder.hh"
+#include "seahorn/Expr/Smt/EZ3.hh"
+#include "seahorn/Expr/Smt/SmtLibParser.hh"
+#include "seahorn/Expr/Smt/SmtLibWriter.hh"
+#include "seahorn/HornClauseDB.hh"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "sea_doctest.hh" // doctest is last to avoid name clash
+
+using namespace expr;
+using namespace seahorn;
+
+/* Checks with Z3 that the parsed assertions are equivalent to Z3's parse */
+static void checkAgainstZ3(const std::string &script) {
+  CAPTURE(script);
+  ExprFactory efac;
+  SmtLibParser parser(efac);
+  REQUIRE(parser.parse(script));
+
+  // -- write back what was parsed; Z3 unifies the re-declared symbols
+  std::string str;
+  llvm::raw_string_ostream out(str);
+  SmtLibWriter writer(out);
+  for (Expr d : parser.getDecls())
+    writer.writeDeclareFun(d);
+  for (auto &a : parser.getAssertions())
+    writer.writeAssert(a.closed());
+  out.flush();
+  CAPTURE(str);
+
+  z3::context ctx;
+  z3::expr_vector theirs = ctx.parse_string(script.c_str());
+  z3::expr_vector ours = ctx.parse_string(str.c_str());
+  z3::solver s(ctx);
+  s.add(z3::mk_and(ours) != z3::mk_and(theirs));
+  CHECK(s.check() == z3::unsat);
+}
+
+TEST_CASE("smtlib_parser.terms") {
+  checkAgainstZ3(R"(
+    ; integer and real arithmetic
+    (set-logic ALL)
+    (declare-fun x () Int)
+    (declare-const |y z| Int)
+    (declare-fun r () Real)
+    (declare-fun f (Int Int) Int)
+    (define-fun twice ((a Int)) Int (+ a a))
+    (assert (let ((s (+ x |y z|)) (t (* 2 x)))
+              (and (> (f s t) (twice s)) (distinct s t (- 3)))))
+    (assert (=> (<= 0 x 10) (= (mod x 3) (div (abs |y z|) 2) (- x 1))))
+    (assert (< r (/ 1.5 (- 2.0))))
+  )");
+
+  checkAgainstZ3(R"(
+    ; bit-vectors and arrays
+    (declare-fun b () (_ BitVec 8))
+    (declare-fun A () (Array (_ BitVec 8) (_ BitVec 8)))
+    (assert (bvult (bvadd b #x01 #b00000010) (_ bv200 8)))
+    (assert (= ((_ zero_extend 8) b) (concat #x00 ((_ extract 7 0) b))))
+    (assert (= (select (store A b #xff) b) ((_ extract 7 0) #xabff)))
+    (assert (= ((as const (Array (_ BitVec 8) (_ BitVec 8))) #x00)
+               (store A #x00 #x00)))
+    (assert (bvsle ((_ sign_extend 0) b) (bvashr b (bvnot b))))
+  )");
+}
+
+TEST_CASE("smtlib_parser.quantifiers") {
+  ExprFactory efac;
+  SmtLibParser parser(efac);
+  REQUIRE(parser.parse(R"(
+    (declare-fun x () Int)
+    (assert (forall ((k Int) (y Int)) (exists ((j Int)) (> (+ k j) (+ x y)))))
+  )"));
+  REQUIRE(parser.getAssertions().size() == 1);
+  auto &a = parser.getAssertions()[0];
+  // -- the top-level forall is opened, inner binders are kept
+  CHECK(a.vars.size() == 2);
+  CHECK(isOpX<EXISTS>(a.body));
+  CHECK(isOpX<FORALL>(a.closed()));
+}
+
+TEST_CASE("smtlib_parser.deep_let") {
+  // -- a long chain of nested lets, as written for large shared DAGs
+  const unsigned depth = 20000;
+  std::string script = "(declare-fun x () Int)\n(assert ";
+  script.reserve(depth * 32);
+  std::string prev = "x";
+  for (unsigned i = 0; i < depth; ++i) {
+    std::string name = "a" + std::to_string(i);
+    script += "(let ((" + name + " (+ " + prev + " " + prev + "))) ";
+    prev = name;
+  }
+  script += "(> " + prev + " 0)";
+  script += std::string(depth, ')');
+  script += ")\n";
+
+  ExprFactory efac;
+  SmtLibParser parser(efac);
+  REQUIRE(parser.parse(script));
+  REQUIRE(parser.getAssertions().size() == 1);
+  // -- the DAG is linear in the number of lets
+  CHECK(dagSize(parser.getAssertions()[0].body) < 2 * depth + 10);
+}
+
+TEST_CASE("smtlib_parser.errors") {
+  ExprFactory efac;
+  SmtLibParser parser(efac);
+  CHECK(!parser.parse("(declare-fun x () Int)\n(assert (> x y))"));
+  CHECK(parser.getError().find("line 2") == 0);
+  CHECK(parser.getError().find("unknown symbol y") != std::string::npos);
+  CHECK(!parser.parse("(assert (and true"));
+  CHECK(!parser.parse("(declare-fun s () String)"));
+  // -- errors of the lexer and of arguments stop the parse too
+  CHECK(!parser.parse("(assert |x)"));
+  CHECK(parser.getError().find("unterminated literal") != std::string::npos);
+  CHECK(!parser.parse("(assert (= #x #x0))"));
+  CHECK(parser.getError().find("bad literal") != std::string::npos);
+  CHECK(!parser.parse("(assert (not true false))"));
+  CHECK(parser.getError().find("wrong number of arguments of not") !=
+        std::string::npos);
+  CHECK(!parser.parse("(assert (= (_ bvx 8) (_ bv0 8)))"));
+  CHECK(parser.parse("(assert true)"));
+  CHECK(parser.getError().empty());
+}
+
+static unsigned checkHorn(const std::string &script, bool safe) {
+  CAPTURE(script);
+  ExprFactory efac;
+  SmtLibParser parser(efac);
+  REQUIRE(parser.parse(script));
+  HornClauseDB db(efac);
+  REQUIRE(db.loadSmtLib(parser));
+  REQUIRE(db.hasQuery());
+
+  // -- write the database back and let Z3 solve it
+  std::string str;
+  llvm::raw_string_ostream out(str);
+  REQUIRE(db.isSmtLibWritable());
+  db.writeSmtLib(out);
+  out.flush();
+  CAPTURE(str);
+  z3::context ctx;
+  z3::solver s(ctx, "HORN");
+  s.from_string(str.c_str());
+  CHECK(s.check() == (safe ? z3::sat : z3::unsat));
+  return db.getRules().size();
+}
+
+TEST_CASE("smtlib_parser.horn") {
+  // -- CHC-COMP style
+  const char *chc = R"(
+    (set-logic HORN)
+    (declare-fun inv (Int Int) Bool)
+    (assert (forall ((x Int) (y Int)) (=> (and (= x 0) (= y 10)) (inv x y))))
+    (assert (forall ((x Int) (y Int) (x1 Int) (y1 Int))
+              (=> (and (inv x y) (< x y) (= x1 (+ x 1)) (= y1 (- y 1)))
+                  (inv x1 y1))))
+    (assert (forall ((x Int) (y Int)) (=> (and (inv x y) (>= x y)) (<= x 6))))
+    (check-sat)
+  )";
+  CHECK(checkHorn(chc, true) == 3);
+
+  const char *bad = R"(
+    (set-logic HORN)
+    (declare-fun inv (Int) Bool)
+    (assert (forall ((x Int)) (=> (= x 0) (inv x))))
+    (assert (forall ((x Int)) (=> (inv x) (inv (+ x 1)))))
+    (assert (forall ((x Int)) (not (and (inv x) (> x 5)))))
+  )";
+  CHECK(checkHorn(bad, false) == 3);
+
+  // -- fixedpoint extensions, as written by the Z3 printer
+  const char *fp = R"(
+    (declare-rel inv (Int))
+    (declare-rel err ())
+    (declare-var x Int)
+    (rule (=> (= x 0) (inv x)))
+    (rule (=> (and (inv x) (< x 10)) (inv (+ x 1))) step)
+    (rule (=> (and (inv x) (> x 10)) err))
+    (query err :print-certificate true)
+  )";
+  CHECK(checkHorn(fp, true) == 3);
+
+  // -- without (set-logic HORN), or with ALL, declared predicates are
+  // -- still relations
+  for (const char *logic : {"", "(set-logic ALL)"}) {
+    std::string nologic = std::string(logic) + R"(
+      (declare-fun inv (Int) Bool)
+      (declare-fun err () Bool)
+      (assert (forall ((x Int)) (=> (= x 0) (inv x))))
+      (assert (forall ((x Int)) (=> (and (inv x) (< x 10)) (inv (+ x 1)))))
+      (assert (forall ((x Int)) (=> (and (inv x) (> x 10)) err)))
+      (assert (=> err false))
+    )";
+    CHECK(checkHorn(nologic, true) == 4);
+
+    std::string unsafe = std::string(logic) + R"(
+      (declare-fun inv (Int) Bool)
+      (assert (forall ((x Int)) (=> (= x 0) (inv x))))
+      (assert (forall ((x Int)) (=> (inv x) (inv (+ x 1)))))
+      (assert (forall ((x Int)) (=> (inv x) (<= x 5))))
+    )";
+    CHECK(checkHorn(unsafe, false) == 3);
+  }
+}
+
+TEST_CASE("smtlib_parser.round_trip") {
+  ExprFactory efac;
+  Expr a = bv::bvConst(mkTerm<std::string>("a", efac), 32);
+  Expr x = a;
+  for (unsigned i = 0; i < 30; ++i)
+    x = mk<BADD>(x, mk<BMUL>(x, x));
+  Expr e = mk<BULT>(x, a);
+
+  std::string str;
+  llvm::raw_string_ostream out(str);
+  SmtLibWriter writer(out);
+  writer.writeDeclareFun(bind::fname(a));
+  writer.writeAssert(e);
+  out.flush();
+
+  // -- sharing is preserved and hash-consing gives back the same DAG
+  SmtLibParser parser(efac);
+  REQUIRE(parser.parse(str));
+  REQUIRE(parser.getAssertions().size() == 1);
+  CHECK(parser.getAssertions()[0].body == e);
+}
+
+/* Large CHC-COMP-like system: a chain of n relations over k variables */
+static std::string largeChc(unsigned n, unsigned k) {
+  std::string s = "(set-logic HORN)\n";
+  auto vars = [k](const char *p) {
+    std::string r;
+    for (unsigned i = 0; i < k; ++i)
+      r += std::string(" ") + p + std::to_string(i);
+    return r;
+  };
+  auto decls = [k](const char *p) {
+    std::string r;
+    for (unsigned i = 0; i < k; ++i)
+      r += std::string("(") + p + std::to_string(i) + " Int)";
+    return r;
+  };
+  for (unsigned j = 0; j <= n; ++j) {
+    s += "(declare-fun p" + std::to_string(j) + " (";
+    for (unsigned i = 0; i < k; ++i)
+      s += " Int";
+    s += ") Bool)\n";
+  }
+  s += "(assert (forall (" + decls("x") + ") (p0" + vars("x") + ")))\n";
+  for (unsigned j = 0; j < n; ++j) {
+    s += "(assert (forall (" + decls("x") + decls("y") + ") (=> (and (p" +
+         std::to_string(j) + vars("x") + ")";
+    for (unsigned i = 0; i < k; ++i) {
+      std::string xi = "x" + std::to_string(i), yi = "y" + std::to_string(i);
+      s += " (let ((t (+ " + xi + " " + xi + "))) (= " + yi + " (ite (> t " +
+           std::to_string(j) + ") t (- t 1))))";
+    }
+    s += ") (p" + std::to_string(j + 1) + vars("y") + "))))\n";
+  }
+  s += "(assert (forall (" + decls("x") + ") (=> (p" + std::to_string(n) +
+       vars("x") + ") false)))\n(check-sat)\n";
+  return s;
+}
+
+TEST_CASE("smtlib_parser.bench" * doctest::skip(true)) {
+  std::string script = largeChc(2000, 16);
+  using clock = std::chrono::steady_clock;
+
+  ExprFactory efac;
+  auto start = clock::now();
+  SmtLibParser parser(efac);
+  REQUIRE(parser.parse(script));
+  std::chrono::duration<double> native = clock::now() - start;
+
+  ExprFactory zefac;
+  EZ3 zctx(zefac);
+  start = clock::now();
+  Expr e = z3_from_smtlib(zctx, script);
+  std::chrono::duration<double> z3 = clock::now() - start;
+  REQUIRE(e);
+
+  MESSAGE("input: " << script.size() << " bytes, "
+                    << parser.getAssertions().size() << " assertions");
+  MESSAGE("native: " << native.count() << "s, z3 round trip: " << z3.count()
+                     << "s");
+}
@@ -0,0 +1,150 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <string>
+
+#include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/ExprGmp.hh"
+#include "seahorn/Expr/ExprOpBinder.hh"
+#include "seahorn/Expr/ExprOpBv.hh"
+#include "seahorn/Expr/Smt/EZ3.hh"
+#include "seahorn/Expr/Smt/SmtLibWriter.hh"
+#include "seahorn/HornClauseDB.hh"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "sea_doctest.hh" // doctest is last to avoid name clash
+
+using namespace expr;
+using namespace seahorn;
+
+static Expr mkInt(signed long num, ExprFactory &efac) {
+  return mkTerm<expr::mpz_class>(expr::mpz_class(num), efac);
+}
+
+static Expr intConst(const std::string &name, ExprFactory &efac) {
+  return bind::intConst(mkTerm<std::string>(name, efac));
+}
+
+/* Writes e as a single assertion after declaring decls */
+static std::string toSmtLib(Expr e, const ExprVector &decls) {
+  std::string str;
+  llvm::raw_string_ostream out(str);
+  SmtLibWriter writer(out);
+  for (Expr d : decls) {
+    writer.writeDeclareFun(bind::fname(d));
+    out << "\n";
+  }
+  writer.writeAssert(e);
+  return out.str();
+}
+
+/* Checks with Z3 that the written term is equivalent to e as printed by Z3 */
+static void checkEquivalent(Expr e, const ExprVector &decls) {
+  std::string str;
+  llvm::raw_string_ostream out(str);
+  SmtLibWriter writer(out);
+  for (Expr d : decls) {
+    writer.writeDeclareFun(bind::fname(d));
+    out << "\n";
+  }
+  EZ3 zctx(e->efac());
+  out << "(assert (not (= ";
+  writer.writeTerm(e);
+  out << " " << zctx.toSmtLib(e) << ")))\n";
+  out.flush();
+  CAPTURE(str);
+
+  z3::context ctx;
+  z3::solver s(ctx);
+  s.from_string(str.c_str());
+  CHECK(s.check() == z3::unsat);
+}
+
+TEST_CASE("smtlib.let_sharing") {
+  ExprFactory efac;
+  Expr a = bv::bvConst(mkTerm<std::string>("a", efac), 32);
+  // -- a tree of 2^40 nodes, but a DAG of 40
+  Expr x = a;
+  for (unsigned i = 0; i < 40; ++i)
+    x = mk<BADD>(x, x);
+  Expr e = mk<EQ>(x, bv::bvnum(expr::mpz_class(0UL), 32, efac));
+
+  std::string str = toSmtLib(e, {a});
+  CHECK(str.find("(let ") != std::string::npos);
+  CHECK(str.size() < 4096);
+  checkEquivalent(e, {a});
+}
+
+TEST_CASE("smtlib.operators") {
+  ExprFactory efac;
+  Expr x = intConst("x", efac);
+  Expr y = intConst("y#1", efac);
+  Expr b = bv::bvConst(mkTerm<std::string>("main@%b.0", efac), 8);
+  Expr arr = bind::mkConst(mkTerm<std::string>("A", efac),
+                           sort::arrayTy(mk<INT_TY>(efac), mk<INT_TY>(efac)));
+
+  ExprVector conj;
+  conj.push_back(mk<EQ>(mk<MOD>(x, mkInt(3, efac)), mkInt(-1, efac)));
+  conj.push_back(mk<NEQ>(mk<DIV>(y, mkInt(2, efac)), mk<UN_MINUS>(x)));
+  conj.push_back(mk<EQ>(mk<SELECT>(mk<STORE>(arr, x, y), x), y));
+  conj.push_back(
+      mk<EQ>(bv::sext(bv::extract(3, 0, b), 24),
+             bv::extract(23, 0, bv::zext(mk<BCONCAT>(b, b, b), 40))));
+  conj.push_back(mk<BULT>(b, bv::bvnum(expr::mpz_class(-1L), 8, efac)));
+  conj.push_back(mk<ITE>(mk<GT>(x, y), mk<TRUE>(efac),
+                         mk<LEQ>(mk<PLUS>(x, y), mkInt(7, efac))));
+  Expr e = mknary<AND>(conj);
+  checkEquivalent(e, {x, y, b, arr});
+}
+
+TEST_CASE("smtlib.quantifiers") {
+  ExprFactory efac;
+  Expr x = intConst("x", efac);
+  Expr y = intConst("y", efac);
+  Expr z = intConst("z", efac);
+  // -- a shared sub-term under a quantifier that uses the bound variable
+  Expr s = mk<PLUS>(x, y);
+  Expr body = mk<OR>(mk<GT>(mk<MULT>(s, s), z), mk<LT>(s, z));
+  Expr e = mk<AND>(bind::abs<FORALL>(x, y, body), mk<GT>(z, mkInt(0, efac)));
+  checkEquivalent(e, {z});
+}
+
+static std::string hornSmtLib(bool safe) {
+  ExprFactory efac;
+  HornClauseDB db(efac);
+  ExprVector sig{mk<INT_TY>(efac), mk<BOOL_TY>(efac)};
+  Expr inv = bind::fdecl(mkTerm<std::string>("inv", efac), sig);
+  Expr err = bind::boolConstDecl(mkTerm<std::string>("err", efac));
+  db.registerRelation(inv);
+  db.registerRelation(err);
+
+  Expr x = intConst("x", efac);
+  Expr y = intConst("y", efac);
+  ExprVector vx{x}, vxy{x, y};
+  db.addRule(vx, mk<IMPL>(mk<EQ>(x, mkInt(0, efac)), bind::fapp(inv, x)));
+  db.addRule(vxy, mk<IMPL>(mk<AND>(bind::fapp(inv, x),
+                                   mk<EQ>(y, mk<PLUS>(x, mkInt(1, efac)))),
+                           bind::fapp(inv, y)));
+  Expr bad = safe ? mk<LT>(x, mkInt(0, efac)) : mk<GT>(x, mkInt(5, efac));
+  db.addRule(vx, mk<IMPL>(mk<AND>(bind::fapp(inv, x), bad), bind::fapp(err)));
+  db.addQuery(bind::fapp(err));
+
+  REQUIRE(db.isSmtLibWritable());
+  std::string str;
+  llvm::raw_string_ostream out(str);
+  db.writeSmtLib(out);
+  return out.str();
+}
+
+TEST_CASE("smtlib.horn") {
+  for (bool safe : {true, false}) {
+    std::string str = hornSmtLib(safe);
+    CAPTURE(str);
+    CHECK(str.find("(set-logic HORN)") == 0);
+    z3::context ctx;
+    z3::solver s(ctx, "HORN");
+    s.from_string(str.c_str());
+    // -- a satisfiable set of CHCs is safe
+    CHECK(s.check() == (safe ? z3::sat : z3::unsat));
+  }
+}
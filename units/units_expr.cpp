@@ -1,9 +1,21 @@
 #include "seahorn/Expr/Expr.hh"
+#include "seahorn/Expr/ExprCache.hh"
+#include "seahorn/Expr/ExprFreeVars.hh"
 #include "seahorn/Expr/ExprGmp.hh"
 #include "seahorn/Expr/ExprLlvm.hh"
+#include "seahorn/Expr/Smt/EZ3.hh"
+#include "seahorn/Expr/Smt/Z3.hh"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/ADT/APInt.h"
+#include "boost/bimap.hpp"
+#include "boost/bimap/list_of.hpp"
+#include "boost/bimap/unordered_set_of.hpp"
 #include "boost/lexical_cast.hpp"
+
+#include <chrono>
+#include <climits>
+#include <random>
+
 #include "sea_doctest.hh" // doctest is last to avoid name clash
 
 inline expr::mpz_class toMpzE(const llvm::APInt &v) {
@@ -52,3 +64,405 @@ TEST_CASE("expr.APInt.large") {
   numA2.print(actual, false);
   CHECK(actual.str() == numZ2.to_string());
 }
+
+TEST_CASE("expr.mpz.small") {
+  using namespace expr;
+  ExprFactory efac;
+
+  // -- the same number is the same expression however it is created
+  Expr a = mkTerm<mpz_class>(42, efac);
+  CHECK(a == mkTerm(mpz_class(42L), efac));
+  CHECK(a == mkTerm(mpz_class("42"), efac));
+  CHECK(a == mkTerm<mpz_class>(42UL, efac));
+  CHECK(a->op().hash() == mkTerm(mpz_class("42"), efac)->op().hash());
+  signed long v;
+  CHECK(getSmallMpz(a, v));
+  CHECK(v == 42);
+  CHECK(getTerm<mpz_class>(a) == 42L);
+
+  Expr neg = mkTerm<mpz_class>(-7, efac);
+  CHECK(neg == mkTerm(mpz_class("-7"), efac));
+  CHECK(getTerm<mpz_class>(neg).to_string() == "-7");
+
+  // -- numbers that do not fit in a signed long are stored in GMP
+  Expr big = mkTerm<mpz_class>(ULONG_MAX, efac);
+  CHECK(!getSmallMpz(big, v));
+  CHECK(big == mkTerm(mpz_class("18446744073709551615"), efac));
+  CHECK(getTerm<mpz_class>(big).to_string() == "18446744073709551615");
+  CHECK(big != mkTerm<mpz_class>(-1, efac));
+  Expr huge = mkTerm(mpz_class("453350497004842588831744"), efac);
+  CHECK(huge == mkTerm(mpz_class("453350497004842588831744"), efac));
+  CHECK(!getSmallMpz(huge, v));
+
+  // -- bit-vector numerals
+  Expr n = bv::bvnum(5U, 32, efac);
+  CHECK(n == bv::bvnum(mpz_class(5UL), 32, efac));
+  CHECK(bv::toSmallNum(n, v));
+  CHECK(v == 5);
+  CHECK(bv::toMpz(n) == 5L);
+  CHECK(bv::toMpz(bv::bvnum(ULONG_MAX, 64, efac)).to_string() ==
+        "18446744073709551615");
+}
+
+TEST_CASE("expr.mpz.z3") {
+  using namespace expr;
+  using namespace seahorn;
+  ExprFactory efac;
+  EZ3 z3(efac);
+  // -- numerals are marshaled to Z3 and back
+  ZSimplifier<EZ3> zs(z3);
+
+  std::vector<Expr> nums = {
+      mkTerm<mpz_class>(0, efac),
+      mkTerm<mpz_class>(-12345, efac),
+      mkTerm<mpz_class>(LONG_MIN, efac),
+      mkTerm<mpz_class>(ULONG_MAX, efac),
+      mkTerm(mpz_class("-453350497004842588831744"), efac),
+      bv::bvnum(0U, 8, efac),
+      bv::bvnum(255U, 8, efac),
+      bv::bvnum(LONG_MAX, 64, efac),
+      bv::bvnum(ULONG_MAX, 64, efac),
+      bv::bvnum(mpz_class("453350497004842588831744"), 85, efac)};
+  for (Expr e : nums) {
+    INFO("num: " << *e);
+    CHECK(zs.simplify(e) == e);
+  }
+  // -- negative bit-vector numerals are taken modulo 2^width
+  CHECK(zs.simplify(bv::bvnum(-1, 8, efac)) ==
+        bv::bvnum(255U, 8, efac));
+}
+
+TEST_CASE("expr.mpz.bench" * doctest::skip(true)) {
+  using namespace expr;
+  using clock = std::chrono::steady_clock;
+  const unsigned n = 1 << 20;
+
+  auto run = [&](auto mkNum) {
+    ExprFactory efac;
+    ExprVector v;
+    v.reserve(2 * n);
+    auto start = clock::now();
+    // -- every numeral is created twice, the second time it is found in
+    // -- the unique table
+    for (unsigned r = 0; r < 2; ++r)
+      for (unsigned i = 0; i < n; ++i)
+        v.push_back(mkNum(i, efac));
+    std::chrono::duration<double> t = clock::now() - start;
+    return t.count();
+  };
+
+  double tg = run([](unsigned i, ExprFactory &efac) {
+    return bv::bvnum(mpz_class(static_cast<unsigned long>(i)), 32, efac);
+  });
+  double ts = run([](unsigned i, ExprFactory &efac) {
+    return bv::bvnum(i, 32, efac);
+  });
+
+  MESSAGE("numerals: " << 2 * n);
+  MESSAGE("through mpz_class: " << 2 * n / tg << " numerals/s");
+  MESSAGE("small: " << 2 * n / ts << " numerals/s");
+}
+
+TEST_CASE("expr.epoch") {
+  using namespace expr;
+  ExprFactory efac;
+  Expr x = bind::intConst(mkTerm<std::string>("x", efac));
+
+  efac.beginEpoch();
+  {
+    Expr e = mk<PLUS>(x, mkTerm<mpz_class>(1, efac));
+    ENode *p = e.get();
+    unsigned id = e->getId();
+    e.reset();
+    // -- garbage is kept until the epoch ends
+    CHECK(efac.garbageSize() == 1);
+    // -- and is reused when it is created again
+    e = mk<PLUS>(x, mkTerm<mpz_class>(1, efac));
+    CHECK(e.get() == p);
+    CHECK(e->getId() == id);
+  }
+  // -- a node that is released again is queued once
+  CHECK(efac.garbageSize() == 1);
+  efac.collect();
+  CHECK(efac.garbageSize() == 0);
+
+  // -- a deep chain is released without recursion
+  {
+    Expr e = x;
+    for (unsigned i = 0; i < 100000; ++i)
+      e = mk<PLUS>(e, mkTerm<mpz_class>(i % 8, efac));
+  }
+  CHECK(efac.garbageSize() > 0);
+  efac.endEpoch();
+  CHECK(efac.garbageSize() == 0);
+  CHECK(!efac.inEpoch());
+
+  // -- outside of an epoch garbage is freed eagerly
+  {
+    Expr e = mk<PLUS>(x, x);
+    e.reset();
+    CHECK(efac.garbageSize() == 0);
+  }
+}
+
+TEST_CASE("expr.epoch.bench" * doctest::skip(true)) {
+  using namespace expr;
+  using clock = std::chrono::steady_clock;
+  const unsigned n = 1 << 21;
+
+  // -- time to release a DAG of n nodes
+  auto run = [&](bool epoch) {
+    ExprFactory efac;
+    Expr x = bind::intConst(mkTerm<std::string>("x", efac));
+    if (epoch)
+      efac.beginEpoch();
+    ExprVector v;
+    v.reserve(n);
+    for (unsigned i = 0; i < n; ++i)
+      v.push_back(mk<PLUS>(x, mkTerm<mpz_class>(i, efac)));
+    auto start = clock::now();
+    v.clear();
+    if (epoch)
+      efac.endEpoch();
+    std::chrono::duration<double> t = clock::now() - start;
+    return t.count();
+  };
+
+  double te = run(false);
+  double tb = run(true);
+  MESSAGE("nodes: " << 2 * n);
+  MESSAGE("eager release: " << te << "s");
+  MESSAGE("epoch release: " << tb << "s");
+}
+
+TEST_CASE("expr.summary") {
+  using namespace expr;
+  ExprFactory efac;
+  Expr x = bind::intConst(mkTerm<std::string>("x", efac));
+  Expr y = bind::intConst(mkTerm<std::string>("y", efac));
+  Expr a = bind::mkConst(mkTerm<std::string>("a", efac),
+                         sort::arrayTy(sort::intTy(efac), sort::intTy(efac)));
+
+  Expr s = mk<PLUS>(x, y);
+  Expr e = mk<MULT>(s, s);
+  // -- sizes agree with the visitors, the bound is the tree size
+  CHECK(e->sizeBound() == treeSize(e));
+  CHECK(e->sizeBound() >= dagSize(e));
+  CHECK(e->depth() == s->depth() + 1);
+  CHECK(mkTerm<mpz_class>(1, efac)->depth() == 0);
+
+  CHECK(e->hasOpFamily(OpFamilyId::NumericOp));
+  CHECK(!e->hasOpFamily(OpFamilyId::ArrayOp));
+  CHECK(!e->hasOpFamily(OpFamilyId::BinderOp));
+  Expr r = mk<SELECT>(a, x);
+  CHECK(r->hasOpFamily(OpFamilyId::ArrayOp));
+  CHECK(mk<PLUS>(r, y)->hasOpFamily(OpFamilyId::ArrayOp));
+
+  CHECK(contains(e, s));
+  CHECK(contains(e, e));
+  CHECK(!contains(s, e));
+  CHECK(!contains(e, r));
+
+  // -- the bound saturates instead of overflowing
+  Expr big = x;
+  for (unsigned i = 0; i < 40; ++i)
+    big = mk<PLUS>(big, big);
+  CHECK(big->sizeBound() == UINT32_MAX);
+  CHECK(big->depth() == 42);
+  CHECK(dagSize(big) == 40 + 4);
+}
+
+TEST_CASE("expr.freevars") {
+  using namespace expr;
+  ExprFactory efac;
+  Expr x = bind::intConst(mkTerm<std::string>("x", efac));
+  Expr y = bind::intConst(mkTerm<std::string>("y", efac));
+  Expr z = bind::intConst(mkTerm<std::string>("z", efac));
+  Expr b0 = bind::intBVar(0, efac);
+  Expr one = mkTerm<mpz_class>(1, efac);
+
+  CHECK(b0->hasBoundVar());
+  CHECK(!x->hasBoundVar());
+  CHECK(mk<PLUS>(x, b0)->hasBoundVar());
+
+  FreeVarIndex idx;
+  Expr e = mk<AND>(mk<LT>(mk<PLUS>(x, one), y), mk<GT>(x, one));
+  CHECK(idx.signature(one) == 0);
+  CHECK(idx.signature(e) ==
+        (FreeVarIndex::constSignature(x) | FreeVarIndex::constSignature(y)));
+
+  const ExprVector &vs = idx.vars(e);
+  REQUIRE(vs.size() == 2);
+  CHECK(vs[0]->getId() < vs[1]->getId());
+  CHECK(((vs[0] == x && vs[1] == y) || (vs[0] == y && vs[1] == x)));
+  CHECK(idx.vars(one).empty());
+
+  CHECK(idx.mayContain(e, mk<PLUS>(x, one)));
+  CHECK(!idx.mayContain(e, b0));
+  CHECK(!idx.mayContain(mk<PLUS>(x, one), e));
+
+  // -- same result as replace
+  ExprMap sub;
+  sub[x] = z;
+  sub[mk<GT>(x, one)] = mk<TRUE>(efac);
+  CHECK(idx.replace(e, sub) == replace(e, sub));
+  sub.clear();
+  sub[b0] = y;
+  Expr f = mk<OR>(e, mk<EQ>(b0, mk<PLUS>(x, b0)));
+  CHECK(idx.replace(f, sub) == replace(f, sub));
+  CHECK(idx.replace(e, sub) == e);
+
+  // -- substitution of bound variables
+  ExprVector bvars;
+  filter(
+      f, [](Expr u) { return bind::isBVar(u); },
+      [](Expr u) { return !u->hasBoundVar(); }, std::back_inserter(bvars));
+  CHECK(bvars.size() == 1);
+  CHECK(bind::sub(y, f) == replace(f, sub));
+}
+
+TEST_CASE("expr.cache") {
+  using namespace expr;
+  ExprFactory efac;
+  Expr x = bind::intConst(mkTerm<std::string>("x", efac));
+  ExprVector es;
+  for (unsigned i = 0; i < 64; ++i)
+    es.push_back(mk<PLUS>(x, mkTerm<mpz_class>(i, efac)));
+
+  SUBCASE("lookup and eviction") {
+    ExprCache<unsigned> cache(16);
+    for (unsigned i = 0; i < 16; ++i)
+      CHECK(cache.insert(es[i], i).second);
+    CHECK(!cache.insert(es[3], 100).second);
+    CHECK(cache.size() == 16);
+    for (unsigned i = 0; i < 16; ++i) {
+      auto it = cache.find(es[i]);
+      REQUIRE(it != cache.end());
+      CHECK(it->first == es[i].get());
+      CHECK(it->second == i);
+    }
+    // -- the cache holds its keys
+    CHECK(es[0]->use_count() == 2);
+
+    // -- entries that were hit since the last sweep survive
+    cache.insert(es[16], 16);
+    CHECK(cache.size() == 16);
+    cache.find(es[16]);
+    for (unsigned i = 17; i < 64; ++i) {
+      cache.find(es[16]);
+      cache.insert(es[i], i);
+    }
+    CHECK(cache.size() == 16);
+    CHECK(cache.find(es[16]) != cache.end());
+    CHECK(cache.find(es[63]) != cache.end());
+
+    // -- every remaining entry can be found after the shifts of erase
+    unsigned found = 0;
+    for (unsigned i = 0; i < 64; ++i) {
+      auto it = cache.find(es[i]);
+      if (it != cache.end()) {
+        CHECK(it->second == i);
+        ++found;
+      }
+    }
+    CHECK(found == 16);
+
+    cache.clear();
+    CHECK(cache.size() == 0);
+    CHECK(es[0]->use_count() == 1);
+  }
+
+  SUBCASE("weak") {
+    ExprCache<unsigned> cache(8, efac);
+    Expr e = mk<MINUS>(x, x);
+    cache.insert(e, 1);
+    cache.insert(es[0], 2);
+    CHECK(e->use_count() == 1);
+    CHECK(cache.size() == 2);
+    // -- the factory erases released keys
+    e.reset();
+    CHECK(cache.size() == 1);
+    CHECK(cache.find(es[0])->second == 2);
+  }
+}
+
+namespace {
+/// The previous ExprCache, an LRU list over a node-based hash map.
+/// Baseline for expr.cache.bench
+template <typename T> class BimapExprCache {
+  using cache_type =
+      boost::bimaps::bimap<boost::bimaps::unordered_set_of<expr::ENode *>,
+                           boost::bimaps::list_of<T>>;
+  using value_type = typename cache_type::left_value_type;
+
+  cache_type cache;
+  size_t capacity;
+
+public:
+  using const_iterator = typename cache_type::left_const_iterator;
+
+  BimapExprCache(size_t c) : capacity(c) {}
+  ~BimapExprCache() {
+    for (auto &kv : cache.left)
+      kv.first->efac().Deref(kv.first);
+  }
+
+  const_iterator find(expr::Expr e) {
+    auto it = cache.left.find(&*e);
+    if (it != cache.left.end())
+      cache.right.relocate(cache.right.end(), cache.project_right(it));
+    return it;
+  }
+  const_iterator end() const { return cache.left.end(); }
+
+  void insert(expr::Expr e, const T &v) {
+    if (cache.size() == capacity) {
+      auto it = cache.right.begin();
+      expr::ENode *old = it->second;
+      old->efac().Deref(old);
+      cache.right.erase(it);
+    }
+    e->Ref();
+    cache.left.insert(value_type(&*e, v));
+  }
+};
+} // namespace
+
+TEST_CASE("expr.cache.bench" * doctest::skip(true)) {
+  using namespace expr;
+  ExprFactory efac;
+  Expr x = bind::intConst(mkTerm<std::string>("x", efac));
+  const unsigned n = 1u << 16;
+  ExprVector es;
+  for (unsigned i = 0; i < n; ++i)
+    es.push_back(mk<PLUS>(x, mkTerm<mpz_class>(i, efac)));
+
+  // -- a marshalling-like workload: mostly hits on a hot set that fits
+  // -- in the cache, and a stream of misses on cold terms
+  std::vector<unsigned> trace;
+  std::mt19937 rnd(42);
+  for (unsigned i = 0; i < (1u << 23); ++i)
+    trace.push_back(rnd() % 10 < 8 ? rnd() % 6000 : rnd() % n);
+
+  auto run = [&](auto &cache) {
+    auto start = std::chrono::steady_clock::now();
+    size_t hits = 0;
+    for (unsigned i : trace) {
+      if (cache.find(es[i]) != cache.end())
+        ++hits;
+      else
+        cache.insert(es[i], i);
+    }
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    MESSAGE("hits: " << hits);
+    return d.count();
+  };
+
+  BimapExprCache<unsigned> lru(8192);
+  double tl = run(lru);
+  ExprCache<unsigned> clock(8192);
+  double tc = run(clock);
+  MESSAGE("lookups: " << trace.size());
+  MESSAGE("bimap lru: " << tl << "s");
+  MESSAGE("flat clock: " << tc << "s");
+}
@@ -298,4 +298,91 @@ TEST_CASE("yices2-const-array.test") {
   CHECK(true);
 }
 
+TEST_CASE("yices2-incremental.test") {
+  using namespace std;
+  using namespace expr;
+  using namespace seahorn;
+  using seahorn::solver::SolverResult;
+
+  expr::ExprFactory efac;
+  seahorn::solver::yices_solver_impl s(efac);
+
+  Expr x = op::bv::bvConst(mkTerm<string>("x", efac), 32);
+  Expr y = op::bv::bvConst(mkTerm<string>("y", efac), 32);
+  Expr e1 = mk<EQ>(x, op::bv::bvnum(3, 32, efac));
+  Expr e2 = mk<BSGT>(y, x);
+  Expr e3 = mk<BSGT>(x, y);
+
+  // -- formulas are asserted in one batch by check()
+  s.add(e1);
+  s.add(e2);
+  CHECK(s.check() == SolverResult::SAT);
+
+  // -- formulas added after push are dropped by pop, even if never checked
+  s.push();
+  s.add(e3);
+  s.pop();
+  CHECK(s.check() == SolverResult::SAT);
+
+  s.push();
+  s.add(e3);
+  CHECK(s.check() == SolverResult::UNSAT);
+  s.pop();
+  CHECK(s.check() == SolverResult::SAT);
+
+  // -- model values are cached, and the term cache survives push/pop
+  auto model = s.get_model();
+  Expr vx = model->eval(x, false);
+  CHECK(vx == op::bv::bvnum(3, 32, efac));
+  CHECK(model->eval(x, false) == vx);
+
+  // -- unsat core over assumptions
+  // -- every core contains gt5 since e2 is consistent with e1
+  Expr gt5 = mk<BSGT>(x, op::bv::bvnum(5, 32, efac));
+  ExprVector core;
+  unsat_core(&s, {gt5, e2}, core);
+  CHECK(std::find(core.begin(), core.end(), gt5) != core.end());
+
+  s.reset();
+  s.add(e3);
+  CHECK(s.check() == SolverResult::SAT);
+}
+
+TEST_CASE("yices2-to-smt-lib.test") {
+  using namespace std;
+  using namespace expr;
+  using namespace seahorn;
+  using seahorn::solver::SolverResult;
+
+  expr::ExprFactory efac;
+  seahorn::solver::yices_solver_impl s(efac);
+
+  Expr x = op::bv::bvConst(mkTerm<string>("x", efac), 32);
+  Expr y = op::bv::bvConst(mkTerm<string>("y", efac), 32);
+
+  // -- the dump of the query (used by --sea-slow-query) has the same
+  // -- result in Z3
+  auto z3Check = [&s]() {
+    std::string str;
+    llvm::raw_string_ostream out(str);
+    s.to_smt_lib(out);
+    out.flush();
+    z3::context ctx;
+    z3::solver z(ctx);
+    z.from_string(str.c_str());
+    return z.check();
+  };
+
+  s.add(mk<BSGT>(y, x));
+  CHECK(s.check() == SolverResult::SAT);
+  CHECK(z3Check() == z3::sat);
+
+  s.push();
+  s.add(mk<BSGT>(x, y));
+  CHECK(s.check() == SolverResult::UNSAT);
+  CHECK(z3Check() == z3::unsat);
+  s.pop();
+  CHECK(z3Check() == z3::sat);
+}
+
 #endif